@@ -0,0 +1,140 @@
+/* Created on: Oct 19, 2026
+ *     Author: T.Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_FRAME_ALLOCATOR_H_
+# define GRAPHICS_ORIGIN_FRAME_ALLOCATOR_H_
+# include "../graphics_origin.h"
+# include "../tools/memory.h"
+# include "../tools/arena_allocator.h"
+# include <memory>
+# include <vector>
+
+namespace graphics_origin {
+  namespace application {
+
+    /**@brief Memory for the temporary data of a frame.
+     *
+     * Renderables often need temporary buffers to build the data sent to the
+     * GPU. Allocating them with new or malloc at each frame is slow and
+     * fragments the heap. Instead, they can allocate them with this frame
+     * allocator, which is available from the renderer:
+     * \code{.cpp}
+     * frame_vector< gl_real > positions( 3 * n, renderer_ptr->get_frame_allocator() );
+     * \endcode
+     *
+     * The frame allocator is made of two linear arenas. The renderer switches
+     * between them at the beginning of each frame, by calling next_frame().
+     * The arena selected is then reset, since the frame that used it is
+     * complete. As a consequence, the memory allocated during a frame stays
+     * valid during the next frame, but not longer.
+     *
+     * When an arena is full, the allocations fall back to the heap, and the
+     * arena is enlarged the next time it is reset. Thus, after a few frames,
+     * no more calls to malloc are done. Deallocations do nothing: memory is
+     * reclaimed all at once when its arena is reset.
+     *
+     * A single frame with large temporaries, e.g. to upload a new mesh, would
+     * leave its arena enlarged for good. Thus, an arena that used at most a
+     * quarter of its capacity during quiet_frames_before_shrinking
+     * consecutive frames is shrunk to twice the largest usage of those
+     * frames, but never below the initial capacity.
+     *
+     * This class is not thread-safe: it should only be used in the thread of
+     * the renderer.
+     */
+    class GO_API frame_allocator {
+    public:
+      /**@brief Usage of the frame allocator during a frame. */
+      struct statistics {
+        statistics();
+        /**Index of the frame. */
+        size_t frame;
+        /**Number of allocations done. */
+        size_t number_of_allocations;
+        /**Number of allocations that did not fit in the arena. */
+        size_t number_of_overflows;
+        /**Bytes used in the arena, including headers and padding. */
+        size_t used_bytes;
+        /**Bytes allocated on the heap because the arena was full. */
+        size_t overflow_bytes;
+        /**Size of the arena. */
+        size_t capacity;
+      };
+
+      /**@brief Build a frame allocator.
+       *
+       * @param capacity Initial size, in bytes, of each of the two arenas. */
+      explicit frame_allocator( size_t capacity = size_t(8) << 20 );
+      ~frame_allocator();
+
+      /**@brief Allocate memory for the current frame.
+       *
+       * This function has the signature of tools::memory_arena::allocate(),
+       * so that a frame allocator can be used with tools::arena_allocator.
+       * @return Aligned memory, valid until the end of the next frame. */
+      void* allocate(
+          size_t size_in_bytes,
+          size_t alignment,
+          const char* file,
+          const char* line,
+          const char* function );
+
+      /**@brief Does nothing.
+       *
+       * Memory is reclaimed when the arena that provided it is reset. */
+      inline void deallocate( void* ) {}
+
+      /**@brief Start a new frame.
+       *
+       * Switch to the other arena and reset it. The memory allocated during
+       * the frame before the current one is reclaimed. */
+      void next_frame();
+
+      /**@brief Get the usage of the frame allocator during the current frame. */
+      const statistics& get_current_frame_statistics() const;
+      /**@brief Get the usage of the frame allocator during the last complete frame. */
+      const statistics& get_last_frame_statistics() const;
+      /**@brief Get the maximum number of bytes used by a frame so far. */
+      size_t get_peak_usage() const;
+
+      /**@brief Number of consecutive frames using at most a quarter of an
+       * arena before this arena is shrunk. */
+      static constexpr size_t quiet_frames_before_shrinking = 256;
+
+    private:
+      typedef tools::memory_arena<
+          tools::allocation_policy::linear,
+          tools::thread_policy::single_thread,
+          tools::bounds_checking_policy::no,
+          tools::memory_tracking_policy::no,
+          tools::memory_tagging_policy::no > arena_type;
+
+      struct buffer {
+        explicit buffer( size_t capacity );
+        ~buffer();
+        void release_overflows();
+
+        tools::memory_area::on_heap area;
+        tools::allocation_policy::linear allocator;
+        arena_type arena;
+        std::vector< void* > overflows;
+        statistics stats;
+        /**Number of consecutive quiet frames, and their largest usage. */
+        size_t quiet_frames;
+        size_t quiet_peak_usage;
+      };
+
+      std::unique_ptr< buffer > m_buffers[2];
+      statistics m_last_frame;
+      size_t m_initial_capacity;
+      size_t m_peak_usage;
+      size_t m_frame;
+      unsigned char m_current;
+    };
+
+    /**@brief A std::vector whose memory is provided by a frame allocator. */
+    template< typename type >
+    using frame_vector = std::vector< type, tools::arena_allocator< type, frame_allocator > >;
+  }
+}
+# endif
@@ -1,30 +1,21 @@
 # ifndef GRAPHICS_ORIGIN_BALLS_RENDERABLE_H_
 # define GRAPHICS_ORIGIN_BALLS_RENDERABLE_H_
 # include "../renderable.h"
-# include "../../tools/tight_buffer_manager.h"
+# include "../../tools/tight_soa_buffer_manager.h"
 # include "../../geometry/ball.h"
 
 namespace graphics_origin {
   namespace application {
     class GO_API balls_renderable
       : public renderable {
-    public:
-      struct storage {
-        gl_vec4 ball;
-        gl_vec4 color;
-        storage( const gl_vec4& ball, const gl_vec4& color );
-        storage( const storage& other );
-
-        storage& operator=( storage && other );
-        storage& operator=( const storage& other );
-
-        storage();
-      };
     private:
-      typedef tools::tight_buffer_manager<
-          storage,
+      // balls and colors are stored in two columns, uploaded as two streams
+      enum { ball_column, color_column };
+      typedef tools::tight_soa_buffer_manager<
           uint32_t,
-          22 > balls_buffer;
+          22,
+          gl_vec4,
+          gl_vec4 > balls_buffer;
     public:
       balls_renderable(
           shader_program_ptr program,
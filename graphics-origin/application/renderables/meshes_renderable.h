@@ -44,6 +44,16 @@ namespace graphics_origin {
       void remove( handle h );
       storage& get( handle h );
 
+      /**@brief Enable the optimization of index buffers at upload.
+       *
+       * When enabled, triangles are reordered for the post-transform vertex
+       * cache and to reduce overdraw, and vertices are reordered in their
+       * order of first use before being sent to the GPU. The vertex cache
+       * statistics before and after optimization are logged. This is
+       * disabled by default since it slows down uploads.
+       * @param optimize True to enable the optimization. */
+      void set_index_buffer_optimization( bool optimize );
+
       /**
        * TODO: managing render type (wireframe, color, transparency, ...)
        */
@@ -54,6 +64,7 @@ namespace graphics_origin {
       void remove_gpu_data() override;
 
       mesh_buffer m_meshes;
+      bool m_optimize_index_buffers;
     };
 }}
 # endif 
@@ -2,6 +2,7 @@
 # define GRAPHICS_ORIGIN_QT_APPLICATION_RENDERER_H_
 # include "../geometry/matrix.h"
 # include "../tools/period_counter.h"
+# include "./frame_allocator.h"
 # include <atomic>
 # include <condition_variable>
 # include <QObject>
@@ -56,6 +57,14 @@ namespace graphics_origin {
       gl_vec3 get_camera_position() const;
       ///@}
 
+      /**@brief Access to the memory for the temporary data of a frame.
+       *
+       * Renderables can allocate temporary buffers in this allocator, e.g.
+       * to prepare data sent to the GPU, without calling malloc. Those buffers
+       * remain valid until the end of the next frame.
+       * \sa frame_allocator */
+      frame_allocator& get_frame_allocator();
+
     public slots:
       void render_next();
     signals:
@@ -131,6 +140,7 @@ namespace graphics_origin {
       /**Note: the camera is not deleted in the destructor. */
       camera* gl_camera;
       tools::period_counter period;
+      frame_allocator frame_memory;
       std::mutex lock;
       std::condition_variable cv;
       std::atomic_char size_changed;
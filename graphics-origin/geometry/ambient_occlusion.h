@@ -0,0 +1,77 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_AMBIENT_OCCLUSION_H_
+# define GRAPHICS_ORIGIN_AMBIENT_OCCLUSION_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  class mesh_spatial_optimization;
+
+  /**@brief Parameters of an ambient occlusion baking. */
+  struct GO_API ambient_occlusion_parameters {
+    ambient_occlusion_parameters();
+    /**@brief Number of rays cast from every point, which is also the number
+     * of rays added at each refinement round. */
+    uint32_t min_rays;
+    /**@brief Maximum number of rays cast from a point. */
+    uint32_t max_rays;
+    /**@brief A point stops casting rays once the standard error of its
+     * occlusion estimate is below this value. */
+    real max_standard_error;
+    /**@brief Occluders further than this distance are ignored. */
+    real max_distance;
+    /**@brief Offset of the ray origins along the normal, relative to the
+     * diagonal of the bounding box of the mesh, to avoid self occlusion. */
+    real bias;
+    /**@brief Seed of the ray directions. */
+    uint64_t seed;
+  };
+
+  /**@brief Bake the ambient occlusion at oriented points.
+   *
+   * Estimate, for each oriented point, the ambient occlusion, i.e. the
+   * cosine weighted fraction of its hemisphere hidden by the mesh, and the
+   * bent normal, i.e. the mean unoccluded direction. Rays are distributed
+   * according to the cosine, so the occlusion is the fraction of occluded
+   * rays. Their directions follow a low discrepancy sequence randomly
+   * rotated per point, so results only depend on the seed.
+   *
+   * Points are processed by chunks, in rounds: at each round, every point
+   * whose estimate is not accurate enough casts min_rays more rays. The
+   * rays of a round are tested in a single batch of any-hit queries. Thus,
+   * rays adapt to the variance: a point fully visible or fully hidden stops
+   * after the first round, while points in penumbra get more rays.
+   * @param m The spatial optimization of the mesh, with a BVH.
+   * @param points The points.
+   * @param normals The unit normals of the points.
+   * @param npoints The number of points.
+   * @param parameters The parameters of the baking.
+   * @param occlusion Pointer to an array of npoints occlusions in [0,1].
+   * @param bent_normals Pointer to an array of npoints bent normals, or
+   * null. The bent normal of a fully occluded point is its normal.
+   * @param nrays Pointer to an array of npoints number of rays cast, or
+   * null. */
+  GO_API void bake_ambient_occlusion(
+      const mesh_spatial_optimization& m,
+      const vec3* points, const vec3* normals, size_t npoints,
+      const ambient_occlusion_parameters& parameters,
+      real* occlusion, vec3* bent_normals = nullptr, uint32_t* nrays = nullptr );
+  /**@brief Bake the ambient occlusion of the vertices of a mesh.
+   *
+   * Bake the ambient occlusion at the vertices of the mesh of a spatial
+   * optimization, and store the accessibility, i.e. one minus the
+   * occlusion, in the vertex colors as a gray level.
+   * @param m The spatial optimization of the mesh, with a BVH.
+   * @param parameters The parameters of the baking.
+   * @param bent_normals If not null, will contain the bent normal of each
+   * vertex. */
+  GO_API void bake_ambient_occlusion(
+      mesh_spatial_optimization& m,
+      const ambient_occlusion_parameters& parameters,
+      std::vector< vec3 >* bent_normals = nullptr );
+
+} END_GO_NAMESPACE
+# endif
@@ -16,6 +16,13 @@ namespace graphics_origin {
         typedef uint32_t node_index;
         typedef uint32_t element_index;
         static constexpr size_t max_number_of_elements = (1U << uint8_t(sizeof(node_index)*8 - 1)) - 1;
+        /**Size of the fixed stacks used by traversals that must not allocate.
+         * The hierarchy is built on 63 bits Morton codes, with the 32 bits
+         * element index breaking ties between equal codes, so a root-to-leaf
+         * path has at most 63 + 32 = 95 internal nodes. Traversals push at
+         * most one node per level, so this size covers any hierarchy the
+         * builder can produce. */
+        static constexpr size_t traversal_stack_size = 128;
 
         static_assert(
             std::is_default_constructible< bounding_volume >::value,
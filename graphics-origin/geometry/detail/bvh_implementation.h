@@ -290,7 +290,7 @@ namespace {
         {
           iteration_required = false;
           # pragma omp parallel for reduction(bvbactivity_reduction: iteration_required)
-          for( thread_index tid = 0; tid < input.number_of_internal_nodes; ++ tid )
+          for( thread_index tid = 0; tid < input.number_of_leaf_nodes; ++ tid )
             {
               kernel( tid, iteration_required );
             }
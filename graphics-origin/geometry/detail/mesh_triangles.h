@@ -0,0 +1,36 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_GEOMETRY_DETAIL_MESH_TRIANGLES_H_
+# define GRAPHICS_ORIGIN_GEOMETRY_DETAIL_MESH_TRIANGLES_H_
+# include "../../graphics_origin.h"
+# include "../indexed_mesh.h"
+# include "../triangle.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry { namespace detail {
+
+  /**Build the triangles of the valid faces of a mesh, along with the index
+   * of the face of each triangle and, if indices is not null, the vertex
+   * indices of each triangle. */
+  inline void build_triangles(
+      const indexed_mesh& m, std::vector< triangle >& triangles,
+      std::vector< uint32_t >& faces, std::vector< uint32_t >* indices = nullptr )
+  {
+    const size_t nfaces = m.get_number_of_faces();
+    for( size_t i = 0; i < nfaces; ++ i )
+      {
+        const uint32_t* face = m.indices.data() + 3 * i;
+        if( face[0] == indexed_mesh::invalid_index
+         || face[1] == indexed_mesh::invalid_index
+         || face[2] == indexed_mesh::invalid_index )
+          continue;
+        triangles.emplace_back( m.vertices[ face[0] ], m.vertices[ face[1] ], m.vertices[ face[2] ] );
+        faces.push_back( uint32_t( i ) );
+        if( indices )
+          indices->insert( indices->end(), face, face + 3 );
+      }
+  }
+
+} } END_GO_NAMESPACE
+# endif
@@ -0,0 +1,27 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_GEOMETRY_DETAIL_SAMPLING_H_
+# define GRAPHICS_ORIGIN_GEOMETRY_DETAIL_SAMPLING_H_
+# include "../../graphics_origin.h"
+# include "../vec.h"
+
+BEGIN_GO_NAMESPACE namespace geometry { namespace detail {
+
+  /**Finalizer of SplitMix64, to derive independent values from a seed and
+   * an index. Consecutive indices thus get unrelated values. */
+  inline uint64_t mix_seed( uint64_t seed, uint64_t index )
+  {
+    uint64_t z = seed + ( index + 1 ) * 0x9E3779B97F4A7C15ull;
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+    return z ^ ( z >> 31 );
+  }
+
+  /**Increments of the R2 low discrepancy sequence in [0,1)^2, whose i-th
+   * point is the fractional part of a seed plus i times these increments. */
+  constexpr real r2_first_increment = 0.7548776662466927;
+  constexpr real r2_second_increment = 0.5698402909980532;
+
+} } END_GO_NAMESPACE
+# endif
@@ -0,0 +1,165 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_INDEX_BUFFER_OPTIMIZATION_H_
+# define GRAPHICS_ORIGIN_INDEX_BUFFER_OPTIMIZATION_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <cstring>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct indexed_mesh;
+
+  /**@brief Statistics of a post-transform vertex cache.
+   *
+   * Those statistics are obtained by simulating a FIFO cache of transformed
+   * vertices, as found on most GPUs.
+   */
+  struct GO_API vertex_cache_statistics {
+    vertex_cache_statistics();
+    /**@brief Number of vertices transformed, i.e. number of cache misses. */
+    size_t transformed_vertices;
+    /**@brief Average cache miss ratio: the number of vertices transformed
+     * per triangle. It lies in [0.5,3], lower is better. */
+    real acmr;
+    /**@brief Average transform to vertex ratio: the number of vertices
+     * transformed per referenced vertex. It is at least 1, which is the
+     * optimal value. */
+    real atvr;
+  };
+
+  /**@brief Simulate a FIFO vertex cache.
+   *
+   * Simulate a FIFO post-transform vertex cache on an index buffer to
+   * measure how many vertices would be transformed. This allows to check the
+   * efficiency of an index buffer on CPU without any GPU.
+   * @param indices The index buffer, three indices per triangle.
+   * @param nindices The number of indices.
+   * @param nvertices The number of vertices.
+   * @param cache_size The number of entries in the cache.
+   * @return The cache statistics. */
+  GO_API
+  vertex_cache_statistics analyze_vertex_cache(
+      const uint32_t* indices, size_t nindices, size_t nvertices, size_t cache_size = 16 );
+
+  /**@brief Reorder triangles for the post-transform vertex cache.
+   *
+   * Reorder triangles with the Tipsify algorithm of Sander et al., which
+   * fans around vertices while they are still in the cache. It runs in
+   * linear time and usually brings the ACMR close to 0.7 for a cache of 16
+   * entries. Triangles are reordered but not modified.
+   * @param destination The reordered index buffer, with nindices elements. It
+   * must not overlap with indices.
+   * @param indices The index buffer to reorder.
+   * @param nindices The number of indices.
+   * @param nvertices The number of vertices.
+   * @param cache_size The number of entries in the targeted cache.
+   * @param clusters If not null, will contain the index of the first
+   * triangle of each cluster, i.e. each time the fanning restarted from a
+   * vertex out of the cache. Those clusters can be reordered freely without
+   * degrading much the cache efficiency. There are at most nindices / 3
+   * clusters, so the caller can allocate this buffer where it wants.
+   * @return The number of clusters. */
+  GO_API
+  size_t optimize_vertex_cache(
+      uint32_t* destination, const uint32_t* indices, size_t nindices, size_t nvertices,
+      size_t cache_size = 16, uint32_t* clusters = nullptr );
+
+  /**@brief Reorder clusters of triangles to reduce overdraw.
+   *
+   * Reorder clusters of triangles so that clusters facing outward are drawn
+   * first, which reduces overdraw for most viewpoints. Clusters produced by
+   * optimize_vertex_cache() are split where the vertex cache efficiency
+   * allows it, then sorted. Clusters are only split when the ACMR of the
+   * parts stays below threshold times the ACMR of the whole cluster, so the
+   * vertex cache efficiency is roughly preserved.
+   * @param destination The reordered index buffer, with nindices elements. It
+   * must not overlap with indices.
+   * @param indices The index buffer, usually the output of optimize_vertex_cache().
+   * @param nindices The number of indices.
+   * @param positions Pointer to the first component of the first vertex position.
+   * @param nvertices The number of vertices.
+   * @param position_stride The number of gl_real between two consecutive positions.
+   * @param clusters The clusters computed by optimize_vertex_cache().
+   * @param nclusters The number of clusters. If zero, the whole index buffer
+   * is considered as a single cluster.
+   * @param cache_size The number of entries in the targeted cache.
+   * @param threshold The maximum degradation of the ACMR allowed. */
+  GO_API
+  void optimize_overdraw(
+      uint32_t* destination, const uint32_t* indices, size_t nindices,
+      const gl_real* positions, size_t nvertices, size_t position_stride,
+      const uint32_t* clusters, size_t nclusters,
+      size_t cache_size = 16, real threshold = 1.05 );
+  /**@brief Reorder clusters of triangles to reduce overdraw.
+   *
+   * Same as above, for real positions.
+   * @param destination The reordered index buffer.
+   * @param indices The index buffer, usually the output of optimize_vertex_cache().
+   * @param nindices The number of indices.
+   * @param positions The vertex positions.
+   * @param nvertices The number of vertices.
+   * @param clusters The clusters computed by optimize_vertex_cache().
+   * @param nclusters The number of clusters.
+   * @param cache_size The number of entries in the targeted cache.
+   * @param threshold The maximum degradation of the ACMR allowed. */
+  GO_API
+  void optimize_overdraw(
+      uint32_t* destination, const uint32_t* indices, size_t nindices,
+      const vec3* positions, size_t nvertices,
+      const uint32_t* clusters, size_t nclusters,
+      size_t cache_size = 16, real threshold = 1.05 );
+
+  /**@brief Compute a vertex remapping for the pre-transform vertex cache.
+   *
+   * Compute a new index for each vertex so that vertices are stored in the
+   * order of their first use in the index buffer. Vertex fetches are then
+   * nearly sequential in memory. Unreferenced vertices are sent at the end.
+   * Indices are remapped in place.
+   * @param remap Will contain, for each vertex, its new index. It must have
+   * room for nvertices elements.
+   * @param indices The index buffer to remap in place.
+   * @param nindices The number of indices.
+   * @param nvertices The number of vertices.
+   * @return The number of referenced vertices. */
+  GO_API
+  size_t optimize_vertex_fetch(
+      uint32_t* remap, uint32_t* indices, size_t nindices, size_t nvertices );
+
+  /**@brief Apply a vertex remapping on a vertex buffer.
+   *
+   * Move vertex attributes to their new location.
+   * @param destination The remapped vertex buffer. It must not overlap with source.
+   * @param source The vertex buffer to remap.
+   * @param nvertices The number of vertices.
+   * @param vertex_size The size in bytes of a vertex in the buffers.
+   * @param remap The remapping computed by optimize_vertex_fetch(). */
+  inline void remap_vertex_buffer(
+      void* destination, const void* source, size_t nvertices, size_t vertex_size,
+      const uint32_t* remap )
+  {
+    auto dst = reinterpret_cast< unsigned char* >( destination );
+    auto src = reinterpret_cast< const unsigned char* >( source );
+    for( size_t i = 0; i < nvertices; ++ i )
+      std::memcpy( dst + remap[ i ] * vertex_size, src + i * vertex_size, vertex_size );
+  }
+
+  /**@brief Optimize an indexed mesh for rendering.
+   *
+   * Apply in sequence the vertex cache, the overdraw and the vertex fetch
+   * optimizations on an indexed mesh. Unreferenced vertices are removed.
+   * This is meant to be done once, when the render data of a mesh is built
+   * and cached.
+   * @param m The mesh to optimize.
+   * @param cache_size The number of entries in the targeted cache.
+   * @param overdraw_threshold The maximum degradation of the ACMR allowed by
+   * the overdraw optimization.
+   * @param before If not null, will contain the cache statistics before optimization.
+   * @param after If not null, will contain the cache statistics after optimization. */
+  GO_API
+  void optimize_for_rendering(
+      indexed_mesh& m, size_t cache_size = 16, real overdraw_threshold = 1.05,
+      vertex_cache_statistics* before = nullptr, vertex_cache_statistics* after = nullptr );
+
+} END_GO_NAMESPACE
+# endif
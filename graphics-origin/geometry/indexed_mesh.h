@@ -0,0 +1,129 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_INDEXED_MESH_H_
+# define GRAPHICS_ORIGIN_INDEXED_MESH_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct mesh;
+  struct aabox;
+
+  /**@brief A compact triangular mesh.
+   *
+   * This class represents a triangular mesh by an array of vertex positions
+   * and an array of vertex indices, three per face. Compared to the mesh
+   * class, there is no connectivity information, which makes this
+   * representation smaller and far cheaper to build and to process in
+   * parallel. It is meant for batch operations that rewrite the whole
+   * geometry, such as simplification or reordering, and for uploads to the
+   * GPU. Use the conversion functions to go back and forth with a mesh.
+   */
+  struct GO_API indexed_mesh {
+    typedef uint32_t vertex_index;
+    /**@brief Index used to mark a removed face or an invalid vertex. */
+    static constexpr vertex_index invalid_index = vertex_index(-1);
+
+    /**@brief Create an empty indexed mesh. */
+    indexed_mesh();
+    /**@brief Create an indexed mesh from a mesh.
+     *
+     * Copy the vertex positions and the faces of a mesh.
+     * @param m The mesh to copy. */
+    explicit indexed_mesh( const mesh& m );
+
+    /**@brief Copy the content of a mesh.
+     *
+     * Replace the content of this instance by the vertex positions and the
+     * faces of a mesh.
+     * @param m The mesh to copy. */
+    void from_mesh( const mesh& m );
+    /**@brief Copy the content of this instance into a mesh.
+     *
+     * Clear a mesh and fill it with the vertices and faces of this instance.
+     * Vertex and face normals are then computed.
+     * @param m The mesh to fill. */
+    void to_mesh( mesh& m ) const;
+
+    /**@brief Get the number of faces. */
+    inline size_t get_number_of_faces() const noexcept
+    {
+      return indices.size() / 3;
+    }
+    /**@brief Get the number of vertices. */
+    inline size_t get_number_of_vertices() const noexcept
+    {
+      return vertices.size();
+    }
+
+    /**@brief Compute the bounding box of the vertices.
+     * @param b The box to set. */
+    void compute_bounding_box( aabox& b ) const;
+
+    /**@brief Remove faces that are marked as removed or degenerated.
+     *
+     * Remove faces that have an invalid_index or twice the same vertex. The
+     * relative order of remaining faces is preserved.
+     * @return The number of removed faces. */
+    size_t remove_degenerated_faces();
+
+    /**@brief Remove vertices that are not referenced by any face.
+     *
+     * Remove vertices not referenced by faces, and update indices. The
+     * relative order of remaining vertices is preserved.
+     * @param remap If not null, will contain for each former vertex its new
+     * index or invalid_index if it was removed.
+     * @return The number of removed vertices. */
+    size_t remove_unreferenced_vertices( std::vector< vertex_index >* remap = nullptr );
+
+    std::vector< vec3 > vertices;
+    std::vector< vertex_index > indices;
+  };
+
+  /**@brief Faces incident to each vertex.
+   *
+   * This class stores, in a compressed sparse row format, the indices of
+   * the faces incident to each vertex of an indexed mesh. This is the only
+   * connectivity needed by most parallel algorithms on indexed meshes, as it
+   * allows to gather face contributions per vertex without any atomic
+   * operation. Faces incident to a vertex are sorted by increasing index.
+   */
+  struct GO_API vertex_face_adjacency {
+    typedef uint32_t face_index;
+
+    /**@brief Build the adjacency of an indexed mesh.
+     *
+     * Build the adjacency in parallel. Faces with an invalid_index are
+     * skipped.
+     * @param indices Pointer to the vertex indices, three per face.
+     * @param nfaces The number of faces.
+     * @param nvertices The number of vertices. */
+    void build( const uint32_t* indices, size_t nfaces, size_t nvertices );
+    /**@brief Build the adjacency of an indexed mesh.
+     * @param m The indexed mesh. */
+    void build( const indexed_mesh& m );
+
+    /**@brief Start of the faces incident to a vertex. */
+    inline const face_index* begin( uint32_t vertex ) const
+    {
+      return faces.data() + offsets[ vertex ];
+    }
+    /**@brief End of the faces incident to a vertex. */
+    inline const face_index* end( uint32_t vertex ) const
+    {
+      return faces.data() + offsets[ vertex + 1 ];
+    }
+    /**@brief Number of faces incident to a vertex. */
+    inline size_t valence( uint32_t vertex ) const
+    {
+      return offsets[ vertex + 1 ] - offsets[ vertex ];
+    }
+
+    std::vector< uint32_t > offsets;
+    std::vector< face_index > faces;
+  };
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,97 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_ISOSURFACE_H_
+# define GRAPHICS_ORIGIN_ISOSURFACE_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <functional>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct indexed_mesh;
+
+  /**@brief Isosurface extraction methods.
+   *
+   * - marching_cubes: each cell crossed by the isosurface gives up to five
+   * triangles, looked up in a table indexed by the signs of its eight
+   * corners. Vertices lie on the grid edges and are shared by all the cells
+   * around an edge. Ambiguous faces are always split such that corners
+   * below the isovalue are separated, so that neighbor cells agree and the
+   * surface has no crack. This is the default method.
+   * - marching_tetrahedra: each cell is split into six tetrahedra sharing
+   * its main diagonal, and each tetrahedron crossed by the isosurface gives
+   * one or two triangles whose vertices lie on its edges. The decomposition
+   * is the same for all cells, so the surface has no crack.
+   * - dual_contouring: each cell crossed by the isosurface gives one vertex,
+   * placed by minimizing the distance to the tangent planes at the crossings
+   * of its edges, and each grid edge crossed by the isosurface gives a quad
+   * joining the vertices of its four cells. Sharp features are preserved and
+   * the mesh has far fewer faces, but it can self-intersect. */
+  enum class isosurface_method {
+    marching_cubes,
+    marching_tetrahedra,
+    dual_contouring
+  };
+
+  /**@brief Parameters of an isosurface extraction.
+   *
+   * The scalar field is sampled on a regular grid of resolution[0] x
+   * resolution[1] x resolution[2] cells, the sample (x,y,z) being located at
+   * origin + (x,y,z) * cell_size, for x in [0, resolution[0]] and so on.
+   */
+  struct GO_API isosurface_parameters {
+    isosurface_parameters();
+    vec3 origin;
+    real cell_size;
+    uint32_t resolution[3];
+    /**@brief Value of the isosurface. Faces are oriented toward increasing
+     * values, so normals point outward for a signed distance field that is
+     * negative inside. */
+    real isovalue;
+    /**@brief Number of cells along each side of a block. Blocks are
+     * processed in parallel. */
+    uint32_t block_size;
+    /**@brief Lipschitz constant of the scalar field, i.e. a bound of the
+     * norm of its gradient, such as 1 for a signed distance field. When this
+     * constant is positive, a block is skipped with a single evaluation at
+     * its center if the field cannot reach the isovalue inside. Otherwise,
+     * all the samples of a block are evaluated before skipping it. */
+    real lipschitz_constant;
+    isosurface_method method;
+  };
+
+  /**@brief Type of scalar fields. The function must be thread safe. */
+  typedef std::function< real( const vec3& ) > scalar_field;
+
+  /**@brief Extract an isosurface of a scalar field.
+   *
+   * Extract the isosurface of a scalar field in parallel. The domain is
+   * split into blocks of cells, and blocks that the isosurface does not
+   * cross are skipped. Each block is sampled and triangulated independently.
+   * Vertices are identified by the grid edge (or cell, for dual contouring)
+   * they come from. Vertices generated by several blocks are merged by
+   * sorting those keys in parallel, so the output is an indexed mesh without
+   * duplicated vertices, which does not depend on the number of threads.
+   * @param field The scalar field, evaluated concurrently by several threads.
+   * @param parameters The parameters of the extraction.
+   * @param output Will contain the isosurface.
+   * @return False if the parameters are invalid. */
+  GO_API bool extract_isosurface(
+      const scalar_field& field, const isosurface_parameters& parameters,
+      indexed_mesh& output );
+  /**@brief Extract an isosurface of a sampled scalar field.
+   *
+   * Extract the isosurface of a scalar field sampled on a grid. The sample
+   * (x,y,z) is stored at values[ (z * (resolution[1] + 1) + y) *
+   * (resolution[0] + 1) + x ]. The lipschitz_constant parameter is ignored:
+   * blocks are skipped according to the range of their samples.
+   * @param values The samples of the scalar field.
+   * @param parameters The parameters of the extraction.
+   * @param output Will contain the isosurface.
+   * @return False if the parameters are invalid. */
+  GO_API bool extract_isosurface(
+      const real* values, const isosurface_parameters& parameters,
+      indexed_mesh& output );
+
+} END_GO_NAMESPACE
+# endif
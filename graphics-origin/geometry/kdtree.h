@@ -0,0 +1,196 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_KDTREE_H_
+# define GRAPHICS_ORIGIN_KDTREE_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  /**@brief Neighborhoods of a batch of locations.
+   *
+   * This structure stores, in a compressed sparse row format, the results of
+   * a batch of radius searches: the neighbors of the i-th location are in the
+   * range [offsets[i], offsets[i+1]) of indices and squared_distances.
+   */
+  struct GO_API point_neighborhoods {
+    /**@brief Start of the neighbors of a location. */
+    inline const uint32_t* begin( size_t location ) const
+    {
+      return indices.data() + offsets[ location ];
+    }
+    /**@brief End of the neighbors of a location. */
+    inline const uint32_t* end( size_t location ) const
+    {
+      return indices.data() + offsets[ location + 1 ];
+    }
+    /**@brief Number of neighbors of a location. */
+    inline size_t size( size_t location ) const
+    {
+      return offsets[ location + 1 ] - offsets[ location ];
+    }
+
+    std::vector< size_t > offsets;
+    std::vector< uint32_t > indices;
+    std::vector< real > squared_distances;
+  };
+
+  /**@brief A kdtree of points.
+   *
+   * This class allows efficient nearest and radius searches on a set of
+   * points. The tree is balanced: each node splits its points at the median
+   * of the axis of largest extent. Nodes are stored in a heap layout, i.e.
+   * the children of the node i are 2i+1 and 2i+2, and points are copied in
+   * the order of the leaves, which makes the tree compact and cache friendly.
+   * Subtrees are built in parallel, level by level.
+   *
+   * The scalar type is the type used to store point coordinates and to
+   * compute distances. With gl_real, the memory footprint is halved, at the
+   * cost of precision. Queries and results always use real.
+   *
+   * Batch queries process locations in parallel and write into preallocated
+   * buffers, so they do not allocate any memory per location.
+   */
+  template< typename scalar >
+  class GO_API point_kdtree {
+  public:
+    typedef uint32_t point_index;
+    /**@brief Index used to fill unused result slots. */
+    static constexpr point_index invalid_index = point_index(-1);
+
+    /**@brief Build a kdtree.
+     *
+     * Build a kdtree of points. The points are copied, so they can be
+     * destroyed or modified after the construction.
+     * @param points Pointer to 3 * npoints reals, three per point.
+     * @param npoints The number of points.
+     * @param max_leaf_size The maximum number of points in a leaf. */
+    point_kdtree( const real* points, size_t npoints, size_t max_leaf_size = 16 );
+    /**@brief Build a kdtree.
+     * @param points Pointer to the points.
+     * @param npoints The number of points.
+     * @param max_leaf_size The maximum number of points in a leaf. */
+    point_kdtree( const vec3* points, size_t npoints, size_t max_leaf_size = 16 );
+
+    /**@brief Get the number of points in the tree. */
+    inline size_t get_number_of_points() const noexcept
+    {
+      return m_entries.size();
+    }
+
+    /**@brief Find the nearest points of a location.
+     *
+     * Look for the k nearest points of a location.
+     * @param location The location of interest.
+     * @param k The number of neighbors to find.
+     * @param indices Pointer to an array with enough place to store k point
+     * indices.
+     * @param squared_distances Pointer to an array with enough place to store
+     * k squared distances.
+     * @return The number of neighbors found, which is k if there are at
+     * least k points. Neighbors are sorted by increasing distance. */
+    size_t k_nearest( const vec3& location, uint32_t k, point_index* indices, real* squared_distances ) const;
+    /**@brief Find the nearest points of a batch of locations.
+     *
+     * Look in parallel for the k nearest points of each location. The
+     * results of the i-th location are written in the range [i*k, (i+1)*k)
+     * of indices and squared_distances, sorted by increasing distance. If
+     * there are less than k points, unused slots are filled with
+     * invalid_index and REAL_MAX.
+     * @param locations Pointer to the locations of interest.
+     * @param nlocations The number of locations.
+     * @param k The number of neighbors to find per location.
+     * @param indices Pointer to an array of nlocations * k point indices.
+     * @param squared_distances Pointer to an array of nlocations * k squared
+     * distances. */
+    void k_nearest(
+        const vec3* locations, size_t nlocations, uint32_t k,
+        point_index* indices, real* squared_distances ) const;
+
+    /**@brief Find the points in a ball.
+     *
+     * Look for any point that lies in a ball.
+     * @param location The center of the search ball.
+     * @param radius The radius of the search ball.
+     * @param indices_sdistances A vector of pair containing the index of a
+     * point inside the search ball and its squared distance to the ball
+     * center. Those pairs are ordered by increasing distances. The vector is
+     * cleared first, so it is advised to reuse the same vector. */
+    void radius_search( const vec3& location, real radius, std::vector< std::pair< point_index, real > >& indices_sdistances ) const;
+    /**@brief Count the points in a ball.
+     * @param location The center of the search ball.
+     * @param radius The radius of the search ball.
+     * @return The number of points inside the ball. */
+    size_t count_in_radius( const vec3& location, real radius ) const;
+    /**@brief Count the points in balls of a batch of locations.
+     *
+     * Count in parallel the points in the ball of each location, and store
+     * the result as offsets for a compressed sparse row output.
+     * @param locations Pointer to the centers of the search balls.
+     * @param nlocations The number of locations.
+     * @param radius The radius of the search balls.
+     * @param offsets Pointer to an array of nlocations + 1 elements. After
+     * the call, the neighbors of the i-th location should be stored in the
+     * range [offsets[i], offsets[i+1]).
+     * @return The total number of neighbors, i.e. offsets[nlocations]. */
+    size_t count_in_radius( const vec3* locations, size_t nlocations, real radius, size_t* offsets ) const;
+    /**@brief Find the points in balls of a batch of locations.
+     *
+     * Look in parallel for the points in the ball of each location. The
+     * output buffers must be allocated with the offsets computed by
+     * count_in_radius() for the same locations and radius. Neighbors of a
+     * location are not sorted.
+     * @param locations Pointer to the centers of the search balls.
+     * @param nlocations The number of locations.
+     * @param radius The radius of the search balls.
+     * @param offsets The offsets computed by count_in_radius().
+     * @param indices Pointer to an array of offsets[nlocations] point indices.
+     * @param squared_distances Pointer to an array of offsets[nlocations]
+     * squared distances, or null if distances are not needed. */
+    void radius_search(
+        const vec3* locations, size_t nlocations, real radius,
+        const size_t* offsets, point_index* indices, real* squared_distances ) const;
+    /**@brief Find the points in balls of a batch of locations.
+     *
+     * Count then find in parallel the points in the ball of each location.
+     * The memory of the neighborhoods is reused, so it is advised to pass the
+     * same instance over and over.
+     * @param locations Pointer to the centers of the search balls.
+     * @param nlocations The number of locations.
+     * @param radius The radius of the search balls.
+     * @param neighborhoods Will contain the neighbors of each location. */
+    void radius_search(
+        const vec3* locations, size_t nlocations, real radius,
+        point_neighborhoods& neighborhoods ) const;
+
+  private:
+    struct entry {
+      scalar position[3];
+      point_index index;
+    };
+    struct node {
+      scalar split;
+      uint32_t axis;
+    };
+
+    void build( size_t max_leaf_size );
+    template< typename visitor >
+    void search( const vec3& location, visitor& v ) const;
+    template< typename visitor >
+    void search( size_t node_index, size_t begin, size_t end, const scalar* q,
+        scalar min_distance, scalar* axis_distances, visitor& v ) const;
+
+    std::vector< entry > m_entries;
+    std::vector< node > m_nodes;
+    size_t m_first_leaf;
+  };
+
+  /**@brief A kdtree storing its points with real precision. */
+  typedef point_kdtree< real > kdtree;
+  /**@brief A kdtree storing its points with half the memory of a kdtree. */
+  typedef point_kdtree< gl_real > compact_kdtree;
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,91 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_MEDIAL_AXIS_H_
+# define GRAPHICS_ORIGIN_MEDIAL_AXIS_H_
+# include "../graphics_origin.h"
+# include "ball.h"
+# include "kdtree.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  class mesh_spatial_optimization;
+
+  /**@brief Parameters of the shrinking ball algorithm. */
+  struct GO_API shrinking_ball_parameters {
+    shrinking_ball_parameters();
+    /**@brief Radius of the balls before they shrink. If it is not positive,
+     * the diagonal of the bounding box of the points is used. */
+    real initial_radius;
+    /**@brief Minimum angle, in radians, between the two points touching a
+     * ball, seen from its center. A ball shrinks by finding a point inside
+     * it: if the angle between this point and the point of the ball is
+     * smaller, this point is considered as noise and the ball stops
+     * shrinking. This denoising is disabled by default: on a smooth surface
+     * of revolution, the two points touching a medial ball can be close,
+     * while values around M_PI / 8 help on noisy inputs such as scans. */
+    real separation_angle;
+    /**@brief Maximum number of times a ball shrinks. Balls that did not
+     * reach an empty state are discarded. */
+    uint32_t max_iterations;
+    /**@brief Set to true to compute balls inside the shape, i.e. in the
+     * direction opposite to the normals, and to false to compute balls
+     * outside the shape. */
+    bool inner;
+  };
+
+  /**@brief Approximate the medial axis of a point set with shrinking balls.
+   *
+   * Compute in parallel a maximal empty ball for each oriented point, with
+   * the shrinking ball algorithm of Ma et al.: a large ball tangent to the
+   * point is shrunk, until it does not contain any other point, with the
+   * ball tangent to the point and passing by the nearest point of its
+   * center. The centers of such balls are located near the medial axis of
+   * the shape sampled by the points. Only one nearest neighbor query is
+   * made per iteration, with the kdtree of the points.
+   * @param points The points.
+   * @param normals The unit normals of the points, oriented outward.
+   * @param npoints The number of points.
+   * @param tree A kdtree of the points, with the same point indices.
+   * @param parameters The parameters of the algorithm.
+   * @param balls Will contain the valid balls.
+   * @param sources If not null, will contain the index of the point of each
+   * ball. */
+  GO_API void compute_shrinking_balls(
+      const vec3* points, const vec3* normals, size_t npoints, const kdtree& tree,
+      const shrinking_ball_parameters& parameters,
+      std::vector< ball >& balls, std::vector< uint32_t >* sources = nullptr );
+  /**@brief Approximate the medial axis of a mesh with shrinking balls.
+   *
+   * Compute a shrinking ball for each vertex of a mesh, with the vertex
+   * normals and the kdtree of a spatial optimization, which must be built.
+   * @param m The spatial optimization of the mesh.
+   * @param parameters The parameters of the algorithm.
+   * @param balls Will contain the valid balls.
+   * @param sources If not null, will contain the index of the vertex of
+   * each ball. */
+  GO_API void compute_shrinking_balls(
+      const mesh_spatial_optimization& m,
+      const shrinking_ball_parameters& parameters,
+      std::vector< ball >& balls, std::vector< uint32_t >* sources = nullptr );
+
+  /**@brief Simplify a set of balls by removing included balls.
+   *
+   * Remove the balls included in another one, which do not change the union
+   * of the set. A ball b is considered included in a ball B if
+   * |c(b) - c(B)| + r(b) <= (1 + tolerance) r(B). Candidates B are searched
+   * among the balls whose centers are the nearest to the center of b, in
+   * parallel. When two balls include each other, the first one is kept.
+   * The relative order of the remaining balls is preserved, and the result
+   * can be given directly to a bvh<ball>.
+   * @param balls The balls to simplify.
+   * @param tolerance The relative tolerance of the inclusion test.
+   * @param nneighbors The number of candidates tested for each ball.
+   * @param sources If not null, the sources of the balls are filtered along.
+   * @return The number of removed balls. */
+  GO_API size_t remove_included_balls(
+      std::vector< ball >& balls, real tolerance = 0, uint32_t nneighbors = 16,
+      std::vector< uint32_t >* sources = nullptr );
+
+} END_GO_NAMESPACE
+# endif
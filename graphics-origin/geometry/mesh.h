@@ -7,7 +7,7 @@
 # include "triangle.h"
 # include "traits.h"
 # include "box.h"
-# include "../extlibs/nanoflann.h"
+# include "kdtree.h"
 # include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
 
 BEGIN_GO_NAMESPACE namespace geometry {
@@ -155,8 +155,8 @@ BEGIN_GO_NAMESPACE namespace geometry {
    * This class allows efficient radius and nearest search of mesh vertices
    * thanks to a kdtree of such vertices. This kdtree is built only once,
    * at the construction of an instance. Thus, be sure to create an instance
-   * once the mesh is fully built and cleaned. Also, for memory and speed
-   * efficiency, vertices are not copied into this class. So, an instance
+   * once the mesh is fully built and cleaned. The kdtree stores its own copy
+   * of vertex positions, but get_point() reads the mesh. So, an instance
    * should not be used anymore once the mesh used to build it is destroyed.
    *
    * If you need more than radius and nearest search, have a look to the
@@ -215,82 +215,6 @@ BEGIN_GO_NAMESPACE namespace geometry {
     void radius_search( const vec3& location, real radius, std::vector< std::pair< vertex_index, real> >& indices_sdistances ) const;
     /**@}*/
 
-    /**@brief Nanoflann functions.
-     *
-     * Those functions are required by the nanoflann library to build a kdtree
-     * on custom geometric data.
-     * @{
-     */
-    /**@brief Get the number of points inside the kdtree.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It simply returns the number of vertices to
-     * store in the ktree, i.e. the number of mesh vertices.
-     * @return The number of vertices in the mesh. */
-    inline size_t kdtree_get_point_count() const
-    {
-      return nbpoints;
-    }
-
-    /**@brief Get the kdtree distance between two points.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It computes the distance between a given point
-     * and a point stored in the kdtree.
-     * @param a Pointer to three consecutive real values representing the first point.
-     * @param idx The index of the second point in the kdtree.
-     * @param size The dimension of points in the kdtree (3 here).
-     * @return The squared distance between the two given points. */
-    inline real kdtree_distance(const real* a, const size_t b_idx, size_t size) const
-    {
-      (void)size;
-      const real* b = get_point( b_idx );
-      real result = a[0] - b[0];
-      result *= result;
-      real temp = a[1] - b[1];
-      temp *= temp;
-      result += temp;
-      temp = a[2] - b[2];
-      temp *= temp;
-      result += temp;
-      return result;
-    }
-
-    /**@brief Get the bounding box the mesh.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It asks for the bounding box of the underlying
-     * data. If no bounding box is found (return value is false), the nanoflann
-     * library will compute the bounding box.
-     * @param bb The bounding box requested.
-     * @return True if the bounding box is set by this function. */
-    template <class BBOX>
-    bool kdtree_get_bbox(BBOX& bb) const
-    {
-      auto low  = bounding_box.get_min();
-      auto high = bounding_box.get_max();
-      for( uint32_t d = 0; d < 3; ++ d )
-       {
-          bb[ d ].low  =  low[d];
-          bb[ d ].high = high[d];
-       }
-      return true;
-    }
-
-    /**@brief Get the component of a point stored in the kdtree.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It fetches the component of a point stored
-     * in the kdtree, which is here the position of a mesh vertex.
-     * @param idx Index of the point to fetch.
-     * @param component Component index to fetch, i.e. 0 for X, 1 for Y and
-     * 2 for Z.
-     * @return The component-th component of the vertex of index idx. */
-    inline const real& kdtree_get_pt(const size_t idx, int component) const
-    {
-      return points[ idx * 3 + component ];
-    }
-
     /**@brief Utilities functions.
      * @{
      */
@@ -313,14 +237,19 @@ BEGIN_GO_NAMESPACE namespace geometry {
       return bounding_box;
     }
 
+    /**@brief Access to the kdtree.
+     *
+     * Get the kdtree of vertices, to perform batch queries. */
+    inline const geometry::kdtree& get_kdtree() const noexcept
+    {
+      return kdtree;
+    }
+
   private:
     aabox bounding_box;
     const real* points;
     const size_t nbpoints;
-    nanoflann::KDTreeSingleIndexAdaptor<
-     nanoflann::L2_Simple_Adaptor< real, mesh_vertices_kdtree, real >,
-     mesh_vertices_kdtree, 3, vertex_index
-     > kdtree;
+    geometry::kdtree kdtree;
   };
 
 
@@ -405,6 +334,99 @@ BEGIN_GO_NAMESPACE namespace geometry {
      * intersection point if it exist.
      * @return True if an intersection is found. */
     bool intersect( const ray& r, real& distance_to_mesh, size_t& closest_face_index ) const;
+    /**@brief Find the closest intersection of a batch of rays.
+     *
+     * Perform a closest hit query for each ray of a batch. Rays are processed
+     * in parallel. For rays that do not hit the mesh, the distance is set to
+     * REAL_MAX and the face index is left untouched.
+     * @param rays Pointer to an array of nrays rays.
+     * @param nrays The number of rays to test.
+     * @param distances Pointer to an array with enough place to store nrays
+     * distances.
+     * @param faces Pointer to an array with enough place to store nrays face
+     * indices.
+     * @return The number of rays that hit the mesh. */
+    size_t intersect( const ray* rays, size_t nrays, real* distances, size_t* faces ) const;
+
+    /**@brief Check if a ray hits the mesh before a given distance.
+     *
+     * This any-hit query is meant for visibility and shadow tests: the
+     * traversal stops at the first confirmed intersection closer than
+     * max_distance, without looking for the closest one. Since no distance
+     * is required, children are not sorted either. This function only uses
+     * the BVH and does not allocate any memory.
+     * @param r The ray to test.
+     * @param max_distance Intersections further than this distance from the
+     * ray origin are ignored.
+     * @return True if the mesh is hit before max_distance. */
+    bool occlude( const ray& r, real max_distance = REAL_MAX ) const;
+    /**@brief Check if a batch of rays hits the mesh before given distances.
+     *
+     * Perform an any-hit query for each ray of a batch. Rays are processed
+     * in parallel.
+     * @param rays Pointer to an array of nrays rays.
+     * @param max_distances Pointer to an array of nrays maximum distances.
+     * @param nrays The number of rays to test.
+     * @param occluded Pointer to an array with enough place to store nrays
+     * results.
+     * @return The number of occluded rays. */
+    size_t occlude( const ray* rays, const real* max_distances, size_t nrays, bool* occluded ) const;
+
+    /**@brief Find all the intersections of a ray with the mesh.
+     *
+     * Collect every crossing of a ray with the mesh, sorted by increasing
+     * distance to the ray origin. The results are written in caller-provided
+     * buffers so no memory is allocated. If there are more intersections
+     * than the buffers can hold, only the capacity closest ones are kept, but
+     * the returned value is still the total number of intersections. Note
+     * that a ray crossing exactly an edge or a vertex could be reported once
+     * per incident face. This function only uses the BVH.
+     * @param r The ray to test.
+     * @param distances Pointer to an array with enough place to store
+     * capacity distances.
+     * @param faces Pointer to an array with enough place to store capacity
+     * face indices.
+     * @param capacity The number of elements in the distances and faces buffers.
+     * @return The total number of intersections. */
+    size_t intersect_all( const ray& r, real* distances, size_t* faces, size_t capacity ) const;
+    /**@brief Find all the intersections of a batch of rays with the mesh.
+     *
+     * Perform an all-hits query for each ray of a batch. Rays are processed
+     * in parallel. The i-th ray writes its results in the range
+     * [i * capacity, (i+1) * capacity) of distances and faces.
+     * @param rays Pointer to an array of nrays rays.
+     * @param nrays The number of rays to test.
+     * @param distances Pointer to an array of nrays * capacity distances.
+     * @param faces Pointer to an array of nrays * capacity face indices.
+     * @param capacity The number of results that can be stored per ray.
+     * @param counts Pointer to an array with enough place to store the total
+     * number of intersections of each ray. */
+    void intersect_all( const ray* rays, size_t nrays, real* distances, size_t* faces, size_t capacity, size_t* counts ) const;
+
+    /**@brief Find the closest point of the mesh.
+     *
+     * Find the point of the mesh surface closest to a location, with a best
+     * first traversal of the BVH. This function only uses the BVH and does
+     * not allocate any memory.
+     * @param location The location of interest.
+     * @param closest_point Will contain the closest point of the surface.
+     * @param closest_face_index Will contain the index of the face on which
+     * lies the closest point.
+     * @return The squared distance between the location and the surface. */
+    real get_closest_point( const vec3& location, vec3& closest_point, size_t& closest_face_index ) const;
+    /**@brief Find the closest points of the mesh for a batch of locations.
+     *
+     * Perform a closest point query for each location of a batch. Locations
+     * are processed in parallel.
+     * @param locations Pointer to an array of nlocations locations.
+     * @param nlocations The number of locations.
+     * @param closest_points Pointer to an array with enough place to store
+     * nlocations points.
+     * @param faces Pointer to an array with enough place to store nlocations
+     * face indices.
+     * @param squared_distances Pointer to an array with enough place to store
+     * nlocations squared distances. */
+    void get_closest_point( const vec3* locations, size_t nlocations, vec3* closest_points, size_t* faces, real* squared_distances ) const;
 
     /**@brief Check if a point is inside the mesh.
      *
@@ -436,61 +458,6 @@ BEGIN_GO_NAMESPACE namespace geometry {
     void radius_search( const vec3& location, real radius, std::vector< std::pair< vertex_index, real> >& indices_sdistances ) const;
     /**@}*/
 
-    /**@brief Nanoflann functions.
-     *
-     * Those functions are required by the nanoflann library to build a kdtree
-     * on custom geometric data.
-     * @{
-     */
-    /**@brief Get the number of points inside the kdtree.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It simply returns the number of vertices to
-     * store in the ktree, i.e. the number of mesh vertices.
-     * @return The number of vertices in the mesh. */
-    inline size_t kdtree_get_point_count() const
-    {
-      return m_mesh.n_vertices();
-    }
-
-    /**@brief Get the kdtree distance between two points.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It computes the distance between a given point
-     * and a point stored in the kdtree.
-     * @param a Pointer to three consecutive real values representing the first point.
-     * @param idx The index of the second point in the kdtree.
-     * @param size The dimension of points in the kdtree (3 here).
-     * @return The squared distance between the two given points. */
-    inline real kdtree_distance(const real* a, const size_t b_idx, size_t size) const
-    {
-      (void)size;
-      const real* b = get_point( b_idx );
-      real result = a[0] - b[0];
-      result *= result;
-      real temp = a[1] - b[1];
-      temp *= temp;
-      result += temp;
-      temp = a[2] - b[2];
-      temp *= temp;
-      result += temp;
-      return result;
-    }
-
-    /**@brief Get the component of a point stored in the kdtree.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It fetches the component of a point stored
-     * in the kdtree, which is here the position of a mesh vertex.
-     * @param idx Index of the point to fetch.
-     * @param component Component index to fetch, i.e. 0 for X, 1 for Y and
-     * 2 for Z.
-     * @return The component-th component of the vertex of index idx. */
-    inline const real& kdtree_get_pt(const size_t idx, int component) const
-    {
-      return m_points[ idx * 3 + component ];
-    }
-
     /**@brief Utilities functions.
      * @{
      */
@@ -517,6 +484,14 @@ BEGIN_GO_NAMESPACE namespace geometry {
       return m_normals + idx * 3;
     }
 
+    /**@brief Copy the vertex positions and normals.
+     *
+     * Copy in parallel the positions and normals of the vertices, for
+     * algorithms that work on arrays of vec3.
+     * @param points Will contain the position of each vertex.
+     * @param normals Will contain the normal of each vertex. */
+    void copy_vertices( std::vector< vec3 >& points, std::vector< vec3 >& normals ) const;
+
     /**@brief Get the number of triangles.
      *
      * Get the number of triangles in the underlying mesh.
@@ -537,39 +512,26 @@ BEGIN_GO_NAMESPACE namespace geometry {
       return m_triangles[ idx ];
     }
 
-    /**@brief Get the bounding box the mesh.
-     *
-     * This function is required by the nanoflann library to build a kdtree
-     * on custom geometric data. It asks for the bounding box of the underlying
-     * data. If no bounding box is found (return value is false), the nanoflann
-     * library will compute the bounding box.
-     * @param bb The bounding box requested.
-     * @return True if the bounding box is set by this function. */
-    template <class BBOX>
-    bool kdtree_get_bbox(BBOX& bb) const
-    {
-      auto low  = bounding_box.get_min();
-      auto high = bounding_box.get_max();
-      for( size_t d = 0; d < 3; ++ d )
-       {
-          bb[ d ].low  =  low[d];
-          bb[ d ].high = high[d];
-       }
-      return true;
-    }
-
     /**@brief Access to the bvh.
      *
      * Get the bvh built with axis aligned boxes as bounding objects and the
      * triangles of the mesh as bounded objects.
      * @return The bvh. */
     bvh<aabox>* get_bvh();
+    const bvh<aabox>* get_bvh() const;
+
+    /**@brief Access to the kdtree.
+     *
+     * Get the kdtree built on the mesh vertices, to perform batch queries.
+     * @return The kdtree, or null if it is not built yet. */
+    const kdtree* get_kdtree() const;
 
     /**@brief Access to the mesh.
      *
      * Get the mesh spatially optimized by this.
      * @return The mesh. */
     mesh& get_geometry();
+    const mesh& get_geometry() const;
 
     /**@brief Access to the mesh's bounding box.
      *
@@ -587,9 +549,7 @@ BEGIN_GO_NAMESPACE namespace geometry {
     const real* m_points;
     const real* m_normals;
     mesh& m_mesh;
-    nanoflann::KDTreeSingleIndexAdaptor<
-     nanoflann::L2_Simple_Adaptor< real, mesh_spatial_optimization, real >,
-     mesh_spatial_optimization, 3, vertex_index >* m_kdtree;
+    kdtree* m_kdtree;
     bvh<aabox>* m_bvh;
   };
 
@@ -0,0 +1,158 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_MESH_DISTANCE_H_
+# define GRAPHICS_ORIGIN_MESH_DISTANCE_H_
+# include "../graphics_origin.h"
+# include "triangle.h"
+# include "box.h"
+# include "bvh.h"
+# include <algorithm>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct indexed_mesh;
+  class mesh_spatial_optimization;
+
+  /**@brief Find the closest point of a set of triangles.
+   *
+   * Find the point of a set of triangles closest to a location, with a best
+   * first traversal of their bounding volume hierarchy: the nearest child is
+   * visited first, and nodes further than the closest point found so far are
+   * pruned. This function does not allocate any memory.
+   * @param hierarchy The hierarchy of the triangles.
+   * @param triangles The triangles indexed by the hierarchy.
+   * @param location The location of interest.
+   * @param closest_point Will contain the closest point, if one is found.
+   * @param closest_face_index Will contain the index of the triangle of the
+   * closest point, if one is found.
+   * @param max_squared_distance Points further than the square root of this
+   * value are ignored.
+   * @return The squared distance to the closest point, or REAL_MAX if no
+   * point is closer than max_squared_distance. */
+  GO_API real get_closest_point(
+      const bvh< aabox >& hierarchy, const triangle* triangles,
+      const vec3& location, vec3& closest_point, size_t& closest_face_index,
+      real max_squared_distance = REAL_MAX );
+
+  /**@brief Parameters of a distance computation between meshes. */
+  struct GO_API distance_parameters {
+    distance_parameters();
+    /**@brief Number of samples in the interior of faces, distributed
+     * proportionally to their area with at least one sample per face. Those
+     * samples are used to estimate the mean and RMS distances. Set to zero to
+     * estimate them with vertices only. */
+    size_t number_of_samples;
+    /**@brief Tolerance of the Hausdorff distance, relative to the diagonal
+     * of the bounding box of the source mesh. */
+    real tolerance;
+  };
+
+  /**@brief The distance from a mesh to another one.
+   *
+   * The one-sided Hausdorff distance from a source mesh to a target mesh is
+   * the maximum distance from a point of the source to the target surface.
+   * It is not symmetric: a decimated mesh can be close to the input mesh
+   * while the input mesh has details far from the decimated one.
+   */
+  struct GO_API one_sided_distance {
+    one_sided_distance();
+    /**@brief The one-sided Hausdorff distance. */
+    real hausdorff;
+    /**@brief The mean distance from the source surface to the target one. */
+    real mean;
+    /**@brief The root mean square distance from the source surface to the
+     * target one. */
+    real rms;
+    /**@brief The point of the source surface where the Hausdorff distance is
+     * reached. */
+    vec3 source_location;
+    /**@brief The point of the target surface closest to source_location. */
+    vec3 target_location;
+    /**@brief The number of distance evaluations. */
+    size_t number_of_samples;
+  };
+
+  /**@brief The symmetric distance between two meshes. */
+  struct GO_API mesh_distance {
+    /**@brief Get the symmetric Hausdorff distance. */
+    inline real get_hausdorff() const
+    {
+      return std::max( forward.hausdorff, backward.hausdorff );
+    }
+    /**@brief Distance from the first mesh to the second one. */
+    one_sided_distance forward;
+    /**@brief Distance from the second mesh to the first one. */
+    one_sided_distance backward;
+  };
+
+  /**@brief Compute the distance from a mesh to a set of triangles.
+   *
+   * Compute the one-sided Hausdorff distance, along with mean and RMS
+   * distances, from a source mesh to target triangles. Distances are
+   * evaluated in parallel with closest point queries, in three steps:
+   * - vertices of the source give a first lower bound of the Hausdorff
+   * distance;
+   * - samples in the interior of faces give the mean and RMS distances, and
+   * improve the lower bound;
+   * - a bound-and-prune traversal of a hierarchy of the source faces computes
+   * for each node an upper bound, as the distance of its center to the target
+   * plus its radius. Nodes whose upper bound is below the lower bound cannot
+   * contain the maximizing point and are pruned. Remaining faces are
+   * recursively split in four, the distance being 1-Lipschitz, until their
+   * upper bound is within the tolerance of the lower bound.
+   * @param source The source mesh. Faces with an invalid index are skipped,
+   * as well as vertices that are not referenced by a valid face.
+   * @param target_hierarchy The hierarchy of the target triangles.
+   * @param target_triangles The target triangles.
+   * @param parameters The parameters of the computation.
+   * @param result The distances. */
+  GO_API void compute_one_sided_distance(
+      const indexed_mesh& source,
+      const bvh< aabox >& target_hierarchy, const triangle* target_triangles,
+      const distance_parameters& parameters, one_sided_distance& result );
+  /**@brief Compute the distance from a mesh to another one.
+   *
+   * Build the triangles and the hierarchy of the target mesh, then compute
+   * the one-sided distance. A target mesh with a single valid face has no
+   * hierarchy, its triangle being tested directly. If the target mesh has no
+   * valid face, an error is logged and the result has no sample.
+   * @param source The source mesh.
+   * @param target The target mesh.
+   * @param parameters The parameters of the computation.
+   * @param result The distances. */
+  GO_API void compute_one_sided_distance(
+      const indexed_mesh& source, const indexed_mesh& target,
+      const distance_parameters& parameters, one_sided_distance& result );
+  /**@brief Compute the distance from a mesh to another one.
+   *
+   * Compute the one-sided distance with the triangles and the BVH of the
+   * target spatial optimization, which must be built.
+   * @param source The source mesh.
+   * @param target The target mesh.
+   * @param parameters The parameters of the computation.
+   * @param result The distances. */
+  GO_API void compute_one_sided_distance(
+      const mesh_spatial_optimization& source, const mesh_spatial_optimization& target,
+      const distance_parameters& parameters, one_sided_distance& result );
+
+  /**@brief Compute the symmetric distance between two meshes.
+   * @param first The first mesh.
+   * @param second The second mesh.
+   * @param parameters The parameters of the computation.
+   * @param result The distances in both directions. */
+  GO_API void compute_distance(
+      const indexed_mesh& first, const indexed_mesh& second,
+      const distance_parameters& parameters, mesh_distance& result );
+  /**@brief Compute the symmetric distance between two meshes.
+   *
+   * The BVH of both spatial optimizations must be built.
+   * @param first The first mesh.
+   * @param second The second mesh.
+   * @param parameters The parameters of the computation.
+   * @param result The distances in both directions. */
+  GO_API void compute_distance(
+      const mesh_spatial_optimization& first, const mesh_spatial_optimization& second,
+      const distance_parameters& parameters, mesh_distance& result );
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,116 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_MESH_INTERSECTION_H_
+# define GRAPHICS_ORIGIN_MESH_INTERSECTION_H_
+# include "../graphics_origin.h"
+# include "triangle.h"
+# include "box.h"
+# include "bvh.h"
+# include <utility>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct indexed_mesh;
+
+  /**@brief Intersecting pairs of faces.
+   *
+   * This structure stores the result of an intersection detection: pairs of
+   * faces that intersect and, on demand, the segment along which they
+   * intersect. Pairs are sorted by increasing first face, then second face.
+   */
+  struct GO_API face_intersections {
+    typedef uint32_t face_index;
+    /**@brief Get the number of intersecting pairs. */
+    inline size_t size() const noexcept
+    {
+      return faces.size();
+    }
+    /**@brief Remove all pairs. */
+    void clear();
+    /**@brief Intersecting pairs of faces. For a self intersection, the first
+     * face of a pair has the lowest index. */
+    std::vector< std::pair< face_index, face_index > > faces;
+    /**@brief Intersection segment of each pair, if segments were requested.
+     * For two coplanar faces, the segment is reduced to a point of their
+     * overlap. */
+    std::vector< std::pair< vec3, vec3 > > segments;
+  };
+
+  /**@brief Test if two triangles intersect.
+   *
+   * Test if two triangles intersect with the interval overlap method of
+   * Moller: each triangle is intersected with the plane of the other, and
+   * the two resulting segments are compared along the intersection line of
+   * the planes. Coplanar triangles are tested in 2D. Signed distances to the
+   * planes are filtered, i.e. snapped to zero under a tolerance relative to
+   * the size of the triangles, so that touching triangles are consistently
+   * reported as intersecting. Degenerated triangles never intersect.
+   * @param a The first triangle.
+   * @param b The second triangle.
+   * @param start If not null, will contain the start of the intersection
+   * segment.
+   * @param end If not null, will contain the end of the intersection segment.
+   * @return True if the triangles intersect. */
+  GO_API bool intersect(
+      const triangle& a, const triangle& b,
+      vec3* start = nullptr, vec3* end = nullptr );
+
+  /**@brief Find the intersecting faces of two sets of triangles.
+   *
+   * Traverse simultaneously two bounding volume hierarchies to find pairs of
+   * leaves with overlapping boxes, then test those candidates with the
+   * triangle intersection test. The traversal is split into tasks on pairs
+   * of subtrees, which are distributed among threads by the OpenMP task
+   * scheduler: idle threads steal pending pairs, so the work stays balanced
+   * even when intersections are concentrated in a small region.
+   * @param first_hierarchy The hierarchy of the first triangles.
+   * @param first_triangles The triangles indexed by the first hierarchy.
+   * @param second_hierarchy The hierarchy of the second triangles.
+   * @param second_triangles The triangles indexed by the second hierarchy.
+   * @param result Will contain the pairs of intersecting triangles, the first
+   * element of a pair being a triangle of the first set.
+   * @param compute_segments Set to true to compute intersection segments. */
+  GO_API void find_intersections(
+      const bvh< aabox >& first_hierarchy, const triangle* first_triangles,
+      const bvh< aabox >& second_hierarchy, const triangle* second_triangles,
+      face_intersections& result, bool compute_segments = false );
+  /**@brief Find the self intersections of a set of triangles.
+   *
+   * Traverse a bounding volume hierarchy against itself to find pairs of
+   * triangles that intersect. Faces sharing an edge are never reported.
+   * Faces sharing a single vertex are reported only if they intersect
+   * elsewhere than at this vertex.
+   * @param hierarchy The hierarchy of the triangles.
+   * @param triangles The triangles indexed by the hierarchy.
+   * @param indices The vertex indices of the triangles, three per triangle,
+   * used to detect adjacent faces.
+   * @param result Will contain the pairs of intersecting triangles.
+   * @param compute_segments Set to true to compute intersection segments. */
+  GO_API void find_self_intersections(
+      const bvh< aabox >& hierarchy, const triangle* triangles, const uint32_t* indices,
+      face_intersections& result, bool compute_segments = false );
+
+  /**@brief Find the intersecting faces of two meshes.
+   *
+   * Build the triangles and the hierarchies of two meshes, and find their
+   * intersecting faces. Faces with an invalid index are skipped.
+   * @param first The first mesh.
+   * @param second The second mesh.
+   * @param result Will contain the pairs of intersecting faces.
+   * @param compute_segments Set to true to compute intersection segments. */
+  GO_API void find_intersections(
+      const indexed_mesh& first, const indexed_mesh& second,
+      face_intersections& result, bool compute_segments = false );
+  /**@brief Find the self intersections of a mesh.
+   *
+   * Build the triangles and the hierarchy of a mesh, and find its self
+   * intersections. Faces with an invalid index are skipped.
+   * @param m The mesh.
+   * @param result Will contain the pairs of intersecting faces.
+   * @param compute_segments Set to true to compute intersection segments. */
+  GO_API void find_self_intersections(
+      const indexed_mesh& m, face_intersections& result, bool compute_segments = false );
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,119 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_MESH_NORMALS_H_
+# define GRAPHICS_ORIGIN_MESH_NORMALS_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct mesh;
+  struct indexed_mesh;
+  struct vertex_face_adjacency;
+
+  /**@brief Weighting of face normals in a vertex normal.
+   *
+   * A vertex normal is the normalized sum of the normals of its incident
+   * faces, each one weighted by:
+   * - uniform: one;
+   * - area: the area of the face, which favors large faces;
+   * - angle: the angle of the face at the vertex, which does not depend on
+   * the way the neighborhood of the vertex is triangulated. */
+  enum class normal_weighting {
+    uniform,
+    area,
+    angle
+  };
+
+  /**@brief Compute the contribution of a face to the normals of its vertices.
+   *
+   * Compute the unit normal of a face and the weight of this normal at each
+   * corner of the face. This is the per-face step of every vertex normal
+   * computation, so that they all agree on the weighting.
+   * @param positions The positions of the three vertices of the face.
+   * @param weighting The weighting of face normals.
+   * @param normal Will contain the unit normal of the face.
+   * @param weights Will contain the weight of the normal at each corner.
+   * @return False if the face is degenerated, in which case the normal and
+   * the weights are null. */
+  GO_API bool compute_face_contribution(
+      const vec3* positions, normal_weighting weighting,
+      vec3& normal, vec3& weights );
+
+  /**@brief Compute face normals.
+   *
+   * Compute in parallel the unit normals of faces. Degenerated faces and
+   * faces with an invalid index get a null normal.
+   * @param positions The vertex positions.
+   * @param indices The vertex indices, three per face.
+   * @param nfaces The number of faces.
+   * @param normals Will contain the nfaces normals. */
+  GO_API void compute_face_normals(
+      const vec3* positions, const uint32_t* indices, size_t nfaces,
+      vec3* normals );
+
+  /**@brief Compute vertex normals.
+   *
+   * Compute in parallel the vertex normals of an indexed mesh. Face
+   * contributions are computed once per face, then gathered per vertex
+   * thanks to a face adjacency, so no atomic operation or per-thread
+   * buffer is needed. Since the adjacency only depends on the connectivity,
+   * it can be built once and reused every time positions change, e.g. when
+   * the mesh is deformed. Vertices without valid incident face get a null
+   * normal.
+   * @param positions The vertex positions.
+   * @param nvertices The number of vertices.
+   * @param indices The vertex indices, three per face.
+   * @param nfaces The number of faces.
+   * @param adjacency The faces incident to each vertex.
+   * @param normals Will contain the nvertices normals.
+   * @param weighting The weighting of face normals. */
+  GO_API void compute_vertex_normals(
+      const vec3* positions, size_t nvertices,
+      const uint32_t* indices, size_t nfaces,
+      const vertex_face_adjacency& adjacency,
+      vec3* normals, normal_weighting weighting = normal_weighting::angle );
+  /**@brief Compute vertex normals into a GPU buffer.
+   *
+   * Same as above, but normals are written as gl_real, e.g. directly into
+   * an interleaved vertex buffer.
+   * @param positions The vertex positions.
+   * @param nvertices The number of vertices.
+   * @param indices The vertex indices, three per face.
+   * @param nfaces The number of faces.
+   * @param adjacency The faces incident to each vertex.
+   * @param normals Pointer to the first component of the first normal.
+   * @param normal_stride The number of gl_real between two consecutive normals.
+   * @param weighting The weighting of face normals. */
+  GO_API void compute_vertex_normals(
+      const vec3* positions, size_t nvertices,
+      const uint32_t* indices, size_t nfaces,
+      const vertex_face_adjacency& adjacency,
+      gl_real* normals, size_t normal_stride,
+      normal_weighting weighting = normal_weighting::angle );
+  /**@brief Compute the vertex normals of an indexed mesh.
+   *
+   * Build the face adjacency of an indexed mesh and compute its vertex
+   * normals. If normals are computed repeatedly on the same connectivity,
+   * prefer the version that takes an adjacency.
+   * @param m The indexed mesh.
+   * @param normals Will contain the normal of each vertex.
+   * @param weighting The weighting of face normals. */
+  GO_API void compute_vertex_normals(
+      const indexed_mesh& m, std::vector< vec3 >& normals,
+      normal_weighting weighting = normal_weighting::angle );
+
+  /**@brief Update the normals of a mesh.
+   *
+   * Compute in parallel the face and vertex normals of a mesh and store them
+   * in the mesh attributes. This replaces the sequential update_face_normals()
+   * and update_vertex_normals() of OpenMesh, which walk the half-edge
+   * structure. The mesh should be cleaned before.
+   * @param m The mesh to update.
+   * @param weighting The weighting of face normals. */
+  GO_API void update_normals(
+      mesh& m, normal_weighting weighting = normal_weighting::angle );
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,78 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_MESH_SAMPLING_H_
+# define GRAPHICS_ORIGIN_MESH_SAMPLING_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct indexed_mesh;
+
+  /**@brief Sample uniformly the surface of a mesh.
+   *
+   * Generate random samples uniformly distributed on the surface of a mesh.
+   * Faces are picked proportionally to their area, by a binary search in the
+   * prefix sum of face areas, which is computed in parallel. Samples are
+   * generated in parallel by blocks of fixed size, each block having its own
+   * random engine seeded from the seed and the block index. Thus, the
+   * samples only depend on the seed, and not on the number of threads.
+   * @param m The mesh to sample. Faces with an invalid index are skipped.
+   * @param nsamples The number of samples to generate.
+   * @param seed The seed of the random engines.
+   * @param positions Pointer to an array of nsamples positions.
+   * @param normals Pointer to an array of nsamples normals, or null if the
+   * normals are not needed. The normal of a sample is the normal of its face.
+   * @param faces Pointer to an array of nsamples face indices, or null if
+   * the faces are not needed.
+   * @return False if the mesh has no surface to sample. */
+  GO_API bool sample_uniformly(
+      const indexed_mesh& m, size_t nsamples, uint64_t seed,
+      vec3* positions, vec3* normals = nullptr, uint32_t* faces = nullptr );
+
+  /**@brief Parameters of a Poisson-disk sampling. */
+  struct GO_API poisson_disk_parameters {
+    poisson_disk_parameters();
+    /**@brief The minimum distance between two samples. */
+    real radius;
+    /**@brief Number of uniform candidates generated per sample of a maximal
+     * sampling. A higher number gives a sampling closer to be maximal, at
+     * the price of a longer computation. */
+    real candidates_per_sample;
+    /**@brief The seed of the random engines. */
+    uint64_t seed;
+  };
+
+  /**@brief Generate a Poisson-disk sampling of the surface of a mesh.
+   *
+   * Generate samples on the surface of a mesh, such that no two samples are
+   * closer than a radius. This is a blue noise sampling: samples are
+   * randomly but evenly distributed. The Euclidean distance is used, not the
+   * geodesic one.
+   *
+   * Candidates are first drawn with sample_uniformly() and sorted into a
+   * sparse grid whose cell size is the radius. Candidates are then accepted
+   * by dart throwing, cell by cell. Two cells whose coordinates have the
+   * same remainders modulo 3 are separated by at least twice the radius, so
+   * the 27 groups of such cells are processed one after another, while the
+   * cells of a group are processed in parallel without any synchronization.
+   * The result only depends on the parameters, and not on the number of
+   * threads.
+   *
+   * The output arrays have a fixed capacity. If there are more samples than
+   * the capacity, only the first capacity samples are stored, but the
+   * returned value is still the total number of samples: the function can be
+   * called again with larger arrays to get the same, complete, sampling.
+   * @param m The mesh to sample. Faces with an invalid index are skipped.
+   * @param parameters The parameters of the sampling.
+   * @param capacity The number of elements of the output arrays.
+   * @param positions Pointer to an array of capacity positions.
+   * @param normals Pointer to an array of capacity normals, or null.
+   * @param faces Pointer to an array of capacity face indices, or null.
+   * @return The number of samples. */
+  GO_API size_t sample_poisson_disk(
+      const indexed_mesh& m, const poisson_disk_parameters& parameters,
+      size_t capacity, vec3* positions, vec3* normals = nullptr, uint32_t* faces = nullptr );
+
+} END_GO_NAMESPACE
+# endif
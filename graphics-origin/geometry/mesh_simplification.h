@@ -0,0 +1,109 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_MESH_SIMPLIFICATION_H_
+# define GRAPHICS_ORIGIN_MESH_SIMPLIFICATION_H_
+# include "../graphics_origin.h"
+# include "indexed_mesh.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  /**@brief Parameters of a mesh simplification.
+   *
+   * A simplification stops as soon as one of the two targets is reached: the
+   * number of faces drops to target_number_of_faces, or no edge can be
+   * collapsed with a quadric error lower than max_error.
+   */
+  struct GO_API simplification_parameters {
+    simplification_parameters();
+
+    /**@brief Number of faces to reach. */
+    size_t target_number_of_faces;
+    /**@brief Maximum quadric error of a collapse, i.e. a sum of squared
+     * distances to the planes of the original faces. */
+    real max_error;
+    /**@brief Fraction of the cheapest edges considered at each parallel
+     * round. Lower values give results closer to a sequential greedy
+     * simplification, higher values need fewer rounds. */
+    real collapse_fraction;
+    /**@brief Minimum cosine between the normals of a face before and after a
+     * collapse. Collapses that rotate faces more than that are rejected, which
+     * prevents fold-overs. */
+    real min_normal_cosine;
+    /**@brief Weight of the quadrics that keep boundary edges in place. Set to
+     * zero to let boundaries move freely. */
+    real boundary_weight;
+    /**@brief Optional vertices that should not move. If not null, this array
+     * must have one element per vertex of the input mesh. A locked vertex is
+     * never removed. */
+    const bool* locked_vertices;
+  };
+
+  /**@brief Simplify a mesh by quadric error edge collapses.
+   *
+   * Simplify a mesh with the quadric error metric of Garland and Heckbert.
+   * Instead of collapsing edges one by one in a priority queue, edges are
+   * collapsed by rounds of independent sets: at each round, the cheapest
+   * edges are selected in parallel such that no two selected collapses touch
+   * the same face. Those collapses are thus applied in parallel without any
+   * lock. This scheme allows to reduce millions of triangles in a few
+   * seconds, with a quality close to the sequential greedy algorithm.
+   *
+   * Collapses that would make the surface non-manifold or flip faces are
+   * rejected. Removed faces and vertices are compacted at the end.
+   * @param m The mesh to simplify.
+   * @param parameters The simplification parameters.
+   * @param remap If not null, will contain for each vertex of the input mesh
+   * its index in the simplified mesh, or invalid_index if it was removed.
+   * @return The maximum quadric error of the collapses done. */
+  GO_API
+  real simplify(
+      indexed_mesh& m, const simplification_parameters& parameters,
+      std::vector< indexed_mesh::vertex_index >* remap = nullptr );
+
+  /**@brief A chain of levels of detail.
+   *
+   * Store simplified versions of a mesh, from the finest to the coarsest one,
+   * along with the quadric error of each level. This allows a renderable or
+   * a collision system to select a level according to its budget.
+   */
+  struct GO_API level_of_detail_chain {
+    /**@brief Select the coarsest level under an error bound.
+     *
+     * @param max_error The maximum quadric error allowed.
+     * @return The index of the coarsest level with an error lower than
+     * max_error, or 0 if there is none. */
+    size_t select_by_error( real max_error ) const;
+    /**@brief Select the finest level under a face budget.
+     *
+     * @param max_number_of_faces The maximum number of faces allowed.
+     * @return The index of the finest level with less than max_number_of_faces
+     * faces, or the index of the coarsest level if there is none. */
+    size_t select_by_faces( size_t max_number_of_faces ) const;
+
+    std::vector< indexed_mesh > levels;
+    std::vector< real > errors;
+  };
+
+  /**@brief Build a whole chain of levels of detail in one pass.
+   *
+   * Simplify a mesh progressively and take a snapshot each time a target
+   * number of faces is reached. This is cheaper than calling simplify() for
+   * every level since the work done for a level is reused by the next one.
+   * The first level of the chain is the input mesh.
+   * @param input The mesh to simplify.
+   * @param face_targets The number of faces of each level, in decreasing order.
+   * @param parameters The simplification parameters. The target number of
+   * faces is ignored, but the error bound still applies: the chain stops at
+   * the first level that cannot be reached under max_error.
+   * @param chain The chain to fill. */
+  GO_API
+  void build_level_of_detail_chain(
+      const indexed_mesh& input,
+      const std::vector< size_t >& face_targets,
+      const simplification_parameters& parameters,
+      level_of_detail_chain& chain );
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,110 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_SPACE_FILLING_CURVE_H_
+# define GRAPHICS_ORIGIN_SPACE_FILLING_CURVE_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct aabox;
+  struct indexed_mesh;
+  struct mesh;
+
+  /**@brief Available space filling curves.
+   *
+   * Both curves map close positions to close codes. A Morton code is cheaper
+   * to compute, while a Hilbert code never jumps between distant cells and
+   * thus gives a better locality. */
+  enum class space_filling_curve {
+    morton,
+    hilbert
+  };
+
+  /**@brief Number of bits per dimension of space filling curve codes. */
+  static constexpr unsigned int space_filling_curve_bits = 21;
+
+  /**@brief Compute the Morton code of a position.
+   *
+   * Compute the 63 bits Morton code of a position, i.e. interleave the bits
+   * of its quantized coordinates.
+   * @param p The position, with coordinates in [0,1].
+   * @return The Morton code of p. */
+  GO_API uint64_t compute_morton_code( const vec3& p );
+
+  /**@brief Compute the Hilbert code of a position.
+   *
+   * Compute the 63 bits Hilbert code of a position with the algorithm of
+   * J. Skilling (Programming the Hilbert curve, 2004).
+   * @param p The position, with coordinates in [0,1].
+   * @return The Hilbert code of p. */
+  GO_API uint64_t compute_hilbert_code( const vec3& p );
+
+  /**@brief Sort points along a space filling curve.
+   *
+   * Compute in parallel the order of a set of points along a space filling
+   * curve.
+   * @param points The points to sort.
+   * @param npoints The number of points.
+   * @param box A box that contains all the points.
+   * @param curve The space filling curve to use.
+   * @param order Will contain the npoints indices of the points, in the
+   * order of the curve. */
+  GO_API void compute_spatial_order(
+      const vec3* points, size_t npoints, const aabox& box,
+      space_filling_curve curve, std::vector< uint32_t >& order );
+
+  /**@brief Locality statistics of a mesh.
+   *
+   * Measure how far apart in memory are data accessed together when
+   * traversing the faces of a mesh. Lower is better. */
+  struct GO_API mesh_locality_statistics {
+    mesh_locality_statistics();
+    /**@brief Average difference between the largest and the smallest vertex
+     * indices of a face. */
+    real average_face_index_span;
+    /**@brief Average difference between the smallest vertex indices of
+     * two consecutive faces. */
+    real average_face_index_jump;
+  };
+
+  /**@brief Compute the locality statistics of faces.
+   * @param indices The vertex indices, three per face.
+   * @param nfaces The number of faces.
+   * @return The locality statistics. */
+  GO_API mesh_locality_statistics compute_locality_statistics( const uint32_t* indices, size_t nfaces );
+
+  /**@brief Reorder an indexed mesh along a space filling curve.
+   *
+   * Sort the vertices of an indexed mesh by the code of their position and
+   * the faces by the code of their centroid. Vertices and faces close in
+   * space are then close in memory, which speeds up any spatial structure
+   * build or traversal on this mesh.
+   * @param m The mesh to reorder.
+   * @param curve The space filling curve to use.
+   * @param vertex_order If not null, will contain for each new vertex the
+   * index of that vertex before the reordering.
+   * @param face_order If not null, will contain for each new face the index
+   * of that face before the reordering. */
+  GO_API void spatially_reorder(
+      indexed_mesh& m, space_filling_curve curve = space_filling_curve::hilbert,
+      std::vector< uint32_t >* vertex_order = nullptr,
+      std::vector< uint32_t >* face_order = nullptr );
+
+  /**@brief Reorder a mesh along a space filling curve.
+   *
+   * Rebuild a mesh with its vertices sorted by the code of their position and
+   * its faces sorted by the code of their centroid. The mesh should be
+   * cleaned before. Vertex positions, normals and colors, face normals and
+   * colors and halfedge normals and texture coordinates are preserved. As
+   * with mesh::clean(), handles are invalidated.
+   * @param m The mesh to reorder.
+   * @param curve The space filling curve to use.
+   * @return The number of faces that could not be added in the new order,
+   * e.g. faces on complex edges, and were thus dropped. */
+  GO_API size_t spatially_reorder(
+      mesh& m, space_filling_curve curve = space_filling_curve::hilbert );
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,158 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_SPATIAL_GRID_H_
+# define GRAPHICS_ORIGIN_SPATIAL_GRID_H_
+# include "../graphics_origin.h"
+# include "kdtree.h"
+# include "box.h"
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  /**@brief A uniform grid of points.
+   *
+   * This class allows efficient radius searches on a set of points, when
+   * the search radius is close to the cell size. This is typically the case
+   * for uniformly sampled point sets, for which the grid is both faster to
+   * build and to query than a kdtree.
+   *
+   * Points are sorted by cell with a parallel counting sort (cell index,
+   * prefix sum, scatter) and copied in that order. A query visits the
+   * stencil of cells overlapping the search ball. When the grid would have
+   * too many cells compared to the number of points, e.g. for a sparse set
+   * with a large extent, cells are hashed into a table whose size is
+   * proportional to the number of points. In that case, points are filtered
+   * by their cell, so hash collisions never produce duplicates.
+   *
+   * Radius search functions have the same signatures as those of
+   * point_kdtree, so the two structures can be swapped.
+   */
+  class GO_API spatial_grid {
+  public:
+    typedef uint32_t point_index;
+
+    /**@brief Build a grid.
+     *
+     * Build a grid of points. The points are copied, so they can be
+     * destroyed or modified after the construction.
+     * @param points Pointer to 3 * npoints reals, three per point.
+     * @param npoints The number of points.
+     * @param cell_size The size of the grid cells. The best choice is the
+     * radius of most queries. */
+    spatial_grid( const real* points, size_t npoints, real cell_size );
+    /**@brief Build a grid.
+     * @param points Pointer to the points.
+     * @param npoints The number of points.
+     * @param cell_size The size of the grid cells. */
+    spatial_grid( const vec3* points, size_t npoints, real cell_size );
+
+    /**@brief Get the number of points in the grid. */
+    inline size_t get_number_of_points() const noexcept
+    {
+      return m_positions.size();
+    }
+    /**@brief Get the size of the grid cells. */
+    inline real get_cell_size() const noexcept
+    {
+      return m_cell_size;
+    }
+    /**@brief Get the bounding box of the points. */
+    inline const aabox& get_bounding_box() const noexcept
+    {
+      return m_bounding_box;
+    }
+
+    /**@brief Find the points in a ball.
+     *
+     * Look for any point that lies in a ball.
+     * @param location The center of the search ball.
+     * @param radius The radius of the search ball.
+     * @param indices_sdistances A vector of pair containing the index of a
+     * point inside the search ball and its squared distance to the ball
+     * center. Those pairs are ordered by increasing distances. The vector is
+     * cleared first, so it is advised to reuse the same vector. */
+    void radius_search( const vec3& location, real radius, std::vector< std::pair< point_index, real > >& indices_sdistances ) const;
+    /**@brief Count the points in a ball.
+     * @param location The center of the search ball.
+     * @param radius The radius of the search ball.
+     * @return The number of points inside the ball. */
+    size_t count_in_radius( const vec3& location, real radius ) const;
+    /**@brief Count the points in balls of a batch of locations.
+     *
+     * Count in parallel the points in the ball of each location, and store
+     * the result as offsets for a compressed sparse row output.
+     * @param locations Pointer to the centers of the search balls.
+     * @param nlocations The number of locations.
+     * @param radius The radius of the search balls.
+     * @param offsets Pointer to an array of nlocations + 1 elements.
+     * @return The total number of neighbors, i.e. offsets[nlocations]. */
+    size_t count_in_radius( const vec3* locations, size_t nlocations, real radius, size_t* offsets ) const;
+    /**@brief Find the points in balls of a batch of locations.
+     *
+     * Look in parallel for the points in the ball of each location. The
+     * output buffers must be allocated with the offsets computed by
+     * count_in_radius() for the same locations and radius. Neighbors of a
+     * location are not sorted.
+     * @param locations Pointer to the centers of the search balls.
+     * @param nlocations The number of locations.
+     * @param radius The radius of the search balls.
+     * @param offsets The offsets computed by count_in_radius().
+     * @param indices Pointer to an array of offsets[nlocations] point indices.
+     * @param squared_distances Pointer to an array of offsets[nlocations]
+     * squared distances, or null if distances are not needed. */
+    void radius_search(
+        const vec3* locations, size_t nlocations, real radius,
+        const size_t* offsets, point_index* indices, real* squared_distances ) const;
+    /**@brief Find the points in balls of a batch of locations.
+     *
+     * Count then find in parallel the points in the ball of each location.
+     * @param locations Pointer to the centers of the search balls.
+     * @param nlocations The number of locations.
+     * @param radius The radius of the search balls.
+     * @param neighborhoods Will contain the neighbors of each location. */
+    void radius_search(
+        const vec3* locations, size_t nlocations, real radius,
+        point_neighborhoods& neighborhoods ) const;
+
+    /**@brief Find the neighbors of every point of the grid.
+     *
+     * Compute in parallel, for each point of the grid, the other points at
+     * distance at most radius. Points are processed in the order of the grid
+     * to benefit from the cache, but the neighbors of the i-th point are
+     * stored in the range [offsets[i], offsets[i+1]) of the output.
+     * Neighbors of a point are not sorted, and a point is not its own
+     * neighbor.
+     * @param radius The radius of the neighborhoods.
+     * @param neighborhoods Will contain the neighbors of each point. */
+    void compute_all_neighbors( real radius, point_neighborhoods& neighborhoods ) const;
+
+  private:
+    struct cell_range {
+      int64_t low[3];
+      int64_t high[3];
+    };
+    void build( const real* points, size_t npoints );
+    void get_cell_range( const vec3& location, real radius, cell_range& range ) const;
+    size_t get_bucket( int64_t x, int64_t y, int64_t z ) const;
+    template< typename visitor >
+    void search( const vec3& location, real radius, visitor&& v ) const;
+
+    aabox m_bounding_box;
+    vec3 m_origin;
+    real m_cell_size;
+    real m_inv_cell_size;
+    int64_t m_resolution[3];
+    size_t m_bucket_mask;
+    bool m_dense;
+    /**Start of each bucket in the sorted arrays. A bucket is a cell if the
+     * grid is dense, a set of hashed cells otherwise. */
+    std::vector< uint32_t > m_bucket_offsets;
+    /**Point data, sorted by bucket. */
+    std::vector< vec3 > m_positions;
+    std::vector< uint64_t > m_cell_keys;
+    std::vector< point_index > m_indices;
+  };
+
+} END_GO_NAMESPACE
+# endif
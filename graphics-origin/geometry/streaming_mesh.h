@@ -0,0 +1,179 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_STREAMING_MESH_H_
+# define GRAPHICS_ORIGIN_STREAMING_MESH_H_
+# include "../graphics_origin.h"
+# include "indexed_mesh.h"
+# include "mesh_normals.h"
+# include "mesh_simplification.h"
+# include "triangle.h"
+# include "box.h"
+# include "bvh.h"
+# include <functional>
+# include <memory>
+# include <string>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  /**@brief Parameters of a streaming mesh. */
+  struct GO_API streaming_parameters {
+    streaming_parameters();
+    /**@brief Number of faces read from the disk at once. */
+    size_t chunk_size;
+    /**@brief Number of faces a tile should not exceed. The memory needed by
+     * a tile worker is proportional to this number. A tile can only be
+     * larger when too many faces are concentrated in a small region. */
+    size_t max_faces_per_tile;
+    /**@brief Number of tiles processed at the same time. Set to zero to use
+     * as many workers as OpenMP threads. */
+    size_t number_of_workers;
+    /**@brief Directory in which tiles are written. The system temporary
+     * directory is used if this string is empty. */
+    std::string temporary_directory;
+  };
+
+  /**@brief A tile of a streaming mesh.
+   *
+   * A tile contains the faces whose centroid lies in a region of space, as
+   * an indexed mesh with local vertex indices. The vertices of a tile that
+   * are also referenced by faces of other tiles are called shared vertices.
+   * They are the only link between tiles, and are used to stitch the
+   * results of per-tile operations.
+   */
+  struct GO_API streaming_tile {
+    typedef indexed_mesh::vertex_index vertex_index;
+    /**@brief Index of this tile in the streaming mesh. */
+    size_t index;
+    /**@brief Bounding box of the faces of this tile. */
+    aabox bounding_box;
+    /**@brief Faces of this tile. */
+    indexed_mesh mesh;
+    /**@brief Index of each vertex of mesh in the input file. */
+    std::vector< vertex_index > global_indices;
+    /**@brief Index of each vertex of mesh among the shared vertices, or
+     * invalid_index if the vertex is only referenced by this tile. */
+    std::vector< vertex_index > shared_indices;
+  };
+
+  /**@brief An out-of-core triangular mesh.
+   *
+   * This class processes meshes that do not fit in memory. When loaded,
+   * faces are read by chunks and bucketed into tiles, with an adaptive
+   * subdivision of the bounding box such that each tile has a bounded
+   * number of faces. Tiles are stored in temporary files, along with the
+   * positions of their vertices, so they can be loaded independently with
+   * sequential reads. Operations are then done by parallel tile workers,
+   * each one loading a single tile at a time: the memory needed is bounded
+   * by the number of workers times the size of a tile.
+   *
+   * Per-tile results are stitched through shared vertices, which are
+   * vertices referenced by more than one tile:
+   * - normals of shared vertices gather the contributions of every tile
+   * before being normalized, so they are the same as those that would be
+   * computed on the whole mesh;
+   * - shared vertices are locked during the decimation, so the boundaries
+   * between tiles are kept and written once: the decimated mesh is as
+   * watertight as the input one.
+   *
+   * Only binary little endian PLY files with triangular faces are supported.
+   * Vertex positions can be stored as floats or doubles, and vertex indices
+   * as 32 bits integers. Other properties are skipped.
+   */
+  class GO_API streaming_mesh {
+  public:
+    typedef indexed_mesh::vertex_index vertex_index;
+
+    streaming_mesh();
+    ~streaming_mesh();
+
+    /**@brief Load a mesh from a file.
+     *
+     * Read the faces of a mesh by chunks and write them into tiles. The
+     * content of the file is read three times: once to compute the
+     * bounding box of the vertices, once to estimate the distribution of
+     * faces and once to fill the tiles. Vertex positions are accessed through
+     * a memory mapping of the file, so they do not need to fit in memory.
+     * @param filename The name of the PLY file to load.
+     * @param parameters The streaming parameters.
+     * @return True if the mesh has been successfully loaded. */
+    bool load( const std::string& filename, const streaming_parameters& parameters = streaming_parameters{} );
+    /**@brief Release the input file and remove the tiles. */
+    void clear();
+
+    /**@brief Get the number of vertices in the input file. */
+    size_t get_number_of_vertices() const noexcept;
+    /**@brief Get the number of faces in the input file. */
+    size_t get_number_of_faces() const noexcept;
+    /**@brief Get the number of vertices shared by several tiles. */
+    size_t get_number_of_shared_vertices() const noexcept;
+    /**@brief Get the number of tiles. */
+    size_t get_number_of_tiles() const noexcept;
+    /**@brief Get the bounding box of the vertices. */
+    const aabox& get_bounding_box() const noexcept;
+    /**@brief Get the bounding box of the faces of a tile. */
+    const aabox& get_tile_bounding_box( size_t tile ) const;
+    /**@brief Get the number of faces of a tile. */
+    size_t get_tile_number_of_faces( size_t tile ) const;
+
+    /**@brief Load a tile in memory.
+     * @param tile The index of the tile to load.
+     * @param result The tile to fill.
+     * @return True if the tile has been successfully read. */
+    bool load_tile( size_t tile, streaming_tile& result ) const;
+    /**@brief Process every tile.
+     *
+     * Tiles are loaded and given to a worker function in parallel, by at
+     * most number_of_workers threads. A worker can modify the tile it
+     * receives, as it is not written back on the disk.
+     * @param worker The function to call for each tile.
+     * @return True if every tile has been successfully read. */
+    bool process_tiles( const std::function< void( streaming_tile& ) >& worker ) const;
+    /**@brief Process the bounding volume hierarchy of every tile.
+     *
+     * Build, for every tile, the triangles of its faces and a bounding
+     * volume hierarchy of those triangles. The hierarchy is given to a
+     * worker function, and released right after. This allows for instance
+     * to cast rays against each tile, the tile bounding boxes being used to
+     * skip tiles not hit. Tiles with a single face have no hierarchy and
+     * are skipped.
+     * @param worker The function to call for each tile, with the tile, its
+     * triangles and their hierarchy.
+     * @return True if every tile has been successfully read. */
+    bool process_tile_hierarchies(
+        const std::function< void( const streaming_tile&, const std::vector< triangle >&, const bvh< aabox >& ) >& worker ) const;
+
+    /**@brief Compute the vertex normals.
+     *
+     * Compute, tile by tile, the normals of the input vertices and write them
+     * in a file, as three floats per vertex in the order of the input file.
+     * Vertices not referenced by any face have a null normal.
+     * @param filename The name of the file to write.
+     * @param weighting The weighting of face normals.
+     * @return True if the normals have been successfully written. */
+    bool compute_vertex_normals(
+        const std::string& filename,
+        normal_weighting weighting = normal_weighting::angle ) const;
+    /**@brief Decimate the mesh.
+     *
+     * Simplify every tile with simplify() and write the result into a binary
+     * PLY file. Shared vertices are locked, hence the boundaries between tiles
+     * keep their original resolution. Shared vertices are written first, then
+     * the remaining vertices of each tile.
+     * @param filename The name of the PLY file to write.
+     * @param ratio The fraction of faces to keep in each tile.
+     * @param parameters The simplification parameters. The target number of
+     * faces and the locked vertices are set for each tile.
+     * @return True if the decimated mesh has been successfully written. */
+    bool simplify(
+        const std::string& filename, real ratio,
+        const simplification_parameters& parameters = simplification_parameters{} ) const;
+
+  private:
+    struct implementation;
+    std::unique_ptr< implementation > m_implementation;
+  };
+
+} END_GO_NAMESPACE
+# endif
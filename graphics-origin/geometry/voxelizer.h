@@ -0,0 +1,148 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_VOXELIZER_H_
+# define GRAPHICS_ORIGIN_VOXELIZER_H_
+# include "../graphics_origin.h"
+# include "vec.h"
+# include <array>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+  struct indexed_mesh;
+
+  /**@brief Voxelization modes.
+   *
+   * - surface: a voxel is set if it intersects a triangle. This is a
+   * conservative voxelization, without any hole even for thin features.
+   * - parity: surface voxels, plus voxels whose center is inside the mesh,
+   * i.e. crossed an odd number of times by the surface along the x axis.
+   * - winding: surface voxels, plus voxels whose center has a non null
+   * winding number. Unlike parity, overlapping closed components stay
+   * solid. The mesh must be consistently oriented. */
+  enum class voxelization_mode {
+    surface,
+    parity,
+    winding
+  };
+
+  /**@brief A dense grid of voxels.
+   *
+   * This structure stores one bit per voxel. Voxels are stored in rows along
+   * the x axis, each row being padded to a whole number of bytes. The voxel
+   * (x,y,z) covers the box [origin + (x,y,z) * voxel_size, origin +
+   * (x+1,y+1,z+1) * voxel_size).
+   */
+  struct GO_API voxel_grid {
+    voxel_grid();
+
+    /**@brief Check if a voxel is set. */
+    inline bool get( uint32_t x, uint32_t y, uint32_t z ) const
+    {
+      return ( bits[ ( size_t( z ) * resolution[1] + y ) * row_size + ( x >> 3 ) ] >> ( x & 7 ) ) & 1;
+    }
+    /**@brief Set a voxel. */
+    inline void set( uint32_t x, uint32_t y, uint32_t z )
+    {
+      bits[ ( size_t( z ) * resolution[1] + y ) * row_size + ( x >> 3 ) ] |= uint8_t( 1 << ( x & 7 ) );
+    }
+    /**@brief Count the voxels set, in parallel. */
+    size_t count_voxels() const;
+    /**@brief Compute the volume of the voxels set. */
+    real compute_volume() const;
+
+    vec3 origin;
+    real voxel_size;
+    uint32_t resolution[3];
+    /**@brief Number of bytes per row of voxels along x. */
+    size_t row_size;
+    std::vector< uint8_t > bits;
+  };
+
+  /**@brief A sparse grid of voxels.
+   *
+   * This structure stores voxels in bricks of 8x8x8 voxels. Only bricks that
+   * are neither empty nor full are allocated, which makes this format far
+   * more compact than a voxel_grid for high resolutions: at 1024^3, a
+   * surface usually needs a few percents of the memory of a dense grid. A
+   * brick stores its voxel (x,y,z) in the bit 8y+x of its z-th word.
+   */
+  struct GO_API voxel_brick_map {
+    typedef std::array< uint64_t, 8 > brick;
+    /**@brief Number of voxels along each side of a brick. */
+    static constexpr uint32_t brick_size = 8;
+    /**@brief Index of a brick without any voxel set. */
+    static constexpr uint32_t empty_brick = uint32_t(-1);
+    /**@brief Index of a brick with all its voxels set. */
+    static constexpr uint32_t full_brick = uint32_t(-2);
+
+    voxel_brick_map();
+
+    /**@brief Get the index of the brick containing a voxel. */
+    inline size_t get_brick( uint32_t x, uint32_t y, uint32_t z ) const
+    {
+      return ( size_t( z >> 3 ) * brick_resolution[1] + ( y >> 3 ) ) * brick_resolution[0] + ( x >> 3 );
+    }
+    /**@brief Check if a voxel is set. */
+    inline bool get( uint32_t x, uint32_t y, uint32_t z ) const
+    {
+      const uint32_t index = brick_indices[ get_brick( x, y, z ) ];
+      if( index == empty_brick )
+        return false;
+      if( index == full_brick )
+        return true;
+      return ( bricks[ index ][ z & 7 ] >> ( ( y & 7 ) * 8 + ( x & 7 ) ) ) & 1;
+    }
+    /**@brief Count the voxels set, in parallel. */
+    size_t count_voxels() const;
+    /**@brief Compute the volume of the voxels set. */
+    real compute_volume() const;
+    /**@brief Convert to a dense grid.
+     * @param grid The dense grid to fill. */
+    void to_dense( voxel_grid& grid ) const;
+
+    vec3 origin;
+    real voxel_size;
+    uint32_t resolution[3];
+    uint32_t brick_resolution[3];
+    /**@brief For each brick, its index in bricks, or empty_brick, or full_brick. */
+    std::vector< uint32_t > brick_indices;
+    std::vector< brick > bricks;
+  };
+
+  /**@brief Voxelize a mesh into a sparse grid.
+   *
+   * Rasterize the triangles of a mesh into voxels. The grid covers the
+   * bounding box of the mesh with cubic voxels, resolution voxels along its
+   * largest side.
+   *
+   * Triangles are first binned in parallel into the bricks they intersect.
+   * Then, each brick is processed by a single thread that tests its
+   * triangles against the voxels of their footprint with the separating
+   * axis test of triangle::intersect( const aabox& ). For solid modes,
+   * triangles are also binned into tiles of 8x8 columns along x. Each tile
+   * computes the crossings of its columns with triangles, with a top-left
+   * rule so that a column crossing a shared edge or vertex is counted once,
+   * and fills the voxels inside.
+   * @param m The mesh to voxelize. Faces with an invalid index are skipped.
+   * @param resolution The number of voxels along the largest side of the
+   * bounding box of the mesh.
+   * @param mode The voxelization mode.
+   * @param result The voxels. */
+  GO_API void voxelize(
+      const indexed_mesh& m, uint32_t resolution, voxelization_mode mode,
+      voxel_brick_map& result );
+  /**@brief Voxelize a mesh into a dense grid.
+   *
+   * Same as above, but the result is converted into a dense grid.
+   * @param m The mesh to voxelize.
+   * @param resolution The number of voxels along the largest side of the
+   * bounding box of the mesh.
+   * @param mode The voxelization mode.
+   * @param result The voxels. */
+  GO_API void voxelize(
+      const indexed_mesh& m, uint32_t resolution, voxelization_mode mode,
+      voxel_grid& result );
+
+} END_GO_NAMESPACE
+# endif
@@ -0,0 +1,247 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_ARENA_ALLOCATOR_H_
+# define GRAPHICS_ORIGIN_ARENA_ALLOCATOR_H_
+
+# include "./memory.h"
+# include <cstddef>
+# include <limits>
+# include <new>
+# include <type_traits>
+
+# if defined( _MSVC_LANG )
+#  define GO_CPLUSPLUS _MSVC_LANG
+# else
+#  define GO_CPLUSPLUS __cplusplus
+# endif
+# if GO_CPLUSPLUS >= 201703L && defined( __has_include )
+#  if __has_include( <memory_resource> )
+#   include <memory_resource>
+#   define GO_HAS_MEMORY_RESOURCE
+#  endif
+# endif
+
+/**@file
+ * @brief Use memory arenas in the containers of the standard library.
+ *
+ * This file provides an allocator, conforming to the requirements of the
+ * standard library, that forwards allocations to a memory_arena. With it, a
+ * std::vector or a std::unordered_map can live in a stack or a linear arena,
+ * without any call to malloc:
+ * \code{.cpp}
+ * tools::memory_area::on_stack< 4096 > area;
+ * tools::allocation_policy::linear linear( area );
+ * typedef tools::memory_arena< tools::allocation_policy::linear, ... > arena_type;
+ * arena_type arena( &linear );
+ * std::vector< int, tools::arena_allocator< int, arena_type > > values( arena );
+ * \endcode
+ * When compiled in C++17, a std::pmr::memory_resource is also provided.
+ *
+ * Containers allocate from inside the standard library, where no callsite is
+ * known. Thus, the allocator stores the callsite at which it is built and
+ * gives it to the arena, so that a tracking policy such as per_callsite
+ * reports the allocations of a container where this container is declared.
+ * The macro go_arena_allocator() builds an allocator with its callsite:
+ * \code{.cpp}
+ * std::vector< int, tools::arena_allocator< int, arena_type > > values(
+ *   go_arena_allocator( int, arena ) );
+ * \endcode
+ * An allocator built from an arena only reports its allocations in this file.
+ */
+/**@brief Build an arena_allocator that reports the current callsite.
+ *
+ * @param type_ Type of the allocated objects.
+ * @param arena_ A memory arena. */
+# define go_arena_allocator(type_,arena_)                                       \
+  graphics_origin::tools::arena_allocator<                                     \
+    type_, typename std::remove_reference< decltype(arena_) >::type >(         \
+    arena_, __FILE__, GO_STRINGIZE(__LINE__), GO_PRETTY_FUNCTION )
+
+namespace graphics_origin {
+  namespace tools {
+
+    /**@brief Allocator of the standard library using a memory arena.
+     *
+     * This allocator is stateful: it stores a pointer to a memory arena, which
+     * must outlive the containers using it. Two allocators are equal if they
+     * use the same arena, in which case one can free the memory of the other.
+     *
+     * When a container is move assigned or swapped, its allocator follows its
+     * memory, so that those operations never copy elements and are always
+     * valid. When a container is copy assigned, it keeps its allocator, as a
+     * copy of a container in an arena should stay in this arena. Finally, a
+     * copy constructed container uses the same arena as the original.
+     * Allocators keep their callsite when they are copied or rebound, but
+     * the callsite plays no role in their comparison.
+     *
+     * If the arena cannot satisfy an allocation, std::bad_alloc is thrown, as
+     * required by the standard library.
+     *
+     * Containers free their memory in any order: a growing std::vector frees
+     * its previous buffer after allocating the next one. Thus, the allocation
+     * policy of the arena must either ignore deallocations, as the linear
+     * one, or accept them in any order, as the pool and tlsf ones. A stack
+     * policy can only be used for containers that never reallocate, e.g. a
+     * std::vector whose capacity is reserved once.
+     * @tparam type Type of the allocated objects.
+     * @tparam arena Type of the memory_arena. */
+    template< typename type, class arena >
+    class arena_allocator {
+    public:
+      typedef type value_type;
+      typedef type* pointer;
+      typedef const type* const_pointer;
+      typedef type& reference;
+      typedef const type& const_reference;
+      typedef size_t size_type;
+      typedef std::ptrdiff_t difference_type;
+
+      typedef std::false_type propagate_on_container_copy_assignment;
+      typedef std::true_type propagate_on_container_move_assignment;
+      typedef std::true_type propagate_on_container_swap;
+      typedef std::false_type is_always_equal;
+
+      template< typename other_type >
+      struct rebind {
+        typedef arena_allocator< other_type, arena > other;
+      };
+
+      arena_allocator( arena& a ) noexcept
+        : m_arena{ &a }, m_file{ __FILE__ }, m_line{ GO_STRINGIZE(__LINE__) },
+          m_function{ GO_PRETTY_FUNCTION }
+      {}
+
+      /**@brief Build an allocator reporting its allocations at a callsite.
+       *
+       * This constructor is called by the go_arena_allocator() macro. */
+      arena_allocator( arena& a, const char* file, const char* line, const char* function ) noexcept
+        : m_arena{ &a }, m_file{ file }, m_line{ line }, m_function{ function }
+      {}
+
+      template< typename other_type >
+      arena_allocator( const arena_allocator< other_type, arena >& other ) noexcept
+        : m_arena{ other.get_arena() }, m_file{ other.get_file() },
+          m_line{ other.get_line() }, m_function{ other.get_function() }
+      {}
+
+      type* allocate( size_t n )
+      {
+        if( n > std::numeric_limits< size_t >::max() / sizeof(type) )
+          throw std::bad_alloc();
+        void* result = m_arena->allocate( n * sizeof(type), alignof(type), m_file, m_line, m_function );
+        if( !result )
+          throw std::bad_alloc();
+        return static_cast< type* >( result );
+      }
+
+      void deallocate( type* p, size_t ) noexcept
+      {
+        m_arena->deallocate( p );
+      }
+
+      size_t max_size() const noexcept
+      {
+        return std::numeric_limits< size_t >::max() / sizeof(type);
+      }
+
+      arena_allocator select_on_container_copy_construction() const
+      {
+        return *this;
+      }
+
+      arena* get_arena() const noexcept
+      {
+        return m_arena;
+      }
+
+      const char* get_file() const noexcept
+      {
+        return m_file;
+      }
+
+      const char* get_line() const noexcept
+      {
+        return m_line;
+      }
+
+      const char* get_function() const noexcept
+      {
+        return m_function;
+      }
+
+    private:
+      arena* m_arena;
+      const char* m_file;
+      const char* m_line;
+      const char* m_function;
+    };
+
+    template< typename type1, typename type2, class arena >
+    inline bool operator==( const arena_allocator< type1, arena >& a, const arena_allocator< type2, arena >& b ) noexcept
+    {
+      return a.get_arena() == b.get_arena();
+    }
+
+    template< typename type1, typename type2, class arena >
+    inline bool operator!=( const arena_allocator< type1, arena >& a, const arena_allocator< type2, arena >& b ) noexcept
+    {
+      return a.get_arena() != b.get_arena();
+    }
+
+# ifdef GO_HAS_MEMORY_RESOURCE
+    /**@brief Polymorphic memory resource using a memory arena.
+     *
+     * This memory resource lets the std::pmr containers use a memory arena,
+     * without making the type of the arena part of the type of the
+     * containers. Two resources are equal if they use the same arena. As
+     * for arena_allocator, the allocations are reported at the callsite
+     * given at construction, if any, or in this file otherwise.
+     * @tparam arena Type of the memory_arena. */
+    template< class arena >
+    class arena_memory_resource
+      : public std::pmr::memory_resource {
+    public:
+      explicit arena_memory_resource( arena& a ) noexcept
+        : m_arena{ &a }, m_file{ __FILE__ }, m_line{ GO_STRINGIZE(__LINE__) },
+          m_function{ GO_PRETTY_FUNCTION }
+      {}
+
+      arena_memory_resource( arena& a, const char* file, const char* line, const char* function ) noexcept
+        : m_arena{ &a }, m_file{ file }, m_line{ line }, m_function{ function }
+      {}
+
+      arena* get_arena() const noexcept
+      {
+        return m_arena;
+      }
+
+    private:
+      void* do_allocate( size_t bytes, size_t alignment ) override
+      {
+        void* result = m_arena->allocate( bytes, alignment, m_file, m_line, m_function );
+        if( !result )
+          throw std::bad_alloc();
+        return result;
+      }
+
+      void do_deallocate( void* p, size_t, size_t ) override
+      {
+        m_arena->deallocate( p );
+      }
+
+      bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override
+      {
+        const arena_memory_resource* resource = dynamic_cast< const arena_memory_resource* >( &other );
+        return resource && resource->m_arena == m_arena;
+      }
+
+      arena* m_arena;
+      const char* m_file;
+      const char* m_line;
+      const char* m_function;
+    };
+# endif
+  }
+}
+# endif
@@ -4,13 +4,23 @@
 # include "./assert.h"
 # include "./log.h"
 # include <new>
+# include <atomic>
+# include <mutex>
+# include <thread>
+# include <vector>
+# include <unordered_map>
+# include <algorithm>
+# include <functional>
+# include <cstring>
 
 // virtual_memory namespace
 # ifdef _WIN32
 #  include <windows.h>
 # elif __linux__
 #  include <sys/mman.h>
+#  include <sys/syscall.h>
 #  include <unistd.h>
+#  include <cstdio>
 # else
 #  error "unknown platform"
 # endif
@@ -204,61 +214,213 @@ namespace graphics_origin {
 # endif
       }
 
-      /**
+      /**@brief Get the size of a huge page.
+       *
+       * Huge pages cover a larger range of addresses with a single TLB entry
+       * than normal pages. Buffers accessed randomly, such as the nodes of a
+       * BVH, trigger fewer TLB misses when they are mapped to huge pages.
+       * @return The size of the default huge page, or 0 if there is none. */
+      inline size_t get_huge_page_size()
+      {
+# ifdef _WIN32
+        return GetLargePageMinimum();
+# elif __linux__
+        static const size_t huge_page_size = []
+        {
+          size_t result = 0;
+          if( FILE* meminfo = std::fopen( "/proc/meminfo", "r" ) )
+            {
+              char line[256];
+              unsigned long kilobytes = 0;
+              while( std::fgets( line, sizeof(line), meminfo ) )
+                if( std::sscanf( line, "Hugepagesize: %lu kB", &kilobytes ) == 1 )
+                  {
+                    result = size_t( kilobytes ) << 10;
+                    break;
+                  }
+              std::fclose( meminfo );
+            }
+          return result;
+        }();
+        return huge_page_size;
+# endif
+      }
+
+      /**@brief Kind of physical pages used to back an address space.
        *
+       * - normal pages are the default ones
+       * - transparent_huge pages are requested to the kernel, which uses them
+       * when it can, for 2MB aligned ranges of 2MB. The address space is thus
+       * aligned on the huge page size, and the memory should be committed by
+       * multiples of the huge page size to benefit from them.
+       * - explicit_huge pages are taken from the pool of huge pages configured
+       * by the administrator, at the reservation since later failures cannot
+       * be detected. If the pool is too small, transparent huge pages are
+       * used instead. Commits and decommits must be multiples of the huge
+       * page size.
        *
-       */
-      inline void* allocate_address_space( size_t max_size_in_bytes )
+       * Huge pages are only supported on Linux. On other platforms, normal
+       * pages are always used. */
+      enum class page_kind {
+        normal,
+        transparent_huge,
+        explicit_huge
+      };
+
+      /**@brief Reserve a range of addresses.
+       *
+       * No physical memory is used until a part of the range is committed
+       * with commit_memory().
+       * @param max_size_in_bytes The size of the range.
+       * @param kind The kind of pages that will back the range.
+       * @return The start of the range, or nullptr on failure. */
+      inline void* allocate_address_space( size_t max_size_in_bytes, page_kind kind = page_kind::normal )
       {
 # ifdef _WIN32
+        (void)kind;
         return VirtualAlloc( nullptr, max_size_in_bytes, MEM_RESERVE, PAGE_NOACCESS );
 # elif __linux__
-        void* result = mmap( nullptr, max_size_in_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0 );
-        msync( result, max_size_in_bytes, MS_SYNC | MS_INVALIDATE );
-        return result;
+        const size_t huge_page_size = get_huge_page_size();
+        if( kind != page_kind::normal && !huge_page_size )
+          kind = page_kind::normal;
+
+        if( kind == page_kind::explicit_huge )
+          {
+            // the size is rounded in both cases, as free_address_space() will do
+            max_size_in_bytes = (( max_size_in_bytes + huge_page_size - 1 ) / huge_page_size ) * huge_page_size;
+            void* result = mmap( nullptr, max_size_in_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+            if( result != MAP_FAILED )
+              return result;
+            LOG( warning, "not enough huge pages to reserve " << max_size_in_bytes << " bytes, using transparent huge pages instead" );
+            kind = page_kind::transparent_huge;
+          }
+
+        if( kind == page_kind::transparent_huge && max_size_in_bytes >= huge_page_size )
+          {
+            // over-reserve, then trim the range to make it start at a huge page
+            // boundary. The size is rounded to pages, as munmap() needs an
+            // aligned start to trim the end of the range.
+            const size_t page_size = get_page_size();
+            max_size_in_bytes = (( max_size_in_bytes + page_size - 1 ) / page_size ) * page_size;
+            const size_t size = max_size_in_bytes + huge_page_size - page_size;
+            char* raw = static_cast<char*>( mmap( nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 ) );
+            if( raw == MAP_FAILED )
+              return nullptr;
+            char* result = static_cast<char*>( detail::align( raw, huge_page_size ) );
+            if( result != raw )
+              munmap( raw, result - raw );
+            if( result + max_size_in_bytes != raw + size )
+              munmap( result + max_size_in_bytes, raw + size - result - max_size_in_bytes );
+            madvise( result, max_size_in_bytes, MADV_HUGEPAGE );
+            return result;
+          }
+
+        void* result = mmap( nullptr, max_size_in_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+        return result == MAP_FAILED ? nullptr : result;
 # endif
       }
 
-      /**
+      /**@brief Allocate physical memory for a part of a reserved range.
+       *
        * Allocate physical memory and map it into the virtual address space.
        * This operation is also known as committing the memory, hence the name
-       * of the function.
-       */
-      inline void commit_memory( void* start, size_t size )
+       * of the function. On Linux, physical pages are only given at the first
+       * access to the memory.
+       * @param start The start of the part, aligned on a page.
+       * @param size The size of the part.
+       * @return True if the memory can be accessed. */
+      inline bool commit_memory( void* start, size_t size )
       {
 # ifdef _WIN32
-        VirtualAlloc( start, size, MEM_COMMIT, PAGE_READWRITE );
+        return VirtualAlloc( start, size, MEM_COMMIT, PAGE_READWRITE ) != nullptr;
 # elif __linux__
-//        mprotect( start, size, PROT_READ | PROT_READ );
-
-        mmap( start, size, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED | MAP_ANON, -1, 0 );
-        msync( start, size, MS_SYNC | MS_INVALIDATE );
-//        void * ptr = mmap(addr, size, PROT_READ|PROT_WRITE, MAP_FIXED|MAP_SHARED|MAP_ANON, -1, 0);
-//         msync(addr, size, MS_SYNC|MS_INVALIDATE);
-//         return ptr;
+        return mprotect( start, size, PROT_READ | PROT_WRITE ) == 0;
 # endif
       }
 
       /**
        * Un-map the physical memory and return it to the operating system.
+       * The range stays reserved and can be committed again. It will then be
+       * filled with zeros.
        */
       inline void decommit_memory( void* start, size_t size_in_bytes )
       {
 # ifdef _WIN32
         VirtualFree( start, size_in_bytes, MEM_DECOMMIT );
 # elif __linux__
-        mmap(start, size_in_bytes, PROT_NONE, MAP_FIXED|MAP_PRIVATE|MAP_ANON, -1, 0);
-        msync(start, size_in_bytes, MS_SYNC|MS_INVALIDATE);
+        madvise( start, size_in_bytes, MADV_DONTNEED );
+        mprotect( start, size_in_bytes, PROT_NONE );
 # endif
       }
 
-      inline void free_address_space( void* start, size_t size_in_bytes )
+      /**@brief Release a range of addresses.
+       *
+       * @param start The start of the range.
+       * @param size_in_bytes The size given to allocate_address_space().
+       * @param kind The kind of pages given to allocate_address_space(). */
+      inline void free_address_space( void* start, size_t size_in_bytes, page_kind kind = page_kind::normal )
       {
 # ifdef _WIN32
+        (void)size_in_bytes;
+        (void)kind;
         VirtualFree( start, 0, MEM_RELEASE );
 # elif __linux__
+        if( !start )
+          return;
+        // huge pages mappings must be released by multiples of the huge page size
+        const size_t huge_page_size = get_huge_page_size();
+        if( kind == page_kind::explicit_huge && huge_page_size )
+          {
+            size_in_bytes = (( size_in_bytes + huge_page_size - 1 ) / huge_page_size ) * huge_page_size;
+          }
         auto result = munmap( start, size_in_bytes );
         GO_ASSERT( result >= 0, "freeing physical memory failed" )(result,start,size_in_bytes);
+# endif
+      }
+
+      /**@brief Get the NUMA node of the processor running the calling thread.
+       *
+       * @return The index of the node, or -1 if it cannot be determined. */
+      inline int get_current_numa_node()
+      {
+# ifdef _WIN32
+        PROCESSOR_NUMBER processor;
+        GetCurrentProcessorNumberEx( &processor );
+        USHORT node = 0;
+        return GetNumaProcessorNodeEx( &processor, &node ) ? int( node ) : -1;
+# elif __linux__
+        unsigned int cpu = 0, node = 0;
+        return syscall( SYS_getcpu, &cpu, &node, nullptr ) == 0 ? int( node ) : -1;
+# endif
+      }
+
+      /**@brief Bind a range of addresses to a NUMA node.
+       *
+       * The physical pages of the range will be allocated on the memory of
+       * the specified node. Binding a range before committing it lets a
+       * worker thread keep its memory on its own socket. Pages already in
+       * use are moved to this node.
+       * @param start The start of the range, aligned on a page.
+       * @param size_in_bytes The size of the range.
+       * @param node The index of the NUMA node.
+       * @return True if the range was bound to the node. */
+      inline bool bind_to_numa_node( void* start, size_t size_in_bytes, int node )
+      {
+# ifdef _WIN32
+        (void)start;
+        (void)size_in_bytes;
+        (void)node;
+        return false;
+# elif __linux__
+        static constexpr int bind_policy = 2;    // MPOL_BIND
+        static constexpr unsigned move_flag = 2; // MPOL_MF_MOVE
+        static constexpr size_t max_nodes = 1024;
+        static constexpr size_t bits_per_word = sizeof(unsigned long) * 8;
+        if( node < 0 || size_t( node ) >= max_nodes )
+          return false;
+        unsigned long mask[ max_nodes / bits_per_word ] = {};
+        mask[ node / bits_per_word ] = 1ul << ( node % bits_per_word );
+        return syscall( SYS_mbind, start, size_in_bytes, bind_policy, mask, max_nodes + 1, move_flag ) == 0;
 # endif
       }
     }
@@ -354,6 +516,11 @@ namespace graphics_origin {
         thread_guard.enter();
           const size_t allocation_size = size_in_bytes + front_offset + bounds_checking_policy::size_back;
           char* plain_memory = static_cast<char*>( allocator->allocate( allocation_size, alignment, front_offset ));
+          if( !plain_memory )
+            {
+              thread_guard.leave();
+              return nullptr;
+            }
           char* user_memory = plain_memory + front_offset;
 
           bounds_checker.guard_front( plain_memory + allocation_policy::size_front );
@@ -384,6 +551,12 @@ namespace graphics_origin {
         thread_guard.leave();
       }
 
+      /**@brief Get the memory tracker, e.g. to query its statistics. */
+      const memory_tracking_policy& get_memory_tracker() const
+      {
+        return memory_tracker;
+      }
+
     private:
       static constexpr size_t front_offset = bounds_checking_policy::size_front + allocation_policy::size_front;
       allocation_policy* allocator;
@@ -533,6 +706,20 @@ namespace graphics_origin {
           return reinterpret_cast<uint32_t*>(allocation)[0];
         }
 
+        /**@brief Get the number of bytes used since the last reset.
+         *
+         * This includes the padding inserted to align the allocations. */
+        inline size_t get_used_memory() const
+        {
+          return size_t( current - begin );
+        }
+
+        /**@brief Get the size of the managed memory area. */
+        inline size_t get_capacity() const
+        {
+          return size_t( end - begin );
+        }
+
         /**@brief Allocate a new bunch of memory.
          *
          * Allocate a space of memory, with the specified alignment. The allocation
@@ -551,10 +738,9 @@ namespace graphics_origin {
            */
           char* aligned = (char*)detail::align( current + offset, alignment );
           char* user_ptr = aligned - offset;
-          current = user_ptr + size;
-
-          if( current > end )
+          if( user_ptr + size > end )
             return nullptr;
+          current = user_ptr + size;
 
           // write the size just before the aligned allocation
           reinterpret_cast<uint32_t*>(user_ptr)[0] = uint32_t(size);
@@ -632,10 +818,9 @@ namespace graphics_origin {
           const uint32_t allocation_offset = static_cast<uint32_t>(current - start);
           char* aligned = (char*)detail::align( current + offset, alignment );
           char* user_ptr = aligned - offset;
-          current = user_ptr + size;
-
-          if( current > end )
+          if( user_ptr + size > end )
             return nullptr;
+          current = user_ptr + size;
 
           reinterpret_cast<uint32_t*>(user_ptr)[0] = uint32_t(size);
           reinterpret_cast<uint32_t*>(user_ptr)[1] = allocation_offset;
@@ -729,10 +914,9 @@ namespace graphics_origin {
           const uint32_t allocation_offset = static_cast<uint32_t>(current - start);
           char* aligned = (char*)detail::align( current + offset, alignment );
           char* user_ptr = aligned - offset;
-          current = user_ptr + size;
-
-          if( current > end )
+          if( user_ptr + size > end )
             return nullptr;
+          current = user_ptr + size;
 
           ++id;
           reinterpret_cast<uint32_t*>(user_ptr)[0] = uint32_t(size);
@@ -770,18 +954,30 @@ namespace graphics_origin {
 
         static constexpr size_t size_front = sizeof(uint32_t) + sizeof(uint32_t);
 
-        growing_stack( uint32_t max_size_in_bytes, uint32_t grow_size_in_bytes )
-          : virtual_start( (char*)virtual_memory::allocate_address_space( max_size_in_bytes ) )
+        growing_stack( uint32_t max_size_in_bytes, uint32_t grow_size_in_bytes,
+            virtual_memory::page_kind kind = virtual_memory::page_kind::normal )
+          : virtual_start( (char*)virtual_memory::allocate_address_space( max_size_in_bytes, kind ) )
           , virtual_end( virtual_start + max_size_in_bytes )
           , physical_current( virtual_start )
           , physical_end( virtual_start )
           , max_size( max_size_in_bytes )
           , grow_size( grow_size_in_bytes )
+          , kind( kind )
         {}
 
         ~growing_stack()
         {
-          virtual_memory::free_address_space( virtual_start, max_size );
+          virtual_memory::free_address_space( virtual_start, max_size, kind );
+        }
+
+        /**@brief Allocate the physical memory of this stack on a NUMA node.
+         *
+         * This should be done before any allocation, by the thread that will
+         * use the stack, with virtual_memory::get_current_numa_node().
+         * @return True if the memory was bound to the node. */
+        bool bind_to_numa_node( int node )
+        {
+          return virtual_memory::bind_to_numa_node( virtual_start, max_size, node );
         }
 
         inline size_t get_allocation_size( void* allocation ) const
@@ -805,10 +1001,9 @@ namespace graphics_origin {
           const uint32_t allocation_offset = static_cast<uint32_t>(physical_current - virtual_start );
           char* aligned = (char*)detail::align( physical_current + offset, alignment );
           char* user_ptr = aligned - offset;
-          physical_current = user_ptr + size;
 
           // not enough physical memory left
-          if( physical_current > physical_end )
+          if( user_ptr + size > physical_end )
             {
               // check if we can still get physical pages from the remaining virtual memory
               const size_t needed_physical_size = (( size + grow_size - 1 ) / grow_size ) * grow_size;
@@ -816,9 +1011,11 @@ namespace graphics_origin {
                 return nullptr;
 
               // allocate new memory pages at the end of already allocated pages
-              virtual_memory::commit_memory( physical_end, needed_physical_size );
+              if( !virtual_memory::commit_memory( physical_end, needed_physical_size ) )
+                return nullptr;
               physical_end += needed_physical_size;
             }
+          physical_current = user_ptr + size;
 
           reinterpret_cast<uint32_t*>(user_ptr)[0] = uint32_t(size);
           reinterpret_cast<uint32_t*>(user_ptr)[1] = allocation_offset;
@@ -850,62 +1047,1383 @@ namespace graphics_origin {
         char* physical_end;
         const uint32_t max_size;
         const uint32_t grow_size;
+        const virtual_memory::page_kind kind;
       };
-    }
 
-    namespace thread_policy {
-      struct single_thread {
-        inline void enter() const {}
-        inline void leave() const {}
-      };
-    }
+      /**@brief Implements a pool allocator.
+       *
+       * A pool allocator operates on a contiguous memory of fixed size, cut
+       * into slots of the same size. Allocations and deallocations are made
+       * in constant time, in any order. This is useful for many objects of the
+       * same type, such as nodes or renderable storages.
+       *
+       * Freed slots are linked in an intrusive free list: the link is stored
+       * in front of the slot, in place of the allocation size. Thus, the user
+       * memory of a freed slot is not modified, and it can be checked by a
+       * memory tagging policy. Slots that were never allocated are not
+       * touched, so the memory area is not written at construction.
+       *
+       * The slots are laid out for a specific allocation size, alignment and
+       * offset, known at construction. For a memory_arena storing objects of
+       * type T, with a bounds checking policy B, they can be computed with:
+       * \code{.cpp}
+       * tools::allocation_policy::pool allocator( area,
+       *   tools::allocation_policy::pool::get_slot_size< B >( sizeof(T) ),
+       *   alignof(T),
+       *   tools::allocation_policy::pool::get_user_offset< B >() );
+       * \endcode
+       *
+       * \sa growing_pool
+       */
+      class pool {
+      public:
+        /**@brief Amount of bytes used in front of the allocation to store information.
+         *
+         * In front of each allocation, we store the size of the allocation,
+         * or the next free slot when the slot is free.
+         */
+        static constexpr size_t size_front = sizeof(void*);
 
-    namespace bounds_checking_policy {
-      struct no {
-        static constexpr size_t size_front = size_t{0};
-        static constexpr size_t size_back = size_t{0};
-        inline void guard_front( void* ) const {}
-        inline void guard_back( void* ) const {}
-        inline void check_front( const void* ) const {}
-        inline void check_back( const void* ) const {}
-      };
+        /**@brief Get the size of the slots for a memory arena.
+         *
+         * @param object_size The size of the objects given to the user.
+         * @return The size requested to a pool by a memory_arena with the
+         * bounds checking policy specified as the template parameter. */
+        template< class bounds_checking_policy >
+        static constexpr size_t get_slot_size( size_t object_size )
+        {
+          return object_size + get_user_offset< bounds_checking_policy >() + bounds_checking_policy::size_back;
+        }
 
-      struct per_allocation {
-        static constexpr uint32_t front_word = uint32_t{0xFEEDFACE};
-        static constexpr uint32_t back_word = uint32_t{0x1BADC0DE};
-        static constexpr size_t size_front = sizeof(front_word);
-        static constexpr size_t size_back = sizeof(back_word);
-        inline void guard_front( void* ptr ) const
+        /**@brief Get the offset of the user memory in an allocation made by a
+         * memory arena.
+         *
+         * @return The offset of the user memory for a memory_arena with the
+         * bounds checking policy specified as the template parameter. */
+        template< class bounds_checking_policy >
+        static constexpr size_t get_user_offset()
         {
-          *(static_cast<uint32_t*>(ptr)) = front_word;
+          return bounds_checking_policy::size_front + size_front;
         }
-        inline void guard_back( void* ptr ) const
+
+        /**@brief Construct a new pool allocator.
+         *
+         * Instantiate a new pool allocator on an area of contiguous memory.
+         * This is not the responsibility of this allocator to free this area.
+         * @param area A memory area (such as tools::memory_area::on_heap)
+         * @param allocation_size The maximum size of an allocation, including
+         * the data stored in front of it.
+         * @param alignment The alignment of the user memory.
+         * @param offset The offset of the user memory in an allocation. */
+        template< class memory_area >
+        pool( memory_area& area, size_t allocation_size, size_t alignment, size_t offset ) :
+          stride{ compute_stride( allocation_size, alignment ) },
+          allocation_size{ allocation_size }, alignment{ alignment }, offset{ offset },
+          free_list{ nullptr },
+          current{ (char*)detail::align( reinterpret_cast<char*>(area.begin()) + offset, alignment ) - offset },
+          end{ reinterpret_cast<char*>(area.end()) }
+        {}
+
+        inline size_t get_allocation_size( void* allocation ) const
         {
-          *(static_cast<uint32_t*>(ptr)) = back_word;
+          return reinterpret_cast<uint32_t*>(allocation)[0];
         }
-        inline void check_front( const void* ptr ) const
+
+        void* allocate( size_t size, size_t alignment, size_t offset )
         {
-          uint32_t word = *reinterpret_cast<const uint32_t*>( ptr );
           GO_ASSERT(
-            word == front_word,
-            "front guard had been overwritten (is not 0xFEEDFACE)")
-            (word);
+            size <= allocation_size && alignment <= this->alignment,
+            "the allocation does not fit in a slot of the pool")
+            (size,alignment,allocation_size);
+          GO_ASSERT(
+            offset == this->offset,
+            "the slots of the pool are aligned for another offset")
+            (offset,this->offset);
+
+          char* slot = free_list;
+          if( slot )
+            free_list = get_next( slot );
+          else if( current + stride <= end )
+            {
+              slot = current;
+              current += stride;
+            }
+          else return nullptr;
+
+          reinterpret_cast<uint32_t*>(slot)[0] = uint32_t(size);
+          return reinterpret_cast<void*>(slot);
         }
-        inline void check_back( const void* ptr ) const
+
+        void deallocate( void* allocation )
+        {
+          set_next( static_cast<char*>(allocation), free_list );
+          free_list = static_cast<char*>(allocation);
+        }
+
+        /**@brief Get the distance in bytes between two slots. */
+        size_t get_stride() const
+        {
+          return stride;
+        }
+
+      private:
+        friend class growing_pool;
+
+        static inline size_t compute_stride( size_t allocation_size, size_t alignment )
+        {
+          const size_t slot_size = allocation_size > size_front ? allocation_size : size_front;
+          return ( ( slot_size + alignment - 1 ) / alignment ) * alignment;
+        }
+
+        static inline char* get_next( char* slot )
+        {
+          char* next;
+          std::memcpy( &next, slot, sizeof(next) );
+          return next;
+        }
+
+        static inline void set_next( char* slot, char* next )
+        {
+          std::memcpy( slot, &next, sizeof(next) );
+        }
+
+        const size_t stride;
+        const size_t allocation_size;
+        const size_t alignment;
+        const size_t offset;
+        char* free_list;
+        char* current;
+        char* end;
+      };
+
+      /**@brief Implements a pool allocator that grows on demand.
+       *
+       * This allocator works as the pool allocator, but on a reserved address
+       * space, i.e. a virtual memory range not backed by physical memory.
+       * Physical pages are committed when the pool runs out of slots, so that
+       * the pool can have a large capacity while using only the memory it
+       * needs. The slots never move.
+       *
+       * \sa pool, growing_stack
+       */
+      class growing_pool {
+      public:
+        static constexpr size_t size_front = pool::size_front;
+
+        /**@brief Construct a new growing pool allocator.
+         *
+         * @param max_size_in_bytes The size of the reserved address space.
+         * @param grow_size_in_bytes The amount of memory committed at once,
+         * which should be a multiple of the page size.
+         * @param allocation_size The maximum size of an allocation, including
+         * the data stored in front of it.
+         * @param alignment The alignment of the user memory.
+         * @param offset The offset of the user memory in an allocation.
+         * @param kind The kind of pages used for the slots. */
+        growing_pool(
+            size_t max_size_in_bytes, size_t grow_size_in_bytes,
+            size_t allocation_size, size_t alignment, size_t offset,
+            virtual_memory::page_kind kind = virtual_memory::page_kind::normal )
+          : virtual_start( (char*)virtual_memory::allocate_address_space( max_size_in_bytes, kind ) )
+          , virtual_end( virtual_start + max_size_in_bytes )
+          , physical_end( virtual_start )
+          , current( (char*)detail::align( virtual_start + offset, alignment ) - offset )
+          , free_list( nullptr )
+          , stride( pool::compute_stride( allocation_size, alignment ) )
+          , allocation_size( allocation_size )
+          , alignment( alignment )
+          , offset( offset )
+          , max_size( max_size_in_bytes )
+          , grow_size( grow_size_in_bytes )
+          , kind( kind )
+        {}
+
+        ~growing_pool()
+        {
+          virtual_memory::free_address_space( virtual_start, max_size, kind );
+        }
+
+        growing_pool( const growing_pool& ) = delete;
+        growing_pool& operator=( const growing_pool& ) = delete;
+
+        inline size_t get_allocation_size( void* allocation ) const
+        {
+          return reinterpret_cast<uint32_t*>(allocation)[0];
+        }
+
+        void* allocate( size_t size, size_t alignment, size_t offset )
         {
-          uint32_t word = *reinterpret_cast<const uint32_t*>( ptr );
           GO_ASSERT(
-            word == back_word,
-            "back guard had been overwritten (is not 0x1BADC0DE)")
-            (word);
+            size <= allocation_size && alignment <= this->alignment,
+            "the allocation does not fit in a slot of the pool")
+            (size,alignment,allocation_size);
+          GO_ASSERT(
+            offset == this->offset,
+            "the slots of the pool are aligned for another offset")
+            (offset,this->offset);
+
+          char* slot = free_list;
+          if( slot )
+            free_list = pool::get_next( slot );
+          else
+            {
+              // not enough physical memory left
+              if( current + stride > physical_end )
+                {
+                  const size_t needed = current + stride - physical_end;
+                  const size_t needed_physical_size = (( needed + grow_size - 1 ) / grow_size ) * grow_size;
+                  if( physical_end + needed_physical_size > virtual_end
+                      || !virtual_memory::commit_memory( physical_end, needed_physical_size ) )
+                    return nullptr;
+                  physical_end += needed_physical_size;
+                }
+              slot = current;
+              current += stride;
+            }
+
+          reinterpret_cast<uint32_t*>(slot)[0] = uint32_t(size);
+          return reinterpret_cast<void*>(slot);
+        }
+
+        void deallocate( void* allocation )
+        {
+          pool::set_next( static_cast<char*>(allocation), free_list );
+          free_list = static_cast<char*>(allocation);
+        }
+
+        size_t get_committed_memory() const
+        {
+          return physical_end - virtual_start;
+        }
+
+        size_t get_stride() const
+        {
+          return stride;
+        }
+
+        /**@brief Allocate the physical memory of this pool on a NUMA node.
+         *
+         * \sa growing_stack::bind_to_numa_node() */
+        bool bind_to_numa_node( int node )
+        {
+          return virtual_memory::bind_to_numa_node( virtual_start, max_size, node );
         }
+
+      private:
+        char* virtual_start;
+        char* virtual_end;
+        char* physical_end;
+        char* current;
+        char* free_list;
+        const size_t stride;
+        const size_t allocation_size;
+        const size_t alignment;
+        const size_t offset;
+        const size_t max_size;
+        const size_t grow_size;
+        const virtual_memory::page_kind kind;
       };
-    }
 
-    namespace memory_tracking_policy {
-      struct no {
-        inline void track( void*, size_t, size_t, const char*, const char*, const char*) const {}
-        inline void untrack( void* ) const {}
+      /**@brief Implements a Two-Level Segregated Fit allocator.
+       *
+       * A TLSF allocator operates on a contiguous memory, for allocations of
+       * any size freed in any order, in bounded constant time. This is the
+       * allocator to use instead of new/malloc when latency spikes are not
+       * acceptable, e.g. for mesh attribute buffers or staging uploads in the
+       * render thread. The design is the one of M. Masmano et al. "TLSF: a New
+       * Dynamic Memory Allocator for Real-Time Systems", with the block layout
+       * of the implementation of M. Conte.
+       *
+       * Free blocks are stored in segregated lists: a first level splits the
+       * sizes in powers of two, and a second level splits each power of two
+       * in 32 linear ranges. Two levels of bitmaps give in constant time a
+       * non empty list whose blocks are all large enough for an allocation.
+       * A block is split at allocation, and merged immediately with its free
+       * physical neighbors at deallocation, which limits the fragmentation.
+       *
+       * Every block has a header of one word, plus the data stored by this
+       * allocator in front of the allocation (size_front). An allocation with
+       * an alignment larger than 8 bytes may waste up to alignment - 1 bytes.
+       *
+       * \sa growing_tlsf
+       */
+      class tlsf {
+      public:
+        /**@brief Amount of bytes used in front of the allocation to store information.
+         *
+         * In front of each allocation, we store 2 values on 4 bytes: the size of
+         * the allocation and its distance to the beginning of the block.
+         */
+        static constexpr size_t size_front = sizeof(uint32_t) + sizeof(uint32_t);
+
+        /**@brief Construct a new TLSF allocator.
+         *
+         * Instantiate a new TLSF allocator on an area of contiguous memory.
+         * This is not the responsibility of this allocator to free this area.
+         * @param area A memory area (such as tools::memory_area::on_heap) */
+        template< class memory_area >
+        tlsf( memory_area& area )
+        {
+          initialize();
+          char* begin = (char*)detail::align( area.begin(), block_alignment );
+          add_memory( begin, size_t( reinterpret_cast<char*>(area.end()) - begin ) );
+        }
+
+        tlsf( const tlsf& ) = delete;
+        tlsf& operator=( const tlsf& ) = delete;
+
+        inline size_t get_allocation_size( void* allocation ) const
+        {
+          return reinterpret_cast<uint32_t*>(allocation)[0];
+        }
+
+        void* allocate( size_t size, size_t alignment, size_t offset )
+        {
+          // the user memory is aligned inside the block, after a gap of at most
+          // alignment - 1 bytes, which is empty when the payload alignment is enough
+          const bool aligned_payload = alignment <= block_alignment && !( offset % alignment );
+          const size_t request = get_block_size( size + ( aligned_payload ? 0 : alignment - 1 ) );
+          if( !request )
+            return nullptr;
+
+          block_header* block = find_free_block( request );
+          if( !block )
+            return nullptr;
+          if( get_size( block ) >= sizeof(block_header) + request )
+            split( block, request );
+          mark_as_used( block );
+
+          char* payload = get_payload( block );
+          char* user_ptr = (char*)detail::align( payload + offset, alignment ) - offset;
+          reinterpret_cast<uint32_t*>(user_ptr)[0] = uint32_t(size);
+          reinterpret_cast<uint32_t*>(user_ptr)[1] = uint32_t(user_ptr - payload);
+          return reinterpret_cast<void*>(user_ptr);
+        }
+
+        void deallocate( void* allocation )
+        {
+          char* payload = static_cast<char*>(allocation) - reinterpret_cast<uint32_t*>(allocation)[1];
+          release( get_block( payload ) );
+        }
+
+        /**@brief Get the memory managed by this allocator, in bytes. */
+        size_t get_managed_memory() const
+        {
+          return managed_memory;
+        }
+
+        /**@brief Get the memory available in free blocks, in bytes. */
+        size_t get_free_memory() const
+        {
+          return free_memory;
+        }
+
+        /**@brief Get the number of free blocks. */
+        size_t get_number_of_free_blocks() const
+        {
+          return number_of_free_blocks;
+        }
+
+        /**@brief Get the size of the largest free block, in bytes.
+         *
+         * This is the size of the largest allocation that can succeed. The
+         * free blocks of the largest non empty list are visited. */
+        size_t get_largest_free_block() const
+        {
+          if( !first_level_bitmap )
+            return 0;
+          const uint32_t fl = find_last_set( first_level_bitmap );
+          const uint32_t sl = find_last_set( second_level_bitmaps[ fl ] );
+          size_t result = 0;
+          for( block_header* block = free_lists[ fl ][ sl ]; block; block = block->next_free )
+            result = std::max( result, get_size( block ) );
+          return result;
+        }
+
+        /**@brief Get the fragmentation of the free memory.
+         *
+         * The fragmentation is 1 - largest free block / free memory: it is 0
+         * when all the free memory can be used by a single allocation, and
+         * tends to 1 when the free memory is split into many small blocks. */
+        double get_fragmentation() const
+        {
+          return free_memory ? 1.0 - double( get_largest_free_block() ) / double( free_memory ) : 0.0;
+        }
+
+      protected:
+        /**Alignment of the blocks and of their sizes. */
+        static constexpr size_t block_alignment = 8;
+        /**Logarithm of the number of second level lists. */
+        static constexpr uint32_t second_level_log2 = 5;
+        static constexpr uint32_t second_level_count = 1u << second_level_log2;
+        /**Blocks smaller than this size are all in the first first level list,
+         * and are linearly distributed in its second level lists. */
+        static constexpr uint32_t first_level_shift = second_level_log2 + 3;
+        static constexpr size_t small_block_size = size_t(1) << first_level_shift;
+        /**Blocks are smaller than 2^first_level_max bytes. */
+        static constexpr uint32_t first_level_max = 32;
+        static constexpr uint32_t first_level_count = first_level_max - first_level_shift + 1;
+
+        /**Header of a block. The previous physical block is stored in the last
+         * word of the previous block, and is only valid when this one is
+         * free. The lists links are only valid when the block is free, and are
+         * located in the memory handed to the user otherwise. */
+        struct block_header {
+          block_header* previous_physical;
+          size_t size;
+          block_header* next_free;
+          block_header* previous_free;
+        };
+        static constexpr size_t free_bit = 1;
+        static constexpr size_t previous_free_bit = 2;
+        /**Memory used by a used block in addition to its payload. */
+        static constexpr size_t block_overhead = sizeof(size_t);
+        /**Offset of the payload from the beginning of a block header. */
+        static constexpr size_t payload_offset = sizeof(block_header*) + sizeof(size_t);
+        static constexpr size_t min_block_size = sizeof(block_header) - sizeof(block_header*);
+        static constexpr size_t max_block_size = size_t(1) << ( first_level_max - 1 );
+
+        tlsf()
+        {
+          initialize();
+        }
+
+        void initialize()
+        {
+          first_level_bitmap = 0;
+          for( uint32_t i = 0; i < first_level_count; ++ i )
+            {
+              second_level_bitmaps[ i ] = 0;
+              for( uint32_t j = 0; j < second_level_count; ++ j )
+                free_lists[ i ][ j ] = nullptr;
+            }
+          managed_memory = 0;
+          free_memory = 0;
+          number_of_free_blocks = 0;
+        }
+
+        /**Manage a new memory region, which must be 8-bytes aligned. The last
+         * 2 words are used for a sentinel block, that stops the merges. */
+        void add_memory( char* begin, size_t size_in_bytes )
+        {
+          GO_ASSERT(
+            size_in_bytes >= 2 * block_overhead + min_block_size && size_in_bytes - 2 * block_overhead < max_block_size,
+            "the memory area size is not supported by the TLSF allocator")
+            (size_in_bytes);
+          const size_t size = ( ( size_in_bytes - 2 * block_overhead ) / block_alignment ) * block_alignment;
+
+          // the previous physical block field is outside of the region, but it is never read
+          block_header* block = reinterpret_cast<block_header*>( begin - block_overhead );
+          block->size = size;
+          block->size |= free_bit;
+          insert( block );
+
+          block_header* sentinel = link_next( block );
+          sentinel->size = previous_free_bit;
+          managed_memory += size;
+        }
+
+        /**Extend the memory region ending by the sentinel block located at
+         * end - 2 * block_overhead with size_in_bytes contiguous bytes. */
+        void extend_memory( char* end, size_t size_in_bytes )
+        {
+          block_header* block = reinterpret_cast<block_header*>( end - 2 * block_overhead );
+          block->size = ( size_in_bytes - block_overhead ) | ( block->size & previous_free_bit );
+          block_header* sentinel = get_next( block );
+          sentinel->size = 0;
+          managed_memory += size_in_bytes;
+          release( block );
+        }
+
+        static inline uint32_t find_first_set( uint32_t word )
+        {
+# ifdef _MSC_VER
+          unsigned long index;
+          _BitScanForward( &index, word );
+          return uint32_t( index );
+# else
+          return uint32_t( __builtin_ctz( word ) );
+# endif
+        }
+
+        static inline uint32_t find_last_set( size_t word )
+        {
+# ifdef _MSC_VER
+          unsigned long index;
+          _BitScanReverse64( &index, word );
+          return uint32_t( index );
+# else
+          return uint32_t( sizeof(unsigned long long) * 8 - 1 - __builtin_clzll( word ) );
+# endif
+        }
+
+        /**Compute the block size for a requested size, or 0 if this size
+         * cannot be allocated. */
+        static inline size_t get_block_size( size_t size )
+        {
+          const size_t aligned = ( ( size + block_alignment - 1 ) / block_alignment ) * block_alignment;
+          if( aligned >= max_block_size )
+            return 0;
+          return aligned > min_block_size ? aligned : min_block_size;
+        }
+
+        static inline void mapping( size_t size, uint32_t& fl, uint32_t& sl )
+        {
+          if( size < small_block_size )
+            {
+              fl = 0;
+              sl = uint32_t( size / ( small_block_size / second_level_count ) );
+            }
+          else
+            {
+              const uint32_t last = find_last_set( size );
+              sl = uint32_t( size >> ( last - second_level_log2 ) ) ^ second_level_count;
+              fl = last - ( first_level_shift - 1 );
+            }
+        }
+
+        static inline size_t get_size( const block_header* block )
+        {
+          return block->size & ~( free_bit | previous_free_bit );
+        }
+
+        static inline char* get_payload( block_header* block )
+        {
+          return reinterpret_cast<char*>(block) + payload_offset;
+        }
+
+        static inline block_header* get_block( char* payload )
+        {
+          return reinterpret_cast<block_header*>( payload - payload_offset );
+        }
+
+        static inline block_header* get_next( block_header* block )
+        {
+          return reinterpret_cast<block_header*>( get_payload( block ) + get_size( block ) - block_overhead );
+        }
+
+        static inline block_header* link_next( block_header* block )
+        {
+          block_header* next = get_next( block );
+          next->previous_physical = block;
+          return next;
+        }
+
+        /**Find a free block of at least the requested size, and remove it from
+         * its list. Sizes are rounded up to the next list, so that any block
+         * of the list found is large enough. */
+        block_header* find_free_block( size_t size )
+        {
+          if( size >= small_block_size )
+            size += ( size_t(1) << ( find_last_set( size ) - second_level_log2 ) ) - 1;
+          uint32_t fl, sl;
+          mapping( size, fl, sl );
+          if( fl >= first_level_count )
+            return nullptr;
+
+          uint32_t second_level_map = second_level_bitmaps[ fl ] & ( ~0u << sl );
+          if( !second_level_map )
+            {
+              const uint32_t first_level_map = fl + 1 < 32 ? first_level_bitmap & ( ~0u << ( fl + 1 ) ) : 0;
+              if( !first_level_map )
+                return nullptr;
+              fl = find_first_set( first_level_map );
+              second_level_map = second_level_bitmaps[ fl ];
+            }
+          sl = find_first_set( second_level_map );
+          block_header* block = free_lists[ fl ][ sl ];
+          remove( block, fl, sl );
+          return block;
+        }
+
+        void insert( block_header* block )
+        {
+          uint32_t fl, sl;
+          mapping( get_size( block ), fl, sl );
+          block_header* head = free_lists[ fl ][ sl ];
+          block->next_free = head;
+          block->previous_free = nullptr;
+          if( head )
+            head->previous_free = block;
+          free_lists[ fl ][ sl ] = block;
+          first_level_bitmap |= 1u << fl;
+          second_level_bitmaps[ fl ] |= 1u << sl;
+          free_memory += get_size( block );
+          ++ number_of_free_blocks;
+        }
+
+        void remove( block_header* block, uint32_t fl, uint32_t sl )
+        {
+          block_header* previous = block->previous_free;
+          block_header* next = block->next_free;
+          if( next )
+            next->previous_free = previous;
+          if( previous )
+            previous->next_free = next;
+          else
+            {
+              free_lists[ fl ][ sl ] = next;
+              if( !next )
+                {
+                  second_level_bitmaps[ fl ] &= ~( 1u << sl );
+                  if( !second_level_bitmaps[ fl ] )
+                    first_level_bitmap &= ~( 1u << fl );
+                }
+            }
+          free_memory -= get_size( block );
+          -- number_of_free_blocks;
+        }
+
+        void remove( block_header* block )
+        {
+          uint32_t fl, sl;
+          mapping( get_size( block ), fl, sl );
+          remove( block, fl, sl );
+        }
+
+        /**Split a free block, not in a list, to the requested size. The
+         * remaining part is inserted in the lists. */
+        void split( block_header* block, size_t size )
+        {
+          block_header* remaining = reinterpret_cast<block_header*>( get_payload( block ) + size - block_overhead );
+          remaining->size = ( get_size( block ) - size - block_overhead ) | free_bit;
+          block->size = size | ( block->size & ( free_bit | previous_free_bit ) );
+          link_next( block );
+          link_next( remaining )->size |= previous_free_bit;
+          insert( remaining );
+        }
+
+        void mark_as_used( block_header* block )
+        {
+          get_next( block )->size &= ~previous_free_bit;
+          block->size &= ~free_bit;
+        }
+
+        /**Free a used block, merge it with its free physical neighbors and
+         * insert the result in the lists. */
+        void release( block_header* block )
+        {
+          if( block->size & previous_free_bit )
+            {
+              block_header* previous = block->previous_physical;
+              remove( previous );
+              previous->size += get_size( block ) + block_overhead;
+              block = previous;
+            }
+          block_header* next = get_next( block );
+          if( next->size & free_bit )
+            {
+              remove( next );
+              block->size += get_size( next ) + block_overhead;
+            }
+          block->size |= free_bit;
+          link_next( block )->size |= previous_free_bit;
+          insert( block );
+        }
+
+        uint32_t first_level_bitmap;
+        uint32_t second_level_bitmaps[ first_level_count ];
+        block_header* free_lists[ first_level_count ][ second_level_count ];
+        size_t managed_memory;
+        size_t free_memory;
+        size_t number_of_free_blocks;
+      };
+
+      /**@brief Implements a TLSF allocator that grows on demand.
+       *
+       * This allocator works as the tlsf allocator, but on a reserved address
+       * space, as the growing_stack allocator. Physical pages are committed at
+       * the end of the managed memory when no free block is large enough, and
+       * merged with the last block if it is free. Allocations never move.
+       *
+       * \sa tlsf, growing_stack
+       */
+      class growing_tlsf
+        : public tlsf {
+      public:
+        /**@brief Construct a new growing TLSF allocator.
+         *
+         * @param max_size_in_bytes The size of the reserved address space.
+         * @param grow_size_in_bytes The amount of memory committed at once,
+         * which should be a multiple of the page size.
+         * @param kind The kind of pages used for the managed memory. */
+        growing_tlsf( size_t max_size_in_bytes, size_t grow_size_in_bytes,
+            virtual_memory::page_kind kind = virtual_memory::page_kind::normal )
+          : virtual_start( (char*)virtual_memory::allocate_address_space( max_size_in_bytes, kind ) )
+          , virtual_end( virtual_start + max_size_in_bytes )
+          , physical_end( virtual_start )
+          , max_size( max_size_in_bytes )
+          , grow_size( grow_size_in_bytes )
+          , kind( kind )
+        {}
+
+        ~growing_tlsf()
+        {
+          virtual_memory::free_address_space( virtual_start, max_size, kind );
+        }
+
+        void* allocate( size_t size, size_t alignment, size_t offset )
+        {
+          void* result = tlsf::allocate( size, alignment, offset );
+          if( !result )
+            {
+              // enough room for the block rounded up to the next list, its header and a sentinel
+              const size_t needed = size + alignment + ( size >> second_level_log2 ) + sizeof(block_header) + 2 * block_overhead;
+              const size_t needed_physical_size = (( needed + grow_size - 1 ) / grow_size ) * grow_size;
+              if( physical_end + needed_physical_size > virtual_end
+                  || !virtual_memory::commit_memory( physical_end, needed_physical_size ) )
+                return nullptr;
+
+              if( physical_end == virtual_start )
+                add_memory( physical_end, needed_physical_size );
+              else
+                extend_memory( physical_end, needed_physical_size );
+              physical_end += needed_physical_size;
+              result = tlsf::allocate( size, alignment, offset );
+            }
+          return result;
+        }
+
+        size_t get_committed_memory() const
+        {
+          return physical_end - virtual_start;
+        }
+
+        /**@brief Allocate the physical memory of this allocator on a NUMA node.
+         *
+         * \sa growing_stack::bind_to_numa_node() */
+        bool bind_to_numa_node( int node )
+        {
+          return virtual_memory::bind_to_numa_node( virtual_start, max_size, node );
+        }
+
+      private:
+        char* virtual_start;
+        char* virtual_end;
+        char* physical_end;
+        const size_t max_size;
+        const size_t grow_size;
+        const virtual_memory::page_kind kind;
+      };
+    }
+
+    namespace detail {
+      /**@brief Hint the processor that we are in a spin-wait loop.
+       *
+       * This reduces the power consumption and the penalty of leaving the
+       * loop, and lets the other hardware thread of the core progress. */
+      inline void cpu_relax()
+      {
+# if defined( _WIN32 )
+        YieldProcessor();
+# elif defined( __i386__ ) || defined( __x86_64__ )
+        __builtin_ia32_pause();
+# elif defined( __aarch64__ ) || defined( __arm__ )
+        asm volatile( "yield" ::: "memory" );
+# endif
+      }
+
+      /**@brief Indices of the running threads.
+       *
+       * Gives to a thread the smallest index that is not used by another
+       * running thread. The index is released when the thread terminates, so
+       * that the indices stay bounded by the number of concurrent threads. */
+      class thread_indices {
+      public:
+        static thread_indices& get()
+        {
+          static thread_indices instance;
+          return instance;
+        }
+
+        uint32_t acquire()
+        {
+          std::lock_guard< std::mutex > lock( m_mutex );
+          if( m_released.empty() )
+            return m_next++;
+          std::pop_heap( m_released.begin(), m_released.end(), std::greater< uint32_t >() );
+          const uint32_t index = m_released.back();
+          m_released.pop_back();
+          return index;
+        }
+
+        void release( uint32_t index )
+        {
+          std::lock_guard< std::mutex > lock( m_mutex );
+          m_released.push_back( index );
+          std::push_heap( m_released.begin(), m_released.end(), std::greater< uint32_t >() );
+        }
+
+      private:
+        thread_indices()
+          : m_next{ 0 }
+        {}
+
+        std::mutex m_mutex;
+        std::vector< uint32_t > m_released;
+        uint32_t m_next;
+      };
+
+      /**@brief Hold the index of a thread until it terminates. */
+      struct thread_index_holder {
+        thread_index_holder()
+          : index{ thread_indices::get().acquire() }
+        {}
+        ~thread_index_holder()
+        {
+          thread_indices::get().release( index );
+        }
+        const uint32_t index;
+      };
+
+      /**@brief Get the index of the calling thread.
+       *
+       * Running threads have distinct indices, starting from 0. The index of a
+       * terminated thread is given to the next thread calling this function
+       * for the first time, the smallest released index first. Thus, a pool
+       * of n threads, such as the OpenMP one, uses the indices 0 to n-1 even
+       * after other threads have been created and terminated. */
+      inline uint32_t get_thread_index()
+      {
+        thread_local const thread_index_holder holder;
+        return holder.index;
+      }
+    }
+
+    namespace thread_policy {
+      /**@brief No synchronization.
+       *
+       * The memory arena must be used by one thread at a time. */
+      struct single_thread {
+        inline void enter() const {}
+        inline void leave() const {}
+      };
+
+      /**@brief Synchronization with a mutex.
+       *
+       * A thread waiting for the critical section is put to sleep by the
+       * operating system. This is the right choice when critical sections are
+       * long, e.g. when the allocator commits memory, or when there are more
+       * threads than cores. */
+      class mutex {
+      public:
+        inline void enter()
+        {
+          m.lock();
+        }
+        inline void leave()
+        {
+          m.unlock();
+        }
+      private:
+        std::mutex m;
+      };
+
+      /**@brief Synchronization with a spinlock.
+       *
+       * A thread waiting for the critical section spins on a flag, with a
+       * test-and-test-and-set loop: the flag is only written when it was seen
+       * free, so waiting threads read their cached copy of the flag instead of
+       * invalidating it for all cores. After a failed attempt, a thread waits
+       * during an exponentially growing number of pauses, then yields its time
+       * slice once the maximum backoff is reached. This is the right choice for
+       * short critical sections, as the ones of the allocation policies with
+       * memory already committed. */
+      class spinlock {
+      public:
+        spinlock()
+          : locked{ false }
+        {}
+
+        inline void enter()
+        {
+          uint32_t backoff = 1;
+          while( locked.exchange( true, std::memory_order_acquire ) )
+            {
+              do
+                {
+                  for( uint32_t i = 0; i < backoff; ++ i )
+                    detail::cpu_relax();
+                  if( backoff < max_backoff )
+                    backoff <<= 1;
+                  else
+                    std::this_thread::yield();
+                }
+              while( locked.load( std::memory_order_relaxed ) );
+            }
+        }
+
+        inline void leave()
+        {
+          locked.store( false, std::memory_order_release );
+        }
+      private:
+        /**Maximum number of pauses between two attempts to get the lock. */
+        static constexpr uint32_t max_backoff = 1024;
+        std::atomic< bool > locked;
+      };
+    }
+
+    namespace allocation_policy {
+      /**@brief Per-thread caches in front of a thread safe memory arena.
+       *
+       * This allocation policy gives each thread its own linear sub-arena. A
+       * sub-arena is a list of chunks, obtained from a parent memory arena,
+       * which must be thread safe (see thread_policy::mutex and
+       * thread_policy::spinlock). A thread allocates in its current chunk
+       * without any synchronization, and only locks the parent when this chunk
+       * is exhausted, to refill its sub-arena with a new chunk. Thus, this
+       * policy can be used in a memory_arena with the thread_policy
+       * single_thread, even inside OpenMP parallel loops.
+       *
+       * As with the linear allocator, individual allocations cannot be freed.
+       * Instead, reset() makes all the chunks of all the threads available
+       * again, without returning them to the parent. It must be called when no
+       * thread is allocating, e.g. between two parallel loops. Chunks are given
+       * back to the parent in the destructor, in no particular order: the
+       * parent allocation policy must accept this, as the linear one does.
+       *
+       * A thread is associated to a sub-arena by its index, given by
+       * detail::get_thread_index(). Indices of terminated threads are reused,
+       * so a sub-arena outlives its thread and serves the next one. Threads
+       * whose index is larger than the number of sub-arenas, i.e. when more
+       * threads run at the same time than expected, share an additional
+       * sub-arena, protected by a lock of type thread_policy. They are served
+       * correctly, but slower.
+       * \code{.cpp}
+       * tools::memory_area::on_heap area( 64 << 20 );
+       * tools::allocation_policy::linear linear( area );
+       * typedef tools::memory_arena< tools::allocation_policy::linear,
+       *   tools::thread_policy::spinlock, ... > parent_arena;
+       * parent_arena parent( &linear );
+       * tools::allocation_policy::thread_cache< parent_arena > cache( parent, 1 << 16 );
+       * tools::memory_arena< tools::allocation_policy::thread_cache< parent_arena >,
+       *   tools::thread_policy::single_thread, ... > arena( &cache );
+       * # pragma omp parallel for
+       * for( int i = 0; i < n; ++ i )
+       *   {
+       *     float* temp = go_new_array( float[16], arena );
+       *     ...
+       *   }
+       * cache.reset();
+       * \endcode
+       */
+      template<
+        class parent_arena,
+        class thread_policy = thread_policy::spinlock >
+      class thread_cache {
+      public:
+        /**@brief Amount of bytes used in front of the allocation to store information.
+         *
+         * As for the linear allocator, we store the size of the allocation on 4 bytes.
+         */
+        static constexpr size_t size_front = sizeof(uint32_t);
+
+        /**@brief Construct a new set of per-thread caches.
+         *
+         * @param parent The thread safe arena from which chunks are obtained.
+         * @param chunk_size_in_bytes The size of the chunks. An allocation
+         * larger than a chunk gets its own chunk.
+         * @param number_of_threads The number of sub-arenas. By default, there
+         * is one sub-arena per hardware thread. */
+        thread_cache(
+            parent_arena& parent,
+            size_t chunk_size_in_bytes,
+            size_t number_of_threads = std::max( std::thread::hardware_concurrency(), 1u ) )
+          : parent{ parent }, chunk_size{ chunk_size_in_bytes },
+            slots( number_of_threads + 1 )
+        {}
+
+        ~thread_cache()
+        {
+          for( auto& s : slots )
+            for( auto chunk : s.chunks )
+              parent.deallocate( chunk.begin );
+        }
+
+        thread_cache( const thread_cache& ) = delete;
+        thread_cache& operator=( const thread_cache& ) = delete;
+
+        /**@brief Does nothing.
+         *
+         * Individual allocations cannot be freed. Call reset() instead. */
+        inline void deallocate( void* ) const {}
+
+        /**@brief Reset all the sub-arenas.
+         *
+         * After this call, all the chunks can be reused by their thread. No
+         * thread must be allocating during this call. */
+        void reset()
+        {
+          for( auto& s : slots )
+            s.rewind();
+        }
+
+        inline size_t get_allocation_size( void* allocation ) const
+        {
+          return reinterpret_cast<uint32_t*>(allocation)[0];
+        }
+
+        void* allocate( size_t size, size_t alignment, size_t offset )
+        {
+          const size_t index = detail::get_thread_index();
+          if( index + 1 < slots.size() )
+            return allocate( slots[ index ], size, alignment, offset );
+
+          shared_guard.enter();
+            void* result = allocate( slots.back(), size, alignment, offset );
+          shared_guard.leave();
+          return result;
+        }
+
+        /**@brief Get the number of chunks obtained from the parent.
+         *
+         * This number is also the number of times the parent was locked. */
+        size_t get_number_of_chunks() const
+        {
+          size_t result = 0;
+          for( auto& s : slots )
+            result += s.chunks.size();
+          return result;
+        }
+
+      private:
+        /**Alignment of the chunks, to avoid false sharing between threads. */
+        static constexpr size_t cache_line_size = 64;
+
+        struct chunk {
+          char* begin;
+          char* end;
+        };
+
+        struct slot {
+          slot()
+            : current{ nullptr }, end{ nullptr }, active{ 0 }
+          {}
+
+          void rewind()
+          {
+            active = 0;
+            current = chunks.empty() ? nullptr : chunks.front().begin;
+            end = chunks.empty() ? nullptr : chunks.front().end;
+          }
+
+          char* current;
+          char* end;
+          size_t active;
+          std::vector< chunk > chunks;
+          // keep the hot members of two slots on different cache lines
+          char padding[ cache_line_size ];
+        };
+
+        static inline char* get_user_pointer( const slot& s, size_t alignment, size_t offset )
+        {
+          return (char*)detail::align( s.current + offset, alignment ) - offset;
+        }
+
+        void* allocate( slot& s, size_t size, size_t alignment, size_t offset )
+        {
+          if( !s.current || get_user_pointer( s, alignment, offset ) + size > s.end )
+            {
+              if( !refill( s, size + offset + alignment ) )
+                return nullptr;
+            }
+          char* user_ptr = get_user_pointer( s, alignment, offset );
+          s.current = user_ptr + size;
+          reinterpret_cast<uint32_t*>(user_ptr)[0] = uint32_t(size);
+          return reinterpret_cast<void*>(user_ptr);
+        }
+
+        /**Make the next chunk of a slot that can hold the requested size the
+         * current one, by taking it from the parent if needed. */
+        bool refill( slot& s, size_t size )
+        {
+          while( s.active + 1 < s.chunks.size() )
+            {
+              const chunk& next = s.chunks[ ++ s.active ];
+              if( size_t( next.end - next.begin ) >= size )
+                {
+                  s.current = next.begin;
+                  s.end = next.end;
+                  return true;
+                }
+            }
+
+          const size_t size_in_bytes = std::max( chunk_size, size );
+          char* begin = static_cast<char*>( parent.allocate(
+              size_in_bytes, cache_line_size, __FILE__, GO_STRINGIZE(__LINE__), GO_PRETTY_FUNCTION ) );
+          if( !begin )
+            return false;
+          s.chunks.push_back( chunk{ begin, begin + size_in_bytes } );
+          s.active = s.chunks.size() - 1;
+          s.current = begin;
+          s.end = begin + size_in_bytes;
+          return true;
+        }
+
+        parent_arena& parent;
+        const size_t chunk_size;
+        std::vector< slot > slots;
+        thread_policy shared_guard;
+      };
+    }
+
+    namespace bounds_checking_policy {
+      struct no {
+        static constexpr size_t size_front = size_t{0};
+        static constexpr size_t size_back = size_t{0};
+        inline void guard_front( void* ) const {}
+        inline void guard_back( void* ) const {}
+        inline void check_front( const void* ) const {}
+        inline void check_back( const void* ) const {}
+      };
+
+      struct per_allocation {
+        static constexpr uint32_t front_word = uint32_t{0xFEEDFACE};
+        static constexpr uint32_t back_word = uint32_t{0x1BADC0DE};
+        static constexpr size_t size_front = sizeof(front_word);
+        static constexpr size_t size_back = sizeof(back_word);
+        inline void guard_front( void* ptr ) const
+        {
+          *(static_cast<uint32_t*>(ptr)) = front_word;
+        }
+        inline void guard_back( void* ptr ) const
+        {
+          *(static_cast<uint32_t*>(ptr)) = back_word;
+        }
+        inline void check_front( const void* ptr ) const
+        {
+          uint32_t word = *reinterpret_cast<const uint32_t*>( ptr );
+          GO_ASSERT(
+            word == front_word,
+            "front guard had been overwritten (is not 0xFEEDFACE)")
+            (word);
+        }
+        inline void check_back( const void* ptr ) const
+        {
+          uint32_t word = *reinterpret_cast<const uint32_t*>( ptr );
+          GO_ASSERT(
+            word == back_word,
+            "back guard had been overwritten (is not 0x1BADC0DE)")
+            (word);
+        }
+      };
+    }
+
+    namespace memory_tracking_policy {
+      struct no {
+        inline void track( void*, size_t, size_t, const char*, const char*, const char*) const {}
+        inline void untrack( void* ) const {}
+      };
+
+      /**@brief Track live allocations and gather statistics per callsite.
+       *
+       * Live allocations are recorded in an open addressing hash table keyed
+       * by their address, with linear probing and backward shift deletion, so
+       * that tracking and untracking are made in constant time without
+       * allocating memory most of the time. Each allocation refers to its
+       * callsite, i.e. the file, line and function given by the go_new macros,
+       * for which the number of allocations and bytes are aggregated:
+       * currently live, in total and at the high-water mark.
+       *
+       * The statistics can be queried at runtime with
+       * memory_arena::get_memory_tracker(), e.g. to display them in a
+       * dashboard. When the tracker is destroyed, i.e. with its arena, the
+       * allocations not yet freed are reported as leaks in the log, grouped by
+       * callsite.
+       *
+       * The sizes are the ones of the allocations made by the allocation
+       * policy: they include the data stored by the arena in front and at the
+       * back of the user memory.
+       */
+      class per_callsite {
+      public:
+        /**@brief Statistics of a callsite. */
+        struct callsite {
+          const char* file;
+          const char* line;
+          const char* function;
+          size_t live_count;
+          size_t live_bytes;
+          size_t total_count;
+          size_t total_bytes;
+          size_t peak_count;
+          size_t peak_bytes;
+        };
+
+        per_callsite()
+          : allocations( initial_capacity ), number_of_allocations{ 0 },
+            live_bytes{ 0 }, peak_bytes{ 0 }
+        {
+          callsites.reserve( initial_capacity );
+        }
+
+        ~per_callsite()
+        {
+          report_leaks();
+        }
+
+        void track( void* allocated_memory, size_t allocation_size, size_t,
+            const char* file, const char* line, const char* function )
+        {
+          const uint32_t callsite_index = get_callsite( file, line, function );
+          callsite& c = callsites[ callsite_index ];
+          ++ c.live_count;
+          ++ c.total_count;
+          c.live_bytes += allocation_size;
+          c.total_bytes += allocation_size;
+          c.peak_count = std::max( c.peak_count, c.live_count );
+          c.peak_bytes = std::max( c.peak_bytes, c.live_bytes );
+          live_bytes += allocation_size;
+          peak_bytes = std::max( peak_bytes, live_bytes );
+
+          if( 2 * ( number_of_allocations + 1 ) > allocations.size() )
+            grow();
+          insert( entry{ allocated_memory, allocation_size, callsite_index } );
+          ++ number_of_allocations;
+        }
+
+        void untrack( void* allocated_memory )
+        {
+          const size_t mask = allocations.size() - 1;
+          size_t i = hash( allocated_memory ) & mask;
+          while( allocations[ i ].memory != allocated_memory )
+            {
+              GO_ASSERT( allocations[ i ].memory, "freeing an allocation that was not tracked" )(allocated_memory);
+              i = ( i + 1 ) & mask;
+            }
+
+          const entry& e = allocations[ i ];
+          callsite& c = callsites[ e.callsite ];
+          -- c.live_count;
+          c.live_bytes -= e.size;
+          live_bytes -= e.size;
+          -- number_of_allocations;
+
+          // backward shift deletion: move back the next entries of the cluster
+          // that are not at their ideal position, to keep probe sequences valid
+          size_t j = i;
+          for(;;)
+            {
+              j = ( j + 1 ) & mask;
+              if( !allocations[ j ].memory )
+                break;
+              const size_t ideal = hash( allocations[ j ].memory ) & mask;
+              // the entry can move to i if i is between its ideal slot and j
+              if( ( ( j - ideal ) & mask ) >= ( ( j - i ) & mask ) )
+                {
+                  allocations[ i ] = allocations[ j ];
+                  i = j;
+                }
+            }
+          allocations[ i ] = entry{ nullptr, 0, 0 };
+        }
+
+        /**@brief Get the number of live allocations. */
+        size_t get_number_of_allocations() const
+        {
+          return number_of_allocations;
+        }
+
+        /**@brief Get the number of bytes in live allocations. */
+        size_t get_live_bytes() const
+        {
+          return live_bytes;
+        }
+
+        /**@brief Get the maximum number of bytes in live allocations since
+         * the creation of the tracker. */
+        size_t get_peak_bytes() const
+        {
+          return peak_bytes;
+        }
+
+        /**@brief Get the statistics of all the callsites that made an allocation. */
+        const std::vector< callsite >& get_callsites() const
+        {
+          return callsites;
+        }
+
+        /**@brief Log the callsites that have live allocations.
+         *
+         * This function is called when the tracker is destroyed, to report
+         * leaks. It can also be called at any time, e.g. at the end of a frame
+         * to check that all its memory was freed.
+         * @return The number of live allocations. */
+        size_t report_leaks() const
+        {
+          if( number_of_allocations )
+            {
+              LOG( warning, number_of_allocations << " allocations (" << live_bytes << " bytes) were not freed" );
+              for( auto& c : callsites )
+                if( c.live_count )
+                  LOG_WITH_LINE_FILE( warning,
+                    c.live_count << " allocations (" << c.live_bytes << " bytes) were not freed in "
+                    << ( c.function ? c.function : "unknown function" ),
+                    ( c.line ? c.line : "?" ), ( c.file ? c.file : "unknown file" ) );
+            }
+          return number_of_allocations;
+        }
+
+      private:
+        static constexpr size_t initial_capacity = 64;
+
+        struct entry {
+          void* memory;
+          size_t size;
+          uint32_t callsite;
+        };
+
+        static inline size_t hash( const void* memory )
+        {
+          // Fibonacci hashing of the address, allocations being at least
+          // aligned on 4 bytes
+          return size_t( ( uint64_t( reinterpret_cast<uintptr_t>(memory) >> 2 ) * 0x9E3779B97F4A7C15ull ) >> 16 );
+        }
+
+        void insert( const entry& e )
+        {
+          const size_t mask = allocations.size() - 1;
+          size_t i = hash( e.memory ) & mask;
+          while( allocations[ i ].memory )
+            i = ( i + 1 ) & mask;
+          allocations[ i ] = e;
+        }
+
+        void grow()
+        {
+          std::vector< entry > previous( allocations.size() * 2 );
+          previous.swap( allocations );
+          for( auto& e : previous )
+            if( e.memory )
+              insert( e );
+        }
+
+        /**Get the index of a callsite, identified by the addresses of its
+         * strings. The strings given by the go_new macros are literals, thus
+         * the same callsite always gives the same addresses. */
+        uint32_t get_callsite( const char* file, const char* line, const char* function )
+        {
+          const size_t key = ( reinterpret_cast<uintptr_t>(file) * 31 + reinterpret_cast<uintptr_t>(line) ) * 31 + reinterpret_cast<uintptr_t>(function);
+          auto range = callsite_indices.equal_range( key );
+          for( auto it = range.first; it != range.second; ++ it )
+            {
+              const callsite& c = callsites[ it->second ];
+              if( c.file == file && c.line == line && c.function == function )
+                return it->second;
+            }
+          const uint32_t index = uint32_t( callsites.size() );
+          callsites.push_back( callsite{ file, line, function, 0, 0, 0, 0, 0, 0 } );
+          callsite_indices.emplace( key, index );
+          return index;
+        }
+
+        std::vector< entry > allocations;
+        std::vector< callsite > callsites;
+        std::unordered_multimap< size_t, uint32_t > callsite_indices;
+        size_t number_of_allocations;
+        size_t live_bytes;
+        size_t peak_bytes;
       };
     }
 
@@ -5,12 +5,16 @@
 # define GRAPHICS_ORIGIN_TIGHT_BUFFER_MANAGER_H_
 
 # include "../graphics_origin.h"
+# include "./memory.h"
 # include "../extlibs/thrust/sort.h"
+# include "../extlibs/thrust/remove.h"
 # include "../extlibs/thrust/system/omp/execution_policy.h"
 # include "../extlibs/thrust/system/cpp/execution_policy.h"
 
 # include <type_traits>
 # include <stdexcept>
+# include <new>
+# include <vector>
 
 BEGIN_GO_NAMESPACE namespace tools {
 
@@ -74,6 +78,401 @@ BEGIN_GO_NAMESPACE namespace tools {
     {}
   };
 
+  /**@brief How a tight buffer manager gets more memory.
+   *
+   * - reallocate: new buffers are allocated on the heap and elements are moved
+   * to them. Element addresses change, and the memory used during the growth
+   * is the sum of the old and new buffers.
+   * - commit_in_place: the address space required by the maximal capacity is
+   * reserved at construction, and pages are committed at the end of the
+   * buffers when more elements are created. Elements never move, and no
+   * memory is wasted during the growth. */
+  enum class tight_buffer_growth {
+    reallocate,
+    commit_in_place
+  };
+
+  namespace detail {
+    /**Number of bytes committed at once by a tight buffer manager growing in place. */
+    constexpr size_t tight_buffer_commit_size = size_t(64) << 10;
+
+    /**Number of elements committed at once, to commit about tight_buffer_commit_size
+     * bytes of elements each time. */
+    constexpr size_t get_tight_buffer_commit_granularity( size_t element_size )
+    {
+      return element_size < tight_buffer_commit_size ? tight_buffer_commit_size / element_size : 1;
+    }
+
+    /**Commit the pages covering [begin + old_size, begin + new_size) */
+    inline void commit_tight_buffer( void* begin, size_t old_size, size_t new_size )
+    {
+      const size_t page_size = virtual_memory::get_page_size();
+      char* first = static_cast< char* >( begin ) + ( old_size / page_size ) * page_size;
+      char* last = static_cast< char* >( begin ) + (( new_size + page_size - 1 ) / page_size ) * page_size;
+      if( !virtual_memory::commit_memory( first, last - first ) )
+        throw std::bad_alloc();
+    }
+
+    /**@brief Handles of the elements of a tight buffer manager.
+     *
+     * This table maps handles to the indices of the elements in the buffers of
+     * a tight buffer manager, and those indices back to the handles. It is
+     * shared by tight_buffer_manager and tight_soa_buffer_manager, which store
+     * the elements and move them as the table tells them to. The table grows
+     * with the same tight_buffer_growth as the elements. */
+    template< typename handle_type, uint8_t index_bits >
+    class tight_handle_table {
+    public:
+      static constexpr uint8_t handle_bits = sizeof(handle_type) << 3;
+      static constexpr size_t max_index = (1 << index_bits) - 1;
+      static constexpr size_t max_counter =  (1 << (handle_bits - index_bits - 2)) - 1;
+
+      enum { STATUS_FREE = 0, STATUS_ALLOCATED = 1, STATUS_GARBAGE = 2 };
+
+      /**@brief An handle to designate an element.
+       *
+       * The handle is composed of two fields:
+       * - index, that gives the index of the element in the tight
+       * element buffer
+       * - counter, that tells the 'version' of the element at that index
+       * in the tight buffer (how many time an element had been allocated
+       * at this index). */
+      struct handle {
+        handle_type index  : index_bits;
+        handle_type counter: handle_bits - index_bits;
+
+        handle()
+          : index{ max_index },
+            counter{ max_counter + 1 }
+        {}
+
+        handle( handle_type i, handle_type c )
+          : index{ i }, counter{ c }
+        {}
+
+        inline operator handle_type() const
+        {
+          return (counter << index_bits) | index;
+        }
+        bool is_valid() const noexcept
+        {
+          return counter <= max_counter;
+        }
+      };
+
+      struct entry {
+        handle_type next_free_index : index_bits;
+        handle_type counter         : handle_bits - index_bits - 2;
+        handle_type status          : 2;
+
+        size_t element_index;
+
+        entry()
+          : next_free_index{ 0 }, counter{ 0 },
+            status{ STATUS_FREE }, element_index{ 0 }
+        {}
+      };
+
+      /**@note std::bad_alloc is thrown if the address space cannot be reserved. */
+      explicit tight_handle_table( tight_buffer_growth growth )
+        : m_capacity{ 0 }, m_size{ 0 }, m_next_free_entry{ 0 },
+          m_element_to_handle{ nullptr }, m_entries{ nullptr }, m_growth{ growth }
+      {
+        if( m_growth == tight_buffer_growth::commit_in_place )
+          {
+            m_element_to_handle = static_cast< size_t* >( virtual_memory::allocate_address_space( max_index * sizeof(size_t) ) );
+            m_entries = static_cast< entry* >( virtual_memory::allocate_address_space( max_index * sizeof(entry) ) );
+            if( !m_element_to_handle || !m_entries )
+              {
+                release_address_space();
+                throw std::bad_alloc();
+              }
+          }
+      }
+
+      ~tight_handle_table()
+      {
+        if( m_growth == tight_buffer_growth::commit_in_place )
+          release_address_space();
+        else
+          {
+            delete[] m_element_to_handle;
+            delete[] m_entries;
+          }
+      }
+
+      tight_handle_table( const tight_handle_table& ) = delete;
+      tight_handle_table& operator=( const tight_handle_table& ) = delete;
+
+      size_t get_size() const noexcept
+      {
+        return m_size;
+      }
+
+      size_t get_capacity() const noexcept
+      {
+        return m_capacity;
+      }
+
+      tight_buffer_growth get_growth() const noexcept
+      {
+        return m_growth;
+      }
+
+      /**Get the capacity needed to have room for count more elements */
+      size_t get_capacity_for( size_t count, size_t commit_granularity ) const
+      {
+        if( count > max_index - m_size )
+          throw tight_buffer_manager_buffer_overflow( __FILE__, __LINE__ );
+        const size_t required = m_size + count;
+        if( required <= m_capacity )
+          return m_capacity;
+        // committing in place costs no copy: there is no need to double the capacity
+        const size_t new_capacity = m_growth == tight_buffer_growth::commit_in_place
+            ? m_capacity + (( required - m_capacity + commit_granularity - 1 ) / commit_granularity ) * commit_granularity
+            : std::max( required, m_capacity + std::max( m_capacity, size_t{10} ) );
+        return new_capacity < max_index ? new_capacity : max_index;
+      }
+
+      /**Throw if the table cannot grow to new_capacity, to check it before growing the elements */
+      void check_growth( size_t new_capacity ) const
+      {
+        if( new_capacity <= m_capacity || new_capacity > max_index )
+          throw tight_buffer_manager_buffer_overflow( __FILE__, __LINE__ );
+      }
+
+      void grow( size_t new_capacity )
+      {
+        check_growth( new_capacity );
+        if( m_growth == tight_buffer_growth::commit_in_place )
+          {
+            commit_tight_buffer( m_element_to_handle, m_capacity * sizeof(size_t), new_capacity * sizeof(size_t) );
+            commit_tight_buffer( m_entries, m_capacity * sizeof(entry), new_capacity * sizeof(entry) );
+            for( size_t i = m_capacity; i < new_capacity; ++ i )
+              new (m_entries + i) entry;
+          }
+        else
+          {
+            auto new_element_to_handle = new size_t[ new_capacity ];
+            auto new_entries = new entry[ new_capacity ];
+# ifdef _MSC_VER
+            GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+            # pragma omp parallel for
+            for (long i = 0; i < m_capacity; ++ i )
+# else
+            # pragma omp parallel for
+            for( size_t i = 0; i < m_capacity; ++ i )
+# endif
+              {
+                new_element_to_handle[ i ] = m_element_to_handle[ i ];
+                new_entries[ i ] = m_entries[ i ];
+              }
+            delete[] m_element_to_handle;
+            delete[] m_entries;
+            m_element_to_handle = new_element_to_handle;
+            m_entries = new_entries;
+          }
+# ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        # pragma omp parallel for
+        for (long i = m_capacity; i < new_capacity; ++i )
+# else
+        # pragma omp parallel for
+        for( size_t i = m_capacity; i < new_capacity; ++ i )
+# endif
+          m_entries[ i ].next_free_index = i + 1;
+        m_capacity = new_capacity;
+      }
+
+      /**Take a free entry for a new element at the end of the element buffer */
+      handle allocate()
+      {
+        const auto entry_index = m_next_free_entry;
+        auto e = m_entries + entry_index;
+        m_next_free_entry = e->next_free_index;
+
+        // update the entry
+        ++e->counter;
+        if( e->counter > max_counter )
+          e->counter = 0;
+        e->element_index = m_size;
+        e->next_free_index = 0;
+        e->status = STATUS_ALLOCATED;
+
+        // map the element to the entry
+        m_element_to_handle[ m_size ] = entry_index;
+        ++m_size;
+        return handle( entry_index, e->counter );
+      }
+
+      /**Put an entry back in the free list, without changing the elements */
+      void free( size_t entry_index )
+      {
+        auto e = m_entries + entry_index;
+        e->next_free_index = m_next_free_entry;
+        e->status = STATUS_FREE;
+        m_next_free_entry = entry_index;
+      }
+
+      /**Put the entries of several elements back in the free list at once,
+       * without changing the elements. The entries are linked in parallel. */
+      void free_elements( const size_t* element_indices, size_t count )
+      {
+        if( !count )
+          return;
+# ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        # pragma omp parallel for
+        for (long i = 0; i < count; ++ i )
+# else
+        # pragma omp parallel for
+        for( size_t i = 0; i < count; ++ i )
+# endif
+          {
+            auto e = m_entries + m_element_to_handle[ element_indices[ i ] ];
+            e->next_free_index = i + 1 < count ? m_element_to_handle[ element_indices[ i + 1 ] ] : m_next_free_entry;
+            e->status = STATUS_FREE;
+          }
+        m_next_free_entry = m_element_to_handle[ element_indices[ 0 ] ];
+      }
+
+      /**Free the entry of an element and map the last element in its place.
+       * @return The index of the removed element. If it is not the new size,
+       * the last element must be moved from the new size to this index. */
+      size_t remove( size_t entry_index )
+      {
+        free( entry_index );
+        const size_t element_index = m_entries[ entry_index ].element_index;
+        if( --m_size != element_index )
+          move( m_size, element_index );
+        return element_index;
+      }
+
+      /**Map the element moved from one index to another */
+      void move( size_t from, size_t to )
+      {
+        m_element_to_handle[ to ] = m_element_to_handle[ from ];
+        m_entries[ m_element_to_handle[ to ] ].element_index = to;
+      }
+
+      /**Apply a permutation of the elements: the element at order[i] is now at i.
+       * The content of order is overwritten. */
+      void permute( size_t* order )
+      {
+# ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        # pragma omp parallel for
+        for (long i = 0; i < m_size; ++ i )
+# else
+        # pragma omp parallel for
+        for( size_t i = 0; i < m_size; ++ i )
+# endif
+          {
+            order[ i ] = m_element_to_handle[ order[ i ] ];
+            m_entries[ order[ i ] ].element_index = i;
+          }
+        std::copy( order, order + m_size, m_element_to_handle );
+      }
+
+      /**Update the entries after the element_to_handle buffer has been reordered */
+      void update_element_indices()
+      {
+# ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        # pragma omp parallel for
+        for (long i = 0; i < m_size; ++ i )
+# else
+        # pragma omp parallel for
+        for( size_t i = 0; i < m_size; ++ i )
+# endif
+          m_entries[ m_element_to_handle[ i ] ].element_index = i;
+      }
+
+      /**Set the number of elements, once some elements have been collected */
+      void set_size( size_t size ) noexcept
+      {
+        m_size = size;
+      }
+
+      /**Get the entry of a handle, or nullptr if its element is not allocated.
+       * @note An exception is thrown if the handle is invalid. */
+      entry* find( handle h )
+      {
+        if ( h.index >= m_capacity )
+          throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
+        auto e = m_entries + h.index;
+        if( e->status != STATUS_ALLOCATED )
+          return nullptr;
+        if( e->counter != h.counter )
+          throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
+        return e;
+      }
+
+      /**Get the index of the element of a handle.
+       * @note An exception is thrown if the handle is invalid. */
+      size_t get_element_index( handle h ) const
+      {
+        if( h.index >= m_capacity )
+          throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
+        const auto e = m_entries + h.index;
+        if( e->status != STATUS_ALLOCATED || e->counter != h.counter )
+          throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
+        return e->element_index;
+      }
+
+      /**Get the handle of an element.
+       * @note An exception is thrown if the index is invalid. */
+      handle get_handle( size_t element_index ) const
+      {
+        if( element_index >= m_size )
+          throw tight_buffer_manager_invalid_element_index( __FILE__, __LINE__ );
+        const auto entry_index = m_element_to_handle[ element_index ];
+        return handle( entry_index, m_entries[ entry_index ].counter );
+      }
+
+      size_t* get_element_to_handle() noexcept
+      {
+        return m_element_to_handle;
+      }
+
+      entry& get_entry( size_t entry_index ) noexcept
+      {
+        return m_entries[ entry_index ];
+      }
+
+      /**Get the entry of an element */
+      entry& get_element_entry( size_t element_index ) noexcept
+      {
+        return m_entries[ m_element_to_handle[ element_index ] ];
+      }
+
+    private:
+      void release_address_space()
+      {
+        if( m_element_to_handle )
+          virtual_memory::free_address_space( m_element_to_handle, max_index * sizeof(size_t) );
+        if( m_entries )
+          virtual_memory::free_address_space( m_entries, max_index * sizeof(entry) );
+      }
+
+      size_t m_capacity;
+      size_t m_size;
+      size_t m_next_free_entry;
+      size_t* m_element_to_handle;
+      entry* m_entries;
+      const tight_buffer_growth m_growth;
+    };
+
+    template< typename handle_type, uint8_t index_bits >
+    constexpr uint8_t tight_handle_table<handle_type,index_bits>::handle_bits;
+
+    template< typename handle_type, uint8_t index_bits >
+    constexpr size_t tight_handle_table<handle_type,index_bits>::max_index;
+
+    template< typename handle_type, uint8_t index_bits >
+    constexpr size_t tight_handle_table<handle_type,index_bits>::max_counter;
+  }
+
   /**@brief Tight buffer managed by handles.
    *
    * This class stores a set of elements contiguously in an element buffer. The
@@ -86,7 +485,17 @@ BEGIN_GO_NAMESPACE namespace tools {
    * a tight buffer. It should be default constructible and move assignable.
    *
    * The \a handle_type specifies the integral type that will be used to store
-   * the index and the counter of an handle. Thus, it must integral and unsigned. */
+   * the index and the counter of an handle. Thus, it must integral and unsigned.
+   *
+   * By default, the buffers are reallocated when the capacity is exceeded.
+   * With tight_buffer_growth::commit_in_place, the buffers are committed in
+   * place instead: the pointer returned by data() never changes, so it can be
+   * kept, e.g. to map buffers on the GPU, and growing costs no copy.
+   *
+   * Elements can be removed immediately with remove(), which moves the last
+   * element in place of the removed one. When many elements are removed at
+   * once, it is cheaper to mark them with mark_for_removal() and to compact
+   * the buffer once with collect() or collect_stable(). */
   template< class element, typename handle_type, uint8_t index_bits>
   class tight_buffer_manager {
     static_assert(
@@ -108,9 +517,8 @@ BEGIN_GO_NAMESPACE namespace tools {
         index_bits > 0,
         "you should have at least one bit to represent an index, otherwise you cannot store any element");
 
-    static constexpr uint8_t handle_bits = sizeof(handle_type) << 3;
-    static constexpr size_t max_index = (1 << index_bits) - 1;
-    static constexpr size_t max_counter =  (1 << (handle_bits - index_bits - 2)) - 1;
+    typedef detail::tight_handle_table< handle_type, index_bits > handle_table;
+    enum { STATUS_FREE = handle_table::STATUS_FREE, STATUS_ALLOCATED = handle_table::STATUS_ALLOCATED, STATUS_GARBAGE = handle_table::STATUS_GARBAGE };
     template< typename type >
     class tb_iterator :
         public std::iterator<
@@ -149,6 +557,13 @@ BEGIN_GO_NAMESPACE namespace tools {
       type* _ptr;
     };
 
+    struct is_garbage {
+      bool operator()( unsigned char flag ) const
+      {
+        return flag != 0;
+      }
+    };
+
     template< typename strict_weak_ordering >
     struct tuple_comparison {
       tuple_comparison( const strict_weak_ordering& ordering )
@@ -163,48 +578,32 @@ BEGIN_GO_NAMESPACE namespace tools {
       const strict_weak_ordering& f;
     };
 
+
   public:
     /**@brief An handle to designate an element.
      *
-     * The handle is composed of two fields:
-     * - index, that gives the index of the element in the tight
-     * element buffer
-     * - counter, that tells the 'version' of the element at that index
-     * in the tight buffer (how many time an element had been allocated
-     * at this index). */
-    struct handle {
-      handle_type index  : index_bits;
-      handle_type counter: handle_bits - index_bits;
-
-      handle()
-        : index{ max_index },
-          counter{ max_counter + 1 }
-      {}
-
-      handle( handle_type i, handle_type c )
-        : index{ i }, counter{ c }
-      {}
-
-      inline operator handle_type() const
-      {
-        return (counter << index_bits) | index;
-      }
-      bool is_valid() const noexcept
-      {
-        return counter <= max_counter;
-      }
-    };
+     * \sa detail::tight_handle_table::handle */
+    typedef typename handle_table::handle handle;
 
     /**@brief Instance construction.
      *
      * Create a tight buffer with enough memory to handle up to number_of_elements
      * elements. If more memory is required, there will be resizing.
-     * @param number_of_elements Maximal number of elements before resizing. */
-    tight_buffer_manager( size_t number_of_elements = 0 )
-      : m_capacity{ 0 }, m_size{ 0 }, m_next_free_handle_slot{ 0 },
-        m_element_buffer{ nullptr }, m_element_to_handle{ nullptr },
-        m_handle_buffer{ nullptr }
+     * @param number_of_elements Maximal number of elements before resizing.
+     * @param growth How to get more memory when needed.
+     * @note std::bad_alloc is thrown if the address space cannot be reserved. */
+    tight_buffer_manager(
+        size_t number_of_elements = 0,
+        tight_buffer_growth growth = tight_buffer_growth::reallocate )
+      : m_handles{ growth }, m_garbage_size{ 0 }, m_element_buffer{ nullptr },
+        m_collect_counts{}, m_collect_garbage{}, m_collect_moved{}
     {
+      if( growth == tight_buffer_growth::commit_in_place )
+        {
+          m_element_buffer = static_cast< element* >( virtual_memory::allocate_address_space( handle_table::max_index * sizeof(element) ) );
+          if( !m_element_buffer )
+            throw std::bad_alloc();
+        }
       if( number_of_elements )
         grow( number_of_elements );
     }
@@ -214,9 +613,15 @@ BEGIN_GO_NAMESPACE namespace tools {
      * Destroy this tight buffer manager. */
     ~tight_buffer_manager()
     {
-      delete[] m_element_buffer;
-      delete[] m_element_to_handle;
-      delete[] m_handle_buffer;
+      if( get_growth() == tight_buffer_growth::commit_in_place )
+        {
+          const size_t capacity = get_capacity();
+          for( size_t i = 0; i < capacity; ++ i )
+            m_element_buffer[ i ].~element();
+          virtual_memory::free_address_space( m_element_buffer, handle_table::max_index * sizeof(element) );
+        }
+      else
+        delete[] m_element_buffer;
     }
 
     /**@brief Get the tight buffer size.
@@ -225,7 +630,17 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @return The number of elements in the buffer. */
     size_t get_size() const noexcept
     {
-      return m_size;
+      return m_handles.get_size();
+    }
+
+    /**@brief Get the number of elements marked for removal.
+     *
+     * Those elements are still in the element buffer, and counted by
+     * get_size(), until the next call to collect() or collect_stable().
+     * @return The number of elements waiting to be collected. */
+    size_t get_garbage_size() const noexcept
+    {
+      return m_garbage_size;
     }
 
     /**@brief Get the tight buffer capacity.
@@ -235,7 +650,13 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @return The capacity of the tight buffer. */
     size_t get_capacity() const noexcept
     {
-      return m_capacity;
+      return m_handles.get_capacity();
+    }
+
+    /**@brief Get how this tight buffer gets more memory. */
+    tight_buffer_growth get_growth() const noexcept
+    {
+      return m_handles.get_growth();
     }
 
     /**@brief Get the maximal capacity of this tight buffer.
@@ -246,7 +667,7 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @return The maximal capacity of this tight buffer. */
     static size_t get_max_capacity() noexcept
     {
-      return max_index;
+      return handle_table::max_index;
     }
 
     /**@brief Create a new element in the tight buffer.
@@ -261,32 +682,33 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @note An exception could be thrown if the maximal capacity is reached. */
     std::pair<handle, element&> create()
     {
-      if( m_size == m_capacity )
+      reserve_for( 1 );
+      const handle h = m_handles.allocate();
+      return std::pair<handle, element&>( h, m_element_buffer[ get_size() - 1 ] );
+    }
+
+    /**@brief Create several elements in the tight buffer.
+     *
+     * Create count elements at once. The element buffer grows at most once,
+     * and the new elements are contiguous at the end of the element buffer,
+     * so they can be initialized in a single loop.
+     * @param count Number of elements to create.
+     * @param handles If not null, receives the handles of the new elements,
+     * in the order of the elements.
+     * @return A pointer to the first new element.
+     * @note An exception is thrown if the maximal capacity would be exceeded,
+     * in which case no element is created. */
+    element* create_n( size_t count, handle* handles = nullptr )
+    {
+      reserve_for( count );
+      element* first = m_element_buffer + get_size();
+      for( size_t i = 0; i < count; ++ i )
         {
-          grow( std::min( max_index, m_capacity + std::max( m_capacity, size_t{10} ) ) );
+          const handle h = m_handles.allocate();
+          if( handles )
+            handles[ i ] = h;
         }
-      const auto handle_index = m_next_free_handle_slot;
-      auto entry = m_handle_buffer + handle_index;
-      m_next_free_handle_slot = entry->next_free_index;
-
-      // update the entry
-      ++entry->counter;
-      if( entry->counter > max_counter )
-        entry->counter = 0;
-      entry->element_index = m_size;
-      entry->next_free_index = 0;
-      entry->status = STATUS_ALLOCATED;
-
-      // map the element to the handle entry
-      m_element_to_handle[ entry->element_index ] = handle_index;
-
-      std::pair<handle, element&> result = {
-          handle( handle_index, entry->counter ),
-          m_element_buffer[m_size] };
-
-      // update this
-      ++m_size;
-      return result;
+      return first;
     }
 
     /**@brief Remove an element thanks to its handle.
@@ -299,26 +721,8 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @note An exception is thrown if the handle is invalid. */
     void remove( handle h )
     {
-      if ( h.index >= m_capacity )
-        throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
-      auto entry = m_handle_buffer + h.index;
-      if( entry->status != STATUS_ALLOCATED )
-        return;
-      if( entry->counter != h.counter )
-        throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
-
-      entry->next_free_index = m_next_free_handle_slot;
-      entry->status = STATUS_FREE;
-
-      auto& e= m_element_buffer[ entry->element_index ];
-      e.~element();
-
-      m_next_free_handle_slot = h.index;
-      if( --m_size && entry->element_index != m_size )
-        {
-          m_element_buffer[ entry->element_index ] = std::move( m_element_buffer[ m_size ] );
-          m_handle_buffer[ m_element_to_handle[ entry->element_index ] ].element_index = entry->element_index;
-        }
+      if( m_handles.find( h ) )
+        remove_entry( h.index );
     }
 
     /**@brief Remove an element thanks to a pointer to it.
@@ -331,27 +735,193 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @note An exception is thrown if the memory pointed to by e is invalid. */
     void remove( element* e )
     {
-      if( e < m_element_buffer || e >= m_element_buffer + m_size )
-        throw tight_buffer_manager_invalid_element_pointer( __FILE__, __LINE__ );
+      const size_t element_index = get_element_index( e );
+      const auto entry_index = m_handles.get_element_to_handle()[ element_index ];
+      if( m_handles.get_entry( entry_index ).status == STATUS_ALLOCATED )
+        remove_entry( entry_index );
+    }
 
-      const auto element_index = std::distance( m_element_buffer, e );
-      if( m_element_buffer + element_index != e )
-        throw tight_buffer_manager_invalid_element_pointer( __FILE__, __LINE__ );
+    /**@brief Mark an element for removal thanks to its handle.
+     *
+     * The element is not removed immediately: it stays at its place in the
+     * element buffer until the next call to collect() or collect_stable(), so
+     * the indices of the other elements do not change. Meanwhile, the handle
+     * is no longer valid. This is the way to remove elements while iterating
+     * over the element buffer.
+     * @param h The handle of the element to remove.
+     * @note An exception is thrown if the handle is invalid. */
+    void mark_for_removal( handle h )
+    {
+      auto entry = m_handles.find( h );
+      if( !entry )
+        return;
+      entry->status = STATUS_GARBAGE;
+      ++m_garbage_size;
+    }
+
+    /**@brief Mark an element for removal thanks to a pointer to it.
+     *
+     * See mark_for_removal( handle ).
+     * @param e A pointer to the element to remove.
+     * @note An exception is thrown if the memory pointed to by e is invalid. */
+    void mark_for_removal( element* e )
+    {
+      auto& entry = m_handles.get_element_entry( get_element_index( e ) );
+      if( entry.status != STATUS_ALLOCATED )
+        return;
+      entry.status = STATUS_GARBAGE;
+      ++m_garbage_size;
+    }
+
+    /**@brief Remove all the elements marked for removal.
+     *
+     * The holes left by the marked elements before the new end of the
+     * element buffer are filled by the elements that are not marked after
+     * this end. Thus, the order of the elements is not kept, but each element
+     * is moved at most once and the moves are done in parallel. The memory
+     * after the new end is reset to default constructed elements.
+     *
+     * The holes and the elements to move are found in parallel: each block of
+     * the element buffer counts them, a prefix sum of the counts gives where
+     * each block writes them, and the blocks write them in parallel. The
+     * buffers used to do so are kept between calls. */
+    void collect()
+    {
+      if( !m_garbage_size )
+        return;
+      const size_t size = get_size();
+      const size_t new_size = size - m_garbage_size;
+      const size_t nblocks = ( size + collect_block_size - 1 ) / collect_block_size;
+      if( m_collect_counts.size() < 2 * nblocks )
+        m_collect_counts.resize( 2 * nblocks );
+      if( m_collect_garbage.size() < m_garbage_size )
+        {
+          m_collect_garbage.resize( m_garbage_size );
+          m_collect_moved.resize( m_garbage_size );
+        }
+      size_t* counts = m_collect_counts.data();
+      size_t* garbage = m_collect_garbage.data();
+      size_t* moved = m_collect_moved.data();
 
-      const auto entry_index = m_element_to_handle[ element_index ];
+      // count the marked elements, and the elements to move, of each block
+# ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      # pragma omp parallel for
+      for (long b = 0; b < nblocks; ++ b )
+# else
+      # pragma omp parallel for
+      for( size_t b = 0; b < nblocks; ++ b )
+# endif
+        {
+          const size_t begin = b * collect_block_size;
+          const size_t end = std::min( size, begin + collect_block_size );
+          size_t ngarbage = 0, nmoved = 0;
+          for( size_t i = begin; i < end; ++ i )
+            if( is_marked( i ) )
+              ++ ngarbage;
+            else if( i >= new_size )
+              ++ nmoved;
+          counts[ 2 * b ] = ngarbage;
+          counts[ 2 * b + 1 ] = nmoved;
+        }
 
-      auto entry = m_handle_buffer + entry_index;
+      // exclusive prefix sums, to know where each block writes its indices
+      size_t ngarbage = 0, nmoved = 0;
+      for( size_t b = 0; b < nblocks; ++ b )
+        {
+          const size_t block_garbage = counts[ 2 * b ];
+          const size_t block_moved = counts[ 2 * b + 1 ];
+          counts[ 2 * b ] = ngarbage;
+          counts[ 2 * b + 1 ] = nmoved;
+          ngarbage += block_garbage;
+          nmoved += block_moved;
+        }
 
-      entry->next_free_index = m_next_free_handle_slot;
-      entry->status = STATUS_FREE;
-      e->~element();
+# ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      # pragma omp parallel for
+      for (long b = 0; b < nblocks; ++ b )
+# else
+      # pragma omp parallel for
+      for( size_t b = 0; b < nblocks; ++ b )
+# endif
+        {
+          const size_t begin = b * collect_block_size;
+          const size_t end = std::min( size, begin + collect_block_size );
+          size_t* garbage_output = garbage + counts[ 2 * b ];
+          size_t* moved_output = moved + counts[ 2 * b + 1 ];
+          for( size_t i = begin; i < end; ++ i )
+            if( is_marked( i ) )
+              *garbage_output++ = i;
+            else if( i >= new_size )
+              *moved_output++ = i;
+        }
+
+      // the marked elements are sorted: the first ones are the holes before
+      // the new end, as many as the elements to move after it
+      m_handles.free_elements( garbage, m_garbage_size );
+# ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      # pragma omp parallel for
+      for (long i = 0; i < nmoved; ++ i )
+# else
+      # pragma omp parallel for
+      for( size_t i = 0; i < nmoved; ++ i )
+# endif
+        {
+          const auto to = garbage[ i ];
+          const auto from = moved[ i ];
+          m_element_buffer[ to ] = std::move( m_element_buffer[ from ] );
+          m_handles.move( from, to );
+        }
+      shrink( new_size );
+    }
+
+    /**@brief Remove all the elements marked for removal, keeping the order
+     * of the other elements.
+     *
+     * The element buffer is compacted with a parallel stable partition. This
+     * is more expensive than collect(), since every element after the first
+     * marked one is moved, and elements should be copyable. */
+    void collect_stable()
+    {
+      static_assert(
+          std::is_copy_constructible< element >::value,
+          "element is not copy constructible: cannot use thrust::remove_if");
+      static_assert(
+          std::is_copy_assignable< element >::value,
+          "element is not copy assignable: cannot use thrust::remove_if");
+      if( !m_garbage_size )
+        return;
+      const size_t size = get_size();
+      const size_t new_size = size - m_garbage_size;
 
-      m_next_free_handle_slot = entry_index;
-      if( --m_size && entry->element_index != m_size )
+      size_t* element_to_handle = m_handles.get_element_to_handle();
+      std::vector< unsigned char > garbage( size );
+      for( size_t i = 0; i < size; ++ i )
         {
-          m_element_buffer[ entry->element_index ] = std::move( m_element_buffer[ m_size ] );
-          m_handle_buffer[ m_element_to_handle[ entry->element_index ] ].element_index = entry->element_index;
+          const auto entry_index = element_to_handle[ i ];
+          garbage[ i ] = m_handles.get_entry( entry_index ).status == STATUS_GARBAGE;
+          if( garbage[ i ] )
+            m_handles.free( entry_index );
         }
+
+      thrust::remove_if(
+# ifdef _MSC_VER
+          GO_MSVC_OMP_THRUST_BUGS
+          WARN("using single thread implementation instead")
+          thrust::cpp::par,
+# else
+          thrust::omp::par,
+# endif
+          thrust::make_zip_iterator( thrust::make_tuple( m_element_buffer, element_to_handle )),
+          thrust::make_zip_iterator( thrust::make_tuple( m_element_buffer + size, element_to_handle + size )),
+          garbage.data(),
+          is_garbage()
+      );
+
+      shrink( new_size );
+      m_handles.update_element_indices();
     }
 
     /**@brief Get an element by its handle.
@@ -361,12 +931,7 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @note An exception is thrown if the handle is invalid. */
     element& get( handle h )
     {
-      if( h.index >= m_capacity )
-        throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
-      const auto entry = m_handle_buffer + h.index;
-      if( entry->status != STATUS_ALLOCATED || entry->counter != h.counter )
-        throw tight_buffer_manager_invalid_handle( __FILE__, __LINE__ );
-      return m_element_buffer[ entry->element_index ];
+      return m_element_buffer[ m_handles.get_element_index( h ) ];
     }
 
     /**@brief Get an element by its index.
@@ -376,7 +941,7 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @note An exception is thrown if the index is invalid. */
     element& get_by_index( size_t index )
     {
-      if( index >= m_size )
+      if( index >= get_size() )
         throw tight_buffer_manager_invalid_element_index( __FILE__, __LINE__ );
       return m_element_buffer[ index ];
     }
@@ -387,10 +952,7 @@ BEGIN_GO_NAMESPACE namespace tools {
      * @param index Index of the element in the element buffer. */
     handle get_handle( size_t index )
     {
-      if( index >= m_size )
-        throw tight_buffer_manager_invalid_element_index( __FILE__, __LINE__ );
-      auto handle_index = m_element_to_handle[ index ];
-      return handle( handle_index, m_handle_buffer[ handle_index ].counter );
+      return m_handles.get_handle( index );
     }
 
 
@@ -402,13 +964,14 @@ BEGIN_GO_NAMESPACE namespace tools {
     template< typename process_function >
     void process( process_function&& f )
     {
+      const size_t size = get_size();
 # ifdef _MSC_VER
       GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
       # pragma omp parallel for
-      for (long i = 0; i < m_size; ++ i )
+      for (long i = 0; i < size; ++ i )
 # else
       # pragma omp parallel for
-      for( size_t i = 0; i < m_size; ++ i )
+      for( size_t i = 0; i < size; ++ i )
 # endif
         {
           f( m_element_buffer[i] );
@@ -429,6 +992,8 @@ BEGIN_GO_NAMESPACE namespace tools {
           std::is_copy_assignable< element >::value,
           "element is not copy assignable: cannot use thrust::sort");
 
+      const size_t size = get_size();
+      size_t* element_to_handle = m_handles.get_element_to_handle();
       thrust::sort(
 # ifdef _MSC_VER
           GO_MSVC_OMP_THRUST_BUGS
@@ -437,22 +1002,11 @@ BEGIN_GO_NAMESPACE namespace tools {
 # else
           thrust::omp::par,
 # endif
-          thrust::make_zip_iterator( thrust::make_tuple( m_element_buffer, m_element_to_handle )),
-          thrust::make_zip_iterator( thrust::make_tuple( m_element_buffer + m_size, m_element_to_handle + m_size )),
+          thrust::make_zip_iterator( thrust::make_tuple( m_element_buffer, element_to_handle )),
+          thrust::make_zip_iterator( thrust::make_tuple( m_element_buffer + size, element_to_handle + size )),
           tuple_comparison<strict_weak_ordering>(f)
       );
-
-# ifdef _MSC_VER
-      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
-      # pragma omp parallel for
-      for (long i = 0; i < m_size; ++ i )
-# else
-      # pragma omp parallel for
-      for( size_t i = 0; i < m_size; ++ i )
-# endif
-        {
-          m_handle_buffer[ m_element_to_handle[ i ] ].element_index = i;
-        }
+      m_handles.update_element_indices();
     }
 
     element* data()
@@ -475,96 +1029,118 @@ BEGIN_GO_NAMESPACE namespace tools {
 
     iterator end()
     {
-      return iterator( m_element_buffer + m_size );
+      return iterator( m_element_buffer + get_size() );
     }
 
     const_iterator end() const
     {
-      return const_iterator( m_element_buffer + m_size );
+      return const_iterator( m_element_buffer + get_size() );
     }
 
   private:
+    /**Number of elements committed at once, to commit about 64kB each time. */
+    static constexpr size_t commit_granularity = detail::get_tight_buffer_commit_granularity( sizeof(element) );
+    /**Number of elements scanned by a task of collect(). */
+    static constexpr size_t collect_block_size = 4096;
+
+    bool is_marked( size_t element_index )
+    {
+      return m_handles.get_element_entry( element_index ).status == STATUS_GARBAGE;
+    }
+
+    /**Get the index of an element given by a pointer.
+     * @note An exception is thrown if the memory pointed to by e is invalid. */
+    size_t get_element_index( element* e ) const
+    {
+      if( e < m_element_buffer || e >= m_element_buffer + get_size() )
+        throw tight_buffer_manager_invalid_element_pointer( __FILE__, __LINE__ );
+
+      const auto element_index = std::distance( m_element_buffer, e );
+      if( m_element_buffer + element_index != e )
+        throw tight_buffer_manager_invalid_element_pointer( __FILE__, __LINE__ );
+      return element_index;
+    }
+
+    /**Grow the buffers, if needed, to have room for count more elements */
+    void reserve_for( size_t count )
+    {
+      const size_t new_capacity = m_handles.get_capacity_for( count, commit_granularity );
+      if( new_capacity > get_capacity() )
+        grow( new_capacity );
+    }
+
+    /**Remove the element of an allocated handle entry, and move the last element in its place */
+    void remove_entry( size_t entry_index )
+    {
+      const size_t element_index = m_handles.remove( entry_index );
+      const size_t last_index = get_size();
+      if( element_index != last_index )
+        m_element_buffer[ element_index ] = std::move( m_element_buffer[ last_index ] );
+      m_element_buffer[ last_index ] = element{};
+    }
+
+    /**Reset the elements after new_size, once the garbage has been collected */
+    void shrink( size_t new_size )
+    {
+      const size_t size = get_size();
+# ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      # pragma omp parallel for
+      for (long i = new_size; i < size; ++ i )
+# else
+      # pragma omp parallel for
+      for( size_t i = new_size; i < size; ++ i )
+# endif
+        {
+          m_element_buffer[ i ] = element{};
+        }
+      m_handles.set_size( new_size );
+      m_garbage_size = 0;
+    }
+
     void grow( size_t new_capacity )
     {
-      if( new_capacity <= m_capacity || new_capacity > max_index )
-        throw tight_buffer_manager_buffer_overflow( __FILE__, __LINE__ );
-      if( !m_element_buffer )
+      m_handles.check_growth( new_capacity );
+      const size_t capacity = get_capacity();
+      if( get_growth() == tight_buffer_growth::commit_in_place )
         {
-          m_element_buffer = new element[ new_capacity ];
-          m_element_to_handle = new size_t[ new_capacity ];
-          m_handle_buffer = new handle_entry[ new_capacity ];
+          detail::commit_tight_buffer( m_element_buffer, capacity * sizeof(element), new_capacity * sizeof(element) );
+          for( size_t i = capacity; i < new_capacity; ++ i )
+            new (m_element_buffer + i) element;
         }
       else
         {
           auto new_element_buffer = new element[ new_capacity ];
-          auto new_element_to_handle = new size_t[ new_capacity ];
-          auto new_handle_buffer = new handle_entry[ new_capacity ];
+          const size_t size = get_size();
 # ifdef _MSC_VER
           GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
-# pragma omp parallel for
-		  for (long i = 0; i < m_capacity; ++ i )
+          # pragma omp parallel for
+          for (long i = 0; i < size; ++ i )
 # else
           # pragma omp parallel for
-          for( size_t i = 0; i < m_capacity; ++ i )
+          for( size_t i = 0; i < size; ++ i )
 # endif
-            {
-              new_element_buffer[ i ] = std::move( m_element_buffer[ i ] );
-              new_element_to_handle[ i ] = m_element_to_handle[ i ];
-              new_handle_buffer[ i ] = m_handle_buffer[ i ];
-            }
+            new_element_buffer[ i ] = std::move( m_element_buffer[ i ] );
           delete[] m_element_buffer;
-          delete[] m_element_to_handle;
-          delete[] m_handle_buffer;
-
           m_element_buffer = new_element_buffer;
-          m_element_to_handle = new_element_to_handle;
-          m_handle_buffer = new_handle_buffer;
         }
-# ifdef _MSC_VER
-      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
-# pragma omp parallel for
-	  for (long i = m_capacity; i < new_capacity; ++i )
-# else
-      # pragma omp parallel for
-      for( size_t i = m_capacity; i < new_capacity; ++ i )
-# endif
-        m_handle_buffer[ i ].next_free_index = i + 1;
-      m_capacity = new_capacity;
+      m_handles.grow( new_capacity );
     }
 
-    enum { STATUS_FREE = 0, STATUS_ALLOCATED = 1, STATUS_GARBAGE = 2 };
-
-    struct handle_entry {
-      handle_type next_free_index : index_bits;
-      handle_type counter         : handle_bits - index_bits - 2;
-      handle_type status          : 2;
-
-      size_t element_index;
-
-      handle_entry()
-        : next_free_index{ 0 }, counter{ 0 },
-          status{ STATUS_FREE }, element_index{ 0 }
-      {}
-    };
-
-    size_t m_capacity;
-    size_t m_size;
-    size_t m_next_free_handle_slot;
-
+    handle_table m_handles;
+    size_t m_garbage_size;
     element* m_element_buffer;
-    size_t* m_element_to_handle;
-    handle_entry* m_handle_buffer;
-
+    /**Buffers of collect(), kept between calls */
+    std::vector< size_t > m_collect_counts;
+    std::vector< size_t > m_collect_garbage;
+    std::vector< size_t > m_collect_moved;
   };
 
   template< class element, typename handle_type, uint8_t index_bits>
-  constexpr uint8_t tight_buffer_manager<element,handle_type,index_bits>::handle_bits;
-
-  template< class element, typename handle_type, uint8_t index_bits>
-  constexpr size_t tight_buffer_manager<element,handle_type,index_bits>::max_index;
+  constexpr size_t tight_buffer_manager<element,handle_type,index_bits>::commit_granularity;
 
   template< class element, typename handle_type, uint8_t index_bits>
-  constexpr size_t tight_buffer_manager<element,handle_type,index_bits>::max_counter;
+  constexpr size_t tight_buffer_manager<element,handle_type,index_bits>::collect_block_size;
 
 } END_GO_NAMESPACE
-# endif 
+# endif
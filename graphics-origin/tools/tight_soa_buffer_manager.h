@@ -0,0 +1,508 @@
+/* Created on: Oct 19, 2026
+ *     Author: T.Delame (tdelame@gmail.com)
+ */
+# ifndef GRAPHICS_ORIGIN_TIGHT_SOA_BUFFER_MANAGER_H_
+# define GRAPHICS_ORIGIN_TIGHT_SOA_BUFFER_MANAGER_H_
+
+# include "./tight_buffer_manager.h"
+
+# include <tuple>
+# include <utility>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace tools {
+
+  /**@brief A view on a column of a tight_soa_buffer_manager.
+   *
+   * A column stores one field of all elements contiguously. It can thus be
+   * processed with SIMD instructions, or uploaded as is to a vertex buffer.
+   * The view is invalidated when elements are created, removed or sorted. */
+  template< typename type >
+  class tight_buffer_column {
+  public:
+    tight_buffer_column( type* data, size_t size ) noexcept
+      : m_data{ data }, m_size{ size }
+    {}
+
+    type* data() const noexcept
+    {
+      return m_data;
+    }
+
+    size_t size() const noexcept
+    {
+      return m_size;
+    }
+
+    size_t size_in_bytes() const noexcept
+    {
+      return m_size * sizeof(type);
+    }
+
+    type& operator[]( size_t index ) const noexcept
+    {
+      return m_data[ index ];
+    }
+
+    type* begin() const noexcept
+    {
+      return m_data;
+    }
+
+    type* end() const noexcept
+    {
+      return m_data + m_size;
+    }
+
+  private:
+    type* m_data;
+    size_t m_size;
+  };
+
+  namespace detail {
+    constexpr bool all_of()
+    {
+      return true;
+    }
+
+    template< typename... others >
+    constexpr bool all_of( bool first, others... rest )
+    {
+      return first && all_of( rest... );
+    }
+
+    constexpr size_t sum_of()
+    {
+      return 0;
+    }
+
+    template< typename... others >
+    constexpr size_t sum_of( size_t first, others... rest )
+    {
+      return first + sum_of( rest... );
+    }
+  }
+
+  /**@brief Tight buffer managed by handles, storing each field in its own array.
+   *
+   * This class is the structure of arrays counterpart of tight_buffer_manager.
+   * An element is made of several fields, given as template parameters, and
+   * each field of all elements is stored in a contiguous column. Handles, the
+   * removal by swapping with the last element and the growth policies are the
+   * same as in tight_buffer_manager: both use a detail::tight_handle_table.
+   *
+   * This layout is better suited when elements are processed field by field:
+   * computing the depth of a set of primitives only touches their centers and
+   * depths, and sorting by depth only moves the keys before moving each
+   * column once. Columns can also be uploaded as separate vertex streams:
+   * \code{.cpp}
+   * tight_soa_buffer_manager< uint32_t, 22, gl_vec4, gl_vec4 > balls;
+   * auto centers = balls.column<0>();
+   * glBufferSubData( GL_ARRAY_BUFFER, 0, centers.size_in_bytes(), centers.data() );
+   * \endcode
+   *
+   * Each field should be default constructible and move assignable. */
+  template< typename handle_type, uint8_t index_bits, class... fields >
+  class tight_soa_buffer_manager {
+    static_assert(
+        sizeof...(fields) > 0,
+        "there should be at least one field");
+    static_assert(
+        detail::all_of( std::is_default_constructible< fields >::value... ),
+        "a field type is not default constructible");
+    static_assert(
+        detail::all_of( std::is_move_assignable< fields >::value... ),
+        "a field type is not move assignable");
+    static_assert(
+        std::is_integral< handle_type >::value,
+        "handle type is not an integral type");
+    static_assert(
+        std::is_unsigned< handle_type >::value,
+        "handle type is not unsigned");
+    static_assert(
+       index_bits + 2 < sizeof(handle_type) * 8,
+       "handle type is not large enough to have the required bits for the index");
+    static_assert(
+        index_bits > 0,
+        "you should have at least one bit to represent an index, otherwise you cannot store any element");
+
+    typedef detail::tight_handle_table< handle_type, index_bits > handle_table;
+    static constexpr size_t max_index = handle_table::max_index;
+    /**Number of elements committed at once, to commit about 64kB of fields each time. */
+    static constexpr size_t commit_granularity = detail::get_tight_buffer_commit_granularity( detail::sum_of( sizeof(fields)... ) );
+
+    template< typename key_type, typename strict_weak_ordering >
+    struct index_comparison {
+      index_comparison( const key_type* keys, const strict_weak_ordering& ordering )
+        : keys{ keys }, f{ ordering }
+      {}
+      bool operator()( size_t a, size_t b ) const
+      {
+        return f( keys[ a ], keys[ b ] );
+      }
+      const key_type* keys;
+      const strict_weak_ordering& f;
+    };
+
+  public:
+    /**@brief Type of the field at a given position. */
+    template< size_t field >
+    using field_type = typename std::tuple_element< field, std::tuple< fields... > >::type;
+
+    /**@brief References to all the fields of an element. */
+    typedef std::tuple< fields&... > reference;
+
+    /**@brief An handle to designate an element.
+     *
+     * \sa detail::tight_handle_table::handle */
+    typedef typename handle_table::handle handle;
+
+    /**@brief Instance construction.
+     *
+     * Create a tight buffer with enough memory to handle up to number_of_elements
+     * elements. If more memory is required, there will be resizing.
+     * @param number_of_elements Maximal number of elements before resizing.
+     * @param growth How to get more memory when needed.
+     * @note std::bad_alloc is thrown if the address space cannot be reserved. */
+    tight_soa_buffer_manager(
+        size_t number_of_elements = 0,
+        tight_buffer_growth growth = tight_buffer_growth::reallocate )
+      : m_handles{ growth }, m_columns{}, m_sort_permutation{}, m_sort_buffers{}
+    {
+      if( growth == tight_buffer_growth::commit_in_place )
+        {
+          bool reserved = true;
+          for_each_column( [&reserved]( auto& column )
+          {
+            typedef typename std::remove_reference< decltype(*column) >::type type;
+            column = static_cast< type* >( virtual_memory::allocate_address_space( max_index * sizeof(type) ) );
+            reserved = reserved && column;
+          });
+          if( !reserved )
+            {
+              release_address_space();
+              throw std::bad_alloc();
+            }
+        }
+      if( number_of_elements )
+        grow( number_of_elements );
+    }
+
+    /**@brief Instance destruction.
+     *
+     * Destroy this tight buffer manager. */
+    ~tight_soa_buffer_manager()
+    {
+      if( get_growth() == tight_buffer_growth::commit_in_place )
+        {
+          const size_t capacity = get_capacity();
+          for_each_column( [capacity]( auto& column )
+          {
+            typedef typename std::remove_reference< decltype(*column) >::type type;
+            for( size_t i = 0; i < capacity; ++ i )
+              column[ i ].~type();
+          });
+          release_address_space();
+        }
+      else
+        for_each_column( []( auto& column ){ delete[] column; });
+    }
+
+    tight_soa_buffer_manager( const tight_soa_buffer_manager& ) = delete;
+    tight_soa_buffer_manager& operator=( const tight_soa_buffer_manager& ) = delete;
+
+    /**@brief Get the number of elements currently in the tight buffer. */
+    size_t get_size() const noexcept
+    {
+      return m_handles.get_size();
+    }
+
+    /**@brief Get the number of elements that fit in the columns without resizing. */
+    size_t get_capacity() const noexcept
+    {
+      return m_handles.get_capacity();
+    }
+
+    /**@brief Get the maximal number of elements that could be managed by this tight buffer. */
+    static size_t get_max_capacity() noexcept
+    {
+      return max_index;
+    }
+
+    /**@brief Get how this tight buffer gets more memory. */
+    tight_buffer_growth get_growth() const noexcept
+    {
+      return m_handles.get_growth();
+    }
+
+    /**@brief Create a new element in the tight buffer.
+     *
+     * Create another element in the tight buffer and returns references to its
+     * fields with its handle. As for tight_buffer_manager::create(), it is not
+     * advised to store those references.
+     * @return A pair of the handle of the new element and references to its fields.
+     * @note An exception could be thrown if the maximal capacity is reached. */
+    std::pair< handle, reference > create()
+    {
+      reserve_for( 1 );
+      const handle h = m_handles.allocate();
+      return std::pair< handle, reference >( h, get_by_index( get_size() - 1 ) );
+    }
+
+    /**@brief Create a new element in the tight buffer from its fields.
+     *
+     * @param values The value of each field of the new element.
+     * @return The handle of the new element. */
+    handle create( const fields&... values )
+    {
+      reserve_for( 1 );
+      const handle h = m_handles.allocate();
+      get_by_index( get_size() - 1 ) = std::tie( values... );
+      return h;
+    }
+
+    /**@brief Remove an element thanks to its handle.
+     *
+     * The last element is moved to the place of the removed one, in every
+     * column. The memory of the last element is left in a moved-from state.
+     * @param h The handle of the element to remove.
+     * @note An exception is thrown if the handle is invalid. */
+    void remove( handle h )
+    {
+      if( m_handles.find( h ) )
+        remove_entry( h.index );
+    }
+
+    /**@brief Remove an element thanks to its index in the columns.
+     *
+     * @param index Index of the element in the columns.
+     * @note An exception is thrown if the index is invalid. */
+    void remove_by_index( size_t index )
+    {
+      if( index >= get_size() )
+        throw tight_buffer_manager_invalid_element_index( __FILE__, __LINE__ );
+      remove_entry( m_handles.get_element_to_handle()[ index ] );
+    }
+
+    /**@brief Get the fields of an element by its handle.
+     *
+     * @param h The handle to the element.
+     * @note An exception is thrown if the handle is invalid. */
+    reference get( handle h )
+    {
+      return get_by_index( get_index( h ) );
+    }
+
+    /**@brief Get a field of an element by its handle.
+     *
+     * @param h The handle to the element.
+     * @note An exception is thrown if the handle is invalid. */
+    template< size_t field >
+    field_type< field >& get( handle h )
+    {
+      return std::get< field >( m_columns )[ get_index( h ) ];
+    }
+
+    /**@brief Get the index of an element in the columns.
+     *
+     * @param h The handle to the element.
+     * @note An exception is thrown if the handle is invalid. */
+    size_t get_index( handle h ) const
+    {
+      return m_handles.get_element_index( h );
+    }
+
+    /**@brief Get the fields of an element by its index.
+     *
+     * @param index Index of the element in the columns.
+     * @note An exception is thrown if the index is invalid. */
+    reference get_by_index( size_t index )
+    {
+      if( index >= get_size() )
+        throw tight_buffer_manager_invalid_element_index( __FILE__, __LINE__ );
+      return get_by_index( index, std::index_sequence_for< fields... >{} );
+    }
+
+    /**@brief Get the handle of an element designated by its index.
+     *
+     * @param index Index of the element in the columns. */
+    handle get_handle( size_t index ) const
+    {
+      return m_handles.get_handle( index );
+    }
+
+    /**@brief Get a view on a column.
+     *
+     * @tparam field The position of the field in the template parameters. */
+    template< size_t field >
+    tight_buffer_column< field_type< field > > column() noexcept
+    {
+      return tight_buffer_column< field_type< field > >( std::get< field >( m_columns ), get_size() );
+    }
+
+    template< size_t field >
+    tight_buffer_column< const field_type< field > > column() const noexcept
+    {
+      return tight_buffer_column< const field_type< field > >( std::get< field >( m_columns ), get_size() );
+    }
+
+    /**@brief Get the start of a column.
+     *
+     * @tparam field The position of the field in the template parameters. */
+    template< size_t field >
+    field_type< field >* data() noexcept
+    {
+      return std::get< field >( m_columns );
+    }
+
+    /**@brief Sort elements according to one of their fields.
+     *
+     * The keys are sorted first, then each column is permuted once. The
+     * handles remain valid. The permutation and the buffers used to permute
+     * the columns are kept between calls, so that sorting at each frame does
+     * not allocate once the buffers are large enough.
+     * @tparam field The position of the key in the template parameters.
+     * @param f A strict weak ordering on the keys. */
+    template< size_t field, typename strict_weak_ordering >
+    void sort( const strict_weak_ordering& f )
+    {
+      const size_t size = get_size();
+      if( m_sort_permutation.size() < size )
+        m_sort_permutation.resize( size );
+      size_t* order = m_sort_permutation.data();
+      for( size_t i = 0; i < size; ++ i )
+        order[ i ] = i;
+
+      thrust::sort(
+# ifdef _MSC_VER
+          GO_MSVC_OMP_THRUST_BUGS
+          WARN("using single thread implementation instead")
+          thrust::cpp::par,
+# else
+          thrust::omp::par,
+# endif
+          order, order + size,
+          index_comparison< field_type< field >, strict_weak_ordering >( std::get< field >( m_columns ), f ) );
+
+      permute_columns( order, std::index_sequence_for< fields... >{} );
+      m_handles.permute( order );
+    }
+
+  private:
+    /**Grow the columns, if needed, to have room for count more elements */
+    void reserve_for( size_t count )
+    {
+      const size_t new_capacity = m_handles.get_capacity_for( count, commit_granularity );
+      if( new_capacity > get_capacity() )
+        grow( new_capacity );
+    }
+
+    void remove_entry( size_t entry_index )
+    {
+      const size_t element_index = m_handles.remove( entry_index );
+      const size_t last = get_size();
+      if( element_index != last )
+        for_each_column( [element_index,last]( auto& column )
+        {
+          column[ element_index ] = std::move( column[ last ] );
+        });
+    }
+
+    /**Move the elements at order[i] to i in a column, through a sort buffer */
+    template< typename type >
+    void permute_column( type* column, std::vector< type >& buffer, const size_t* order )
+    {
+      const size_t size = get_size();
+      if( buffer.size() < size )
+        buffer.resize( size );
+# ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      # pragma omp parallel for
+      for( long i = 0; i < size; ++ i )
+# else
+      # pragma omp parallel for
+      for( size_t i = 0; i < size; ++ i )
+# endif
+        buffer[ i ] = std::move( column[ order[ i ] ] );
+      std::move( buffer.begin(), buffer.begin() + size, column );
+    }
+
+    template< size_t... field >
+    void permute_columns( const size_t* order, std::index_sequence< field... > )
+    {
+      using expander = int[];
+      (void)expander{ 0, ( permute_column( std::get< field >( m_columns ), std::get< field >( m_sort_buffers ), order ), 0 )... };
+    }
+
+    template< size_t... field >
+    reference get_by_index( size_t index, std::index_sequence< field... > )
+    {
+      return reference( std::get< field >( m_columns )[ index ]... );
+    }
+
+    template< typename function, size_t... field >
+    void for_each_column( function&& f, std::index_sequence< field... > )
+    {
+      using expander = int[];
+      (void)expander{ 0, ( f( std::get< field >( m_columns ) ), 0 )... };
+    }
+
+    template< typename function >
+    void for_each_column( function&& f )
+    {
+      for_each_column( f, std::index_sequence_for< fields... >{} );
+    }
+
+    void release_address_space()
+    {
+      for_each_column( []( auto& column )
+      {
+        if( column )
+          virtual_memory::free_address_space( column, max_index * sizeof(*column) );
+      });
+    }
+
+    void grow( size_t new_capacity )
+    {
+      m_handles.check_growth( new_capacity );
+      const size_t capacity = get_capacity();
+      if( get_growth() == tight_buffer_growth::commit_in_place )
+        {
+          for_each_column( [capacity,new_capacity]( auto& column )
+          {
+            typedef typename std::remove_reference< decltype(*column) >::type type;
+            detail::commit_tight_buffer( column, capacity * sizeof(type), new_capacity * sizeof(type) );
+            for( size_t i = capacity; i < new_capacity; ++ i )
+              new (column + i) type;
+          });
+        }
+      else
+        {
+          const size_t size = get_size();
+          for_each_column( [size,new_capacity]( auto& column )
+          {
+            typedef typename std::remove_reference< decltype(*column) >::type type;
+            type* new_column = new type[ new_capacity ];
+            if( column )
+              std::move( column, column + size, new_column );
+            delete[] column;
+            column = new_column;
+          });
+        }
+      m_handles.grow( new_capacity );
+    }
+
+    handle_table m_handles;
+    std::tuple< fields*... > m_columns;
+    std::vector< size_t > m_sort_permutation;
+    std::tuple< std::vector< fields >... > m_sort_buffers;
+  };
+
+  template< typename handle_type, uint8_t index_bits, class... fields >
+  constexpr size_t tight_soa_buffer_manager<handle_type,index_bits,fields...>::max_index;
+
+  template< typename handle_type, uint8_t index_bits, class... fields >
+  constexpr size_t tight_soa_buffer_manager<handle_type,index_bits,fields...>::commit_granularity;
+
+} END_GO_NAMESPACE
+# endif
@@ -6,34 +6,6 @@
 
 namespace graphics_origin { namespace application {
 
-  balls_renderable::storage::storage( const gl_vec4& ball, const gl_vec4& color )
-    : ball{ ball }, color{ color }
-  {}
-
-  balls_renderable::storage::storage()
-    : ball{}, color{}
-  {}
-
-  balls_renderable::storage&
-  balls_renderable::storage::operator=( storage&& other )
-  {
-    ball  = other.ball ;
-    color = other.color;
-    return *this;
-  }
-
-  balls_renderable::storage&
-  balls_renderable::storage::operator=( const storage& other )
-  {
-    ball  = std::move(other.ball) ;
-    color = std::move(other.color);
-    return *this;
-  }
-
-  balls_renderable::storage::storage( const storage& other )
-    : ball{ other.ball }, color{ other.color }
-  {}
-
   balls_renderable::balls_renderable(
       shader_program_ptr program,
       size_t expected_number_of_balls )
@@ -48,10 +20,7 @@ namespace graphics_origin { namespace application {
   balls_renderable::add( const geometry::ball& ball, const gl_vec4& color )
   {
     m_dirty = true;
-    auto pair = m_balls.create();
-    pair.second.ball = gl_vec4{ ball };
-    pair.second.color  = color;
-    return pair.first;
+    return m_balls.create( gl_vec4{ ball }, color );
   }
 
   void
@@ -73,20 +42,24 @@ namespace graphics_origin { namespace application {
     int ball_location  = program->get_attribute_location(  "ball_attribute" );
     int color_location = program->get_attribute_location( "color_attribute" );
 
+    const auto balls = m_balls.column< ball_column >();
+    const auto colors = m_balls.column< color_column >();
     glcheck(glBindVertexArray( m_vao ));
       glcheck(glBindBuffer( GL_ARRAY_BUFFER, m_balls_vbo ));
-      glcheck(glBufferData( GL_ARRAY_BUFFER, sizeof(storage) * m_balls.get_size(), m_balls.data(), GL_STATIC_DRAW ));
+      glcheck(glBufferData( GL_ARRAY_BUFFER, balls.size_in_bytes() + colors.size_in_bytes(), nullptr, GL_STATIC_DRAW ));
+      glcheck(glBufferSubData( GL_ARRAY_BUFFER, 0, balls.size_in_bytes(), balls.data() ));
+      glcheck(glBufferSubData( GL_ARRAY_BUFFER, balls.size_in_bytes(), colors.size_in_bytes(), colors.data() ));
       glcheck(glEnableVertexAttribArray( ball_location ));
       glcheck(glVertexAttribPointer( ball_location,        // format of ball:
         4, GL_FLOAT, GL_FALSE,                             // 4 unnormalized floats
-        sizeof(storage),                                   // each attribute has the size of storage
-        reinterpret_cast<void*>(offsetof(storage,ball)))); // offset of the center inside an attribute
+        0,                                                 // balls are tightly packed
+        reinterpret_cast<void*>(0)));                      // the balls stream starts the buffer
 
       glcheck(glEnableVertexAttribArray( color_location ));
       glcheck(glVertexAttribPointer( color_location,       // format of color:
         4, GL_FLOAT, GL_FALSE,                             // 4 unnormalized floats
-        sizeof(storage),                                   // each attribute has the size of storage
-        reinterpret_cast<void*>(offsetof(storage,color))));// offset of the color inside an attribute
+        0,                                                 // colors are tightly packed
+        reinterpret_cast<void*>(balls.size_in_bytes())));  // the colors stream follows the balls one
     glcheck(glBindVertexArray( 0 ));
   }
 
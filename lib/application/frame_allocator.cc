@@ -0,0 +1,139 @@
+/* Created on: Oct 19, 2026
+ *     Author: T.Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/application/frame_allocator.h"
+# include "../../graphics-origin/tools/log.h"
+# include <cstdlib>
+
+namespace graphics_origin {
+namespace application {
+
+  frame_allocator::statistics::statistics()
+    : frame{ 0 }, number_of_allocations{ 0 }, number_of_overflows{ 0 },
+      used_bytes{ 0 }, overflow_bytes{ 0 }, capacity{ 0 }
+  {}
+
+  frame_allocator::buffer::buffer( size_t capacity )
+    : area{ capacity }, allocator{ area }, arena{ &allocator },
+      overflows{}, stats{}, quiet_frames{ 0 }, quiet_peak_usage{ 0 }
+  {
+    stats.capacity = capacity;
+  }
+
+  frame_allocator::buffer::~buffer()
+  {
+    release_overflows();
+  }
+
+  void frame_allocator::buffer::release_overflows()
+  {
+    for( auto ptr : overflows )
+      std::free( ptr );
+    overflows.clear();
+  }
+
+  frame_allocator::frame_allocator( size_t capacity )
+    : m_buffers{ std::unique_ptr< buffer >{ new buffer( capacity ) }, std::unique_ptr< buffer >{ new buffer( capacity ) } },
+      m_last_frame{}, m_initial_capacity{ capacity }, m_peak_usage{ 0 }, m_frame{ 0 }, m_current{ 0 }
+  {}
+
+  frame_allocator::~frame_allocator()
+  {}
+
+  void* frame_allocator::allocate(
+      size_t size_in_bytes,
+      size_t alignment,
+      const char* file,
+      const char* line,
+      const char* function )
+  {
+    buffer& b = *m_buffers[ m_current ];
+    ++ b.stats.number_of_allocations;
+    void* result = b.arena.allocate( size_in_bytes, alignment, file, line, function );
+    if( result )
+      {
+        b.stats.used_bytes = b.allocator.get_used_memory();
+        return result;
+      }
+
+    // the arena is full: fall back to the heap until the arena is enlarged
+    const size_t overflow_size = size_in_bytes + alignment;
+    void* plain_memory = std::malloc( overflow_size );
+    if( !plain_memory )
+      return nullptr;
+    b.overflows.push_back( plain_memory );
+    ++ b.stats.number_of_overflows;
+    b.stats.overflow_bytes += overflow_size;
+    return tools::detail::align( plain_memory, alignment );
+  }
+
+  void frame_allocator::next_frame()
+  {
+    m_last_frame = m_buffers[ m_current ]->stats;
+    const size_t usage = m_last_frame.used_bytes + m_last_frame.overflow_bytes;
+    if( usage > m_peak_usage )
+      m_peak_usage = usage;
+
+    ++ m_frame;
+    m_current = 1 - m_current;
+    std::unique_ptr< buffer >& b = m_buffers[ m_current ];
+    const size_t needed = b->stats.used_bytes + b->stats.overflow_bytes;
+    if( needed <= b->stats.capacity / 4 && b->stats.capacity > m_initial_capacity )
+      {
+        // a buffer is reset every other frame: two frames elapsed since its last reset
+        b->quiet_frames += 2;
+        if( needed > b->quiet_peak_usage )
+          b->quiet_peak_usage = needed;
+      }
+    else
+      {
+        b->quiet_frames = 0;
+        b->quiet_peak_usage = 0;
+      }
+
+    if( b->stats.overflow_bytes )
+      {
+        // enlarge the arena such that the frame that used it would have fit
+        size_t capacity = b->stats.capacity;
+        while( capacity < needed )
+          capacity <<= 1;
+        LOG( debug, "frame allocator enlarged from " << b->stats.capacity << " to " << capacity << " bytes" );
+        b.reset();
+        b.reset( new buffer( capacity ) );
+      }
+    else if( b->quiet_frames >= quiet_frames_before_shrinking )
+      {
+        // shrink the arena such that the quiet frames would use half of it
+        size_t capacity = m_initial_capacity;
+        while( capacity < 2 * b->quiet_peak_usage )
+          capacity <<= 1;
+        LOG( debug, "frame allocator shrunk from " << b->stats.capacity << " to " << capacity << " bytes" );
+        b.reset();
+        b.reset( new buffer( capacity ) );
+      }
+    else
+      {
+        b->allocator.reset();
+        b->stats = statistics{};
+        b->stats.capacity = b->allocator.get_capacity();
+      }
+    b->stats.frame = m_frame;
+  }
+
+  const frame_allocator::statistics& frame_allocator::get_current_frame_statistics() const
+  {
+    return m_buffers[ m_current ]->stats;
+  }
+
+  const frame_allocator::statistics& frame_allocator::get_last_frame_statistics() const
+  {
+    return m_last_frame;
+  }
+
+  size_t frame_allocator::get_peak_usage() const
+  {
+    return m_peak_usage;
+  }
+
+}
+}
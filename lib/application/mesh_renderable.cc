@@ -27,7 +27,7 @@ namespace graphics_origin { namespace application {
       }
 
     const auto nvertices = m_mesh.n_vertices();
-    std::vector< gl_real > positions_normals( nvertices * 6 ); // fvec3 + fvec3
+    frame_vector< gl_real > positions_normals( nvertices * 6, renderer_ptr->get_frame_allocator() ); // fvec3 + fvec3
 # ifdef _WIN32
 # pragma message("MSVC does not allow unsigned index variable in OpenMP for statement")
 # pragma omp parallel for
@@ -51,7 +51,7 @@ namespace graphics_origin { namespace application {
       }
 
     const auto nfaces = m_mesh.n_faces();
-    std::vector< unsigned int > indices( nfaces * 3 );
+    frame_vector< unsigned int > indices( nfaces * 3, renderer_ptr->get_frame_allocator() );
 # ifdef _WIN32
 # pragma message("MSVC does not allow unsigned index variable in OpenMP for statement")
 # pragma omp parallel for schedule(static)
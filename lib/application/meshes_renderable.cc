@@ -3,6 +3,8 @@
 # include "../../graphics-origin/application/camera.h"
 # include "../../graphics-origin/application/renderer.h"
 # include "../../graphics-origin/geometry/mesh.h"
+# include "../../graphics-origin/geometry/index_buffer_optimization.h"
+# include "../../graphics-origin/tools/log.h"
 
 # include <GL/glew.h>
 
@@ -39,6 +41,7 @@ namespace graphics_origin {
     }
 
     meshes_renderable::meshes_renderable( shader_program_ptr program )
+      : m_optimize_index_buffers{ false }
     {
       model = gl_mat4(1.0);
       this->program = program;
@@ -63,8 +66,13 @@ namespace graphics_origin {
     void
     meshes_renderable::update_gpu_data()
     {
-      std::vector< gl_real > positions_normals;
-      std::vector< unsigned int > indices;
+      frame_allocator& frame_memory = renderer_ptr->get_frame_allocator();
+      frame_vector< gl_real > positions_normals( frame_memory );
+      frame_vector< uint32_t > indices( frame_memory );
+      frame_vector< gl_real > reordered_positions_normals( frame_memory );
+      frame_vector< uint32_t > reordered_indices( frame_memory );
+      frame_vector< uint32_t > clusters( frame_memory );
+      frame_vector< uint32_t > remap( frame_memory );
       storage* data = m_meshes.data();
       for( size_t i = 0; i < m_meshes.get_size(); ++i, ++data)
         {
@@ -74,8 +82,8 @@ namespace graphics_origin {
               glcheck( glDeleteBuffers( number_of_buffers, data->buffer_ids ));
               // reset the storage
               *data = storage{};
-              // remove from the buffer
-              m_meshes.remove( data );
+              // removing now would move the last element here and skip it
+              m_meshes.mark_for_removal( data );
             }
           else
             {
@@ -128,6 +136,29 @@ namespace graphics_origin {
                       dst[ 2 ] = fvit->idx();
                     }
 
+                  if( m_optimize_index_buffers )
+                    {
+                      const auto before = geometry::analyze_vertex_cache( indices.data(), indices.size(), nvertices );
+                      reordered_indices.resize( indices.size() );
+                      clusters.resize( nfaces );
+                      const size_t nclusters = geometry::optimize_vertex_cache(
+                          reordered_indices.data(), indices.data(), indices.size(), nvertices,
+                          16, clusters.data() );
+                      geometry::optimize_overdraw(
+                          indices.data(), reordered_indices.data(), indices.size(),
+                          positions_normals.data(), nvertices, 6, clusters.data(), nclusters );
+                      remap.resize( nvertices );
+                      geometry::optimize_vertex_fetch( remap.data(), indices.data(), indices.size(), nvertices );
+                      reordered_positions_normals.resize( positions_normals.size() );
+                      geometry::remap_vertex_buffer(
+                          reordered_positions_normals.data(), positions_normals.data(),
+                          nvertices, 6 * sizeof( gl_real ), remap.data() );
+                      positions_normals.swap( reordered_positions_normals );
+                      const auto after = geometry::analyze_vertex_cache( indices.data(), indices.size(), nvertices );
+                      LOG( info, "mesh index buffer optimized: ACMR " << before.acmr << " -> " << after.acmr
+                           << ", ATVR " << before.atvr << " -> " << after.atvr );
+                    }
+
                   int position_location = program->get_attribute_location( "position" );
                   int   normal_location = program->get_attribute_location( "normal"   );
 
@@ -148,12 +179,14 @@ namespace graphics_origin {
                       reinterpret_cast<void*>( 3 * sizeof( gl_real ))));
 
                     glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data->buffer_ids[ indices_vbo ]));
-                    glcheck(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW ));
+                    glcheck(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW ));
                   glcheck(glBindVertexArray( 0 ));
+                  data->dirty = false;
                 }
 
             }
         }
+      m_meshes.collect();
     }
 
     void
@@ -201,5 +234,18 @@ namespace graphics_origin {
      {
        return m_meshes.get( h );
      }
+
+     void
+     meshes_renderable::set_index_buffer_optimization( bool optimize )
+     {
+       if( optimize != m_optimize_index_buffers )
+         {
+           m_optimize_index_buffers = optimize;
+           storage* data = m_meshes.data();
+           for( size_t i = 0; i < m_meshes.get_size(); ++ i, ++ data )
+             data->dirty = true;
+           set_dirty();
+         }
+     }
   }
 }
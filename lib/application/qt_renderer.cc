@@ -20,7 +20,7 @@ namespace graphics_origin {
         frame_buffer_objects{ 0, 0 }, color_textures{ 0, 0 },
 # endif
         depth_render_buffer{ 0 },
-        gl_camera( nullptr ),
+        gl_camera( nullptr ), frame_memory{},
         size_changed( 0 ), is_running( 1 ), width( 0 ), height( 0 ), samples(4)
     {}
 
@@ -86,11 +86,17 @@ namespace graphics_origin {
       return gl_vec2{ width, height };
     }
 
+    frame_allocator& renderer::get_frame_allocator()
+    {
+      return frame_memory;
+    }
+
     // when the texture node is using the texture of the display FBO,
     // it sends a queued signal that execute the following function
     void renderer::render_next()
     {
       period.tick();
+      frame_memory.next_frame();
       context->makeCurrent( surface );
 
       if( !frame_buffer_objects[0] )
@@ -47,7 +47,7 @@ namespace graphics_origin { namespace application {
     const auto nvertices = nfaces * 3;
     const auto attribute_dimension = 8; // fvec3 + fvec3 + fvec2
     const auto attribute_size = attribute_dimension * sizeof(gl_real);
-    std::vector< gl_real > attributes( nvertices * attribute_dimension );
+    frame_vector< gl_real > attributes( nvertices * attribute_dimension, renderer_ptr->get_frame_allocator() );
 # ifdef _WIN32
 # pragma message("MSVC does not allow unsigned index variable in OpenMP for statement")
 # pragma omp parallel for
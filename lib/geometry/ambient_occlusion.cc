@@ -0,0 +1,186 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/ambient_occlusion.h"
+# include "../../graphics-origin/geometry/mesh.h"
+# include "../../graphics-origin/geometry/ray.h"
+# include "../../graphics-origin/geometry/detail/sampling.h"
+
+# include <algorithm>
+# include <cmath>
+# include <memory>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Number of points processed together. This bounds the memory used by
+     * the rays of a round. */
+    constexpr size_t ambient_occlusion_chunk_size = 1 << 16;
+
+    /**Cosine distributed direction around a normal, from two numbers in
+     * [0,1). The tangent frame is built without branch, with the method of
+     * Duff et al. */
+    inline vec3 get_cosine_direction( const vec3& n, real u, real v )
+    {
+      const real sign = std::copysign( real(1), n.z );
+      const real a = real(-1) / ( sign + n.z );
+      const real b = n.x * n.y * a;
+      const vec3 tangent{ real(1) + sign * n.x * n.x * a, sign * b, -sign * n.x };
+      const vec3 bitangent{ b, sign + n.y * n.y * a, -n.y };
+
+      const real radius = std::sqrt( u );
+      const real angle = real(2 * M_PI) * v;
+      return radius * std::cos( angle ) * tangent
+           + radius * std::sin( angle ) * bitangent
+           + std::sqrt( std::max( real(0), real(1) - u ) ) * n;
+    }
+  }
+
+  ambient_occlusion_parameters::ambient_occlusion_parameters()
+    : min_rays{ 32 }, max_rays{ 512 }, max_standard_error{ 0.02 },
+      max_distance{ REAL_MAX }, bias{ 1e-5 }, seed{ 0 }
+  {}
+
+  void bake_ambient_occlusion(
+      const mesh_spatial_optimization& m,
+      const vec3* points, const vec3* normals, size_t npoints,
+      const ambient_occlusion_parameters& parameters,
+      real* occlusion, vec3* bent_normals, uint32_t* nrays )
+  {
+    const uint32_t rays_per_round = std::max( parameters.min_rays, uint32_t(1) );
+    const real offset = parameters.bias * real(2) * length( m.get_bounding_box().hsides );
+    const real max_squared_error = parameters.max_standard_error * parameters.max_standard_error;
+
+    const size_t max_chunk_size = std::min( npoints, ambient_occlusion_chunk_size );
+    std::vector< ray > rays( max_chunk_size * rays_per_round, ray( vec3{ 0, 0, 0 }, vec3{ 0, 0, 1 } ) );
+    std::vector< real > max_distances( rays.size(), parameters.max_distance );
+    std::unique_ptr< bool[] > occluded( new bool[ rays.size() ] );
+    std::vector< uint32_t > hits( max_chunk_size ), counts( max_chunk_size );
+    std::vector< vec3 > directions( max_chunk_size );
+    std::vector< uint32_t > active( max_chunk_size ), next_active;
+
+    for( size_t chunk = 0; chunk < npoints; chunk += max_chunk_size )
+      {
+        const size_t chunk_size = std::min( max_chunk_size, npoints - chunk );
+        for( size_t i = 0; i < chunk_size; ++ i )
+          active[ i ] = uint32_t( i );
+        active.resize( chunk_size );
+        std::fill( hits.begin(), hits.end(), 0 );
+        std::fill( counts.begin(), counts.end(), 0 );
+        std::fill( directions.begin(), directions.end(), vec3{ 0, 0, 0 } );
+
+        while( !active.empty() )
+          {
+            // generate the rays of active points
+            const size_t nactive = active.size();
+            # ifdef _MSC_VER
+            GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+            #   pragma omp parallel for schedule(static)
+            for( long i = 0; i < long(nactive); ++ i )
+            # else
+            #   pragma omp parallel for schedule(static)
+            for( size_t i = 0; i < nactive; ++ i )
+            # endif
+              {
+                const size_t point = chunk + active[ i ];
+                const uint64_t rotation = detail::mix_seed( parameters.seed, point );
+                real u = real( rotation >> 32 ) / real( uint64_t(1) << 32 );
+                real v = real( rotation & 0xFFFFFFFFull ) / real( uint64_t(1) << 32 );
+                const uint32_t first = counts[ active[ i ] ];
+                u += real( first ) * detail::r2_first_increment;
+                v += real( first ) * detail::r2_second_increment;
+                const vec3 origin = points[ point ] + offset * normals[ point ];
+                for( uint32_t j = 0; j < rays_per_round; ++ j )
+                  {
+                    u += detail::r2_first_increment;
+                    v += detail::r2_second_increment;
+                    u -= std::floor( u );
+                    v -= std::floor( v );
+                    rays[ i * rays_per_round + j ] = ray( origin, get_cosine_direction( normals[ point ], u, v ) );
+                  }
+              }
+
+            m.occlude( rays.data(), max_distances.data(), nactive * rays_per_round, occluded.get() );
+
+            // accumulate the results and keep points whose estimate is not accurate enough
+            next_active.clear();
+            # pragma omp parallel
+            {
+              std::vector< uint32_t > thread_active;
+              # ifdef _MSC_VER
+              GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+              #   pragma omp for schedule(static)
+              for( long i = 0; i < long(nactive); ++ i )
+              # else
+              #   pragma omp for schedule(static)
+              for( size_t i = 0; i < nactive; ++ i )
+              # endif
+                {
+                  const uint32_t point = active[ i ];
+                  for( uint32_t j = 0; j < rays_per_round; ++ j )
+                    if( occluded[ i * rays_per_round + j ] )
+                      ++ hits[ point ];
+                    else
+                      directions[ point ] += rays[ i * rays_per_round + j ].get_direction();
+                  counts[ point ] += rays_per_round;
+
+                  const real n = real( counts[ point ] );
+                  const real p = real( hits[ point ] ) / n;
+                  if( counts[ point ] + rays_per_round <= parameters.max_rays
+                   && p * ( real(1) - p ) > max_squared_error * n )
+                    thread_active.push_back( point );
+                }
+              # pragma omp critical
+              next_active.insert( next_active.end(), thread_active.begin(), thread_active.end() );
+            }
+            // keep the order of points, so that rays of a round are coherent
+            std::sort( next_active.begin(), next_active.end() );
+            active.swap( next_active );
+          }
+
+        for( size_t i = 0; i < chunk_size; ++ i )
+          {
+            occlusion[ chunk + i ] = real( hits[ i ] ) / real( counts[ i ] );
+            if( bent_normals )
+              {
+                const real norm = length( directions[ i ] );
+                bent_normals[ chunk + i ] = norm > 0 ? directions[ i ] / norm : normals[ chunk + i ];
+              }
+            if( nrays )
+              nrays[ chunk + i ] = counts[ i ];
+          }
+      }
+  }
+
+  void bake_ambient_occlusion(
+      mesh_spatial_optimization& m,
+      const ambient_occlusion_parameters& parameters,
+      std::vector< vec3 >* bent_normals )
+  {
+    mesh& geometry = m.get_geometry();
+    const size_t nvertices = geometry.n_vertices();
+    std::vector< vec3 > points, normals;
+    m.copy_vertices( points, normals );
+
+    std::vector< real > occlusion( nvertices );
+    if( bent_normals )
+      bent_normals->resize( nvertices );
+    bake_ambient_occlusion(
+        m, points.data(), normals.data(), nvertices, parameters,
+        occlusion.data(), bent_normals ? bent_normals->data() : nullptr );
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nvertices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nvertices; ++ i )
+    # endif
+      {
+        const real accessibility = real(1) - occlusion[ i ];
+        geometry.set_color( mesh::VertexHandle( int( i ) ), mesh::Color( accessibility, accessibility, accessibility, 1 ) );
+      }
+  }
+
+} END_GO_NAMESPACE
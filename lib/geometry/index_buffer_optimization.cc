@@ -0,0 +1,380 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/index_buffer_optimization.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/tools/assert.h"
+
+# include <algorithm>
+# include <numeric>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  vertex_cache_statistics::vertex_cache_statistics()
+    : transformed_vertices{ 0 }, acmr{ 0 }, atvr{ 0 }
+  {}
+
+  vertex_cache_statistics
+  analyze_vertex_cache( const uint32_t* indices, size_t nindices, size_t nvertices, size_t cache_size )
+  {
+    vertex_cache_statistics result;
+    // a vertex is in the cache if it was inserted less than cache_size
+    // insertions ago
+    std::vector< size_t > insertion_time( nvertices, 0 );
+    size_t time = cache_size + 1;
+    size_t referenced = 0;
+    for( size_t i = 0; i < nindices; ++ i )
+      {
+        const uint32_t v = indices[ i ];
+        if( !insertion_time[ v ] )
+          ++referenced;
+        if( time - insertion_time[ v ] > cache_size )
+          {
+            insertion_time[ v ] = time++;
+            ++result.transformed_vertices;
+          }
+      }
+    const size_t ntriangles = nindices / 3;
+    result.acmr = ntriangles ? real( result.transformed_vertices ) / real( ntriangles ) : real(0);
+    result.atvr = referenced ? real( result.transformed_vertices ) / real( referenced ) : real(0);
+    return result;
+  }
+
+  namespace {
+    /**Triangles incident to each vertex, stored in a compressed sparse row
+     * format. Unlike vertex_face_adjacency, this is built sequentially since
+     * it is only used by sequential algorithms. */
+    struct triangle_adjacency {
+      triangle_adjacency( const uint32_t* indices, size_t nindices, size_t nvertices )
+        : offsets( nvertices + 1, 0 ), triangles( nindices )
+      {
+        for( size_t i = 0; i < nindices; ++ i )
+          ++offsets[ indices[ i ] + 1 ];
+        std::partial_sum( offsets.begin(), offsets.end(), offsets.begin() );
+        std::vector< uint32_t > cursors( offsets.begin(), offsets.end() - 1 );
+        for( size_t i = 0; i < nindices; ++ i )
+          triangles[ cursors[ indices[ i ] ]++ ] = uint32_t( i / 3 );
+      }
+      std::vector< uint32_t > offsets;
+      std::vector< uint32_t > triangles;
+    };
+  }
+
+  size_t
+  optimize_vertex_cache(
+      uint32_t* destination, const uint32_t* indices, size_t nindices, size_t nvertices,
+      size_t cache_size, uint32_t* clusters )
+  {
+    const size_t ntriangles = nindices / 3;
+    if( !ntriangles )
+      return 0;
+
+    triangle_adjacency adjacency( indices, nindices, nvertices );
+    // number of triangles not yet emitted around each vertex
+    std::vector< uint32_t > live( nvertices );
+    for( size_t i = 0; i < nvertices; ++ i )
+      live[ i ] = adjacency.offsets[ i + 1 ] - adjacency.offsets[ i ];
+    std::vector< size_t > cache_time( nvertices, 0 );
+    std::vector< bool > emitted( ntriangles, false );
+    std::vector< uint32_t > dead_end_stack;
+    dead_end_stack.reserve( nindices );
+    std::vector< uint32_t > candidates;
+    candidates.reserve( 64 );
+
+    size_t time = cache_size + 1;
+    size_t output = 0;
+    size_t cursor = 0;
+    int64_t fanning = indices[ 0 ];
+    size_t nclusters = 1;
+    if( clusters )
+      clusters[ 0 ] = 0;
+
+    while( fanning >= 0 )
+      {
+        candidates.clear();
+        const uint32_t* t = adjacency.triangles.data() + adjacency.offsets[ fanning ];
+        const uint32_t* tend = adjacency.triangles.data() + adjacency.offsets[ fanning + 1 ];
+        for( ; t != tend; ++ t )
+          {
+            if( emitted[ *t ] )
+              continue;
+            emitted[ *t ] = true;
+            const uint32_t* triangle = indices + 3 * (*t);
+            for( int k = 0; k < 3; ++ k )
+              {
+                const uint32_t v = triangle[ k ];
+                destination[ output++ ] = v;
+                dead_end_stack.push_back( v );
+                candidates.push_back( v );
+                --live[ v ];
+                if( time - cache_time[ v ] > cache_size )
+                  cache_time[ v ] = time++;
+              }
+          }
+
+        // select the next fanning vertex among the candidates: the one that
+        // will stay in the cache while fanning around it and that is the
+        // oldest in the cache.
+        int64_t next = -1;
+        size_t best_priority = 0;
+        for( auto v : candidates )
+          {
+            if( !live[ v ] )
+              continue;
+            size_t priority = 0;
+            if( time - cache_time[ v ] + 2 * live[ v ] <= cache_size )
+              priority = time - cache_time[ v ];
+            if( next < 0 || priority > best_priority )
+              {
+                best_priority = priority;
+                next = v;
+              }
+          }
+
+        if( next < 0 )
+          {
+            // dead end: restart from a recently used vertex or scan the input
+            while( !dead_end_stack.empty() && next < 0 )
+              {
+                const uint32_t v = dead_end_stack.back();
+                dead_end_stack.pop_back();
+                if( live[ v ] )
+                  next = v;
+              }
+            while( next < 0 && cursor < nvertices )
+              {
+                if( live[ cursor ] )
+                  next = cursor;
+                ++cursor;
+              }
+            if( next >= 0 )
+              {
+                if( clusters )
+                  clusters[ nclusters ] = uint32_t( output / 3 );
+                ++nclusters;
+              }
+          }
+        fanning = next;
+      }
+    GO_ASSERT( output == 3 * ntriangles, "some triangles were not emitted")(output, ntriangles);
+    return nclusters;
+  }
+
+  namespace {
+
+    struct gl_real_position_accessor {
+      vec3 operator()( uint32_t v ) const
+      {
+        const gl_real* p = positions + v * stride;
+        return vec3{ p[0], p[1], p[2] };
+      }
+      const gl_real* positions;
+      size_t stride;
+    };
+
+    struct vec3_position_accessor {
+      const vec3& operator()( uint32_t v ) const
+      {
+        return positions[ v ];
+      }
+      const vec3* positions;
+    };
+
+    /**Split clusters where the cache efficiency allows it. The ACMR of a
+     * cluster prefix is compared to the ACMR of the whole cluster: when the
+     * prefix is efficient enough, it becomes a cluster on its own. */
+    void compute_soft_boundaries(
+        std::vector< uint32_t >& soft_clusters,
+        const uint32_t* indices, size_t nindices, size_t nvertices,
+        const uint32_t* clusters, size_t nclusters, size_t cache_size, real threshold )
+    {
+      const size_t ntriangles = nindices / 3;
+      std::vector< size_t > cache_time( nvertices, 0 );
+      size_t time = cache_size + 1;
+      soft_clusters.clear();
+      for( size_t c = 0; c < nclusters; ++ c )
+        {
+          const size_t start = clusters[ c ];
+          const size_t end = c + 1 < nclusters ? clusters[ c + 1 ] : ntriangles;
+          if( start >= end )
+            continue;
+
+          // the ACMR of the whole cluster, starting with a cold cache
+          time += cache_size + 1;
+          size_t misses = 0;
+          for( size_t i = start * 3; i < end * 3; ++ i )
+            if( time - cache_time[ indices[ i ] ] > cache_size )
+              {
+                cache_time[ indices[ i ] ] = time++;
+                ++misses;
+              }
+          const real cluster_acmr = real( misses ) / real( end - start );
+
+          time += cache_size + 1;
+          misses = 0;
+          size_t sub_start = start;
+          soft_clusters.push_back( uint32_t( start ) );
+          for( size_t t = start; t < end; ++ t )
+            {
+              for( size_t k = 0; k < 3; ++ k )
+                if( time - cache_time[ indices[ 3 * t + k ] ] > cache_size )
+                  {
+                    cache_time[ indices[ 3 * t + k ] ] = time++;
+                    ++misses;
+                  }
+              // the next cluster restarts with a cold cache
+              if( t + 1 < end && real( misses ) / real( t + 1 - sub_start ) <= threshold * cluster_acmr )
+                {
+                  time += cache_size + 1;
+                  misses = 0;
+                  sub_start = t + 1;
+                  soft_clusters.push_back( uint32_t( sub_start ) );
+                }
+            }
+        }
+    }
+
+    template< typename position_accessor >
+    void optimize_overdraw_impl(
+        uint32_t* destination, const uint32_t* indices, size_t nindices,
+        const position_accessor& position, size_t nvertices,
+        const uint32_t* clusters, size_t nclusters, size_t cache_size, real threshold )
+    {
+      const size_t ntriangles = nindices / 3;
+      if( !ntriangles )
+        return;
+
+      std::vector< uint32_t > soft_clusters;
+      const uint32_t whole_buffer = 0;
+      if( !nclusters )
+        compute_soft_boundaries( soft_clusters, indices, nindices, nvertices, &whole_buffer, 1, cache_size, threshold );
+      else
+        compute_soft_boundaries( soft_clusters, indices, nindices, nvertices, clusters, nclusters, cache_size, threshold );
+      const size_t nsoft_clusters = soft_clusters.size();
+
+      // area weighted centroid of the mesh
+      vec3 mesh_centroid{ 0, 0, 0 };
+      real mesh_area = 0;
+      std::vector< vec3 > centroids( nsoft_clusters ), normals( nsoft_clusters );
+      for( size_t c = 0; c < nsoft_clusters; ++ c )
+        {
+          const size_t start = soft_clusters[ c ];
+          const size_t end = c + 1 < nsoft_clusters ? soft_clusters[ c + 1 ] : ntriangles;
+          vec3 centroid{ 0, 0, 0 }, normal{ 0, 0, 0 };
+          real area = 0;
+          for( size_t t = start; t < end; ++ t )
+            {
+              const vec3 p0 = position( indices[ 3 * t     ] );
+              const vec3 p1 = position( indices[ 3 * t + 1 ] );
+              const vec3 p2 = position( indices[ 3 * t + 2 ] );
+              const vec3 n = cross( p1 - p0, p2 - p0 );
+              const real a = length( n );
+              centroid += a * ( p0 + p1 + p2 );
+              normal += n;
+              area += a;
+            }
+          mesh_centroid += centroid;
+          mesh_area += area;
+          centroids[ c ] = area > 0 ? centroid / ( real(3) * area ) : position( indices[ 3 * start ] );
+          const real norm = length( normal );
+          normals[ c ] = norm > 0 ? normal / norm : normal;
+        }
+      if( mesh_area > 0 )
+        mesh_centroid /= real(3) * mesh_area;
+
+      // clusters that face outward are more likely to occlude other
+      // clusters, so they are drawn first
+      std::vector< real > scores( nsoft_clusters );
+      for( size_t c = 0; c < nsoft_clusters; ++ c )
+        scores[ c ] = dot( centroids[ c ] - mesh_centroid, normals[ c ] );
+      std::vector< uint32_t > order( nsoft_clusters );
+      std::iota( order.begin(), order.end(), 0 );
+      std::stable_sort( order.begin(), order.end(),
+        [&scores]( uint32_t a, uint32_t b ){ return scores[ a ] > scores[ b ]; });
+
+      size_t output = 0;
+      for( auto c : order )
+        {
+          const size_t start = soft_clusters[ c ];
+          const size_t end = c + 1 < nsoft_clusters ? soft_clusters[ c + 1 ] : ntriangles;
+          std::copy( indices + 3 * start, indices + 3 * end, destination + output );
+          output += 3 * ( end - start );
+        }
+    }
+  }
+
+  void
+  optimize_overdraw(
+      uint32_t* destination, const uint32_t* indices, size_t nindices,
+      const gl_real* positions, size_t nvertices, size_t position_stride,
+      const uint32_t* clusters, size_t nclusters,
+      size_t cache_size, real threshold )
+  {
+    optimize_overdraw_impl(
+        destination, indices, nindices,
+        gl_real_position_accessor{ positions, position_stride }, nvertices,
+        clusters, nclusters, cache_size, threshold );
+  }
+
+  void
+  optimize_overdraw(
+      uint32_t* destination, const uint32_t* indices, size_t nindices,
+      const vec3* positions, size_t nvertices,
+      const uint32_t* clusters, size_t nclusters,
+      size_t cache_size, real threshold )
+  {
+    optimize_overdraw_impl(
+        destination, indices, nindices,
+        vec3_position_accessor{ positions }, nvertices,
+        clusters, nclusters, cache_size, threshold );
+  }
+
+  size_t
+  optimize_vertex_fetch(
+      uint32_t* remap, uint32_t* indices, size_t nindices, size_t nvertices )
+  {
+    const uint32_t unused = uint32_t(-1);
+    std::fill( remap, remap + nvertices, unused );
+    uint32_t next = 0;
+    for( size_t i = 0; i < nindices; ++ i )
+      {
+        uint32_t& r = remap[ indices[ i ] ];
+        if( r == unused )
+          r = next++;
+        indices[ i ] = r;
+      }
+    const size_t referenced = next;
+    for( size_t i = 0; i < nvertices; ++ i )
+      if( remap[ i ] == unused )
+        remap[ i ] = next++;
+    return referenced;
+  }
+
+  void
+  optimize_for_rendering(
+      indexed_mesh& m, size_t cache_size, real overdraw_threshold,
+      vertex_cache_statistics* before, vertex_cache_statistics* after )
+  {
+    const size_t nindices = m.indices.size();
+    const size_t nvertices = m.vertices.size();
+    if( before )
+      *before = analyze_vertex_cache( m.indices.data(), nindices, nvertices, cache_size );
+
+    std::vector< uint32_t > clusters( nindices / 3 );
+    std::vector< uint32_t > buffer( nindices );
+    const size_t nclusters = optimize_vertex_cache( buffer.data(), m.indices.data(), nindices, nvertices, cache_size, clusters.data() );
+    optimize_overdraw( m.indices.data(), buffer.data(), nindices, m.vertices.data(), nvertices, clusters.data(), nclusters, cache_size, overdraw_threshold );
+
+    std::vector< uint32_t > remap( nvertices );
+    const size_t referenced = optimize_vertex_fetch( remap.data(), m.indices.data(), nindices, nvertices );
+    std::vector< vec3 > vertices( nvertices );
+    remap_vertex_buffer( vertices.data(), m.vertices.data(), nvertices, sizeof(vec3), remap.data() );
+    vertices.resize( referenced );
+    m.vertices.swap( vertices );
+
+    if( after )
+      *after = analyze_vertex_cache( m.indices.data(), nindices, referenced, cache_size );
+  }
+
+} END_GO_NAMESPACE
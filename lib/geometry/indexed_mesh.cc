@@ -0,0 +1,272 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/mesh.h"
+# include "../../graphics-origin/geometry/mesh_normals.h"
+# include "../../graphics-origin/geometry/box.h"
+
+# include <algorithm>
+# include <atomic>
+# include <memory>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  constexpr indexed_mesh::vertex_index indexed_mesh::invalid_index;
+
+  indexed_mesh::indexed_mesh()
+  {}
+
+  indexed_mesh::indexed_mesh( const mesh& m )
+  {
+    from_mesh( m );
+  }
+
+  void
+  indexed_mesh::from_mesh( const mesh& m )
+  {
+    const size_t nvertices = m.n_vertices();
+    const size_t nfaces = m.n_faces();
+    vertices.resize( nvertices );
+    indices.resize( nfaces * 3 );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nvertices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nvertices; ++ i )
+    # endif
+      {
+        const auto& p = m.point( mesh::VertexHandle( i ) );
+        vertices[ i ] = vec3{ p[0], p[1], p[2] };
+      }
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        auto fvit = m.cfv_iter( mesh::FaceHandle( i ) );
+        auto dst = indices.data() + 3 * i;
+        dst[ 0 ] = fvit->idx(); ++ fvit;
+        dst[ 1 ] = fvit->idx(); ++ fvit;
+        dst[ 2 ] = fvit->idx();
+      }
+  }
+
+  void
+  indexed_mesh::to_mesh( mesh& m ) const
+  {
+    m.clear();
+    const size_t nvertices = vertices.size();
+    const size_t nfaces = get_number_of_faces();
+    m.reserve( nvertices, nfaces * 3 / 2, nfaces );
+    for( size_t i = 0; i < nvertices; ++ i )
+      {
+        const auto& p = vertices[ i ];
+        m.add_vertex( mesh::Point{ p.x, p.y, p.z } );
+      }
+    for( size_t i = 0; i < nfaces; ++ i )
+      {
+        const auto f = indices.data() + 3 * i;
+        if( f[0] == invalid_index )
+          continue;
+        m.add_face(
+            mesh::VertexHandle( f[0] ),
+            mesh::VertexHandle( f[1] ),
+            mesh::VertexHandle( f[2] ) );
+      }
+    // same weighting as update_vertex_normals() of OpenMesh
+    update_normals( m, normal_weighting::uniform );
+  }
+
+  void
+  indexed_mesh::compute_bounding_box( aabox& b ) const
+  {
+    vec3 minp{ REAL_MAX, REAL_MAX, REAL_MAX };
+    vec3 maxp{ -REAL_MAX, -REAL_MAX, -REAL_MAX };
+    const size_t nvertices = vertices.size();
+    # pragma omp parallel
+    {
+      vec3 thread_minp = minp, thread_maxp = maxp;
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp for
+      for( long i = 0; i < long(nvertices); ++ i )
+      # else
+      #   pragma omp for
+      for( size_t i = 0; i < nvertices; ++ i )
+      # endif
+        {
+          thread_minp = min( thread_minp, vertices[ i ] );
+          thread_maxp = max( thread_maxp, vertices[ i ] );
+        }
+      # pragma omp critical
+      {
+        minp = min( minp, thread_minp );
+        maxp = max( maxp, thread_maxp );
+      }
+    }
+    b = aabox( minp, maxp );
+  }
+
+  size_t
+  indexed_mesh::remove_degenerated_faces()
+  {
+    const size_t nfaces = get_number_of_faces();
+    size_t kept = 0;
+    for( size_t i = 0; i < nfaces; ++ i )
+      {
+        const auto f = indices.data() + 3 * i;
+        if( f[0] == invalid_index || f[1] == invalid_index || f[2] == invalid_index
+         || f[0] == f[1] || f[1] == f[2] || f[2] == f[0] )
+          continue;
+        if( kept != i )
+          {
+            auto dst = indices.data() + 3 * kept;
+            dst[0] = f[0];
+            dst[1] = f[1];
+            dst[2] = f[2];
+          }
+        ++kept;
+      }
+    indices.resize( kept * 3 );
+    return nfaces - kept;
+  }
+
+  size_t
+  indexed_mesh::remove_unreferenced_vertices( std::vector< vertex_index >* remap )
+  {
+    const size_t nvertices = vertices.size();
+    const size_t nindices = indices.size();
+    std::vector< vertex_index > local_remap;
+    std::vector< vertex_index >& new_index = remap ? *remap : local_remap;
+    new_index.assign( nvertices, invalid_index );
+
+    // concurrent writes of the same value are benign here
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nindices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nindices; ++ i )
+    # endif
+      {
+        if( indices[ i ] != invalid_index )
+          new_index[ indices[ i ] ] = 0;
+      }
+
+    vertex_index kept = 0;
+    for( size_t i = 0; i < nvertices; ++ i )
+      {
+        if( new_index[ i ] != invalid_index )
+          {
+            new_index[ i ] = kept;
+            vertices[ kept ] = vertices[ i ];
+            ++kept;
+          }
+      }
+    vertices.resize( kept );
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nindices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nindices; ++ i )
+    # endif
+      {
+        if( indices[ i ] != invalid_index )
+          indices[ i ] = new_index[ indices[ i ] ];
+      }
+    return nvertices - kept;
+  }
+
+  void
+  vertex_face_adjacency::build( const uint32_t* indices, size_t nfaces, size_t nvertices )
+  {
+    offsets.assign( nvertices + 1, 0 );
+    std::unique_ptr< std::atomic< uint32_t >[] > counters( new std::atomic< uint32_t >[ nvertices + 1 ] );
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nvertices + 1); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nvertices + 1; ++ i )
+    # endif
+      counters[ i ].store( 0, std::memory_order_relaxed );
+
+    // count the faces incident to each vertex
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        const uint32_t* f = indices + 3 * i;
+        if( f[0] == indexed_mesh::invalid_index )
+          continue;
+        counters[ f[0] ].fetch_add( 1, std::memory_order_relaxed );
+        counters[ f[1] ].fetch_add( 1, std::memory_order_relaxed );
+        counters[ f[2] ].fetch_add( 1, std::memory_order_relaxed );
+      }
+
+    // exclusive prefix sum, counters become insertion cursors
+    uint32_t sum = 0;
+    for( size_t i = 0; i < nvertices; ++ i )
+      {
+        offsets[ i ] = sum;
+        sum += counters[ i ].load( std::memory_order_relaxed );
+        counters[ i ].store( offsets[ i ], std::memory_order_relaxed );
+      }
+    offsets[ nvertices ] = sum;
+    faces.resize( sum );
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        const uint32_t* f = indices + 3 * i;
+        if( f[0] == indexed_mesh::invalid_index )
+          continue;
+        faces[ counters[ f[0] ].fetch_add( 1, std::memory_order_relaxed ) ] = face_index( i );
+        faces[ counters[ f[1] ].fetch_add( 1, std::memory_order_relaxed ) ] = face_index( i );
+        faces[ counters[ f[2] ].fetch_add( 1, std::memory_order_relaxed ) ] = face_index( i );
+      }
+
+    // make the result deterministic
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,1024)
+    for( long i = 0; i < long(nvertices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,1024)
+    for( size_t i = 0; i < nvertices; ++ i )
+    # endif
+      std::sort( faces.data() + offsets[ i ], faces.data() + offsets[ i + 1 ] );
+  }
+
+  void
+  vertex_face_adjacency::build( const indexed_mesh& m )
+  {
+    build( m.indices.data(), m.get_number_of_faces(), m.get_number_of_vertices() );
+  }
+
+} END_GO_NAMESPACE
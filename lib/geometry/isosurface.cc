@@ -0,0 +1,832 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/isosurface.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/matrix.h"
+# include "../../graphics-origin/tools/log.h"
+
+# include "../../graphics-origin/extlibs/thrust/scan.h"
+# include "../../graphics-origin/extlibs/thrust/sort.h"
+# include "../../graphics-origin/extlibs/thrust/system/omp/execution_policy.h"
+
+# include <algorithm>
+# include <cmath>
+# include <unordered_set>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Corners of a cell are numbered by their offsets: bit 0 for x, bit 1
+     * for y and bit 2 for z. The twelve edges of a cell are numbered by
+     * axis, x edges first, then by their lowest corner. */
+    constexpr uint32_t cube_edge_corners[12][2] = {
+      { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+      { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+      { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+    };
+    /**Edges crossed by the isosurface for each configuration of a cell. A
+     * configuration has its bit c set if the corner c is below the
+     * isovalue. */
+    constexpr uint16_t cube_edges[256] = {
+      0x000, 0x111, 0x221, 0x330, 0x412, 0x503, 0x633, 0x722,
+      0x822, 0x933, 0xa03, 0xb12, 0xc30, 0xd21, 0xe11, 0xf00,
+      0x144, 0x055, 0x365, 0x274, 0x556, 0x447, 0x777, 0x666,
+      0x966, 0x877, 0xb47, 0xa56, 0xd74, 0xc65, 0xf55, 0xe44,
+      0x284, 0x395, 0x0a5, 0x1b4, 0x696, 0x787, 0x4b7, 0x5a6,
+      0xaa6, 0xbb7, 0x887, 0x996, 0xeb4, 0xfa5, 0xc95, 0xd84,
+      0x3c0, 0x2d1, 0x1e1, 0x0f0, 0x7d2, 0x6c3, 0x5f3, 0x4e2,
+      0xbe2, 0xaf3, 0x9c3, 0x8d2, 0xff0, 0xee1, 0xdd1, 0xcc0,
+      0x448, 0x559, 0x669, 0x778, 0x05a, 0x14b, 0x27b, 0x36a,
+      0xc6a, 0xd7b, 0xe4b, 0xf5a, 0x878, 0x969, 0xa59, 0xb48,
+      0x50c, 0x41d, 0x72d, 0x63c, 0x11e, 0x00f, 0x33f, 0x22e,
+      0xd2e, 0xc3f, 0xf0f, 0xe1e, 0x93c, 0x82d, 0xb1d, 0xa0c,
+      0x6cc, 0x7dd, 0x4ed, 0x5fc, 0x2de, 0x3cf, 0x0ff, 0x1ee,
+      0xeee, 0xfff, 0xccf, 0xdde, 0xafc, 0xbed, 0x8dd, 0x9cc,
+      0x788, 0x699, 0x5a9, 0x4b8, 0x39a, 0x28b, 0x1bb, 0x0aa,
+      0xfaa, 0xebb, 0xd8b, 0xc9a, 0xbb8, 0xaa9, 0x999, 0x888,
+      0x888, 0x999, 0xaa9, 0xbb8, 0xc9a, 0xd8b, 0xebb, 0xfaa,
+      0x0aa, 0x1bb, 0x28b, 0x39a, 0x4b8, 0x5a9, 0x699, 0x788,
+      0x9cc, 0x8dd, 0xbed, 0xafc, 0xdde, 0xccf, 0xfff, 0xeee,
+      0x1ee, 0x0ff, 0x3cf, 0x2de, 0x5fc, 0x4ed, 0x7dd, 0x6cc,
+      0xa0c, 0xb1d, 0x82d, 0x93c, 0xe1e, 0xf0f, 0xc3f, 0xd2e,
+      0x22e, 0x33f, 0x00f, 0x11e, 0x63c, 0x72d, 0x41d, 0x50c,
+      0xb48, 0xa59, 0x969, 0x878, 0xf5a, 0xe4b, 0xd7b, 0xc6a,
+      0x36a, 0x27b, 0x14b, 0x05a, 0x778, 0x669, 0x559, 0x448,
+      0xcc0, 0xdd1, 0xee1, 0xff0, 0x8d2, 0x9c3, 0xaf3, 0xbe2,
+      0x4e2, 0x5f3, 0x6c3, 0x7d2, 0x0f0, 0x1e1, 0x2d1, 0x3c0,
+      0xd84, 0xc95, 0xfa5, 0xeb4, 0x996, 0x887, 0xbb7, 0xaa6,
+      0x5a6, 0x4b7, 0x787, 0x696, 0x1b4, 0x0a5, 0x395, 0x284,
+      0xe44, 0xf55, 0xc65, 0xd74, 0xa56, 0xb47, 0x877, 0x966,
+      0x666, 0x777, 0x447, 0x556, 0x274, 0x365, 0x055, 0x144,
+      0xf00, 0xe11, 0xd21, 0xc30, 0xb12, 0xa03, 0x933, 0x822,
+      0x722, 0x633, 0x503, 0x412, 0x330, 0x221, 0x111, 0x000
+    };
+    /**Triangles of each configuration of a cell, as triplets of edges
+     * terminated by -1. On each face of the cell, the isosurface separates
+     * the corners below the isovalue; the segments of the faces are then
+     * chained in loops. Loops are triangulated without joining two vertices
+     * of a same face by a diagonal, since the neighbor cell could use the
+     * same diagonal. Triangles are oriented toward increasing values. */
+    constexpr int8_t cube_triangles[256][16] = {
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  4,  8,  9,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  1, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  8,  1,  8,  9,  1,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  9,  1,  9, 11, -1, -1, -1, -1, -1, -1, -1 },
+      {  4,  5, 11,  4, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5, 11,  0, 11, 10,  0, 10,  8, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11, 10,  0, 10,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  8,  9, 11,  8, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  9,  5,  2,  5,  4,  2,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  4,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  6,  0,  6,  2, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  1, 10,  4,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  6,  1,  6,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1 },
+      {  1,  5, 11,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  2,  1,  5, 11, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11,  1,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  6,  1,  6,  2,  1,  2,  9,  1,  9, 11, -1, -1, -1, -1 },
+      {  2,  8,  6,  4,  5, 11,  4, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5, 11,  0, 11, 10,  0, 10,  6,  0,  6,  2, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11, 10,  0, 10,  4,  2,  8,  6, -1, -1, -1, -1 },
+      {  2,  9, 11,  2, 11, 10,  2, 10,  6, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  7,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  2,  7,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  2,  7,  0,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  7,  5,  2,  5,  4,  2,  4,  8, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  4,  2,  7,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  8,  2,  7,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  2,  7,  0,  7,  5,  1, 10,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  8,  1,  8,  2,  1,  2,  7,  1,  7,  5, -1, -1, -1, -1 },
+      {  1,  5, 11,  2,  7,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5, 11,  2,  7,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  2,  7,  0,  7, 11,  0, 11,  1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  2,  1,  2,  7,  1,  7, 11, -1, -1, -1, -1 },
+      {  2,  7,  9,  4,  5, 11,  4, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5, 11,  0, 11, 10,  0, 10,  8,  2,  7,  9, -1, -1, -1, -1 },
+      {  0,  2,  7,  0,  7, 11,  0, 11, 10,  0, 10,  4, -1, -1, -1, -1 },
+      {  2,  7, 11,  2, 11, 10,  2, 10,  8, -1, -1, -1, -1, -1, -1, -1 },
+      {  6,  7,  9,  6,  9,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  7,  0,  7,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  8,  6,  0,  6,  7,  0,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  4,  6,  7,  4,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  4,  6,  7,  9,  6,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  6,  0,  6,  7,  0,  7,  9, -1, -1, -1, -1 },
+      {  0,  8,  6,  0,  6,  7,  0,  7,  5,  1, 10,  4, -1, -1, -1, -1 },
+      {  1, 10,  6,  1,  6,  7,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  5, 11,  6,  7,  9,  6,  9,  8, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  7,  0,  7,  9,  1,  5, 11, -1, -1, -1, -1 },
+      {  0,  8,  6,  0,  6,  7,  0,  7, 11,  0, 11,  1, -1, -1, -1, -1 },
+      {  1,  4,  6,  1,  6,  7,  1,  7, 11, -1, -1, -1, -1, -1, -1, -1 },
+      {  4,  5, 11,  4, 11, 10,  6,  7,  9,  6,  9,  8, -1, -1, -1, -1 },
+      {  0,  5, 11,  0, 11, 10,  0, 10,  6,  0,  6,  7,  0,  7,  9, -1 },
+      {  0,  8,  6,  0,  6,  7,  0,  7, 11,  0, 11, 10,  0, 10,  4, -1 },
+      {  6,  7, 11,  6, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  3,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  3,  6, 10,  4,  8,  9,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  3,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1,  3,  0,  3,  6,  0,  6,  8, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  1,  3,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  3,  6,  1,  6,  8,  1,  8,  9,  1,  9,  5, -1, -1, -1, -1 },
+      {  1,  5, 11,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5, 11,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11,  1,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  9,  1,  9, 11,  3,  6, 10, -1, -1, -1, -1 },
+      {  3,  6,  4,  3,  4,  5,  3,  5, 11, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5, 11,  0, 11,  3,  0,  3,  6,  0,  6,  8, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11,  3,  0,  3,  6,  0,  6,  4, -1, -1, -1, -1 },
+      {  3,  6,  8,  3,  8,  9,  3,  9, 11, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  8, 10,  2, 10,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10,  3,  0,  3,  2, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  2,  8, 10,  2, 10,  3, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  9,  5,  2,  5,  4,  2,  4, 10,  2, 10,  3, -1, -1, -1, -1 },
+      {  1,  3,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1,  3,  0,  3,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  1,  3,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1 },
+      {  1,  3,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  5, 11,  2,  8, 10,  2, 10,  3, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10,  3,  0,  3,  2,  1,  5, 11, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11,  1,  2,  8, 10,  2, 10,  3, -1, -1, -1, -1 },
+      {  1,  4,  2,  4, 10,  3,  4,  3,  2,  1,  2,  9,  1,  9, 11, -1 },
+      {  2,  8,  4,  2,  4,  5,  2,  5, 11,  2, 11,  3, -1, -1, -1, -1 },
+      {  0,  5, 11,  0, 11,  3,  0,  3,  2, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9, 11,  0, 11,  3,  0,  3,  4,  3,  2,  8,  3,  8,  4, -1 },
+      {  2,  9, 11,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  7,  9,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  2,  7,  9,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  2,  7,  0,  7,  5,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  7,  5,  2,  5,  4,  2,  4,  8,  3,  6, 10, -1, -1, -1, -1 },
+      {  1,  3,  6,  1,  6,  4,  2,  7,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1,  3,  0,  3,  6,  0,  6,  8,  2,  7,  9, -1, -1, -1, -1 },
+      {  0,  2,  7,  0,  7,  5,  1,  3,  6,  1,  6,  4, -1, -1, -1, -1 },
+      {  1,  3,  6,  1,  6,  8,  1,  8,  2,  1,  2,  7,  1,  7,  5, -1 },
+      {  1,  5, 11,  2,  7,  9,  3,  6, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5, 11,  2,  7,  9,  3,  6, 10, -1, -1, -1, -1 },
+      {  0,  2,  7,  0,  7, 11,  0, 11,  1,  3,  6, 10, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  2,  1,  2,  7,  1,  7, 11,  3,  6, 10, -1 },
+      {  2,  7,  9,  3,  6,  4,  3,  4,  5,  3,  5, 11, -1, -1, -1, -1 },
+      {  0,  5, 11,  0, 11,  3,  0,  3,  6,  0,  6,  8,  2,  7,  9, -1 },
+      {  0,  2,  7,  0,  7, 11,  0, 11,  3,  0,  3,  6,  0,  6,  4, -1 },
+      {  2,  7, 11,  2, 11,  8, 11,  3,  6, 11,  6,  8, -1, -1, -1, -1 },
+      {  3,  7,  9,  3,  9,  8,  3,  8, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10,  3,  0,  3,  7,  0,  7,  9, -1, -1, -1, -1 },
+      {  0,  8, 10,  0, 10,  3,  0,  3,  7,  0,  7,  5, -1, -1, -1, -1 },
+      {  3,  7,  5,  3,  5,  4,  3,  4, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  3,  7,  1,  7,  9,  1,  9,  8,  1,  8,  4, -1, -1, -1, -1 },
+      {  0,  1,  3,  0,  3,  7,  0,  7,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  8,  3,  8,  4,  1,  8,  1,  3,  0,  3,  7,  0,  7,  5, -1 },
+      {  1,  3,  7,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  5, 11,  3,  7,  9,  3,  9,  8,  3,  8, 10, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10,  3,  0,  3,  7,  0,  7,  9,  1,  5, 11, -1 },
+      {  0,  8, 10,  0, 10,  3,  0,  3,  7,  0,  7, 11,  0, 11,  1, -1 },
+      {  1,  4,  7,  4, 10,  3,  4,  3,  7,  1,  7, 11, -1, -1, -1, -1 },
+      {  3,  7,  9,  3,  9,  8,  3,  8,  4,  3,  4,  5,  3,  5, 11, -1 },
+      {  0,  5, 11,  0, 11,  3,  0,  3,  7,  0,  7,  9, -1, -1, -1, -1 },
+      {  0,  8,  4,  3,  7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  3,  7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  3, 11,  7,  4,  8,  9,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  4,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  8,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  1, 10,  4,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  8,  1,  8,  9,  1,  9,  5,  3, 11,  7, -1, -1, -1, -1 },
+      {  1,  5,  7,  1,  7,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5,  7,  1,  7,  3, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  7,  0,  7,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  9,  1,  9,  7,  1,  7,  3, -1, -1, -1, -1 },
+      {  3, 10,  4,  3,  4,  5,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5,  7,  0,  7,  3,  0,  3, 10,  0, 10,  8, -1, -1, -1, -1 },
+      {  0,  9,  7,  0,  7,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1 },
+      {  3, 10,  8,  3,  8,  9,  3,  9,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  8,  6,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  2,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  2,  8,  6,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  9,  5,  2,  5,  4,  2,  4,  6,  3, 11,  7, -1, -1, -1, -1 },
+      {  1, 10,  4,  2,  8,  6,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  6,  0,  6,  2,  3, 11,  7, -1, -1, -1, -1 },
+      {  0,  9,  5,  1, 10,  4,  2,  8,  6,  3, 11,  7, -1, -1, -1, -1 },
+      {  1, 10,  6,  1,  6,  2,  1,  2,  9,  1,  9,  5,  3, 11,  7, -1 },
+      {  1,  5,  7,  1,  7,  3,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  2,  1,  5,  7,  1,  7,  3, -1, -1, -1, -1 },
+      {  0,  9,  7,  0,  7,  3,  0,  3,  1,  2,  8,  6, -1, -1, -1, -1 },
+      {  1,  4,  6,  1,  6,  2,  1,  2,  9,  1,  9,  7,  1,  7,  3, -1 },
+      {  2,  8,  6,  3, 10,  4,  3,  4,  5,  3,  5,  7, -1, -1, -1, -1 },
+      {  0,  5,  7,  0,  7,  3,  0,  3, 10,  0, 10,  6,  0,  6,  2, -1 },
+      {  0,  9,  7,  0,  7,  3,  0,  3, 10,  0, 10,  4,  2,  8,  6, -1 },
+      {  2,  9, 10,  9,  7,  3,  9,  3, 10,  2, 10,  6, -1, -1, -1, -1 },
+      {  2,  3, 11,  2, 11,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  2,  3, 11,  2, 11,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  2,  3,  0,  3, 11,  0, 11,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  3, 11,  2, 11,  5,  2,  5,  4,  2,  4,  8, -1, -1, -1, -1 },
+      {  1, 10,  4,  2,  3, 11,  2, 11,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  8,  2,  3, 11,  2, 11,  9, -1, -1, -1, -1 },
+      {  0,  2,  3,  0,  3, 11,  0, 11,  5,  1, 10,  4, -1, -1, -1, -1 },
+      {  1, 10,  8,  1,  8,  2,  1,  2,  5,  2,  3, 11,  2, 11,  5, -1 },
+      {  1,  5,  9,  1,  9,  2,  1,  2,  3, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5,  9,  1,  9,  2,  1,  2,  3, -1, -1, -1, -1 },
+      {  0,  2,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  2,  1,  2,  3, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  3, 10,  2, 10,  4,  2,  4,  5,  2,  5,  9, -1, -1, -1, -1 },
+      {  0,  5,  3,  5,  9,  2,  5,  2,  3,  0,  3, 10,  0, 10,  8, -1 },
+      {  0,  2,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  3, 10,  2, 10,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  3, 11,  9,  3,  9,  8,  3,  8,  6, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  3,  0,  3, 11,  0, 11,  9, -1, -1, -1, -1 },
+      {  0,  8,  6,  0,  6,  3,  0,  3, 11,  0, 11,  5, -1, -1, -1, -1 },
+      {  3, 11,  5,  3,  5,  4,  3,  4,  6, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 10,  4,  3, 11,  9,  3,  9,  8,  3,  8,  6, -1, -1, -1, -1 },
+      {  0,  1, 10,  0, 10,  6,  0,  6,  3,  0,  3, 11,  0, 11,  9, -1 },
+      {  0,  8,  6,  0,  6,  3,  0,  3, 11,  0, 11,  5,  1, 10,  4, -1 },
+      {  1, 10,  6,  1,  6,  5,  6,  3, 11,  6, 11,  5, -1, -1, -1, -1 },
+      {  1,  5,  9,  1,  9,  8,  1,  8,  6,  1,  6,  3, -1, -1, -1, -1 },
+      {  0,  4,  6,  0,  6,  3,  0,  3,  9,  3,  1,  5,  3,  5,  9, -1 },
+      {  0,  8,  6,  0,  6,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  6,  1,  6,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  3, 10,  4,  3,  4,  5,  3,  5,  9,  3,  9,  8,  3,  8,  6, -1 },
+      {  0,  5,  9,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  8,  6,  0,  6,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1 },
+      {  3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  6, 10, 11,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  6, 10, 11,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  6, 10, 11,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  4,  8,  9,  4,  9,  5,  6, 10, 11,  6, 11,  7, -1, -1, -1, -1 },
+      {  1, 11,  7,  1,  7,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 11,  0, 11,  7,  0,  7,  6,  0,  6,  8, -1, -1, -1, -1 },
+      {  0,  9,  5,  1, 11,  7,  1,  7,  6,  1,  6,  4, -1, -1, -1, -1 },
+      {  1, 11,  7,  1,  7,  6,  1,  6,  8,  1,  8,  9,  1,  9,  5, -1 },
+      {  1,  5,  7,  1,  7,  6,  1,  6, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5,  7,  1,  7,  6,  1,  6, 10, -1, -1, -1, -1 },
+      {  0,  9,  7,  0,  7,  6,  0,  6, 10,  0, 10,  1, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  9,  1,  9,  7,  1,  7,  6,  1,  6, 10, -1 },
+      {  4,  5,  7,  4,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5,  7,  0,  7,  6,  0,  6,  8, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  7,  0,  7,  6,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  6,  8,  9,  6,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  8, 10,  2, 10, 11,  2, 11,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10, 11,  0, 11,  7,  0,  7,  2, -1, -1, -1, -1 },
+      {  0,  9,  5,  2,  8, 10,  2, 10, 11,  2, 11,  7, -1, -1, -1, -1 },
+      {  2,  9,  5,  2,  5,  4,  2,  4, 10,  2, 10, 11,  2, 11,  7, -1 },
+      {  1, 11,  7,  1,  7,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1 },
+      {  0,  1, 11,  0, 11,  7,  0,  7,  2, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  5,  1, 11,  7,  1,  7,  2,  1,  2,  8,  1,  8,  4, -1 },
+      {  1, 11,  7,  1,  7,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1 },
+      {  1,  5,  7,  1,  7,  2,  1,  2,  8,  1,  8, 10, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10,  7, 10,  1,  5, 10,  5,  7,  0,  7,  2, -1 },
+      {  0,  9,  7,  0,  7, 10,  7,  2,  8,  7,  8, 10,  0, 10,  1, -1 },
+      {  1,  4, 10,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  8,  4,  2,  4,  5,  2,  5,  7, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5,  7,  0,  7,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  9,  7,  0,  7,  4,  7,  2,  8,  7,  8,  4, -1, -1, -1, -1 },
+      {  2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  6, 10,  2, 10, 11,  2, 11,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4,  8,  2,  6, 10,  2, 10, 11,  2, 11,  9, -1, -1, -1, -1 },
+      {  0,  2,  6,  0,  6, 10,  0, 10, 11,  0, 11,  5, -1, -1, -1, -1 },
+      {  2,  6, 10,  2, 10, 11,  2, 11,  5,  2,  5,  4,  2,  4,  8, -1 },
+      {  1, 11,  9,  1,  9,  2,  1,  2,  6,  1,  6,  4, -1, -1, -1, -1 },
+      {  0,  1, 11,  0, 11,  6, 11,  9,  2, 11,  2,  6,  0,  6,  8, -1 },
+      {  0,  2,  6,  0,  6, 11,  6,  4,  1,  6,  1, 11,  0, 11,  5, -1 },
+      {  1, 11,  5,  2,  6,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  5,  9,  1,  9,  2,  1,  2,  6,  1,  6, 10, -1, -1, -1, -1 },
+      {  0,  4,  8,  1,  5,  9,  1,  9,  2,  1,  2,  6,  1,  6, 10, -1 },
+      {  0,  2,  6,  0,  6, 10,  0, 10,  1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4,  8,  1,  8,  2,  1,  2,  6,  1,  6, 10, -1, -1, -1, -1 },
+      {  2,  6,  4,  2,  4,  5,  2,  5,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5,  6,  5,  9,  2,  5,  2,  6,  0,  6,  8, -1, -1, -1, -1 },
+      {  0,  2,  6,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  2,  6,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  8, 10, 11,  8, 11,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10, 11,  0, 11,  9, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  8, 10,  0, 10, 11,  0, 11,  5, -1, -1, -1, -1, -1, -1, -1 },
+      {  4, 10, 11,  4, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1, 11,  9,  1,  9,  8,  1,  8,  4, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  1, 11,  0, 11,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  8, 11,  8,  4,  1,  8,  1, 11,  0, 11,  5, -1, -1, -1, -1 },
+      {  1, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  5,  9,  1,  9,  8,  1,  8, 10, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  4, 10,  0, 10,  9, 10,  1,  5, 10,  5,  9, -1, -1, -1, -1 },
+      {  0,  8, 10,  0, 10,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  1,  4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  4,  5,  9,  4,  9,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  5,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      {  0,  8,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 }
+    };
+    /**The six tetrahedra of a cell follow the paths
+     * from corner 0 to corner 7 along the axes, so the corners of a
+     * tetrahedron are sorted by inclusion of their bits and all its edges go
+     * toward increasing coordinates. */
+    constexpr uint32_t tetrahedra[6][4] = {
+      { 0, 1, 3, 7 }, { 0, 1, 5, 7 }, { 0, 2, 3, 7 },
+      { 0, 2, 6, 7 }, { 0, 4, 5, 7 }, { 0, 4, 6, 7 }
+    };
+    /**Index of the direction of an edge whose corners differ by some bits.
+     * There are seven such directions: three axes, three face diagonals and
+     * the cell diagonal. */
+    constexpr uint64_t edge_directions[8] = { 0, 0, 1, 3, 2, 4, 5, 6 };
+    constexpr uint64_t number_of_edge_directions = 7;
+    /**Regularization of the quadratic error function of dual contouring,
+     * which pulls the vertex toward the mass point of the crossings when the
+     * tangent planes do not constrain all directions. */
+    constexpr real dual_contouring_regularization = 0.05;
+
+    /**Output of a block: vertices identified by a key, and triangles whose
+     * vertices are referenced by those keys. */
+    struct block_output {
+      std::vector< uint64_t > vertex_keys;
+      std::vector< vec3 > vertex_positions;
+      std::vector< uint64_t > triangles;
+    };
+
+    /**Cells and samples of a block. */
+    struct block {
+      uint32_t start[3];
+      uint32_t size[3];
+      /**Samples of the block, (size[0] + 1) x (size[1] + 1) x (size[2] + 1),
+       * stored along x first. */
+      std::vector< real > samples;
+
+      inline real get( uint32_t x, uint32_t y, uint32_t z ) const
+      {
+        return samples[ ( size_t( z ) * ( size[1] + 1 ) + y ) * ( size[0] + 1 ) + x ];
+      }
+    };
+
+    class extractor {
+    public:
+      extractor( const isosurface_parameters& parameters )
+        : m_parameters( parameters )
+      {}
+
+      inline uint64_t get_sample_key( uint64_t x, uint64_t y, uint64_t z ) const
+      {
+        return ( z * ( m_parameters.resolution[1] + 1 ) + y ) * ( m_parameters.resolution[0] + 1 ) + x;
+      }
+      inline uint64_t get_cell_key( uint64_t x, uint64_t y, uint64_t z ) const
+      {
+        return ( z * m_parameters.resolution[1] + y ) * m_parameters.resolution[0] + x;
+      }
+      inline vec3 get_position( const block& b, uint32_t x, uint32_t y, uint32_t z ) const
+      {
+        return m_parameters.origin + m_parameters.cell_size * vec3{
+          real( b.start[0] + x ), real( b.start[1] + y ), real( b.start[2] + z ) };
+      }
+
+      void triangulate( const block& b, block_output& output ) const
+      {
+        if( m_parameters.method == isosurface_method::marching_cubes )
+          march_cubes( b, output );
+        else if( m_parameters.method == isosurface_method::marching_tetrahedra )
+          march_tetrahedra( b, output );
+        else
+          contour( b, output );
+      }
+
+    private:
+      /**Add a triangle, oriented such that its normal points along the
+       * direction of increasing values. */
+      void add_triangle(
+          block_output& output, const uint64_t keys[3], const vec3 positions[3],
+          const vec3& direction ) const
+      {
+        const bool flip = dot( cross( positions[1] - positions[0], positions[2] - positions[0] ), direction ) < 0;
+        output.triangles.push_back( keys[0] );
+        output.triangles.push_back( keys[ flip ? 2 : 1 ] );
+        output.triangles.push_back( keys[ flip ? 1 : 2 ] );
+      }
+
+      /**Add the vertex on the edge between the corners c0 and c1 of a cell,
+       * with c0 included in c1, if the block does not have it yet. Vertices
+       * are identified by the lowest sample of their edge and its direction,
+       * and shared in a block through a hash set of those keys.
+       * @return The key of the vertex. */
+      uint64_t add_vertex(
+          block_output& output, std::unordered_set< uint64_t >& block_vertices,
+          uint64_t sample_key, const real values[8], const vec3 corners[8],
+          uint32_t c0, uint32_t c1, vec3& position ) const
+      {
+        const real t = ( m_parameters.isovalue - values[c0] ) / ( values[c1] - values[c0] );
+        position = corners[c0] + t * ( corners[c1] - corners[c0] );
+        const uint64_t key = ( sample_key + get_sample_key( c0 & 1, ( c0 >> 1 ) & 1, c0 >> 2 ) ) * number_of_edge_directions
+            + edge_directions[ c0 ^ c1 ];
+        if( block_vertices.insert( key ).second )
+          {
+            output.vertex_keys.push_back( key );
+            output.vertex_positions.push_back( position );
+          }
+        return key;
+      }
+
+      /**Marching cubes on the cells of a block. The vertices of a cell are
+       * computed once per crossed edge, then its triangles are read from
+       * the table of its configuration. */
+      void march_cubes( const block& b, block_output& output ) const
+      {
+        std::unordered_set< uint64_t > block_vertices;
+        const real isovalue = m_parameters.isovalue;
+        for( uint32_t z = 0; z < b.size[2]; ++ z )
+          for( uint32_t y = 0; y < b.size[1]; ++ y )
+            for( uint32_t x = 0; x < b.size[0]; ++ x )
+              {
+                real values[8];
+                uint32_t configuration = 0;
+                for( uint32_t c = 0; c < 8; ++ c )
+                  {
+                    values[c] = b.get( x + ( c & 1 ), y + ( ( c >> 1 ) & 1 ), z + ( c >> 2 ) );
+                    configuration |= uint32_t( values[c] < isovalue ) << c;
+                  }
+                const uint32_t crossed = cube_edges[ configuration ];
+                if( !crossed )
+                  continue;
+
+                vec3 corners[8];
+                for( uint32_t c = 0; c < 8; ++ c )
+                  corners[c] = get_position( b, x + ( c & 1 ), y + ( ( c >> 1 ) & 1 ), z + ( c >> 2 ) );
+                const uint64_t sample_key = get_sample_key( b.start[0] + x, b.start[1] + y, b.start[2] + z );
+
+                uint64_t keys[12];
+                vec3 positions[12];
+                for( uint32_t e = 0; e < 12; ++ e )
+                  if( crossed & ( 1u << e ) )
+                    keys[e] = add_vertex( output, block_vertices, sample_key, values, corners,
+                        cube_edge_corners[e][0], cube_edge_corners[e][1], positions[e] );
+
+                for( const int8_t* t = cube_triangles[ configuration ]; *t != -1; t += 3 )
+                  output.triangles.insert( output.triangles.end(), { keys[ t[0] ], keys[ t[1] ], keys[ t[2] ] } );
+              }
+      }
+
+      /**Marching tetrahedra on the cells of a block. */
+      void march_tetrahedra( const block& b, block_output& output ) const
+      {
+        std::unordered_set< uint64_t > block_vertices;
+        const real isovalue = m_parameters.isovalue;
+        for( uint32_t z = 0; z < b.size[2]; ++ z )
+          for( uint32_t y = 0; y < b.size[1]; ++ y )
+            for( uint32_t x = 0; x < b.size[0]; ++ x )
+              {
+                real values[8];
+                uint32_t ninside = 0;
+                for( uint32_t c = 0; c < 8; ++ c )
+                  {
+                    values[c] = b.get( x + ( c & 1 ), y + ( ( c >> 1 ) & 1 ), z + ( c >> 2 ) );
+                    ninside += values[c] < isovalue;
+                  }
+                if( !ninside || ninside == 8 )
+                  continue;
+
+                vec3 corners[8];
+                for( uint32_t c = 0; c < 8; ++ c )
+                  corners[c] = get_position( b, x + ( c & 1 ), y + ( ( c >> 1 ) & 1 ), z + ( c >> 2 ) );
+                const uint64_t sample_key = get_sample_key( b.start[0] + x, b.start[1] + y, b.start[2] + z );
+
+                auto get_vertex = [&]( uint32_t c0, uint32_t c1, vec3& position )
+                  {
+                    return add_vertex( output, block_vertices, sample_key, values, corners, c0, c1, position );
+                  };
+
+                for( const auto& tetrahedron : tetrahedra )
+                  {
+                    uint32_t inside[4], outside[4], ni = 0, no = 0;
+                    for( uint32_t c : tetrahedron )
+                      {
+                        if( values[c] < isovalue )
+                          inside[ ni++ ] = c;
+                        else
+                          outside[ no++ ] = c;
+                      }
+                    if( !ni || !no )
+                      continue;
+
+                    uint64_t keys[3];
+                    vec3 positions[3];
+                    if( ni == 2 )
+                      {
+                        // a quad i0o0, i0o1, i1o1, i1o0 split in two triangles
+                        uint64_t quad_keys[4];
+                        vec3 quad_positions[4];
+                        const uint32_t pairs[4][2] = {
+                          { inside[0], outside[0] }, { inside[0], outside[1] },
+                          { inside[1], outside[1] }, { inside[1], outside[0] } };
+                        for( int k = 0; k < 4; ++ k )
+                          quad_keys[k] = get_vertex(
+                              std::min( pairs[k][0], pairs[k][1] ), std::max( pairs[k][0], pairs[k][1] ),
+                              quad_positions[k] );
+                        const vec3 direction = corners[ outside[0] ] + corners[ outside[1] ] - corners[ inside[0] ] - corners[ inside[1] ];
+                        for( int k = 0; k < 2; ++ k )
+                          {
+                            const int indices[3] = { 0, k + 1, k + 2 };
+                            for( int l = 0; l < 3; ++ l )
+                              {
+                                keys[l] = quad_keys[ indices[l] ];
+                                positions[l] = quad_positions[ indices[l] ];
+                              }
+                            add_triangle( output, keys, positions, direction );
+                          }
+                      }
+                    else
+                      {
+                        // a triangle around the corner alone on its side
+                        const uint32_t alone = ni == 1 ? inside[0] : outside[0];
+                        const uint32_t* others = ni == 1 ? outside : inside;
+                        vec3 direction = real(3) * corners[ alone ];
+                        for( int k = 0; k < 3; ++ k )
+                          {
+                            keys[k] = get_vertex( std::min( alone, others[k] ), std::max( alone, others[k] ), positions[k] );
+                            direction -= corners[ others[k] ];
+                          }
+                        add_triangle( output, keys, positions, ni == 1 ? -direction : direction );
+                      }
+                  }
+              }
+      }
+
+      /**Dual contouring on the cells of a block. Vertices are identified by
+       * their cell. A block generates the quads of the edges whose lowest
+       * sample is one of the lowest corners of its cells. */
+      void contour( const block& b, block_output& output ) const
+      {
+        const real isovalue = m_parameters.isovalue;
+        const real h = m_parameters.cell_size;
+        for( uint32_t z = 0; z < b.size[2]; ++ z )
+          for( uint32_t y = 0; y < b.size[1]; ++ y )
+            for( uint32_t x = 0; x < b.size[0]; ++ x )
+              {
+                real values[8];
+                uint32_t ninside = 0;
+                for( uint32_t c = 0; c < 8; ++ c )
+                  {
+                    values[c] = b.get( x + ( c & 1 ), y + ( ( c >> 1 ) & 1 ), z + ( c >> 2 ) );
+                    ninside += values[c] < isovalue;
+                  }
+
+                // vertex of the cell
+                if( ninside && ninside != 8 )
+                  {
+                    mat3 ata( real(0) );
+                    vec3 atb{ 0, 0, 0 };
+                    vec3 mass_point{ 0, 0, 0 };
+                    real ncrossings = 0;
+                    std::vector< std::pair< vec3, vec3 > > crossings;
+                    for( uint32_t c0 = 0; c0 < 8; ++ c0 )
+                      for( uint32_t axis = 0; axis < 3; ++ axis )
+                        {
+                          const uint32_t c1 = c0 | ( 1u << axis );
+                          if( c1 == c0 || ( values[c0] < isovalue ) == ( values[c1] < isovalue ) )
+                            continue;
+                          // crossing and gradient of the trilinear interpolation, in cell coordinates
+                          vec3 p{ real( c0 & 1 ), real( ( c0 >> 1 ) & 1 ), real( c0 >> 2 ) };
+                          p[ axis ] = ( isovalue - values[c0] ) / ( values[c1] - values[c0] );
+                          vec3 gradient{ 0, 0, 0 };
+                          for( uint32_t c = 0; c < 8; ++ c )
+                            {
+                              const vec3 corner{ real( c & 1 ), real( ( c >> 1 ) & 1 ), real( c >> 2 ) };
+                              const vec3 weights = corner * p + ( real(1) - corner ) * ( real(1) - p );
+                              const vec3 derivatives = real(2) * corner - real(1);
+                              gradient += values[c] * vec3{
+                                derivatives.x * weights.y * weights.z,
+                                weights.x * derivatives.y * weights.z,
+                                weights.x * weights.y * derivatives.z };
+                            }
+                          const real norm = length( gradient );
+                          if( norm > 0 )
+                            gradient /= norm;
+                          crossings.push_back( std::make_pair( p, gradient ) );
+                          mass_point += p;
+                          ncrossings += 1;
+                        }
+                    mass_point /= ncrossings;
+                    for( const auto& crossing : crossings )
+                      {
+                        const vec3& n = crossing.second;
+                        ata += glm::outerProduct( n, n );
+                        atb += n * dot( n, crossing.first - mass_point );
+                      }
+                    for( int i = 0; i < 3; ++ i )
+                      ata[i][i] += dual_contouring_regularization * ncrossings;
+                    vec3 local = mass_point + glm::inverse( ata ) * atb;
+                    local = glm::clamp( local, vec3{ 0, 0, 0 }, vec3{ 1, 1, 1 } );
+                    output.vertex_keys.push_back( get_cell_key( b.start[0] + x, b.start[1] + y, b.start[2] + z ) );
+                    output.vertex_positions.push_back( get_position( b, x, y, z ) + h * local );
+                  }
+
+                // quads of the edges starting at the lowest corner
+                const uint32_t sample[3] = { b.start[0] + x, b.start[1] + y, b.start[2] + z };
+                for( uint32_t a = 0; a < 3; ++ a )
+                  {
+                    const uint32_t u = ( a + 1 ) % 3, v = ( a + 2 ) % 3;
+                    if( ( values[0] < isovalue ) == ( values[ 1u << a ] < isovalue )
+                     || !sample[u] || !sample[v] )
+                      continue;
+                    // cells around the edge, counterclockwise around the axis a
+                    uint64_t keys[4];
+                    const int32_t offsets[4][2] = { { -1, -1 }, { 0, -1 }, { 0, 0 }, { -1, 0 } };
+                    for( int k = 0; k < 4; ++ k )
+                      {
+                        uint32_t cell[3] = { sample[0], sample[1], sample[2] };
+                        cell[u] += offsets[k][0];
+                        cell[v] += offsets[k][1];
+                        keys[k] = get_cell_key( cell[0], cell[1], cell[2] );
+                      }
+                    if( !( values[0] < isovalue ) )
+                      std::swap( keys[1], keys[3] );
+                    output.triangles.insert( output.triangles.end(), { keys[0], keys[1], keys[2], keys[0], keys[2], keys[3] } );
+                  }
+              }
+      }
+
+      const isosurface_parameters& m_parameters;
+    };
+
+    /**Process all the blocks of the domain in parallel, then merge their
+     * vertices and remap their triangles. A sampler fills the samples of a
+     * block, and returns false if the block can be skipped. */
+    template< typename sampler >
+    bool extract( const isosurface_parameters& parameters, sampler&& sample, indexed_mesh& output )
+    {
+      output.vertices.clear();
+      output.indices.clear();
+      if( !( parameters.cell_size > 0 ) || !parameters.block_size
+        || !parameters.resolution[0] || !parameters.resolution[1] || !parameters.resolution[2] )
+        {
+          LOG( error, "invalid parameters for an isosurface extraction" );
+          return false;
+        }
+
+      uint32_t nblocks[3];
+      for( int i = 0; i < 3; ++ i )
+        nblocks[i] = ( parameters.resolution[i] + parameters.block_size - 1 ) / parameters.block_size;
+      const size_t total_blocks = size_t( nblocks[0] ) * nblocks[1] * nblocks[2];
+      std::vector< block_output > outputs( total_blocks );
+      extractor e( parameters );
+
+      # pragma omp parallel
+      {
+        block b;
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp for schedule(dynamic)
+        for( long i = 0; i < long(total_blocks); ++ i )
+        # else
+        #   pragma omp for schedule(dynamic)
+        for( size_t i = 0; i < total_blocks; ++ i )
+        # endif
+          {
+            const uint32_t coordinates[3] = {
+              uint32_t( i % nblocks[0] ),
+              uint32_t( ( i / nblocks[0] ) % nblocks[1] ),
+              uint32_t( i / ( size_t( nblocks[0] ) * nblocks[1] ) ) };
+            for( int k = 0; k < 3; ++ k )
+              {
+                b.start[k] = coordinates[k] * parameters.block_size;
+                b.size[k] = std::min( parameters.block_size, parameters.resolution[k] - b.start[k] );
+              }
+            if( sample( b ) )
+              e.triangulate( b, outputs[ i ] );
+          }
+      }
+
+      // merge the vertices generated by several blocks
+      std::vector< size_t > vertex_offsets( total_blocks + 1, 0 ), triangle_offsets( total_blocks + 1, 0 );
+      for( size_t i = 0; i < total_blocks; ++ i )
+        {
+          vertex_offsets[ i + 1 ] = outputs[ i ].vertex_keys.size();
+          triangle_offsets[ i + 1 ] = outputs[ i ].triangles.size();
+        }
+      thrust::inclusive_scan( thrust::omp::par, vertex_offsets.begin(), vertex_offsets.end(), vertex_offsets.begin() );
+      thrust::inclusive_scan( thrust::omp::par, triangle_offsets.begin(), triangle_offsets.end(), triangle_offsets.begin() );
+      const size_t nvertices = vertex_offsets.back();
+      std::vector< uint64_t > keys( nvertices );
+      std::vector< uint32_t > order( nvertices );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(dynamic)
+      for( long i = 0; i < long(total_blocks); ++ i )
+      # else
+      #   pragma omp parallel for schedule(dynamic)
+      for( size_t i = 0; i < total_blocks; ++ i )
+      # endif
+        for( size_t j = 0; j < outputs[ i ].vertex_keys.size(); ++ j )
+          {
+            keys[ vertex_offsets[ i ] + j ] = outputs[ i ].vertex_keys[ j ];
+            order[ vertex_offsets[ i ] + j ] = uint32_t( vertex_offsets[ i ] + j );
+          }
+      thrust::stable_sort_by_key( thrust::omp::par, keys.begin(), keys.end(), order.begin() );
+
+      std::vector< uint64_t > unique_keys;
+      unique_keys.reserve( nvertices );
+      for( size_t i = 0; i < nvertices; ++ i )
+        if( !i || keys[ i ] != keys[ i - 1 ] )
+          {
+            unique_keys.push_back( keys[ i ] );
+            // find the block of the first vertex with this key
+            const size_t global = order[ i ];
+            const size_t owner = size_t( std::upper_bound( vertex_offsets.begin(), vertex_offsets.end(), global ) - vertex_offsets.begin() ) - 1;
+            output.vertices.push_back( outputs[ owner ].vertex_positions[ global - vertex_offsets[ owner ] ] );
+          }
+
+      // remap the triangles
+      const size_t nindices = triangle_offsets.back();
+      output.indices.resize( nindices );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(dynamic)
+      for( long i = 0; i < long(total_blocks); ++ i )
+      # else
+      #   pragma omp parallel for schedule(dynamic)
+      for( size_t i = 0; i < total_blocks; ++ i )
+      # endif
+        for( size_t j = 0; j < outputs[ i ].triangles.size(); ++ j )
+          {
+            const uint64_t key = outputs[ i ].triangles[ j ];
+            auto it = std::lower_bound( unique_keys.begin(), unique_keys.end(), key );
+            output.indices[ triangle_offsets[ i ] + j ] = it != unique_keys.end() && *it == key
+                ? uint32_t( it - unique_keys.begin() ) : indexed_mesh::invalid_index;
+          }
+
+      // a missing vertex can only come from a block wrongly skipped: remove its faces
+      if( std::find( output.indices.begin(), output.indices.end(), indexed_mesh::invalid_index ) != output.indices.end() )
+        {
+          LOG( warning, "isosurface faces referencing skipped blocks were removed" );
+          output.remove_degenerated_faces();
+        }
+      return true;
+    }
+  }
+
+  isosurface_parameters::isosurface_parameters()
+    : origin{ 0, 0, 0 }, cell_size{ 1 }, resolution{ 1, 1, 1 },
+      isovalue{ 0 }, block_size{ 16 }, lipschitz_constant{ 0 },
+      method{ isosurface_method::marching_cubes }
+  {}
+
+  bool extract_isosurface(
+      const scalar_field& field, const isosurface_parameters& parameters,
+      indexed_mesh& output )
+  {
+    return extract( parameters, [&]( block& b )
+      {
+        const real isovalue = parameters.isovalue;
+        if( parameters.lipschitz_constant > 0 )
+          {
+            const vec3 half_size = real(0.5) * parameters.cell_size * vec3{ real( b.size[0] ), real( b.size[1] ), real( b.size[2] ) };
+            const vec3 center = parameters.origin
+                + parameters.cell_size * vec3{ real( b.start[0] ), real( b.start[1] ), real( b.start[2] ) } + half_size;
+            if( std::abs( field( center ) - isovalue ) > parameters.lipschitz_constant * length( half_size ) )
+              return false;
+          }
+
+        b.samples.resize( size_t( b.size[0] + 1 ) * ( b.size[1] + 1 ) * ( b.size[2] + 1 ) );
+        size_t ninside = 0, index = 0;
+        for( uint32_t z = 0; z <= b.size[2]; ++ z )
+          for( uint32_t y = 0; y <= b.size[1]; ++ y )
+            for( uint32_t x = 0; x <= b.size[0]; ++ x, ++ index )
+              {
+                b.samples[ index ] = field( parameters.origin + parameters.cell_size * vec3{
+                  real( b.start[0] + x ), real( b.start[1] + y ), real( b.start[2] + z ) } );
+                ninside += b.samples[ index ] < isovalue;
+              }
+        return ninside && ninside != b.samples.size();
+      }, output );
+  }
+
+  bool extract_isosurface(
+      const real* values, const isosurface_parameters& parameters,
+      indexed_mesh& output )
+  {
+    const size_t row_size = size_t( parameters.resolution[0] ) + 1;
+    const size_t slice_size = row_size * ( size_t( parameters.resolution[1] ) + 1 );
+    return extract( parameters, [&]( block& b )
+      {
+        b.samples.resize( size_t( b.size[0] + 1 ) * ( b.size[1] + 1 ) * ( b.size[2] + 1 ) );
+        size_t ninside = 0, index = 0;
+        for( uint32_t z = 0; z <= b.size[2]; ++ z )
+          for( uint32_t y = 0; y <= b.size[1]; ++ y )
+            {
+              const real* row = values + ( b.start[2] + z ) * slice_size + ( b.start[1] + y ) * row_size + b.start[0];
+              for( uint32_t x = 0; x <= b.size[0]; ++ x, ++ index )
+                {
+                  b.samples[ index ] = row[ x ];
+                  ninside += row[ x ] < parameters.isovalue;
+                }
+            }
+        return ninside && ninside != b.samples.size();
+      }, output );
+  }
+
+} END_GO_NAMESPACE
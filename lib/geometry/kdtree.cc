@@ -0,0 +1,375 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/kdtree.h"
+
+# include <algorithm>
+# include <limits>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    template< typename scalar >
+    inline scalar squared_distance( const scalar* a, const scalar* b )
+    {
+      const scalar dx = a[0] - b[0];
+      const scalar dy = a[1] - b[1];
+      const scalar dz = a[2] - b[2];
+      return dx * dx + dy * dy + dz * dz;
+    }
+
+    /**Keep the k closest points, sorted by increasing distance, in
+     * caller-provided buffers. */
+    struct knn_visitor {
+      knn_visitor( uint32_t k, uint32_t* indices, real* squared_distances )
+        : indices{ indices }, squared_distances{ squared_distances },
+          k{ k }, count{ 0 }
+      {}
+      inline real bound() const
+      {
+        return count < k ? REAL_MAX : squared_distances[ k - 1 ];
+      }
+      inline void visit( uint32_t index, real d )
+      {
+        if( d >= bound() )
+          return;
+        size_t i = count < k ? count ++ : k - 1;
+        for( ; i > 0 && squared_distances[ i - 1 ] > d; -- i )
+          {
+            squared_distances[ i ] = squared_distances[ i - 1 ];
+            indices[ i ] = indices[ i - 1 ];
+          }
+        squared_distances[ i ] = d;
+        indices[ i ] = index;
+      }
+      uint32_t* indices;
+      real* squared_distances;
+      const uint32_t k;
+      uint32_t count;
+    };
+
+    struct radius_count_visitor {
+      radius_count_visitor( real squared_radius )
+        : squared_radius{ squared_radius }, count{ 0 }
+      {}
+      inline real bound() const
+      {
+        return squared_radius;
+      }
+      inline void visit( uint32_t, real d )
+      {
+        if( d <= squared_radius )
+          ++ count;
+      }
+      const real squared_radius;
+      size_t count;
+    };
+
+    struct radius_vector_visitor {
+      radius_vector_visitor( real squared_radius, std::vector< std::pair< uint32_t, real > >& result )
+        : squared_radius{ squared_radius }, result( result )
+      {}
+      inline real bound() const
+      {
+        return squared_radius;
+      }
+      inline void visit( uint32_t index, real d )
+      {
+        if( d <= squared_radius )
+          result.push_back( std::make_pair( index, d ) );
+      }
+      const real squared_radius;
+      std::vector< std::pair< uint32_t, real > >& result;
+    };
+
+    struct radius_buffer_visitor {
+      radius_buffer_visitor( real squared_radius, uint32_t* indices, real* squared_distances )
+        : squared_radius{ squared_radius }, indices{ indices },
+          squared_distances{ squared_distances }
+      {}
+      inline real bound() const
+      {
+        return squared_radius;
+      }
+      inline void visit( uint32_t index, real d )
+      {
+        if( d <= squared_radius )
+          {
+            *indices ++ = index;
+            if( squared_distances )
+              *squared_distances ++ = d;
+          }
+      }
+      const real squared_radius;
+      uint32_t* indices;
+      real* squared_distances;
+    };
+  }
+
+  template< typename scalar >
+  constexpr typename point_kdtree< scalar >::point_index point_kdtree< scalar >::invalid_index;
+
+  template< typename scalar >
+  point_kdtree< scalar >::point_kdtree( const real* points, size_t npoints, size_t max_leaf_size )
+    : m_entries( npoints ), m_first_leaf{ 0 }
+  {
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(npoints); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < npoints; ++ i )
+    # endif
+      {
+        auto& e = m_entries[ i ];
+        e.position[0] = scalar( points[ 3 * i     ] );
+        e.position[1] = scalar( points[ 3 * i + 1 ] );
+        e.position[2] = scalar( points[ 3 * i + 2 ] );
+        e.index = point_index( i );
+      }
+    build( max_leaf_size );
+  }
+
+  template< typename scalar >
+  point_kdtree< scalar >::point_kdtree( const vec3* points, size_t npoints, size_t max_leaf_size )
+    : point_kdtree( npoints ? &points[0].x : nullptr, npoints, max_leaf_size )
+  {}
+
+  template< typename scalar >
+  void point_kdtree< scalar >::build( size_t max_leaf_size )
+  {
+    const size_t npoints = m_entries.size();
+    max_leaf_size = std::max( max_leaf_size, size_t(1) );
+
+    // all leaves are at the same depth, with at most max_leaf_size points
+    size_t depth = 0;
+    while( ( ( npoints + ( size_t(1) << depth ) - 1 ) >> depth ) > max_leaf_size )
+      ++ depth;
+    m_first_leaf = ( size_t(1) << depth ) - 1;
+    m_nodes.resize( m_first_leaf );
+
+    // ranges of the nodes of the current level: node j covers [bounds[j], bounds[j+1])
+    std::vector< size_t > bounds = { 0, npoints }, next_bounds;
+    for( size_t level = 0; level < depth; ++ level )
+      {
+        const size_t level_size = size_t(1) << level;
+        const size_t level_start = level_size - 1;
+        next_bounds.resize( 2 * level_size + 1 );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(dynamic)
+        for( long j = 0; j < long(level_size); ++ j )
+        # else
+        #   pragma omp parallel for schedule(dynamic)
+        for( size_t j = 0; j < level_size; ++ j )
+        # endif
+          {
+            const size_t begin = bounds[ j ], end = bounds[ j + 1 ];
+            const size_t middle = begin + ( end - begin ) / 2;
+            next_bounds[ 2 * j ] = begin;
+            next_bounds[ 2 * j + 1 ] = middle;
+            if( j + 1 == level_size )
+              next_bounds[ 2 * j + 2 ] = end;
+
+            auto& n = m_nodes[ level_start + j ];
+            if( begin == end )
+              {
+                n.split = 0;
+                n.axis = 0;
+                continue;
+              }
+
+            scalar low[3], high[3];
+            for( int d = 0; d < 3; ++ d )
+              low[d] = high[d] = m_entries[ begin ].position[ d ];
+            for( size_t i = begin + 1; i < end; ++ i )
+              for( int d = 0; d < 3; ++ d )
+                {
+                  low[d] = std::min( low[d], m_entries[ i ].position[ d ] );
+                  high[d] = std::max( high[d], m_entries[ i ].position[ d ] );
+                }
+            uint32_t axis = 0;
+            for( uint32_t d = 1; d < 3; ++ d )
+              if( high[d] - low[d] > high[axis] - low[axis] )
+                axis = d;
+
+            std::nth_element(
+                m_entries.begin() + begin, m_entries.begin() + middle, m_entries.begin() + end,
+                [axis]( const entry& a, const entry& b )
+                {
+                  return a.position[ axis ] < b.position[ axis ];
+                });
+            n.axis = axis;
+            n.split = m_entries[ middle ].position[ axis ];
+          }
+        bounds.swap( next_bounds );
+      }
+  }
+
+  template< typename scalar >
+  template< typename visitor >
+  void point_kdtree< scalar >::search( const vec3& location, visitor& v ) const
+  {
+    if( m_entries.empty() )
+      return;
+    const scalar q[3] = { scalar( location.x ), scalar( location.y ), scalar( location.z ) };
+    scalar axis_distances[3] = { 0, 0, 0 };
+    search( 0, 0, m_entries.size(), q, 0, axis_distances, v );
+  }
+
+  template< typename scalar >
+  template< typename visitor >
+  void point_kdtree< scalar >::search(
+      size_t node_index, size_t begin, size_t end, const scalar* q,
+      scalar min_distance, scalar* axis_distances, visitor& v ) const
+  {
+    if( node_index >= m_first_leaf )
+      {
+        for( size_t i = begin; i < end; ++ i )
+          {
+            const entry& e = m_entries[ i ];
+            v.visit( e.index, real( squared_distance( q, e.position ) ) );
+          }
+        return;
+      }
+
+    // points of the left child are below the split, those of the right
+    // child are above. Visit first the child containing the query point.
+    const node& n = m_nodes[ node_index ];
+    const size_t middle = begin + ( end - begin ) / 2;
+    const scalar diff = q[ n.axis ] - n.split;
+    if( diff < 0 )
+      search( 2 * node_index + 1, begin, middle, q, min_distance, axis_distances, v );
+    else
+      search( 2 * node_index + 2, middle, end, q, min_distance, axis_distances, v );
+
+    // incremental distance to the other child (Arya & Mount)
+    const scalar saved = axis_distances[ n.axis ];
+    const scalar cut = diff * diff;
+    const scalar far_distance = min_distance - saved + cut;
+    if( real( far_distance ) <= v.bound() )
+      {
+        axis_distances[ n.axis ] = cut;
+        if( diff < 0 )
+          search( 2 * node_index + 2, middle, end, q, far_distance, axis_distances, v );
+        else
+          search( 2 * node_index + 1, begin, middle, q, far_distance, axis_distances, v );
+        axis_distances[ n.axis ] = saved;
+      }
+  }
+
+  template< typename scalar >
+  size_t point_kdtree< scalar >::k_nearest(
+      const vec3& location, uint32_t k, point_index* indices, real* squared_distances ) const
+  {
+    if( !k )
+      return 0;
+    knn_visitor v( k, indices, squared_distances );
+    search( location, v );
+    return v.count;
+  }
+
+  template< typename scalar >
+  void point_kdtree< scalar >::k_nearest(
+      const vec3* locations, size_t nlocations, uint32_t k,
+      point_index* indices, real* squared_distances ) const
+  {
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( long i = 0; i < long(nlocations); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( size_t i = 0; i < nlocations; ++ i )
+    # endif
+      {
+        point_index* result_indices = indices + i * k;
+        real* result_distances = squared_distances + i * k;
+        const size_t found = k_nearest( locations[ i ], k, result_indices, result_distances );
+        std::fill( result_indices + found, result_indices + k, invalid_index );
+        std::fill( result_distances + found, result_distances + k, REAL_MAX );
+      }
+  }
+
+  template< typename scalar >
+  void point_kdtree< scalar >::radius_search(
+      const vec3& location, real radius,
+      std::vector< std::pair< point_index, real > >& indices_sdistances ) const
+  {
+    indices_sdistances.clear();
+    radius_vector_visitor v( radius * radius, indices_sdistances );
+    search( location, v );
+    std::sort( indices_sdistances.begin(), indices_sdistances.end(),
+      []( const std::pair< point_index, real >& a, const std::pair< point_index, real >& b )
+      {
+        return a.second < b.second;
+      });
+  }
+
+  template< typename scalar >
+  size_t point_kdtree< scalar >::count_in_radius( const vec3& location, real radius ) const
+  {
+    radius_count_visitor v( radius * radius );
+    search( location, v );
+    return v.count;
+  }
+
+  template< typename scalar >
+  size_t point_kdtree< scalar >::count_in_radius(
+      const vec3* locations, size_t nlocations, real radius, size_t* offsets ) const
+  {
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( long i = 0; i < long(nlocations); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( size_t i = 0; i < nlocations; ++ i )
+    # endif
+      {
+        offsets[ i + 1 ] = count_in_radius( locations[ i ], radius );
+      }
+    offsets[ 0 ] = 0;
+    for( size_t i = 0; i < nlocations; ++ i )
+      offsets[ i + 1 ] += offsets[ i ];
+    return offsets[ nlocations ];
+  }
+
+  template< typename scalar >
+  void point_kdtree< scalar >::radius_search(
+      const vec3* locations, size_t nlocations, real radius,
+      const size_t* offsets, point_index* indices, real* squared_distances ) const
+  {
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( long i = 0; i < long(nlocations); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( size_t i = 0; i < nlocations; ++ i )
+    # endif
+      {
+        radius_buffer_visitor v( radius * radius, indices + offsets[ i ],
+          squared_distances ? squared_distances + offsets[ i ] : nullptr );
+        search( locations[ i ], v );
+      }
+  }
+
+  template< typename scalar >
+  void point_kdtree< scalar >::radius_search(
+      const vec3* locations, size_t nlocations, real radius,
+      point_neighborhoods& neighborhoods ) const
+  {
+    neighborhoods.offsets.resize( nlocations + 1 );
+    const size_t total = count_in_radius( locations, nlocations, radius, neighborhoods.offsets.data() );
+    neighborhoods.indices.resize( total );
+    neighborhoods.squared_distances.resize( total );
+    radius_search( locations, nlocations, radius, neighborhoods.offsets.data(),
+        neighborhoods.indices.data(), neighborhoods.squared_distances.data() );
+  }
+
+  template class GO_API point_kdtree< real >;
+  template class GO_API point_kdtree< gl_real >;
+
+} END_GO_NAMESPACE
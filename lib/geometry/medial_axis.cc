@@ -0,0 +1,250 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/medial_axis.h"
+
+# include "../../graphics-origin/extlibs/thrust/scan.h"
+# include "../../graphics-origin/extlibs/thrust/system/omp/execution_policy.h"
+
+# include <algorithm>
+# include <cmath>
+# include <memory>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Relative tolerance used to decide that a ball is empty: points on
+     * the sphere of a ball are not inside it. */
+    constexpr real empty_ball_tolerance = 1e-9;
+
+    /**Compact the elements of an array whose flag is set, preserving their
+     * order. */
+    template< typename element >
+    void compact( std::vector< element >& elements, const std::vector< size_t >& offsets, const std::vector< uint8_t >& kept )
+    {
+      std::vector< element > result( offsets.back() );
+      const size_t n = kept.size();
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(n); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < n; ++ i )
+      # endif
+        if( kept[ i ] )
+          result[ offsets[ i ] ] = elements[ i ];
+      elements.swap( result );
+    }
+
+    /**Find the nearest point of a location, skipping the points at a given
+     * position, i.e. the point of a ball and the points coincident with it.
+     * The number of neighbors looked for grows until such a point is found.
+     * @return True if a point was found, whose index is then
+     * indices[ nearest ]. */
+    bool find_nearest_distinct_point(
+        const kdtree& tree, const vec3* points, size_t npoints,
+        const vec3& location, const vec3& position,
+        std::vector< kdtree::point_index >& indices, std::vector< real >& squared_distances,
+        size_t& nearest )
+    {
+      const uint32_t max_neighbors = uint32_t( npoints );
+      for( uint32_t k = std::min( 2u, max_neighbors ); ; k = std::min( 2 * k, max_neighbors ) )
+        {
+          indices.resize( k );
+          squared_distances.resize( k );
+          const size_t found = tree.k_nearest( location, k, indices.data(), squared_distances.data() );
+          nearest = 0;
+          while( nearest < found && points[ indices[ nearest ] ] == position )
+            ++ nearest;
+          if( nearest < found )
+            return true;
+          if( found < k || k == max_neighbors )
+            return false;
+        }
+    }
+
+    /**Compute the offsets of the kept elements. */
+    void compute_offsets( const std::vector< uint8_t >& kept, std::vector< size_t >& offsets )
+    {
+      offsets.assign( kept.size() + 1, 0 );
+      std::copy( kept.begin(), kept.end(), offsets.begin() + 1 );
+      thrust::inclusive_scan( thrust::omp::par, offsets.begin(), offsets.end(), offsets.begin() );
+    }
+  }
+
+  shrinking_ball_parameters::shrinking_ball_parameters()
+    : initial_radius{ 0 }, separation_angle{ 0 }, max_iterations{ 50 }, inner{ true }
+  {}
+
+  void compute_shrinking_balls(
+      const vec3* points, const vec3* normals, size_t npoints, const kdtree& tree,
+      const shrinking_ball_parameters& parameters,
+      std::vector< ball >& balls, std::vector< uint32_t >* sources )
+  {
+    balls.clear();
+    if( sources )
+      sources->clear();
+    if( npoints < 2 )
+      return;
+
+    real initial_radius = parameters.initial_radius;
+    if( !( initial_radius > 0 ) )
+      {
+        vec3 lower = points[0], upper = points[0];
+        # pragma omp parallel
+        {
+          vec3 thread_lower = points[0], thread_upper = points[0];
+          # ifdef _MSC_VER
+          GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+          #   pragma omp for schedule(static)
+          for( long i = 0; i < long(npoints); ++ i )
+          # else
+          #   pragma omp for schedule(static)
+          for( size_t i = 0; i < npoints; ++ i )
+          # endif
+            {
+              thread_lower = min( thread_lower, points[ i ] );
+              thread_upper = max( thread_upper, points[ i ] );
+            }
+          # pragma omp critical
+          {
+            lower = min( lower, thread_lower );
+            upper = max( upper, thread_upper );
+          }
+        }
+        initial_radius = length( upper - lower );
+      }
+
+    const real cos_separation_angle = std::cos( parameters.separation_angle );
+    std::vector< ball > all_balls( npoints );
+    std::vector< uint8_t > valid( npoints, 0 );
+    # pragma omp parallel
+    {
+      std::vector< kdtree::point_index > indices;
+      std::vector< real > squared_distances;
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp for schedule(dynamic,256)
+      for( long i = 0; i < long(npoints); ++ i )
+      # else
+      #   pragma omp for schedule(dynamic,256)
+      for( size_t i = 0; i < npoints; ++ i )
+      # endif
+        {
+          const vec3& p = points[ i ];
+          const vec3 direction = parameters.inner ? -normals[ i ] : normals[ i ];
+          real radius = initial_radius;
+          vec3 center = p + radius * direction;
+          for( uint32_t iteration = 0; iteration < parameters.max_iterations; ++ iteration )
+            {
+              // nearest point of the center, other than p and the points
+              // coincident with p, which are on the sphere of any ball
+              size_t nearest = 0;
+              if( !find_nearest_distinct_point( tree, points, npoints, center, p, indices, squared_distances, nearest ) )
+                break;
+              if( squared_distances[ nearest ] >= radius * radius * ( 1 - empty_ball_tolerance ) )
+                {
+                  // the ball is empty: it is a maximal ball
+                  valid[ i ] = radius < initial_radius;
+                  break;
+                }
+
+              const vec3 q = points[ indices[ nearest ] ];
+              const vec3 pq = q - p;
+              const real denominator = real(2) * dot( direction, pq );
+              if( !( denominator > 0 ) )
+                break;
+              const real next_radius = dot( pq, pq ) / denominator;
+              const vec3 next_center = p + next_radius * direction;
+
+              // the angle between p and q seen from the center is too small: q is noise
+              if( parameters.separation_angle > 0 && iteration
+               && dot( normalize( p - next_center ), normalize( q - next_center ) ) > cos_separation_angle )
+                {
+                  valid[ i ] = radius < initial_radius;
+                  break;
+                }
+              radius = next_radius;
+              center = next_center;
+            }
+          all_balls[ i ] = ball( center, radius );
+        }
+    }
+
+    std::vector< size_t > offsets;
+    compute_offsets( valid, offsets );
+    compact( all_balls, offsets, valid );
+    balls.swap( all_balls );
+    if( sources )
+      {
+        sources->resize( npoints );
+        for( size_t i = 0; i < npoints; ++ i )
+          (*sources)[ i ] = uint32_t( i );
+        compact( *sources, offsets, valid );
+      }
+  }
+
+  size_t remove_included_balls(
+      std::vector< ball >& balls, real tolerance, uint32_t nneighbors,
+      std::vector< uint32_t >* sources )
+  {
+    const size_t nballs = balls.size();
+    if( nballs < 2 || !nneighbors )
+      return 0;
+    nneighbors = uint32_t( std::min( size_t( nneighbors ) + 1, nballs ) );
+
+    std::vector< vec3 > centers( nballs );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nballs); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nballs; ++ i )
+    # endif
+      centers[ i ] = vec3( balls[ i ] );
+    kdtree tree( centers.data(), nballs );
+
+    auto include = [&]( size_t outer, size_t inner )
+      {
+        return length( centers[ inner ] - centers[ outer ] ) + balls[ inner ].w
+            <= ( real(1) + tolerance ) * balls[ outer ].w;
+      };
+
+    std::vector< uint8_t > kept( nballs, 1 );
+    # pragma omp parallel
+    {
+      std::unique_ptr< kdtree::point_index[] > indices( new kdtree::point_index[ nneighbors ] );
+      std::unique_ptr< real[] > squared_distances( new real[ nneighbors ] );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp for schedule(dynamic,256)
+      for( long i = 0; i < long(nballs); ++ i )
+      # else
+      #   pragma omp for schedule(dynamic,256)
+      for( size_t i = 0; i < nballs; ++ i )
+      # endif
+        {
+          const size_t found = tree.k_nearest( centers[ i ], nneighbors, indices.get(), squared_distances.get() );
+          for( size_t k = 0; k < found; ++ k )
+            {
+              const size_t j = indices[ k ];
+              if( j != size_t( i ) && include( j, i ) && ( j < size_t( i ) || !include( i, j ) ) )
+                {
+                  kept[ i ] = 0;
+                  break;
+                }
+            }
+        }
+    }
+
+    std::vector< size_t > offsets;
+    compute_offsets( kept, offsets );
+    compact( balls, offsets, kept );
+    if( sources )
+      compact( *sources, offsets, kept );
+    return nballs - balls.size();
+  }
+
+} END_GO_NAMESPACE
@@ -3,9 +3,14 @@
  */
 # include "../../graphics-origin/geometry/bvh.h"
 # include "../../graphics-origin/geometry/mesh.h"
+# include "../../graphics-origin/geometry/mesh_distance.h"
+# include "../../graphics-origin/geometry/medial_axis.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/mesh_normals.h"
 # include "../../graphics-origin/geometry/box.h"
 # include "../../graphics-origin/geometry/triangle.h"
 # include "../../graphics-origin/geometry/ray.h"
+# include "../../graphics-origin/tools/assert.h"
 # include "../../graphics-origin/tools/filesystem.h"
 # include "../../graphics-origin/tools/log.h"
 
@@ -588,8 +593,8 @@ BEGIN_GO_NAMESPACE namespace geometry {
         if( n_vertices() && normal( VertexHandle{0} ).l8_norm() < 0.5 )
           {
             LOG( info, "input mesh file [" << filename << "] does not have vertex normal. Computing them...");
-            update_face_normals();
-            update_vertex_normals();
+            // same weighting as update_vertex_normals() of OpenMesh
+            update_normals( *this, normal_weighting::uniform );
           }
         return true;
       }
@@ -665,10 +670,9 @@ BEGIN_GO_NAMESPACE namespace geometry {
   mesh_vertices_kdtree::mesh_vertices_kdtree( const mesh& input, size_t max_leaf_size )
     : points{ &input.point( mesh::VertexHandle(0) )[0] },
       nbpoints{ input.n_vertices() },
-      kdtree{ 3, *this, nanoflann::KDTreeSingleIndexAdaptorParams{ max_leaf_size } }
+      kdtree{ points, nbpoints, max_leaf_size }
   {
     input.compute_bounding_box( bounding_box );
-    kdtree.buildIndex();
   }
 
   mesh_vertices_kdtree::~mesh_vertices_kdtree()
@@ -677,13 +681,13 @@ BEGIN_GO_NAMESPACE namespace geometry {
   void mesh_vertices_kdtree::k_nearest_vertices(
       const vec3& location, uint32_t k, uint32_t* indices, real* squared_distances ) const
   {
-    kdtree.knnSearch( &location.x, k, indices, squared_distances );
+    kdtree.k_nearest( location, k, indices, squared_distances );
   }
 
   void mesh_vertices_kdtree::radius_search( const vec3& location, real radius,
       std::vector< std::pair< uint32_t, real >>& indices_sdistances ) const
   {
-    kdtree.radiusSearch( &location.x, radius, indices_sdistances, nanoflann::SearchParams{} );
+    kdtree.radius_search( location, radius, indices_sdistances );
   }
 
 
@@ -762,11 +766,7 @@ BEGIN_GO_NAMESPACE namespace geometry {
   {
     if( !m_kdtree )
       {
-        m_kdtree = new nanoflann::KDTreeSingleIndexAdaptor<
-            nanoflann::L2_Simple_Adaptor< real, mesh_spatial_optimization, real >,
-            mesh_spatial_optimization,
-            3, uint32_t >{ 3, *this, nanoflann::KDTreeSingleIndexAdaptorParams{32} };
-        m_kdtree->buildIndex();
+        m_kdtree = new kdtree{ m_points, m_mesh.n_vertices(), 32 };
       }
   }
 
@@ -839,23 +839,221 @@ BEGIN_GO_NAMESPACE namespace geometry {
     return result;
   }
 
+  size_t
+  mesh_spatial_optimization::intersect( const ray* rays, size_t nrays, real* distances, size_t* faces ) const
+  {
+    size_t nhits = 0;
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,64) reduction(+:nhits)
+    for( long i = 0; i < long(nrays); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,64) reduction(+:nhits)
+    for( size_t i = 0; i < nrays; ++ i )
+    # endif
+      {
+        if( intersect( rays[i], distances[i], faces[i] ) )
+          ++nhits;
+      }
+    return nhits;
+  }
+
+  bool
+  mesh_spatial_optimization::occlude( const ray& r, real max_distance ) const
+  {
+    ray_with_inv_dir inv_r( r );
+    const bvh<geometry::aabox>::node* stack[ bvh<geometry::aabox>::traversal_stack_size ];
+    size_t stack_size = 0;
+    const bvh<geometry::aabox>::node* pnode = &m_bvh->get_node( 0 );
+
+    do
+      {
+        real t1 = REAL_MAX;
+        real t2 = REAL_MAX;
+        auto childL = &m_bvh->get_node( pnode->left_index );
+        auto childR = &m_bvh->get_node( pnode->right_index );
+
+        bool traverseL = childL->bounding.intersect( inv_r, t1 ) && t1 <= max_distance;
+        bool traverseR = childR->bounding.intersect( inv_r, t2 ) && t2 <= max_distance;
+
+        if( traverseL && m_bvh->is_leaf( childL ) )
+          {
+            if( m_triangles[ childL->element ].intersect( r, t1 ) && t1 <= max_distance )
+              return true;
+            traverseL = false;
+          }
+
+        if( traverseR && m_bvh->is_leaf( childR ) )
+          {
+            if( m_triangles[ childR->element ].intersect( r, t2 ) && t2 <= max_distance )
+              return true;
+            traverseR = false;
+          }
+
+        if( traverseL )
+          {
+            if( traverseR )
+              {
+                GO_ASSERT( stack_size < bvh<geometry::aabox>::traversal_stack_size, "BVH too deep for the traversal stack")(stack_size);
+                stack[ stack_size++ ] = childR;
+              }
+            pnode = childL;
+          }
+        else if( traverseR )
+          pnode = childR;
+        else
+          pnode = stack_size ? stack[ --stack_size ] : nullptr;
+      }
+    while( pnode );
+    return false;
+  }
+
+  size_t
+  mesh_spatial_optimization::occlude( const ray* rays, const real* max_distances, size_t nrays, bool* occluded ) const
+  {
+    size_t noccluded = 0;
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,64) reduction(+:noccluded)
+    for( long i = 0; i < long(nrays); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,64) reduction(+:noccluded)
+    for( size_t i = 0; i < nrays; ++ i )
+    # endif
+      {
+        occluded[i] = occlude( rays[i], max_distances[i] );
+        if( occluded[i] )
+          ++noccluded;
+      }
+    return noccluded;
+  }
+
+  size_t
+  mesh_spatial_optimization::intersect_all( const ray& r, real* distances, size_t* faces, size_t capacity ) const
+  {
+    size_t nhits = 0;
+    ray_with_inv_dir inv_r( r );
+    const bvh<geometry::aabox>::node* stack[ bvh<geometry::aabox>::traversal_stack_size ];
+    size_t stack_size = 0;
+    const bvh<geometry::aabox>::node* pnode = &m_bvh->get_node( 0 );
+
+    // insert a hit in the sorted output buffers, dropping the furthest one
+    // when those buffers are full.
+    auto record = [&]( real t, size_t face )
+      {
+        size_t position = nhits < capacity ? nhits : capacity;
+        ++nhits;
+        if( position == capacity && ( !capacity || distances[ capacity - 1 ] <= t ) )
+          return;
+        if( position == capacity )
+          --position;
+        while( position && distances[ position - 1 ] > t )
+          {
+            distances[ position ] = distances[ position - 1 ];
+            faces[ position ] = faces[ position - 1 ];
+            --position;
+          }
+        distances[ position ] = t;
+        faces[ position ] = face;
+      };
+
+    do
+      {
+        real t1 = REAL_MAX;
+        real t2 = REAL_MAX;
+        auto childL = &m_bvh->get_node( pnode->left_index );
+        auto childR = &m_bvh->get_node( pnode->right_index );
+
+        bool traverseL = childL->bounding.intersect( inv_r, t1 );
+        bool traverseR = childR->bounding.intersect( inv_r, t2 );
+
+        if( traverseL && m_bvh->is_leaf( childL ) )
+          {
+            if( m_triangles[ childL->element ].intersect( r, t1 ) )
+              record( t1, childL->element );
+            traverseL = false;
+          }
+
+        if( traverseR && m_bvh->is_leaf( childR ) )
+          {
+            if( m_triangles[ childR->element ].intersect( r, t2 ) )
+              record( t2, childR->element );
+            traverseR = false;
+          }
+
+        if( traverseL )
+          {
+            if( traverseR )
+              {
+                GO_ASSERT( stack_size < bvh<geometry::aabox>::traversal_stack_size, "BVH too deep for the traversal stack")(stack_size);
+                stack[ stack_size++ ] = childR;
+              }
+            pnode = childL;
+          }
+        else if( traverseR )
+          pnode = childR;
+        else
+          pnode = stack_size ? stack[ --stack_size ] : nullptr;
+      }
+    while( pnode );
+    return nhits;
+  }
+
+  void
+  mesh_spatial_optimization::intersect_all( const ray* rays, size_t nrays, real* distances, size_t* faces, size_t capacity, size_t* counts ) const
+  {
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( long i = 0; i < long(nrays); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( size_t i = 0; i < nrays; ++ i )
+    # endif
+      {
+        counts[i] = intersect_all( rays[i], distances + i * capacity, faces + i * capacity, capacity );
+      }
+  }
+
+  real
+  mesh_spatial_optimization::get_closest_point( const vec3& location, vec3& closest_point, size_t& closest_face_index ) const
+  {
+    return geometry::get_closest_point( *m_bvh, m_triangles.data(), location, closest_point, closest_face_index );
+  }
+
+  void
+  mesh_spatial_optimization::get_closest_point( const vec3* locations, size_t nlocations, vec3* closest_points, size_t* faces, real* squared_distances ) const
+  {
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( long i = 0; i < long(nlocations); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,64)
+    for( size_t i = 0; i < nlocations; ++ i )
+    # endif
+      {
+        squared_distances[i] = get_closest_point( locations[i], closest_points[i], faces[i] );
+      }
+  }
+
   void
   mesh_spatial_optimization::get_closest_vertex( const vec3& location, uint32_t& vertex_index, real& squared_distance_to_vertex ) const
   {
-    m_kdtree->knnSearch( &location.x, 1, &vertex_index, &squared_distance_to_vertex );
+    m_kdtree->k_nearest( location, 1, &vertex_index, &squared_distance_to_vertex );
   }
 
   void
   mesh_spatial_optimization::k_nearest_vertices(
       const vec3& location, uint32_t k, uint32_t* indices, real* squared_distances )
   {
-    m_kdtree->knnSearch( &location.x, k, indices, squared_distances );
+    m_kdtree->k_nearest( location, k, indices, squared_distances );
   }
 
   void mesh_spatial_optimization::radius_search( const vec3& location, real radius,
       std::vector< std::pair< uint32_t, real >>& indices_sdistances ) const
   {
-    m_kdtree->radiusSearch( &location.x, radius, indices_sdistances, nanoflann::SearchParams{} );
+    m_kdtree->radius_search( location, radius, indices_sdistances );
   }
 
   bool
@@ -953,15 +1151,84 @@ BEGIN_GO_NAMESPACE namespace geometry {
     return m_bvh;
   }
 
+  const bvh<aabox>* mesh_spatial_optimization::get_bvh() const
+  {
+    return m_bvh;
+  }
+
+  const kdtree* mesh_spatial_optimization::get_kdtree() const
+  {
+    return m_kdtree;
+  }
+
   mesh& mesh_spatial_optimization::get_geometry()
   {
     return m_mesh;
   }
 
+  const mesh& mesh_spatial_optimization::get_geometry() const
+  {
+    return m_mesh;
+  }
+
   const aabox&
   mesh_spatial_optimization::get_bounding_box() const
   {
     return bounding_box;
   }
 
+  void
+  mesh_spatial_optimization::copy_vertices( std::vector< vec3 >& points, std::vector< vec3 >& normals ) const
+  {
+    const size_t nvertices = m_mesh.n_vertices();
+    points.resize( nvertices );
+    normals.resize( nvertices );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nvertices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nvertices; ++ i )
+    # endif
+      {
+        const real* point = get_point( vertex_index( i ) );
+        const real* normal = get_normal( vertex_index( i ) );
+        points[ i ] = vec3{ point[0], point[1], point[2] };
+        normals[ i ] = vec3{ normal[0], normal[1], normal[2] };
+      }
+  }
+
+  void
+  compute_one_sided_distance(
+      const mesh_spatial_optimization& source, const mesh_spatial_optimization& target,
+      const distance_parameters& parameters, one_sided_distance& result )
+  {
+    compute_one_sided_distance(
+        indexed_mesh( source.get_geometry() ),
+        *target.get_bvh(), &target.get_triangle( 0 ),
+        parameters, result );
+  }
+
+  void
+  compute_distance(
+      const mesh_spatial_optimization& first, const mesh_spatial_optimization& second,
+      const distance_parameters& parameters, mesh_distance& result )
+  {
+    compute_one_sided_distance( first, second, parameters, result.forward );
+    compute_one_sided_distance( second, first, parameters, result.backward );
+  }
+
+  void
+  compute_shrinking_balls(
+      const mesh_spatial_optimization& m,
+      const shrinking_ball_parameters& parameters,
+      std::vector< ball >& balls, std::vector< uint32_t >* sources )
+  {
+    const size_t nvertices = m.get_geometry().n_vertices();
+    std::vector< vec3 > points, normals;
+    m.copy_vertices( points, normals );
+    compute_shrinking_balls( points.data(), normals.data(), nvertices, *m.get_kdtree(), parameters, balls, sources );
+  }
+
 } END_GO_NAMESPACE
@@ -0,0 +1,533 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/mesh_distance.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/detail/mesh_triangles.h"
+# include "../../graphics-origin/geometry/detail/sampling.h"
+# include "../../graphics-origin/tools/assert.h"
+# include "../../graphics-origin/tools/log.h"
+
+# include <atomic>
+# include <cmath>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Maximum number of times a face is split in four to refine the upper
+     * bound of the Hausdorff distance. */
+    constexpr unsigned max_refinement_depth = 16;
+
+    /**Closest point of a triangle, from Ericson's Real-Time Collision
+     * Detection. The Voronoi regions of the vertices and edges are tested
+     * before projecting the point on the plane of the triangle. */
+    vec3 get_closest_point_on_triangle( const vec3& p, const vec3& a, const vec3& b, const vec3& c )
+    {
+      const vec3 ab = b - a, ac = c - a, ap = p - a;
+      const real d1 = dot( ab, ap ), d2 = dot( ac, ap );
+      if( d1 <= 0 && d2 <= 0 )
+        return a;
+
+      const vec3 bp = p - b;
+      const real d3 = dot( ab, bp ), d4 = dot( ac, bp );
+      if( d3 >= 0 && d4 <= d3 )
+        return b;
+
+      const real vc = d1 * d4 - d3 * d2;
+      if( vc <= 0 && d1 >= 0 && d3 <= 0 )
+        return a + ( d1 / ( d1 - d3 ) ) * ab;
+
+      const vec3 cp = p - c;
+      const real d5 = dot( ab, cp ), d6 = dot( ac, cp );
+      if( d6 >= 0 && d5 <= d6 )
+        return c;
+
+      const real vb = d5 * d2 - d1 * d6;
+      if( vb <= 0 && d2 >= 0 && d6 <= 0 )
+        return a + ( d2 / ( d2 - d6 ) ) * ac;
+
+      const real va = d3 * d6 - d5 * d4;
+      if( va <= 0 && ( d4 - d3 ) >= 0 && ( d5 - d6 ) >= 0 )
+        return b + ( ( d4 - d3 ) / ( ( d4 - d3 ) + ( d5 - d6 ) ) ) * ( c - b );
+
+      const real denominator = real(1) / ( va + vb + vc );
+      return a + ( vb * denominator ) * ab + ( vc * denominator ) * ac;
+    }
+
+    inline real get_squared_distance( const aabox& b, const vec3& p )
+    {
+      const vec3 d = max( abs( p - b.center ) - b.hsides, vec3{ 0, 0, 0 } );
+      return dot( d, d );
+    }
+
+    /**Closest point queries from a mesh to target triangles. */
+    struct target_surface {
+      /**A target without hierarchy is made of a single triangle, which is
+       * tested directly. */
+      target_surface( const bvh< aabox >* hierarchy, const triangle* triangles )
+        : hierarchy{ hierarchy }, triangles{ triangles }
+      {}
+
+      inline real get_distance( const vec3& p, vec3& closest, size_t& face ) const
+      {
+        if( hierarchy )
+          return std::sqrt( get_closest_point( *hierarchy, triangles, p, closest, face ) );
+        const triangle& t = triangles[ 0 ];
+        closest = get_closest_point_on_triangle(
+            p, t.get_vertex( triangle::V0 ), t.get_vertex( triangle::V1 ), t.get_vertex( triangle::V2 ) );
+        face = 0;
+        return length( closest - p );
+      }
+      inline real get_distance( const vec3& p, vec3& closest ) const
+      {
+        size_t face = 0;
+        return get_distance( p, closest, face );
+      }
+
+      const bvh< aabox >* hierarchy;
+      const triangle* triangles;
+    };
+
+    /**The current lower bound of the Hausdorff distance and where it is
+     * reached. */
+    struct hausdorff_bound {
+      hausdorff_bound()
+        : distance{ 0 }, source{ 0, 0, 0 }, target{ 0, 0, 0 }
+      {}
+      inline void update( real d, const vec3& p, const vec3& q )
+      {
+        if( d > distance )
+          {
+            distance = d;
+            source = p;
+            target = q;
+          }
+      }
+      inline void update( const hausdorff_bound& other )
+      {
+        update( other.distance, other.source, other.target );
+      }
+      real distance;
+      vec3 source;
+      vec3 target;
+    };
+
+    /**Raise an atomic real to a value. */
+    inline void raise( std::atomic< real >& bound, real value )
+    {
+      real current = bound.load( std::memory_order_relaxed );
+      while( value > current && !bound.compare_exchange_weak( current, value, std::memory_order_relaxed ) )
+        {}
+    }
+
+    /**A part of a source face, with the distances of its vertices to the
+     * target. */
+    struct face_part {
+      vec3 vertices[3];
+      real distances[3];
+      size_t faces[3];
+      unsigned depth;
+    };
+
+    /**Upper bound of the distance to the target of the points of a face
+     * part. The distance to a single target face is convex, so its maximum on
+     * the part is reached at a vertex: the distances of the vertices to the
+     * faces closest to them give a first bound. Since the distance to the
+     * target is 1-Lipschitz, no point is further than the distance of a
+     * vertex plus the distance to this vertex, which gives a second bound. */
+    inline real get_upper_bound( const face_part& part, const triangle* triangles )
+    {
+      real bound = REAL_MAX;
+      for( int i = 0; i < 3; ++ i )
+        {
+          if( ( i > 0 && part.faces[i] == part.faces[0] ) || ( i > 1 && part.faces[i] == part.faces[1] ) )
+            continue;
+          const triangle& t = triangles[ part.faces[i] ];
+          real face_bound = 0;
+          for( int j = 0; j < 3; ++ j )
+            {
+              const vec3& p = part.vertices[j];
+              const real d = j == i ? part.distances[j] : length( p - get_closest_point_on_triangle(
+                  p, t.get_vertex( triangle::V0 ), t.get_vertex( triangle::V1 ), t.get_vertex( triangle::V2 ) ) );
+              face_bound = std::max( face_bound, d );
+            }
+          bound = std::min( bound, face_bound );
+        }
+      for( int i = 0; i < 3; ++ i )
+        {
+          const real radius = std::max(
+              length( part.vertices[ ( i + 1 ) % 3 ] - part.vertices[i] ),
+              length( part.vertices[ ( i + 2 ) % 3 ] - part.vertices[i] ) );
+          bound = std::min( bound, part.distances[i] + radius );
+        }
+      return bound;
+    }
+  }
+
+  real
+  get_closest_point(
+      const bvh< aabox >& hierarchy, const triangle* triangles,
+      const vec3& location, vec3& closest_point, size_t& closest_face_index,
+      real max_squared_distance )
+  {
+    typedef bvh< aabox >::node node;
+    std::pair< const node*, real > stack[ bvh< aabox >::traversal_stack_size ];
+    size_t stack_size = 0;
+    real best = max_squared_distance;
+    bool found = false;
+    const node* pnode = &hierarchy.get_node( 0 );
+    do
+      {
+        const bvh< aabox >::node_index indices[2] = { pnode->left_index, pnode->right_index };
+        const node* children[2] = { &hierarchy.get_node( indices[0] ), &hierarchy.get_node( indices[1] ) };
+        real distances[2];
+        bool traverse[2];
+        for( int i = 0; i < 2; ++ i )
+          {
+            distances[i] = get_squared_distance( children[i]->bounding, location );
+            traverse[i] = distances[i] < best;
+            if( traverse[i] && hierarchy.is_leaf( indices[i] ) )
+              {
+                const triangle& t = triangles[ children[i]->element ];
+                const vec3 p = get_closest_point_on_triangle(
+                    location, t.get_vertex( triangle::V0 ), t.get_vertex( triangle::V1 ), t.get_vertex( triangle::V2 ) );
+                const real d = dot( p - location, p - location );
+                if( d < best || ( !found && d <= best ) )
+                  {
+                    best = d;
+                    closest_point = p;
+                    closest_face_index = children[i]->element;
+                    found = true;
+                  }
+                traverse[i] = false;
+              }
+          }
+
+        if( traverse[0] && traverse[1] )
+          {
+            const int first = distances[0] <= distances[1] ? 0 : 1;
+            GO_ASSERT( stack_size < bvh< aabox >::traversal_stack_size, "BVH too deep for the traversal stack")(stack_size);
+            stack[ stack_size++ ] = std::make_pair( children[ 1 - first ], distances[ 1 - first ] );
+            pnode = children[ first ];
+          }
+        else if( traverse[0] || traverse[1] )
+          pnode = children[ traverse[0] ? 0 : 1 ];
+        else
+          {
+            pnode = nullptr;
+            while( stack_size && !pnode )
+              {
+                --stack_size;
+                if( stack[ stack_size ].second < best )
+                  pnode = stack[ stack_size ].first;
+              }
+          }
+      }
+    while( pnode );
+    return found ? best : REAL_MAX;
+  }
+
+  distance_parameters::distance_parameters()
+    : number_of_samples{ 1000000 }, tolerance{ 1e-4 }
+  {}
+
+  one_sided_distance::one_sided_distance()
+    : hausdorff{ 0 }, mean{ 0 }, rms{ 0 },
+      source_location{ 0, 0, 0 }, target_location{ 0, 0, 0 },
+      number_of_samples{ 0 }
+  {}
+
+  namespace {
+    /**Compute the distance from a mesh to a target surface. */
+    void compute_one_sided_distance(
+        const indexed_mesh& source, const target_surface& target,
+        const distance_parameters& parameters, one_sided_distance& result )
+    {
+      result = one_sided_distance();
+      const size_t nvertices = source.get_number_of_vertices();
+      std::vector< triangle > triangles;
+      std::vector< uint32_t > faces;
+      detail::build_triangles( source, triangles, faces );
+      const size_t nfaces = faces.size();
+
+      // only the vertices of valid faces are samples of the source surface
+      std::vector< uint8_t > referenced( nvertices, 0 );
+      for( auto face : faces )
+        for( int k = 0; k < 3; ++ k )
+          referenced[ source.indices[ 3 * size_t( face ) + k ] ] = 1;
+
+      // distances of the vertices: first lower bound
+      std::vector< real > vertex_distances( nvertices );
+      std::vector< size_t > vertex_faces( nvertices );
+      hausdorff_bound bound;
+      real vertex_sum = 0, vertex_squared_sum = 0;
+      size_t nreferenced = 0;
+      # pragma omp parallel
+      {
+        hausdorff_bound thread_bound;
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp for schedule(dynamic,256) reduction(+:vertex_sum,vertex_squared_sum,nreferenced)
+        for( long i = 0; i < long(nvertices); ++ i )
+        # else
+        #   pragma omp for schedule(dynamic,256) reduction(+:vertex_sum,vertex_squared_sum,nreferenced)
+        for( size_t i = 0; i < nvertices; ++ i )
+        # endif
+          {
+            if( !referenced[ i ] )
+              continue;
+            ++ nreferenced;
+            vec3 closest;
+            const real d = target.get_distance( source.vertices[ i ], closest, vertex_faces[ i ] );
+            vertex_distances[ i ] = d;
+            vertex_sum += d;
+            vertex_squared_sum += d * d;
+            thread_bound.update( d, source.vertices[ i ], closest );
+          }
+        # pragma omp critical
+        bound.update( thread_bound );
+      }
+      result.number_of_samples = nreferenced;
+
+      // samples in faces: mean and rms distances, weighted by area
+      std::vector< real > areas( nfaces );
+      real area = 0;
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static) reduction(+:area)
+      for( long i = 0; i < long(nfaces); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static) reduction(+:area)
+      for( size_t i = 0; i < nfaces; ++ i )
+      # endif
+        {
+          const vec3& a = triangles[ i ].get_vertex( triangle::V0 );
+          areas[ i ] = real(0.5) * length( cross(
+              triangles[ i ].get_vertex( triangle::V1 ) - a,
+              triangles[ i ].get_vertex( triangle::V2 ) - a ) );
+          area += areas[ i ];
+        }
+
+      if( parameters.number_of_samples && area > 0 )
+        {
+          const real density = real( parameters.number_of_samples ) / area;
+          real sum = 0, squared_sum = 0;
+          size_t nsamples = 0;
+          # pragma omp parallel
+          {
+            hausdorff_bound thread_bound;
+            # ifdef _MSC_VER
+            GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+            #   pragma omp for schedule(dynamic,64) reduction(+:sum,squared_sum,nsamples)
+            for( long i = 0; i < long(nfaces); ++ i )
+            # else
+            #   pragma omp for schedule(dynamic,64) reduction(+:sum,squared_sum,nsamples)
+            for( size_t i = 0; i < nfaces; ++ i )
+            # endif
+              {
+                const vec3& a = triangles[ i ].get_vertex( triangle::V0 );
+                const vec3 ab = triangles[ i ].get_vertex( triangle::V1 ) - a;
+                const vec3 ac = triangles[ i ].get_vertex( triangle::V2 ) - a;
+                const real face_area = areas[ i ];
+                if( !( face_area > 0 ) )
+                  continue;
+                const size_t n = std::max( size_t( std::ceil( face_area * density ) ), size_t(1) );
+                const real weight = face_area / real( n );
+                real u = 0.5, v = 0.5;
+                for( size_t j = 0; j < n; ++ j )
+                  {
+                    u += detail::r2_first_increment;
+                    v += detail::r2_second_increment;
+                    u -= std::floor( u );
+                    v -= std::floor( v );
+                    const vec3 p = u + v > 1 ? a + ( 1 - u ) * ab + ( 1 - v ) * ac : a + u * ab + v * ac;
+                    vec3 closest;
+                    const real d = target.get_distance( p, closest );
+                    sum += weight * d;
+                    squared_sum += weight * d * d;
+                    thread_bound.update( d, p, closest );
+                  }
+                nsamples += n;
+              }
+            # pragma omp critical
+            bound.update( thread_bound );
+          }
+          result.mean = sum / area;
+          result.rms = std::sqrt( squared_sum / area );
+          result.number_of_samples += nsamples;
+        }
+      else if( nreferenced )
+        {
+          result.mean = vertex_sum / real( nreferenced );
+          result.rms = std::sqrt( vertex_squared_sum / real( nreferenced ) );
+        }
+
+      if( nfaces < 2 )
+        {
+          result.hausdorff = bound.distance;
+          result.source_location = bound.source;
+          result.target_location = bound.target;
+          return;
+        }
+
+      // bound-and-prune traversal of the hierarchy of source faces
+      aabox box;
+      source.compute_bounding_box( box );
+      const real tolerance = parameters.tolerance * real(2) * length( box.hsides );
+      bvh< aabox > hierarchy( triangles.data(), nfaces );
+      std::vector< bvh< aabox >::node_index > frontier( 1, 0 ), next_frontier, leaves;
+      size_t nsamples = 0;
+      while( !frontier.empty() )
+        {
+          next_frontier.clear();
+          # pragma omp parallel
+          {
+            std::vector< bvh< aabox >::node_index > thread_frontier, thread_leaves;
+            const size_t nnodes = frontier.size();
+            # ifdef _MSC_VER
+            GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+            #   pragma omp for schedule(dynamic,16) reduction(+:nsamples)
+            for( long i = 0; i < long(nnodes); ++ i )
+            # else
+            #   pragma omp for schedule(dynamic,16) reduction(+:nsamples)
+            for( size_t i = 0; i < nnodes; ++ i )
+            # endif
+              {
+                const auto& n = hierarchy.get_node( frontier[ i ] );
+                vec3 closest;
+                const real upper_bound = target.get_distance( n.bounding.center, closest ) + length( n.bounding.hsides );
+                ++ nsamples;
+                if( upper_bound <= bound.distance + tolerance )
+                  continue;
+                for( auto child : { n.left_index, n.right_index } )
+                  {
+                    if( hierarchy.is_leaf( child ) )
+                      thread_leaves.push_back( hierarchy.get_node( child ).element );
+                    else
+                      thread_frontier.push_back( child );
+                  }
+              }
+            # pragma omp critical
+            {
+              next_frontier.insert( next_frontier.end(), thread_frontier.begin(), thread_frontier.end() );
+              leaves.insert( leaves.end(), thread_leaves.begin(), thread_leaves.end() );
+            }
+          }
+          frontier.swap( next_frontier );
+        }
+
+      // refinement of the remaining faces
+      std::atomic< real > lower_bound{ bound.distance };
+      # pragma omp parallel
+      {
+        hausdorff_bound thread_bound;
+        std::vector< face_part > parts;
+        const size_t nleaves = leaves.size();
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp for schedule(dynamic,16) reduction(+:nsamples)
+        for( long i = 0; i < long(nleaves); ++ i )
+        # else
+        #   pragma omp for schedule(dynamic,16) reduction(+:nsamples)
+        for( size_t i = 0; i < nleaves; ++ i )
+        # endif
+          {
+            const uint32_t* face = source.indices.data() + 3 * size_t( faces[ leaves[ i ] ] );
+            face_part part;
+            for( int k = 0; k < 3; ++ k )
+              {
+                part.vertices[ k ] = source.vertices[ face[ k ] ];
+                part.distances[ k ] = vertex_distances[ face[ k ] ];
+                part.faces[ k ] = vertex_faces[ face[ k ] ];
+              }
+            part.depth = 0;
+            parts.assign( 1, part );
+            while( !parts.empty() )
+              {
+                const face_part p = parts.back();
+                parts.pop_back();
+                if( get_upper_bound( p, target.triangles ) <= lower_bound.load( std::memory_order_relaxed ) + tolerance
+                 || p.depth == max_refinement_depth )
+                  continue;
+
+                // split in four at the midpoints of the edges
+                vec3 midpoints[3];
+                real distances[3];
+                size_t closest_faces[3];
+                for( int k = 0; k < 3; ++ k )
+                  {
+                    midpoints[ k ] = real(0.5) * ( p.vertices[ k ] + p.vertices[ ( k + 1 ) % 3 ] );
+                    vec3 closest;
+                    distances[ k ] = target.get_distance( midpoints[ k ], closest, closest_faces[ k ] );
+                    thread_bound.update( distances[ k ], midpoints[ k ], closest );
+                    raise( lower_bound, distances[ k ] );
+                  }
+                nsamples += 3;
+                for( int k = 0; k < 3; ++ k )
+                  parts.push_back( face_part{
+                    { p.vertices[ k ], midpoints[ k ], midpoints[ ( k + 2 ) % 3 ] },
+                    { p.distances[ k ], distances[ k ], distances[ ( k + 2 ) % 3 ] },
+                    { p.faces[ k ], closest_faces[ k ], closest_faces[ ( k + 2 ) % 3 ] },
+                    p.depth + 1 } );
+                parts.push_back( face_part{
+                  { midpoints[0], midpoints[1], midpoints[2] },
+                  { distances[0], distances[1], distances[2] },
+                  { closest_faces[0], closest_faces[1], closest_faces[2] },
+                  p.depth + 1 } );
+              }
+          }
+        # pragma omp critical
+        bound.update( thread_bound );
+      }
+
+      result.hausdorff = bound.distance;
+      result.source_location = bound.source;
+      result.target_location = bound.target;
+      result.number_of_samples += nsamples;
+    }
+  }
+
+  void
+  compute_one_sided_distance(
+      const indexed_mesh& source,
+      const bvh< aabox >& target_hierarchy, const triangle* target_triangles,
+      const distance_parameters& parameters, one_sided_distance& result )
+  {
+    compute_one_sided_distance( source, target_surface( &target_hierarchy, target_triangles ), parameters, result );
+  }
+
+  void
+  compute_one_sided_distance(
+      const indexed_mesh& source, const indexed_mesh& target,
+      const distance_parameters& parameters, one_sided_distance& result )
+  {
+    std::vector< triangle > triangles;
+    std::vector< uint32_t > faces;
+    detail::build_triangles( target, triangles, faces );
+    if( triangles.empty() )
+      {
+        LOG( error, "cannot compute a distance to a mesh without any valid face" );
+        result = one_sided_distance();
+        return;
+      }
+    if( triangles.size() < 2 )
+      {
+        // a hierarchy needs two triangles: the single one is tested directly
+        compute_one_sided_distance( source, target_surface( nullptr, triangles.data() ), parameters, result );
+        return;
+      }
+    bvh< aabox > hierarchy( triangles.data(), triangles.size() );
+    compute_one_sided_distance( source, hierarchy, triangles.data(), parameters, result );
+  }
+
+  void
+  compute_distance(
+      const indexed_mesh& first, const indexed_mesh& second,
+      const distance_parameters& parameters, mesh_distance& result )
+  {
+    compute_one_sided_distance( first, second, parameters, result.forward );
+    compute_one_sided_distance( second, first, parameters, result.backward );
+  }
+
+} END_GO_NAMESPACE
@@ -0,0 +1,538 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/mesh_intersection.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/detail/mesh_triangles.h"
+# include "../../graphics-origin/tools/assert.h"
+
+# include <omp.h>
+# include <algorithm>
+# include <cmath>
+# include <numeric>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Tolerance of the intersection tests, relative to the size of the
+     * triangles. */
+    constexpr real intersection_epsilon = 1e-10;
+    /**Depth of the dual traversal under which pairs of subtrees are no more
+     * split into tasks but traversed with a stack. */
+    constexpr unsigned task_depth = 10;
+
+    inline real orient_2d( const vec2& a, const vec2& b, const vec2& c )
+    {
+      return ( b.x - a.x ) * ( c.y - a.y ) - ( b.y - a.y ) * ( c.x - a.x );
+    }
+
+    /**Test if the 2D segments [p0,p1] and [q0,q1] intersect. If so, t is set
+     * to the parameter of an intersection point along [p0,p1]. */
+    bool intersect_segments_2d( const vec2& p0, const vec2& p1, const vec2& q0, const vec2& q1, real& t )
+    {
+      const real o0 = orient_2d( p0, p1, q0 );
+      const real o1 = orient_2d( p0, p1, q1 );
+      const real o2 = orient_2d( q0, q1, p0 );
+      const real o3 = orient_2d( q0, q1, p1 );
+      if( ( o0 > 0 && o1 > 0 ) || ( o0 < 0 && o1 < 0 ) || ( o2 > 0 && o3 > 0 ) || ( o2 < 0 && o3 < 0 ) )
+        return false;
+      if( o2 != o3 )
+        {
+          t = o2 / ( o2 - o3 );
+          return true;
+        }
+      // collinear segments: compare their projections on [p0,p1]
+      const vec2 d = p1 - p0;
+      const real l = dot( d, d );
+      if( !( l > 0 ) )
+        return false;
+      real t0 = dot( q0 - p0, d ) / l, t1 = dot( q1 - p0, d ) / l;
+      if( t0 > t1 )
+        std::swap( t0, t1 );
+      if( t1 < 0 || t0 > 1 )
+        return false;
+      t = std::max( t0, real(0) );
+      return true;
+    }
+
+    inline bool contain_2d( const vec2* t, const vec2& p )
+    {
+      const real o0 = orient_2d( t[0], t[1], p );
+      const real o1 = orient_2d( t[1], t[2], p );
+      const real o2 = orient_2d( t[2], t[0], p );
+      return ( o0 >= 0 && o1 >= 0 && o2 >= 0 ) || ( o0 <= 0 && o1 <= 0 && o2 <= 0 );
+    }
+
+    /**Test two coplanar triangles in the plane orthogonal to the dominant
+     * axis of their normal. If the triangles share a vertex, its index in
+     * each triangle is given by shared_a and shared_b, and this vertex alone
+     * does not make an intersection. */
+    bool intersect_coplanar(
+        const vec3* a, const vec3* b, const vec3& normal,
+        int shared_a, int shared_b, vec3& point )
+    {
+      const vec3 n{ std::abs( normal.x ), std::abs( normal.y ), std::abs( normal.z ) };
+      const int axis = n.x > n.y ? ( n.x > n.z ? 0 : 2 ) : ( n.y > n.z ? 1 : 2 );
+      const int u = ( axis + 1 ) % 3, v = ( axis + 2 ) % 3;
+      vec2 pa[3], pb[3];
+      for( int i = 0; i < 3; ++ i )
+        {
+          pa[i] = vec2{ a[i][u], a[i][v] };
+          pb[i] = vec2{ b[i][u], b[i][v] };
+        }
+
+      for( int i = 0; i < 3; ++ i )
+        {
+          const bool a_edge_shared = i == shared_a || ( i + 1 ) % 3 == shared_a;
+          for( int j = 0; j < 3; ++ j )
+            {
+              // two edges incident to the shared vertex meet at this vertex
+              if( a_edge_shared && ( j == shared_b || ( j + 1 ) % 3 == shared_b ) )
+                continue;
+              real t;
+              if( intersect_segments_2d( pa[i], pa[ ( i + 1 ) % 3 ], pb[j], pb[ ( j + 1 ) % 3 ], t ) )
+                {
+                  point = a[i] + t * ( a[ ( i + 1 ) % 3 ] - a[i] );
+                  return true;
+                }
+            }
+        }
+      // no edge crossing: one triangle can still contain the other
+      for( int i = 0; i < 3; ++ i )
+        if( i != shared_a && contain_2d( pb, pa[i] ) )
+          {
+            point = a[i];
+            return true;
+          }
+      for( int i = 0; i < 3; ++ i )
+        if( i != shared_b && contain_2d( pa, pb[i] ) )
+          {
+            point = b[i];
+            return true;
+          }
+      return false;
+    }
+
+    /**Compute the signed distances of the vertices of a triangle to a plane,
+     * and snap them to zero under a tolerance. Return false if the three
+     * vertices are strictly on the same side of the plane. */
+    inline bool compute_plane_distances(
+        const vec3* t, const vec3& normal, const vec3& origin, real tolerance, real* d )
+    {
+      for( int i = 0; i < 3; ++ i )
+        {
+          d[i] = dot( normal, t[i] - origin );
+          if( std::abs( d[i] ) <= tolerance )
+            d[i] = 0;
+        }
+      return !( ( d[0] > 0 && d[1] > 0 && d[2] > 0 ) || ( d[0] < 0 && d[1] < 0 && d[2] < 0 ) );
+    }
+
+    /**Compute the segment along which a triangle crosses a plane, from the
+     * snapped signed distances of its vertices. */
+    inline void compute_plane_crossing( const vec3* t, const real* d, vec3& s0, vec3& s1 )
+    {
+      vec3 points[2];
+      int n = 0;
+      for( int i = 0; i < 3 && n < 2; ++ i )
+        {
+          const int j = ( i + 1 ) % 3;
+          if( d[i] == 0 )
+            points[ n++ ] = t[i];
+          if( n < 2 && ( ( d[i] < 0 && d[j] > 0 ) || ( d[i] > 0 && d[j] < 0 ) ) )
+            points[ n++ ] = t[i] + ( d[i] / ( d[i] - d[j] ) ) * ( t[j] - t[i] );
+        }
+      s0 = points[0];
+      s1 = n == 2 ? points[1] : points[0];
+    }
+
+    /**Test if two triangles intersect. If the triangles share a vertex, its
+     * index in each triangle is given by shared_a and shared_b. */
+    bool intersect_triangles(
+        const vec3* a, const vec3* b, int shared_a, int shared_b,
+        vec3& start, vec3& end )
+    {
+      const vec3 na = cross( a[1] - a[0], a[2] - a[0] );
+      const vec3 nb = cross( b[1] - b[0], b[2] - b[0] );
+      const real la = length( na ), lb = length( nb );
+      if( !( la > 0 ) || !( lb > 0 ) )
+        return false;
+
+      real size = 0;
+      for( int i = 0; i < 3; ++ i )
+        size = std::max( size, std::max( length( a[ ( i + 1 ) % 3 ] - a[i] ), length( b[ ( i + 1 ) % 3 ] - b[i] ) ) );
+      const real tolerance = intersection_epsilon * size;
+
+      real da[3], db[3];
+      if( !compute_plane_distances( a, nb, b[0], tolerance * lb, da ) )
+        return false;
+      if( da[0] == 0 && da[1] == 0 && da[2] == 0 )
+        {
+          if( !intersect_coplanar( a, b, nb, shared_a, shared_b, start ) )
+            return false;
+          end = start;
+          return true;
+        }
+      if( !compute_plane_distances( b, na, a[0], tolerance * la, db ) )
+        return false;
+      if( db[0] == 0 && db[1] == 0 && db[2] == 0 )
+        {
+          if( !intersect_coplanar( a, b, na, shared_a, shared_b, start ) )
+            return false;
+          end = start;
+          return true;
+        }
+
+      // compare the crossing segments along the intersection line of planes
+      vec3 a0, a1, b0, b1;
+      compute_plane_crossing( a, da, a0, a1 );
+      compute_plane_crossing( b, db, b0, b1 );
+      const vec3 direction = cross( na, nb );
+      real ta0 = dot( direction, a0 ), ta1 = dot( direction, a1 );
+      real tb0 = dot( direction, b0 ), tb1 = dot( direction, b1 );
+      if( ta0 > ta1 )
+        {
+          std::swap( ta0, ta1 );
+          std::swap( a0, a1 );
+        }
+      if( tb0 > tb1 )
+        {
+          std::swap( tb0, tb1 );
+          std::swap( b0, b1 );
+        }
+      if( std::max( ta0, tb0 ) > std::min( ta1, tb1 ) + tolerance * length( direction ) )
+        return false;
+      start = ta0 >= tb0 ? a0 : b0;
+      end = ta1 <= tb1 ? a1 : b1;
+
+      // adjacent triangles touching only at their shared vertex
+      if( shared_a >= 0 )
+        {
+          const vec3& s = a[ shared_a ];
+          const real squared_tolerance = tolerance * tolerance;
+          if( dot( start - s, start - s ) <= squared_tolerance && dot( end - s, end - s ) <= squared_tolerance )
+            return false;
+        }
+      return true;
+    }
+
+    /**Test if two boxes overlap, with a slack large enough to keep the
+     * pairs of triangles that touch within the tolerance of the test. */
+    inline bool overlap( const aabox& a, const aabox& b )
+    {
+      const vec3 h = a.hsides + b.hsides;
+      const real slack = 2 * intersection_epsilon * ( h.x + h.y + h.z );
+      return std::abs( a.center.x - b.center.x ) <= h.x + slack
+          && std::abs( a.center.y - b.center.y ) <= h.y + slack
+          && std::abs( a.center.z - b.center.z ) <= h.z + slack;
+    }
+
+    /**Simultaneous traversal of two hierarchies, or of a hierarchy against
+     * itself. Pairs of leaves with overlapping boxes are given to a tester,
+     * which returns true if the elements intersect. */
+    template< typename pair_tester >
+    class dual_traversal {
+    public:
+      typedef bvh< aabox >::node_index node_index;
+
+      dual_traversal(
+          const bvh< aabox >& first, const bvh< aabox >& second,
+          bool self, pair_tester& tester )
+        : m_first{ first }, m_second{ second }, m_self{ self }, m_tester( tester )
+      {}
+
+      void run()
+      {
+        # pragma omp parallel
+        # pragma omp single nowait
+        split( 0, 0, 0 );
+      }
+
+    private:
+      struct node_pair {
+        node_index first;
+        node_index second;
+      };
+
+      inline real get_size( const aabox& b ) const
+      {
+        return b.hsides.x + b.hsides.y + b.hsides.z;
+      }
+
+      /**Get the pairs of children to visit after a pair of nodes. Pairs of
+       * leaves are tested directly. Return the number of pairs to visit. */
+      int expand( const node_pair& pair, node_pair* children )
+      {
+        const auto& a = m_first.get_node( pair.first );
+        const auto& b = m_second.get_node( pair.second );
+        int n = 0;
+        auto push = [&]( node_index i, node_index j )
+          {
+            if( !overlap( m_first.get_node( i ).bounding, m_second.get_node( j ).bounding ) )
+              return;
+            if( m_first.is_leaf( i ) && m_second.is_leaf( j ) )
+              m_tester( m_first.get_node( i ).element, m_second.get_node( j ).element );
+            else
+              children[ n++ ] = node_pair{ i, j };
+          };
+
+        if( m_self && pair.first == pair.second )
+          {
+            // a leaf is never tested against itself
+            if( m_first.is_leaf( pair.first ) )
+              return 0;
+            push( a.left_index, a.left_index );
+            push( a.right_index, a.right_index );
+            push( a.left_index, a.right_index );
+          }
+        else if( m_second.is_leaf( pair.second )
+             || ( !m_first.is_leaf( pair.first ) && get_size( a.bounding ) >= get_size( b.bounding ) ) )
+          {
+            push( a.left_index, pair.second );
+            push( a.right_index, pair.second );
+          }
+        else
+          {
+            push( pair.first, b.left_index );
+            push( pair.first, b.right_index );
+          }
+        return n;
+      }
+
+      void split( node_index first, node_index second, unsigned depth )
+      {
+        node_pair children[3];
+        const int n = expand( node_pair{ first, second }, children );
+        for( int i = 0; i < n; ++ i )
+          {
+            const node_pair child = children[ i ];
+            if( depth + 1 < task_depth )
+              {
+                # pragma omp task firstprivate( child, depth )
+                split( child.first, child.second, depth + 1 );
+              }
+            else
+              {
+                # pragma omp task firstprivate( child )
+                traverse( child );
+              }
+          }
+      }
+
+      void traverse( const node_pair& root )
+      {
+        // each expansion goes one level deeper in at least one hierarchy and
+        // leaves at most two more pairs on the stack
+        node_pair stack[ 3 * bvh< aabox >::traversal_stack_size ];
+        size_t stack_size = 0;
+        stack[ stack_size++ ] = root;
+        node_pair children[3];
+        while( stack_size )
+          {
+            const node_pair pair = stack[ --stack_size ];
+            const int n = expand( pair, children );
+            GO_ASSERT( stack_size + n <= 3 * bvh< aabox >::traversal_stack_size, "BVH too deep for the traversal stack")(stack_size);
+            for( int i = 0; i < n; ++ i )
+              stack[ stack_size++ ] = children[ i ];
+          }
+      }
+
+      const bvh< aabox >& m_first;
+      const bvh< aabox >& m_second;
+      const bool m_self;
+      pair_tester& m_tester;
+    };
+
+    /**Collect intersecting pairs in per-thread buffers, to merge them at the
+     * end without any lock. */
+    struct intersection_collector {
+      intersection_collector( bool compute_segments )
+        : buffers( omp_get_max_threads() ), compute_segments{ compute_segments }
+      {}
+
+      inline void add( uint32_t a, uint32_t b, const vec3& start, const vec3& end )
+      {
+        face_intersections& buffer = buffers[ omp_get_thread_num() ];
+        buffer.faces.push_back( std::make_pair( a, b ) );
+        if( compute_segments )
+          buffer.segments.push_back( std::make_pair( start, end ) );
+      }
+
+      /**Merge the buffers and sort the pairs. */
+      void merge( face_intersections& result ) const
+      {
+        face_intersections merged;
+        for( auto& buffer : buffers )
+          {
+            merged.faces.insert( merged.faces.end(), buffer.faces.begin(), buffer.faces.end() );
+            merged.segments.insert( merged.segments.end(), buffer.segments.begin(), buffer.segments.end() );
+          }
+        std::vector< size_t > order( merged.faces.size() );
+        std::iota( order.begin(), order.end(), size_t(0) );
+        std::sort( order.begin(), order.end(), [&merged]( size_t i, size_t j )
+          {
+            return merged.faces[ i ] < merged.faces[ j ];
+          });
+        result.clear();
+        result.faces.resize( order.size() );
+        for( size_t i = 0; i < order.size(); ++ i )
+          result.faces[ i ] = merged.faces[ order[ i ] ];
+        if( compute_segments )
+          {
+            result.segments.resize( order.size() );
+            for( size_t i = 0; i < order.size(); ++ i )
+              result.segments[ i ] = merged.segments[ order[ i ] ];
+          }
+      }
+
+      std::vector< face_intersections > buffers;
+      const bool compute_segments;
+    };
+
+    inline void get_vertices( const triangle& t, vec3* vertices )
+    {
+      vertices[0] = t.get_vertex( triangle::V0 );
+      vertices[1] = t.get_vertex( triangle::V1 );
+      vertices[2] = t.get_vertex( triangle::V2 );
+    }
+
+    /**Replace triangle indices by face indices. */
+    void remap_faces(
+        const std::vector< uint32_t >& first_faces, const std::vector< uint32_t >& second_faces,
+        face_intersections& result )
+    {
+      for( auto& pair : result.faces )
+        {
+          pair.first = first_faces[ pair.first ];
+          pair.second = second_faces[ pair.second ];
+        }
+    }
+  }
+
+  void
+  face_intersections::clear()
+  {
+    faces.clear();
+    segments.clear();
+  }
+
+  bool
+  intersect( const triangle& a, const triangle& b, vec3* start, vec3* end )
+  {
+    vec3 va[3], vb[3], s, e;
+    get_vertices( a, va );
+    get_vertices( b, vb );
+    if( !intersect_triangles( va, vb, -1, -1, s, e ) )
+      return false;
+    if( start )
+      *start = s;
+    if( end )
+      *end = e;
+    return true;
+  }
+
+  void
+  find_intersections(
+      const bvh< aabox >& first_hierarchy, const triangle* first_triangles,
+      const bvh< aabox >& second_hierarchy, const triangle* second_triangles,
+      face_intersections& result, bool compute_segments )
+  {
+    intersection_collector collector( compute_segments );
+    auto tester = [&]( uint32_t i, uint32_t j )
+      {
+        vec3 a[3], b[3], start, end;
+        get_vertices( first_triangles[ i ], a );
+        get_vertices( second_triangles[ j ], b );
+        if( intersect_triangles( a, b, -1, -1, start, end ) )
+          collector.add( i, j, start, end );
+      };
+    if( overlap( first_hierarchy.get_node( 0 ).bounding, second_hierarchy.get_node( 0 ).bounding ) )
+      dual_traversal< decltype(tester) >( first_hierarchy, second_hierarchy, false, tester ).run();
+    collector.merge( result );
+  }
+
+  void
+  find_self_intersections(
+      const bvh< aabox >& hierarchy, const triangle* triangles, const uint32_t* indices,
+      face_intersections& result, bool compute_segments )
+  {
+    intersection_collector collector( compute_segments );
+    auto tester = [&]( uint32_t i, uint32_t j )
+      {
+        if( i > j )
+          std::swap( i, j );
+        const uint32_t* fi = indices + 3 * size_t( i );
+        const uint32_t* fj = indices + 3 * size_t( j );
+        int shared_i = -1, shared_j = -1, nshared = 0;
+        for( int k = 0; k < 3; ++ k )
+          for( int l = 0; l < 3; ++ l )
+            if( fi[ k ] == fj[ l ] )
+              {
+                shared_i = k;
+                shared_j = l;
+                ++ nshared;
+              }
+        if( nshared > 1 )
+          return;
+
+        vec3 a[3], b[3], start, end;
+        get_vertices( triangles[ i ], a );
+        get_vertices( triangles[ j ], b );
+        if( intersect_triangles( a, b, shared_i, shared_j, start, end ) )
+          collector.add( i, j, start, end );
+      };
+    dual_traversal< decltype(tester) >( hierarchy, hierarchy, true, tester ).run();
+    collector.merge( result );
+  }
+
+  void
+  find_intersections(
+      const indexed_mesh& first, const indexed_mesh& second,
+      face_intersections& result, bool compute_segments )
+  {
+    std::vector< triangle > first_triangles, second_triangles;
+    std::vector< uint32_t > first_faces, second_faces;
+    detail::build_triangles( first, first_triangles, first_faces );
+    detail::build_triangles( second, second_triangles, second_faces );
+
+    if( first_triangles.size() < 2 || second_triangles.size() < 2 )
+      {
+        // too few triangles for a hierarchy, but also for a costly search
+        intersection_collector collector( compute_segments );
+        for( uint32_t i = 0; i < first_triangles.size(); ++ i )
+          for( uint32_t j = 0; j < second_triangles.size(); ++ j )
+            {
+              vec3 start, end;
+              if( intersect( first_triangles[ i ], second_triangles[ j ], &start, &end ) )
+                collector.add( i, j, start, end );
+            }
+        collector.merge( result );
+      }
+    else
+      {
+        bvh< aabox > first_hierarchy( first_triangles.data(), first_triangles.size() );
+        bvh< aabox > second_hierarchy( second_triangles.data(), second_triangles.size() );
+        find_intersections(
+            first_hierarchy, first_triangles.data(),
+            second_hierarchy, second_triangles.data(),
+            result, compute_segments );
+      }
+    remap_faces( first_faces, second_faces, result );
+  }
+
+  void
+  find_self_intersections( const indexed_mesh& m, face_intersections& result, bool compute_segments )
+  {
+    std::vector< triangle > triangles;
+    std::vector< uint32_t > faces, indices;
+    detail::build_triangles( m, triangles, faces, &indices );
+    result.clear();
+    if( triangles.size() < 2 )
+      return;
+    bvh< aabox > hierarchy( triangles.data(), triangles.size() );
+    find_self_intersections( hierarchy, triangles.data(), indices.data(), result, compute_segments );
+    // triangles are in the order of faces, so pairs stay sorted
+    remap_faces( faces, faces, result );
+  }
+
+} END_GO_NAMESPACE
@@ -0,0 +1,251 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/mesh_normals.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/mesh.h"
+
+# include <cmath>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Compute the unit normal of each face and the weight of this normal at
+     * each corner of the face. */
+    void compute_face_contributions(
+        const vec3* positions, const uint32_t* indices, size_t nfaces,
+        normal_weighting weighting,
+        vec3* normals, vec3* weights )
+    {
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nfaces); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nfaces; ++ i )
+      # endif
+        {
+          const uint32_t* f = indices + 3 * i;
+          if( f[0] == indexed_mesh::invalid_index )
+            {
+              normals[ i ] = vec3{ 0, 0, 0 };
+              if( weights )
+                weights[ i ] = vec3{ 0, 0, 0 };
+              continue;
+            }
+
+          const vec3 p[3] = { positions[ f[0] ], positions[ f[1] ], positions[ f[2] ] };
+          vec3 weight;
+          compute_face_contribution( p, weighting, normals[ i ], weight );
+          if( weights )
+            weights[ i ] = weight;
+        }
+    }
+
+    /**Gather the face contributions around each vertex, then give the
+     * normalized result to a writer. The faces around a vertex are visited by
+     * for_each_incident_face( vertex, visitor ), which calls visitor( face )
+     * for each face incident to the vertex. */
+    template< typename incident_faces, typename writer >
+    void gather_vertex_normals(
+        size_t nvertices, const uint32_t* indices,
+        incident_faces&& for_each_incident_face,
+        const vec3* face_normals, const vec3* face_weights,
+        writer&& write )
+    {
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nvertices); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nvertices; ++ i )
+      # endif
+        {
+          vec3 sum{ 0, 0, 0 };
+          for_each_incident_face( i, [&]( size_t face )
+            {
+              const uint32_t* f = indices + 3 * face;
+              const int corner = f[0] == uint32_t( i ) ? 0 : ( f[1] == uint32_t( i ) ? 1 : 2 );
+              sum += face_normals[ face ] * face_weights[ face ][ corner ];
+            });
+          const real norm = length( sum );
+          write( i, norm > real(0) ? sum / norm : sum );
+        }
+    }
+
+    /**Visit the faces incident to a vertex thanks to a face adjacency. */
+    struct adjacency_incident_faces {
+      template< typename visitor >
+      void operator()( size_t vertex, visitor&& visit ) const
+      {
+        for( auto it = adjacency.begin( vertex ), end = adjacency.end( vertex ); it != end; ++ it )
+          visit( size_t( *it ) );
+      }
+      const vertex_face_adjacency& adjacency;
+    };
+
+  }
+
+  bool
+  compute_face_contribution(
+      const vec3* p, normal_weighting weighting,
+      vec3& normal, vec3& weights )
+  {
+    const vec3 n = cross( p[1] - p[0], p[2] - p[0] );
+    const real double_area = length( n );
+    if( !( double_area > real(0) ) )
+      {
+        normal = vec3{ 0, 0, 0 };
+        weights = vec3{ 0, 0, 0 };
+        return false;
+      }
+    normal = n / double_area;
+    switch( weighting )
+    {
+      case normal_weighting::uniform:
+        weights = vec3{ 1, 1, 1 };
+        break;
+      case normal_weighting::area:
+        weights = vec3{ double_area, double_area, double_area } * real(0.5);
+        break;
+      case normal_weighting::angle:
+        for( int c = 0; c < 3; ++ c )
+          {
+            // the cross product of the two edges has the same length at each corner
+            const vec3 e1 = p[ ( c + 1 ) % 3 ] - p[ c ];
+            const vec3 e2 = p[ ( c + 2 ) % 3 ] - p[ c ];
+            weights[ c ] = std::atan2( double_area, dot( e1, e2 ) );
+          }
+        break;
+    }
+    return true;
+  }
+
+  void
+  compute_face_normals(
+      const vec3* positions, const uint32_t* indices, size_t nfaces,
+      vec3* normals )
+  {
+    compute_face_contributions( positions, indices, nfaces, normal_weighting::uniform, normals, nullptr );
+  }
+
+  void
+  compute_vertex_normals(
+      const vec3* positions, size_t nvertices,
+      const uint32_t* indices, size_t nfaces,
+      const vertex_face_adjacency& adjacency,
+      vec3* normals, normal_weighting weighting )
+  {
+    std::vector< vec3 > face_normals( nfaces ), face_weights( nfaces );
+    compute_face_contributions( positions, indices, nfaces, weighting, face_normals.data(), face_weights.data() );
+    gather_vertex_normals( nvertices, indices, adjacency_incident_faces{ adjacency }, face_normals.data(), face_weights.data(),
+      [normals]( size_t i, const vec3& n )
+      {
+        normals[ i ] = n;
+      });
+  }
+
+  void
+  compute_vertex_normals(
+      const vec3* positions, size_t nvertices,
+      const uint32_t* indices, size_t nfaces,
+      const vertex_face_adjacency& adjacency,
+      gl_real* normals, size_t normal_stride,
+      normal_weighting weighting )
+  {
+    std::vector< vec3 > face_normals( nfaces ), face_weights( nfaces );
+    compute_face_contributions( positions, indices, nfaces, weighting, face_normals.data(), face_weights.data() );
+    gather_vertex_normals( nvertices, indices, adjacency_incident_faces{ adjacency }, face_normals.data(), face_weights.data(),
+      [normals,normal_stride]( size_t i, const vec3& n )
+      {
+        gl_real* dst = normals + i * normal_stride;
+        dst[0] = gl_real( n.x );
+        dst[1] = gl_real( n.y );
+        dst[2] = gl_real( n.z );
+      });
+  }
+
+  void
+  compute_vertex_normals(
+      const indexed_mesh& m, std::vector< vec3 >& normals,
+      normal_weighting weighting )
+  {
+    vertex_face_adjacency adjacency;
+    adjacency.build( m );
+    normals.resize( m.get_number_of_vertices() );
+    compute_vertex_normals(
+        m.vertices.data(), m.get_number_of_vertices(),
+        m.indices.data(), m.get_number_of_faces(),
+        adjacency, normals.data(), weighting );
+  }
+
+  void
+  update_normals( mesh& m, normal_weighting weighting )
+  {
+    const size_t nvertices = m.n_vertices();
+    const size_t nfaces = m.n_faces();
+    if( !nvertices )
+      return;
+
+    // gather the positions and the vertex indices of faces in flat buffers
+    std::vector< vec3 > positions( nvertices );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nvertices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nvertices; ++ i )
+    # endif
+      {
+        const auto& p = m.point( mesh::VertexHandle( i ) );
+        positions[ i ] = vec3{ p[0], p[1], p[2] };
+      }
+
+    std::vector< uint32_t > indices( nfaces * 3 );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        auto fvit = m.cfv_iter( mesh::FaceHandle( i ) );
+        auto dst = indices.data() + 3 * i;
+        dst[ 0 ] = fvit->idx(); ++ fvit;
+        dst[ 1 ] = fvit->idx(); ++ fvit;
+        dst[ 2 ] = fvit->idx();
+      }
+
+    vertex_face_adjacency adjacency;
+    adjacency.build( indices.data(), nfaces, nvertices );
+
+    std::vector< vec3 > face_normals( nfaces ), face_weights( nfaces );
+    compute_face_contributions(
+        positions.data(), indices.data(), nfaces, weighting,
+        face_normals.data(), face_weights.data() );
+    gather_vertex_normals( nvertices, indices.data(), adjacency_incident_faces{ adjacency }, face_normals.data(), face_weights.data(),
+      [&m]( size_t i, const vec3& n )
+      {
+        m.set_normal( mesh::VertexHandle( i ), mesh::Normal{ n.x, n.y, n.z } );
+      });
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        const vec3& n = face_normals[ i ];
+        m.set_normal( mesh::FaceHandle( i ), mesh::Normal{ n.x, n.y, n.z } );
+      }
+  }
+
+} END_GO_NAMESPACE
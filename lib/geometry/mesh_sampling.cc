@@ -0,0 +1,281 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/mesh_sampling.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/box.h"
+# include "../../graphics-origin/geometry/detail/sampling.h"
+# include "../../graphics-origin/tools/log.h"
+
+# include "../../graphics-origin/extlibs/thrust/scan.h"
+# include "../../graphics-origin/extlibs/thrust/sort.h"
+# include "../../graphics-origin/extlibs/thrust/system/omp/execution_policy.h"
+
+# include <algorithm>
+# include <cmath>
+# include <random>
+# include <vector>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Number of samples generated with the same random engine. */
+    constexpr size_t sampling_block_size = 4096;
+    /**Number of bits per coordinate in the key of a Poisson-disk cell. */
+    constexpr int64_t cell_coordinate_bits = 21;
+    constexpr int64_t max_cell_coordinate = ( int64_t(1) << cell_coordinate_bits ) - 1;
+
+    inline uint64_t make_cell_key( int64_t x, int64_t y, int64_t z )
+    {
+      return ( uint64_t( x ) << ( 2 * cell_coordinate_bits ) ) | ( uint64_t( y ) << cell_coordinate_bits ) | uint64_t( z );
+    }
+
+    /**Index of the group of a cell: cells of the same group are at least two
+     * cells apart along an axis. */
+    inline uint32_t get_cell_group( uint64_t key )
+    {
+      return uint32_t(
+          ( ( key >> ( 2 * cell_coordinate_bits ) ) % 3 ) * 9
+        + ( ( ( key >> cell_coordinate_bits ) & max_cell_coordinate ) % 3 ) * 3
+        + ( key & max_cell_coordinate ) % 3 );
+    }
+
+    /**Compute the cumulative areas of the faces of a mesh.
+     * @return The total area. */
+    real compute_cumulative_areas( const indexed_mesh& m, std::vector< real >& cumulative_areas )
+    {
+      const size_t nfaces = m.get_number_of_faces();
+      cumulative_areas.resize( nfaces );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nfaces); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nfaces; ++ i )
+      # endif
+        {
+          const uint32_t* face = m.indices.data() + 3 * i;
+          if( face[0] == indexed_mesh::invalid_index
+           || face[1] == indexed_mesh::invalid_index
+           || face[2] == indexed_mesh::invalid_index )
+            cumulative_areas[ i ] = 0;
+          else
+            {
+              const vec3& a = m.vertices[ face[0] ];
+              cumulative_areas[ i ] = real(0.5) * length( cross( m.vertices[ face[1] ] - a, m.vertices[ face[2] ] - a ) );
+            }
+        }
+      thrust::inclusive_scan( thrust::omp::par, cumulative_areas.begin(), cumulative_areas.end(), cumulative_areas.begin() );
+      return nfaces ? cumulative_areas.back() : real(0);
+    }
+  }
+
+  bool sample_uniformly(
+      const indexed_mesh& m, size_t nsamples, uint64_t seed,
+      vec3* positions, vec3* normals, uint32_t* faces )
+  {
+    std::vector< real > cumulative_areas;
+    const real area = compute_cumulative_areas( m, cumulative_areas );
+    if( !( area > 0 ) )
+      {
+        LOG( error, "cannot sample a mesh without any surface" );
+        return false;
+      }
+
+    const size_t nblocks = ( nsamples + sampling_block_size - 1 ) / sampling_block_size;
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic)
+    for( long b = 0; b < long(nblocks); ++ b )
+    # else
+    #   pragma omp parallel for schedule(dynamic)
+    for( size_t b = 0; b < nblocks; ++ b )
+    # endif
+      {
+        // consecutive blocks get unrelated seeds
+        std::mt19937_64 engine( detail::mix_seed( seed, b ) );
+        std::uniform_real_distribution< real > distribution( real(0), real(1) );
+        const size_t end = std::min( nsamples, size_t( b + 1 ) * sampling_block_size );
+        for( size_t i = size_t( b ) * sampling_block_size; i < end; ++ i )
+          {
+            // the last face with a non zero area is picked if u * area rounds up to area
+            const real u = distribution( engine ) * area;
+            const size_t face_index = std::min(
+                size_t( std::upper_bound( cumulative_areas.begin(), cumulative_areas.end(), u ) - cumulative_areas.begin() ),
+                size_t( std::lower_bound( cumulative_areas.begin(), cumulative_areas.end(), area ) - cumulative_areas.begin() ) );
+            const uint32_t* face = m.indices.data() + 3 * face_index;
+            const vec3& a = m.vertices[ face[0] ];
+            const vec3 ab = m.vertices[ face[1] ] - a;
+            const vec3 ac = m.vertices[ face[2] ] - a;
+
+            const real s = std::sqrt( distribution( engine ) );
+            const real t = distribution( engine );
+            positions[ i ] = a + ( s * ( real(1) - t ) ) * ab + ( s * t ) * ac;
+            if( normals )
+              normals[ i ] = normalize( cross( ab, ac ) );
+            if( faces )
+              faces[ i ] = uint32_t( face_index );
+          }
+      }
+    return true;
+  }
+
+  poisson_disk_parameters::poisson_disk_parameters()
+    : radius{ 0.01 }, candidates_per_sample{ 8 }, seed{ 0 }
+  {}
+
+  size_t sample_poisson_disk(
+      const indexed_mesh& m, const poisson_disk_parameters& parameters,
+      size_t capacity, vec3* positions, vec3* normals, uint32_t* faces )
+  {
+    if( !( parameters.radius > 0 ) )
+      {
+        LOG( error, "the radius of a Poisson-disk sampling must be positive" );
+        return 0;
+      }
+    std::vector< real > cumulative_areas;
+    const real area = compute_cumulative_areas( m, cumulative_areas );
+    if( !( area > 0 ) )
+      {
+        LOG( error, "cannot sample a mesh without any surface" );
+        return 0;
+      }
+    aabox box;
+    m.compute_bounding_box( box );
+    const vec3 origin = box.get_min();
+    const real inv_cell_size = real(1) / parameters.radius;
+    if( max( box.hsides ) * real(2) * inv_cell_size >= real( max_cell_coordinate ) )
+      {
+        LOG( error, "the radius of a Poisson-disk sampling is too small compared to the mesh extent" );
+        return 0;
+      }
+
+    // uniform candidates: a maximal sampling has at most 2 / sqrt(3) * area / radius^2 samples
+    const size_t ncandidates = size_t( std::ceil(
+        parameters.candidates_per_sample * real(1.1547005383792515) * area * inv_cell_size * inv_cell_size ) );
+    std::vector< vec3 > candidates( ncandidates );
+    std::vector< uint32_t > candidate_faces( ncandidates );
+    sample_uniformly( m, ncandidates, parameters.seed, candidates.data(), nullptr, candidate_faces.data() );
+
+    // sort candidates by cell, keeping their random order inside a cell
+    std::vector< uint64_t > keys( ncandidates );
+    std::vector< uint32_t > order( ncandidates );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(ncandidates); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < ncandidates; ++ i )
+    # endif
+      {
+        const vec3 c = ( candidates[ i ] - origin ) * inv_cell_size;
+        keys[ i ] = make_cell_key(
+            std::min( int64_t( c.x ), max_cell_coordinate ),
+            std::min( int64_t( c.y ), max_cell_coordinate ),
+            std::min( int64_t( c.z ), max_cell_coordinate ) );
+        order[ i ] = uint32_t( i );
+      }
+    thrust::stable_sort_by_key( thrust::omp::par, keys.begin(), keys.end(), order.begin() );
+
+    // cells are the ranges of equal keys
+    std::vector< uint64_t > cell_keys;
+    std::vector< uint32_t > cell_offsets;
+    for( size_t i = 0; i < ncandidates; ++ i )
+      if( !i || keys[ i ] != keys[ i - 1 ] )
+        {
+          cell_keys.push_back( keys[ i ] );
+          cell_offsets.push_back( uint32_t( i ) );
+        }
+    const size_t ncells = cell_keys.size();
+    cell_offsets.push_back( uint32_t( ncandidates ) );
+
+    std::vector< uint32_t > groups[ 27 ];
+    for( size_t i = 0; i < ncells; ++ i )
+      groups[ get_cell_group( cell_keys[ i ] ) ].push_back( uint32_t( i ) );
+
+    // accepted candidates are moved at the beginning of the range of their cell
+    std::vector< uint32_t > accepted( ncells, 0 );
+    for( auto& group : groups )
+      {
+        const size_t ngroup_cells = group.size();
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(dynamic,64)
+        for( long g = 0; g < long(ngroup_cells); ++ g )
+        # else
+        #   pragma omp parallel for schedule(dynamic,64)
+        for( size_t g = 0; g < ngroup_cells; ++ g )
+        # endif
+          {
+            const uint32_t cell = group[ g ];
+            const uint64_t key = cell_keys[ cell ];
+            const int64_t x = int64_t( key >> ( 2 * cell_coordinate_bits ) );
+            const int64_t y = int64_t( ( key >> cell_coordinate_bits ) & max_cell_coordinate );
+            const int64_t z = int64_t( key & max_cell_coordinate );
+
+            // gather the candidates already accepted in neighbor cells
+            std::vector< vec3 > neighbors;
+            for( int64_t dx = -1; dx <= 1; ++ dx )
+              for( int64_t dy = -1; dy <= 1; ++ dy )
+                for( int64_t dz = -1; dz <= 1; ++ dz )
+                  {
+                    if( ( !dx && !dy && !dz ) || x + dx < 0 || y + dy < 0 || z + dz < 0 )
+                      continue;
+                    const uint64_t neighbor_key = make_cell_key( x + dx, y + dy, z + dz );
+                    auto it = std::lower_bound( cell_keys.begin(), cell_keys.end(), neighbor_key );
+                    if( it == cell_keys.end() || *it != neighbor_key )
+                      continue;
+                    const size_t neighbor = size_t( it - cell_keys.begin() );
+                    for( uint32_t j = 0; j < accepted[ neighbor ]; ++ j )
+                      neighbors.push_back( candidates[ order[ cell_offsets[ neighbor ] + j ] ] );
+                  }
+
+            const real squared_radius = parameters.radius * parameters.radius;
+            uint32_t naccepted = 0;
+            for( uint32_t j = cell_offsets[ cell ]; j < cell_offsets[ cell + 1 ]; ++ j )
+              {
+                const vec3& p = candidates[ order[ j ] ];
+                bool valid = true;
+                for( uint32_t k = cell_offsets[ cell ]; valid && k < cell_offsets[ cell ] + naccepted; ++ k )
+                  valid = dot( p - candidates[ order[ k ] ], p - candidates[ order[ k ] ] ) >= squared_radius;
+                for( size_t k = 0; valid && k < neighbors.size(); ++ k )
+                  valid = dot( p - neighbors[ k ], p - neighbors[ k ] ) >= squared_radius;
+                if( valid )
+                  std::swap( order[ cell_offsets[ cell ] + naccepted++ ], order[ j ] );
+              }
+            accepted[ cell ] = naccepted;
+          }
+      }
+
+    // write accepted candidates, in the order of cells
+    std::vector< size_t > offsets( ncells + 1, 0 );
+    std::copy( accepted.begin(), accepted.end(), offsets.begin() + 1 );
+    thrust::inclusive_scan( thrust::omp::par, offsets.begin(), offsets.end(), offsets.begin() );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(ncells); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < ncells; ++ i )
+    # endif
+      for( uint32_t j = 0; j < accepted[ i ] && offsets[ i ] + j < capacity; ++ j )
+        {
+          const uint32_t candidate = order[ cell_offsets[ i ] + j ];
+          const size_t output = offsets[ i ] + j;
+          positions[ output ] = candidates[ candidate ];
+          if( normals )
+            {
+              const uint32_t* face = m.indices.data() + 3 * size_t( candidate_faces[ candidate ] );
+              const vec3& a = m.vertices[ face[0] ];
+              normals[ output ] = normalize( cross( m.vertices[ face[1] ] - a, m.vertices[ face[2] ] - a ) );
+            }
+          if( faces )
+            faces[ output ] = candidate_faces[ candidate ];
+        }
+    return offsets[ ncells ];
+  }
+
+} END_GO_NAMESPACE
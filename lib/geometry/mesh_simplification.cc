@@ -0,0 +1,725 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/mesh_simplification.h"
+# include "../../graphics-origin/tools/log.h"
+
+# include "../../graphics-origin/extlibs/thrust/sort.h"
+# include "../../graphics-origin/extlibs/thrust/system/omp/execution_policy.h"
+
+# include <algorithm>
+# include <atomic>
+# include <cmath>
+# include <cstring>
+# include <limits>
+# include <memory>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  simplification_parameters::simplification_parameters()
+    : target_number_of_faces{ 0 }, max_error{ REAL_MAX },
+      collapse_fraction{ 0.25 }, min_normal_cosine{ 0.2 },
+      boundary_weight{ 1000.0 }, locked_vertices{ nullptr }
+  {}
+
+  namespace {
+
+    /**Symmetric 4x4 matrix of a quadric error, stored by its upper triangle:
+     * xx xy xz xw yy yz yw zz zw ww. */
+    struct quadric {
+      quadric()
+      {
+        std::fill( a, a + 10, real(0) );
+      }
+
+      /**Quadric of the squared distance to the plane n.p + d = 0. */
+      quadric( const vec3& n, real d, real weight )
+      {
+        a[0] = weight * n.x * n.x; a[1] = weight * n.x * n.y; a[2] = weight * n.x * n.z; a[3] = weight * n.x * d;
+        a[4] = weight * n.y * n.y; a[5] = weight * n.y * n.z; a[6] = weight * n.y * d;
+        a[7] = weight * n.z * n.z; a[8] = weight * n.z * d;
+        a[9] = weight * d * d;
+      }
+
+      quadric& operator+=( const quadric& other )
+      {
+        for( int i = 0; i < 10; ++ i )
+          a[ i ] += other.a[ i ];
+        return *this;
+      }
+
+      real evaluate( const vec3& p ) const
+      {
+        return a[0] * p.x * p.x + real(2) * a[1] * p.x * p.y + real(2) * a[2] * p.x * p.z + real(2) * a[3] * p.x
+             + a[4] * p.y * p.y + real(2) * a[5] * p.y * p.z + real(2) * a[6] * p.y
+             + a[7] * p.z * p.z + real(2) * a[8] * p.z
+             + a[9];
+      }
+
+      /**Find the position minimizing the quadric, if the system is not
+       * singular. */
+      bool optimize( vec3& p ) const
+      {
+        const real c00 = a[4] * a[7] - a[5] * a[5];
+        const real c01 = a[2] * a[5] - a[1] * a[7];
+        const real c02 = a[1] * a[5] - a[2] * a[4];
+        const real det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+        const real scale = a[0] + a[4] + a[7];
+        if( std::abs( det ) <= real(1e-10) * scale * scale * scale )
+          return false;
+        const real c11 = a[0] * a[7] - a[2] * a[2];
+        const real c12 = a[1] * a[2] - a[0] * a[5];
+        const real c22 = a[0] * a[4] - a[1] * a[1];
+        const real inv_det = real(1) / det;
+        p.x = -( c00 * a[3] + c01 * a[6] + c02 * a[8] ) * inv_det;
+        p.y = -( c01 * a[3] + c11 * a[6] + c12 * a[8] ) * inv_det;
+        p.z = -( c02 * a[3] + c12 * a[6] + c22 * a[8] ) * inv_det;
+        return true;
+      }
+
+      real a[10];
+    };
+
+    inline uint64_t make_edge_key( uint32_t a, uint32_t b )
+    {
+      return a < b ? ( uint64_t(a) << 32 ) | b : ( uint64_t(b) << 32 ) | a;
+    }
+
+    inline uint32_t float_bits( float f )
+    {
+      uint32_t result;
+      std::memcpy( &result, &f, sizeof(float) );
+      return result;
+    }
+
+    /**Build a unique key to order collapses. Costs are quantized on a
+     * logarithmic scale (only 4 bits of mantissa are kept) and ties are broken
+     * by a bijective hash of the edge index. Without this, smoothly varying
+     * costs would have very few local minima, and thus very few independent
+     * collapses per round. */
+    inline uint64_t make_collapse_key( float cost, uint32_t edge )
+    {
+      uint32_t hash = edge;
+      hash ^= hash >> 16; hash *= 0x7feb352dU;
+      hash ^= hash >> 15; hash *= 0x846ca68bU;
+      hash ^= hash >> 16;
+      return ( uint64_t( float_bits( cost ) >> 19 ) << 32 ) | hash;
+    }
+
+    inline void atomic_min( std::atomic< uint64_t >& target, uint64_t value )
+    {
+      uint64_t current = target.load( std::memory_order_relaxed );
+      while( value < current && !target.compare_exchange_weak( current, value, std::memory_order_relaxed ) )
+        {}
+    }
+
+    /**Sort the 3 * nfaces half-edges of a face array to get unique edges.
+     * Removed faces produce keys equal to uint64_t(-1), which end up at the
+     * end of the sorted array. */
+    void compute_sorted_edge_keys( const std::vector< uint32_t >& indices, std::vector< uint64_t >& keys )
+    {
+      const size_t nfaces = indices.size() / 3;
+      keys.resize( nfaces * 3 );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nfaces); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nfaces; ++ i )
+      # endif
+        {
+          const uint32_t* f = indices.data() + 3 * i;
+          uint64_t* dst = keys.data() + 3 * i;
+          if( f[0] == indexed_mesh::invalid_index )
+            {
+              dst[0] = dst[1] = dst[2] = uint64_t(-1);
+            }
+          else
+            {
+              dst[0] = make_edge_key( f[0], f[1] );
+              dst[1] = make_edge_key( f[1], f[2] );
+              dst[2] = make_edge_key( f[2], f[0] );
+            }
+        }
+      thrust::sort( thrust::omp::par, keys.begin(), keys.end() );
+    }
+
+    class quadric_simplifier {
+    public:
+      /**Maximum number of faces around a vertex for it to be collapsed. This
+       * allows to check the link condition on the stack. */
+      static constexpr size_t max_valence = 64;
+
+      quadric_simplifier( const indexed_mesh& input, const simplification_parameters& parameters )
+        : m_positions{ input.vertices }, m_indices{ input.indices },
+          m_quadrics( input.vertices.size() ),
+          m_locked( input.vertices.size(), 0 ),
+          m_on_boundary( input.vertices.size(), 0 ),
+          m_number_of_faces{ input.get_number_of_faces() },
+          m_error{ 0 }, m_parameters( parameters )
+      {
+        const size_t nvertices = m_positions.size();
+        if( parameters.locked_vertices )
+          {
+            for( size_t i = 0; i < nvertices; ++ i )
+              m_locked[ i ] = parameters.locked_vertices[ i ];
+          }
+        initialize_quadrics();
+      }
+
+      /**Collapse edges until the number of faces is lower than a target or
+       * until no edge can be collapsed. */
+      bool run( size_t target_number_of_faces )
+      {
+        while( m_number_of_faces > target_number_of_faces )
+          {
+            // when the cheapest edges cannot be collapsed, consider all of them
+            if( !collapse_independent_set( target_number_of_faces, m_parameters.collapse_fraction )
+             && !collapse_independent_set( target_number_of_faces, real(1) ) )
+              break;
+          }
+        return m_number_of_faces <= target_number_of_faces;
+      }
+
+      void snapshot( indexed_mesh& output, std::vector< indexed_mesh::vertex_index >* remap = nullptr ) const
+      {
+        output.vertices = m_positions;
+        output.indices = m_indices;
+        output.remove_degenerated_faces();
+        output.remove_unreferenced_vertices( remap );
+      }
+
+      size_t get_number_of_faces() const
+      {
+        return m_number_of_faces;
+      }
+
+      real get_error() const
+      {
+        return m_error;
+      }
+
+    private:
+
+      void initialize_quadrics()
+      {
+        const size_t nfaces = m_indices.size() / 3;
+        const size_t nvertices = m_positions.size();
+        std::vector< quadric > face_quadrics( nfaces );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nfaces); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nfaces; ++ i )
+        # endif
+          {
+            const uint32_t* f = m_indices.data() + 3 * i;
+            const vec3& p0 = m_positions[ f[0] ];
+            vec3 n = cross( m_positions[ f[1] ] - p0, m_positions[ f[2] ] - p0 );
+            const real double_area = length( n );
+            if( double_area > 0 )
+              {
+                n *= real(1) / double_area;
+                face_quadrics[ i ] = quadric( n, -dot( n, p0 ), real(0.5) * double_area );
+              }
+          }
+
+        // gather face quadrics per vertex to avoid atomic operations
+        m_adjacency.build( m_indices.data(), nfaces, nvertices );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(dynamic,1024)
+        for( long i = 0; i < long(nvertices); ++ i )
+        # else
+        #   pragma omp parallel for schedule(dynamic,1024)
+        for( size_t i = 0; i < nvertices; ++ i )
+        # endif
+          {
+            for( auto f = m_adjacency.begin( i ), end = m_adjacency.end( i ); f != end; ++ f )
+              m_quadrics[ i ] += face_quadrics[ *f ];
+          }
+
+        // edges with one face are on the boundary, edges with more than two
+        // faces are non-manifold: lock their vertices.
+        std::vector< uint64_t > keys;
+        compute_sorted_edge_keys( m_indices, keys );
+        const size_t nkeys = keys.size();
+        size_t i = 0;
+        while( i < nkeys && keys[ i ] != uint64_t(-1) )
+          {
+            size_t j = i + 1;
+            while( j < nkeys && keys[ j ] == keys[ i ] )
+              ++j;
+            const uint32_t a = uint32_t( keys[ i ] >> 32 );
+            const uint32_t b = uint32_t( keys[ i ] );
+            if( j - i == 1 )
+              {
+                m_on_boundary[ a ] = m_on_boundary[ b ] = 1;
+                if( m_parameters.boundary_weight > 0 )
+                  add_boundary_quadric( a, b );
+              }
+            else if( j - i > 2 )
+              {
+                m_locked[ a ] = m_locked[ b ] = 1;
+              }
+            i = j;
+          }
+      }
+
+      void add_boundary_quadric( uint32_t a, uint32_t b )
+      {
+        // find the face of that boundary edge to get its normal
+        for( auto f = m_adjacency.begin( a ), end = m_adjacency.end( a ); f != end; ++ f )
+          {
+            const uint32_t* face = m_indices.data() + 3 * (*f);
+            if( face[0] != b && face[1] != b && face[2] != b )
+              continue;
+            const vec3& p0 = m_positions[ face[0] ];
+            const vec3 face_normal = cross( m_positions[ face[1] ] - p0, m_positions[ face[2] ] - p0 );
+            const vec3 edge = m_positions[ b ] - m_positions[ a ];
+            vec3 n = cross( edge, face_normal );
+            const real norm = length( n );
+            if( norm > 0 )
+              {
+                n *= real(1) / norm;
+                quadric q( n, -dot( n, m_positions[ a ] ), m_parameters.boundary_weight * dot( edge, edge ) );
+                m_quadrics[ a ] += q;
+                m_quadrics[ b ] += q;
+              }
+            return;
+          }
+      }
+
+      /**Compute the cost of an edge collapse and the position of the vertex
+       * resulting from that collapse. */
+      float compute_cost( uint32_t a, uint32_t b, vec3& target ) const
+      {
+        if( m_locked[ a ] && m_locked[ b ] )
+          return std::numeric_limits< float >::infinity();
+        quadric q = m_quadrics[ a ];
+        q += m_quadrics[ b ];
+        const vec3& pa = m_positions[ a ];
+        const vec3& pb = m_positions[ b ];
+        if( m_locked[ a ] )
+          target = pa;
+        else if( m_locked[ b ] )
+          target = pb;
+        else
+          {
+            const vec3 middle = real(0.5) * ( pa + pb );
+            const real max_distance = distance( pa, pb );
+            if( !q.optimize( target ) || distance( target, middle ) > max_distance )
+              {
+                // singular system or optimum too far: try the edge end points and middle
+                target = middle;
+                real best = q.evaluate( middle );
+                real cost = q.evaluate( pa );
+                if( cost < best ) { best = cost; target = pa; }
+                cost = q.evaluate( pb );
+                if( cost < best ) { target = pb; }
+              }
+          }
+        return float( std::max( real(0), q.evaluate( target ) ) );
+      }
+
+      /**Check if an edge collapse keeps the mesh manifold and does not flip
+       * faces. Return the number of faces removed by the collapse, or 0 if
+       * the collapse is not valid. */
+      size_t check_collapse( uint32_t a, uint32_t b, const vec3& target ) const
+      {
+        if( m_adjacency.valence( a ) > max_valence || m_adjacency.valence( b ) > max_valence )
+          return 0;
+
+        uint32_t neighbors_a[ 2 * max_valence ];
+        uint32_t neighbors_b[ 2 * max_valence ];
+        size_t nneighbors_a = 0, nneighbors_b = 0, nshared = 0;
+
+        for( int side = 0; side < 2; ++ side )
+          {
+            const uint32_t v = side ? b : a;
+            const uint32_t other = side ? a : b;
+            uint32_t* neighbors = side ? neighbors_b : neighbors_a;
+            size_t& nneighbors = side ? nneighbors_b : nneighbors_a;
+            for( auto f = m_adjacency.begin( v ), end = m_adjacency.end( v ); f != end; ++ f )
+              {
+                const uint32_t* face = m_indices.data() + 3 * (*f);
+                if( face[0] == other || face[1] == other || face[2] == other )
+                  {
+                    if( !side ) ++nshared;
+                    continue;
+                  }
+                // check that the face does not flip nor degenerate
+                vec3 p[3] = { m_positions[ face[0] ], m_positions[ face[1] ], m_positions[ face[2] ] };
+                const vec3 old_normal = cross( p[1] - p[0], p[2] - p[0] );
+                for( int k = 0; k < 3; ++ k )
+                  {
+                    if( face[k] == v )
+                      p[k] = target;
+                    else
+                      neighbors[ nneighbors++ ] = face[k];
+                  }
+                const vec3 new_normal = cross( p[1] - p[0], p[2] - p[0] );
+                const real new_norm = length( new_normal );
+                if( new_norm <= real(1e-6) * length( old_normal )
+                 || dot( old_normal, new_normal ) < m_parameters.min_normal_cosine * length( old_normal ) * new_norm )
+                  return 0;
+              }
+          }
+
+        if( !nshared || nshared > 2 )
+          return 0;
+        // an interior edge between two boundary vertices would pinch the surface
+        if( nshared == 2 && m_on_boundary[ a ] && m_on_boundary[ b ] )
+          return 0;
+
+        // link condition: the common neighbors of a and b are exactly the
+        // vertices opposite to the edge.
+        std::sort( neighbors_a, neighbors_a + nneighbors_a );
+        std::sort( neighbors_b, neighbors_b + nneighbors_b );
+        nneighbors_a = std::unique( neighbors_a, neighbors_a + nneighbors_a ) - neighbors_a;
+        nneighbors_b = std::unique( neighbors_b, neighbors_b + nneighbors_b ) - neighbors_b;
+        size_t ncommon = 0;
+        for( size_t i = 0, j = 0; i < nneighbors_a && j < nneighbors_b; )
+          {
+            if( neighbors_a[ i ] < neighbors_b[ j ] ) ++i;
+            else if( neighbors_b[ j ] < neighbors_a[ i ] ) ++j;
+            else { ++ncommon; ++i; ++j; }
+          }
+        // neighbors lists only contain vertices of non-shared faces, so the
+        // opposite vertices are common only if they also belong to such faces.
+        const size_t nopposite = nshared;
+        if( ncommon > nopposite )
+          return 0;
+        // prevent the collapse of a tetrahedron
+        if( nshared == 2 && nneighbors_a + nneighbors_b <= 4 )
+          return 0;
+        return nshared;
+      }
+
+      bool collapse_independent_set( size_t target_number_of_faces, real collapse_fraction )
+      {
+        const size_t nfaces = m_indices.size() / 3;
+        const size_t nvertices = m_positions.size();
+        m_adjacency.build( m_indices.data(), nfaces, nvertices );
+
+        std::vector< uint64_t > edges;
+        compute_sorted_edge_keys( m_indices, edges );
+        edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+        if( !edges.empty() && edges.back() == uint64_t(-1) )
+          edges.pop_back();
+        const size_t nedges = edges.size();
+        if( !nedges )
+          return false;
+
+        std::vector< float > costs( nedges );
+        std::vector< vec3 > targets( nedges );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nedges); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nedges; ++ i )
+        # endif
+          {
+            costs[ i ] = compute_cost( uint32_t( edges[ i ] >> 32 ), uint32_t( edges[ i ] ), targets[ i ] );
+          }
+
+        // only consider the cheapest edges for this round
+        float threshold = float( std::min( m_parameters.max_error, real( std::numeric_limits< float >::max() ) ) );
+        {
+          const size_t k = std::max( size_t(1), size_t( collapse_fraction * real(nedges) ) );
+          if( k < nedges )
+            {
+              std::vector< float > sorted_costs = costs;
+              std::nth_element( sorted_costs.begin(), sorted_costs.begin() + k, sorted_costs.end() );
+              threshold = std::min( threshold, sorted_costs[ k ] );
+            }
+        }
+
+        // candidates are the cheapest edges that can be collapsed
+        std::vector< unsigned char > removed_faces( nedges, 0 );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(dynamic,1024)
+        for( long i = 0; i < long(nedges); ++ i )
+        # else
+        #   pragma omp parallel for schedule(dynamic,1024)
+        for( size_t i = 0; i < nedges; ++ i )
+        # endif
+          {
+            if( costs[ i ] <= threshold )
+              removed_faces[ i ] = (unsigned char)check_collapse(
+                  uint32_t( edges[ i ] >> 32 ), uint32_t( edges[ i ] ), targets[ i ] );
+          }
+
+        // each vertex gets the key of its cheapest candidate edge
+        std::unique_ptr< std::atomic< uint64_t >[] > vertex_keys( new std::atomic< uint64_t >[ nvertices ] );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nvertices); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nvertices; ++ i )
+        # endif
+          vertex_keys[ i ].store( uint64_t(-1), std::memory_order_relaxed );
+
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nedges); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nedges; ++ i )
+        # endif
+          {
+            if( removed_faces[ i ] )
+              {
+                const uint64_t key = make_collapse_key( costs[ i ], uint32_t( i ) );
+                atomic_min( vertex_keys[ edges[ i ] >> 32 ], key );
+                atomic_min( vertex_keys[ uint32_t( edges[ i ] ) ], key );
+              }
+          }
+
+        // Keep only the candidates that are the cheapest at both end points.
+        // Since keys are unique, a vertex has at most one such edge, which
+        // becomes its new key.
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nedges); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nedges; ++ i )
+        # endif
+          {
+            if( removed_faces[ i ] )
+              {
+                const uint64_t key = make_collapse_key( costs[ i ], uint32_t( i ) );
+                if( vertex_keys[ edges[ i ] >> 32 ].load( std::memory_order_relaxed ) != key
+                 || vertex_keys[ uint32_t( edges[ i ] ) ].load( std::memory_order_relaxed ) != key )
+                  removed_faces[ i ] = 0;
+              }
+          }
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nvertices); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nvertices; ++ i )
+        # endif
+          vertex_keys[ i ].store( uint64_t(-1), std::memory_order_relaxed );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nedges); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nedges; ++ i )
+        # endif
+          {
+            if( removed_faces[ i ] )
+              {
+                const uint64_t key = make_collapse_key( costs[ i ], uint32_t( i ) );
+                vertex_keys[ edges[ i ] >> 32 ].store( key, std::memory_order_relaxed );
+                vertex_keys[ uint32_t( edges[ i ] ) ].store( key, std::memory_order_relaxed );
+              }
+          }
+
+        // each face gets the minimum key of its vertices
+        std::vector< uint64_t > face_keys( nfaces );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(nfaces); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < nfaces; ++ i )
+        # endif
+          {
+            const uint32_t* f = m_indices.data() + 3 * i;
+            if( f[0] != indexed_mesh::invalid_index )
+              face_keys[ i ] = std::min(
+                  vertex_keys[ f[0] ].load( std::memory_order_relaxed ),
+                  std::min(
+                      vertex_keys[ f[1] ].load( std::memory_order_relaxed ),
+                      vertex_keys[ f[2] ].load( std::memory_order_relaxed ) ) );
+          }
+
+        // An edge is selected if its key is the minimum of all faces around
+        // its end points. Two selected edges cannot share such a face, so
+        // their collapses are independent.
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(dynamic,1024)
+        for( long i = 0; i < long(nedges); ++ i )
+        # else
+        #   pragma omp parallel for schedule(dynamic,1024)
+        for( size_t i = 0; i < nedges; ++ i )
+        # endif
+          {
+            if( !removed_faces[ i ] )
+              continue;
+            const uint64_t key = make_collapse_key( costs[ i ], uint32_t( i ) );
+            const uint32_t a = uint32_t( edges[ i ] >> 32 );
+            const uint32_t b = uint32_t( edges[ i ] );
+            bool minimum = true;
+            for( auto f = m_adjacency.begin( a ), end = m_adjacency.end( a ); minimum && f != end; ++ f )
+              minimum = face_keys[ *f ] == key;
+            for( auto f = m_adjacency.begin( b ), end = m_adjacency.end( b ); minimum && f != end; ++ f )
+              minimum = face_keys[ *f ] == key;
+            if( !minimum )
+              removed_faces[ i ] = 0;
+          }
+
+        std::vector< uint32_t > selected;
+        for( size_t i = 0; i < nedges; ++ i )
+          if( removed_faces[ i ] )
+            selected.push_back( uint32_t( i ) );
+        if( selected.empty() )
+          return false;
+
+        // do not go further than the target number of faces
+        {
+          size_t total = 0;
+          for( auto e : selected )
+            total += removed_faces[ e ];
+          if( m_number_of_faces - std::min( total, m_number_of_faces ) < target_number_of_faces )
+            {
+              std::sort( selected.begin(), selected.end(),
+                [&costs]( uint32_t e1, uint32_t e2 ){ return costs[ e1 ] < costs[ e2 ]; });
+              size_t n = 0;
+              total = 0;
+              while( n < selected.size() && m_number_of_faces - total > target_number_of_faces )
+                total += removed_faces[ selected[ n++ ] ];
+              selected.resize( n );
+            }
+        }
+
+        const size_t nselected = selected.size();
+        size_t total_removed = 0;
+        float max_cost = 0;
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        GO_MSVC_OMP_NO_CUSTOM_REDUCTION
+        #   pragma omp parallel for schedule(dynamic,256) reduction(+:total_removed)
+        for( long i = 0; i < long(nselected); ++ i )
+        # else
+        #   pragma omp parallel for schedule(dynamic,256) reduction(+:total_removed) reduction(max:max_cost)
+        for( size_t i = 0; i < nselected; ++ i )
+        # endif
+          {
+            const uint32_t e = selected[ i ];
+            uint32_t a = uint32_t( edges[ e ] >> 32 );
+            uint32_t b = uint32_t( edges[ e ] );
+            if( m_locked[ b ] )
+              std::swap( a, b );
+            m_positions[ a ] = targets[ e ];
+            m_quadrics[ a ] += m_quadrics[ b ];
+            m_on_boundary[ a ] |= m_on_boundary[ b ];
+            for( auto f = m_adjacency.begin( b ), end = m_adjacency.end( b ); f != end; ++ f )
+              {
+                uint32_t* face = m_indices.data() + 3 * (*f);
+                if( face[0] == a || face[1] == a || face[2] == a )
+                  face[0] = face[1] = face[2] = indexed_mesh::invalid_index;
+                else
+                  for( int k = 0; k < 3; ++ k )
+                    if( face[ k ] == b )
+                      face[ k ] = a;
+              }
+            total_removed += removed_faces[ e ];
+          # ifndef _MSC_VER
+            max_cost = std::max( max_cost, costs[ e ] );
+          # endif
+          }
+        # ifdef _MSC_VER
+        for( size_t i = 0; i < nselected; ++ i )
+          max_cost = std::max( max_cost, costs[ selected[ i ] ] );
+        # endif
+
+        m_number_of_faces -= std::min( total_removed, m_number_of_faces );
+        m_error = std::max( m_error, real( max_cost ) );
+        return true;
+      }
+
+      std::vector< vec3 > m_positions;
+      std::vector< uint32_t > m_indices;
+      std::vector< quadric > m_quadrics;
+      std::vector< unsigned char > m_locked;
+      std::vector< unsigned char > m_on_boundary;
+      vertex_face_adjacency m_adjacency;
+      size_t m_number_of_faces;
+      real m_error;
+      const simplification_parameters& m_parameters;
+    };
+  }
+
+  real
+  simplify(
+      indexed_mesh& m, const simplification_parameters& parameters,
+      std::vector< indexed_mesh::vertex_index >* remap )
+  {
+    quadric_simplifier simplifier( m, parameters );
+    simplifier.run( parameters.target_number_of_faces );
+    simplifier.snapshot( m, remap );
+    return simplifier.get_error();
+  }
+
+  size_t
+  level_of_detail_chain::select_by_error( real max_error ) const
+  {
+    size_t result = 0;
+    for( size_t i = 1; i < errors.size(); ++ i )
+      {
+        if( errors[ i ] <= max_error )
+          result = i;
+        else
+          break;
+      }
+    return result;
+  }
+
+  size_t
+  level_of_detail_chain::select_by_faces( size_t max_number_of_faces ) const
+  {
+    for( size_t i = 0; i < levels.size(); ++ i )
+      {
+        if( levels[ i ].get_number_of_faces() <= max_number_of_faces )
+          return i;
+      }
+    return levels.empty() ? 0 : levels.size() - 1;
+  }
+
+  void
+  build_level_of_detail_chain(
+      const indexed_mesh& input,
+      const std::vector< size_t >& face_targets,
+      const simplification_parameters& parameters,
+      level_of_detail_chain& chain )
+  {
+    chain.levels.clear();
+    chain.errors.clear();
+    chain.levels.push_back( input );
+    chain.errors.push_back( 0 );
+
+    quadric_simplifier simplifier( input, parameters );
+    for( auto target : face_targets )
+      {
+        if( !simplifier.run( target ) )
+          {
+            LOG( info, "level of detail chain stopped at " << simplifier.get_number_of_faces()
+                 << " faces, target of " << target << " faces cannot be reached under the error bound" );
+            break;
+          }
+        chain.levels.push_back( indexed_mesh{} );
+        simplifier.snapshot( chain.levels.back() );
+        chain.errors.push_back( simplifier.get_error() );
+      }
+  }
+
+} END_GO_NAMESPACE
@@ -0,0 +1,287 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/space_filling_curve.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/mesh.h"
+# include "../../graphics-origin/geometry/box.h"
+# include "../../graphics-origin/tools/log.h"
+
+# include "../../graphics-origin/extlibs/thrust/sort.h"
+# include "../../graphics-origin/extlibs/thrust/system/omp/execution_policy.h"
+
+# include <algorithm>
+# include <numeric>
+# include <utility>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    const uint64_t max_coordinate = ( uint64_t(1) << space_filling_curve_bits ) - 1;
+
+    inline uint64_t quantize( real x )
+    {
+      return uint64_t( std::min( std::max( x * real( max_coordinate ), real(0) ), real( max_coordinate ) ) );
+    }
+
+    /**Insert two zeros between each of the 21 lower bits of x. */
+    inline uint64_t expand_bits( uint64_t x )
+    {
+      x &= 0x1fffff;
+      x = ( x | x << 32 ) & 0x1f00000000ffffULL;
+      x = ( x | x << 16 ) & 0x1f0000ff0000ffULL;
+      x = ( x | x <<  8 ) & 0x100f00f00f00f00fULL;
+      x = ( x | x <<  4 ) & 0x10c30c30c30c30c3ULL;
+      x = ( x | x <<  2 ) & 0x1249249249249249ULL;
+      return x;
+    }
+  }
+
+  uint64_t
+  compute_morton_code( const vec3& p )
+  {
+    return ( expand_bits( quantize( p.x ) ) << 2 )
+         | ( expand_bits( quantize( p.y ) ) << 1 )
+         |   expand_bits( quantize( p.z ) );
+  }
+
+  uint64_t
+  compute_hilbert_code( const vec3& p )
+  {
+    uint64_t x[3] = { quantize( p.x ), quantize( p.y ), quantize( p.z ) };
+    const uint64_t m = uint64_t(1) << ( space_filling_curve_bits - 1 );
+
+    // inverse undo
+    for( uint64_t q = m; q > 1; q >>= 1 )
+      {
+        const uint64_t mask = q - 1;
+        for( int i = 0; i < 3; ++ i )
+          {
+            if( x[i] & q )
+              x[0] ^= mask;
+            else
+              {
+                const uint64_t t = ( x[0] ^ x[i] ) & mask;
+                x[0] ^= t;
+                x[i] ^= t;
+              }
+          }
+      }
+
+    // gray encode
+    x[1] ^= x[0];
+    x[2] ^= x[1];
+    uint64_t t = 0;
+    for( uint64_t q = m; q > 1; q >>= 1 )
+      if( x[2] & q )
+        t ^= q - 1;
+    x[0] ^= t;
+    x[1] ^= t;
+    x[2] ^= t;
+
+    // the transposed form is interleaved like a Morton code
+    return ( expand_bits( x[0] ) << 2 ) | ( expand_bits( x[1] ) << 1 ) | expand_bits( x[2] );
+  }
+
+  void
+  compute_spatial_order(
+      const vec3* points, size_t npoints, const aabox& box,
+      space_filling_curve curve, std::vector< uint32_t >& order )
+  {
+    const vec3 lower = box.get_min();
+    const vec3 sides = box.get_max() - lower;
+    const vec3 inv_sides{
+      sides.x > 0 ? real(1) / sides.x : real(0),
+      sides.y > 0 ? real(1) / sides.y : real(0),
+      sides.z > 0 ? real(1) / sides.z : real(0) };
+
+    std::vector< uint64_t > codes( npoints );
+    order.resize( npoints );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(npoints); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < npoints; ++ i )
+    # endif
+      {
+        const vec3 p = ( points[ i ] - lower ) * inv_sides;
+        codes[ i ] = curve == space_filling_curve::morton ? compute_morton_code( p ) : compute_hilbert_code( p );
+        order[ i ] = uint32_t( i );
+      }
+    thrust::stable_sort_by_key( thrust::omp::par, codes.begin(), codes.end(), order.begin() );
+  }
+
+  mesh_locality_statistics::mesh_locality_statistics()
+    : average_face_index_span{ 0 }, average_face_index_jump{ 0 }
+  {}
+
+  mesh_locality_statistics
+  compute_locality_statistics( const uint32_t* indices, size_t nfaces )
+  {
+    mesh_locality_statistics result;
+    if( !nfaces )
+      return result;
+    real span = 0, jump = 0;
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static) reduction(+:span,jump)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static) reduction(+:span,jump)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        const uint32_t* f = indices + 3 * i;
+        const uint32_t fmin = std::min( f[0], std::min( f[1], f[2] ) );
+        const uint32_t fmax = std::max( f[0], std::max( f[1], f[2] ) );
+        span += real( fmax - fmin );
+        if( i )
+          {
+            const uint32_t* g = f - 3;
+            const uint32_t gmin = std::min( g[0], std::min( g[1], g[2] ) );
+            jump += fmin > gmin ? real( fmin - gmin ) : real( gmin - fmin );
+          }
+      }
+    result.average_face_index_span = span / real( nfaces );
+    result.average_face_index_jump = nfaces > 1 ? jump / real( nfaces - 1 ) : real(0);
+    return result;
+  }
+
+  namespace {
+    /**Compute the vertex and face orders of a mesh. */
+    void compute_mesh_orders(
+        const indexed_mesh& m, space_filling_curve curve,
+        std::vector< uint32_t >& vertex_order, std::vector< uint32_t >& face_order )
+    {
+      const auto& vertices = m.vertices;
+      const uint32_t* indices = m.indices.data();
+      const size_t nfaces = m.get_number_of_faces();
+      aabox box;
+      m.compute_bounding_box( box );
+      compute_spatial_order( vertices.data(), vertices.size(), box, curve, vertex_order );
+
+      std::vector< vec3 > centroids( nfaces );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nfaces); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nfaces; ++ i )
+      # endif
+        {
+          const uint32_t* f = indices + 3 * i;
+          centroids[ i ] = ( vertices[ f[0] ] + vertices[ f[1] ] + vertices[ f[2] ] ) * real( 1.0 / 3.0 );
+        }
+      compute_spatial_order( centroids.data(), nfaces, box, curve, face_order );
+    }
+  }
+
+  void
+  spatially_reorder(
+      indexed_mesh& m, space_filling_curve curve,
+      std::vector< uint32_t >* vertex_order_output,
+      std::vector< uint32_t >* face_order_output )
+  {
+    const size_t nvertices = m.get_number_of_vertices();
+    const size_t nfaces = m.get_number_of_faces();
+    std::vector< uint32_t > local_vertex_order, local_face_order;
+    std::vector< uint32_t >& vertex_order = vertex_order_output ? *vertex_order_output : local_vertex_order;
+    std::vector< uint32_t >& face_order = face_order_output ? *face_order_output : local_face_order;
+    compute_mesh_orders( m, curve, vertex_order, face_order );
+
+    std::vector< uint32_t > new_index( nvertices );
+    std::vector< vec3 > vertices( nvertices );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nvertices); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nvertices; ++ i )
+    # endif
+      {
+        new_index[ vertex_order[ i ] ] = uint32_t( i );
+        vertices[ i ] = m.vertices[ vertex_order[ i ] ];
+      }
+
+    std::vector< uint32_t > indices( nfaces * 3 );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        const uint32_t* src = m.indices.data() + 3 * face_order[ i ];
+        uint32_t* dst = indices.data() + 3 * i;
+        dst[0] = new_index[ src[0] ];
+        dst[1] = new_index[ src[1] ];
+        dst[2] = new_index[ src[2] ];
+      }
+    m.vertices.swap( vertices );
+    m.indices.swap( indices );
+  }
+
+  size_t
+  spatially_reorder( mesh& m, space_filling_curve curve )
+  {
+    indexed_mesh im( m );
+    const size_t nvertices = im.get_number_of_vertices();
+    const size_t nfaces = im.get_number_of_faces();
+    std::vector< uint32_t > vertex_order, face_order;
+    compute_mesh_orders( im, curve, vertex_order, face_order );
+
+    mesh result;
+    result.reserve( nvertices, m.n_edges(), nfaces );
+    std::vector< mesh::VertexHandle > new_handles( nvertices );
+    for( size_t i = 0; i < nvertices; ++ i )
+      {
+        const mesh::VertexHandle old_handle( vertex_order[ i ] );
+        const mesh::VertexHandle new_handle = result.add_vertex( m.point( old_handle ) );
+        result.set_normal( new_handle, m.normal( old_handle ) );
+        result.set_color( new_handle, m.color( old_handle ) );
+        new_handles[ vertex_order[ i ] ] = new_handle;
+      }
+
+    size_t dropped_faces = 0;
+    for( size_t i = 0; i < nfaces; ++ i )
+      {
+        const mesh::FaceHandle old_handle( face_order[ i ] );
+        const uint32_t* f = im.indices.data() + 3 * face_order[ i ];
+        const mesh::FaceHandle new_handle = result.add_face(
+            new_handles[ f[0] ], new_handles[ f[1] ], new_handles[ f[2] ] );
+        // a face rejected by OpenMesh in the new insertion order, e.g. a
+        // complex edge that was accepted in the original order
+        if( !new_handle.is_valid() )
+          {
+            ++dropped_faces;
+            continue;
+          }
+        result.set_normal( new_handle, m.normal( old_handle ) );
+        result.set_color( new_handle, m.color( old_handle ) );
+
+        // match halfedges of the old and new faces by their target vertex
+        for( auto old_it = m.cfh_iter( old_handle ); old_it.is_valid(); ++ old_it )
+          {
+            const mesh::VertexHandle target = new_handles[ m.to_vertex_handle( *old_it ).idx() ];
+            for( auto new_it = result.fh_iter( new_handle ); new_it.is_valid(); ++ new_it )
+              if( result.to_vertex_handle( *new_it ) == target )
+                {
+                  result.set_normal( *new_it, m.normal( *old_it ) );
+                  result.set_texcoord2D( *new_it, m.texcoord2D( *old_it ) );
+                  break;
+                }
+          }
+      }
+    if( dropped_faces )
+      LOG( warning, "spatial reordering dropped " << dropped_faces << " faces out of " << nfaces << " that could not be added in the new order");
+    m = std::move( result );
+    return dropped_faces;
+  }
+
+} END_GO_NAMESPACE
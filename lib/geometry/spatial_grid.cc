@@ -0,0 +1,375 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/spatial_grid.h"
+# include "../../graphics-origin/tools/log.h"
+
+# include "../../graphics-origin/extlibs/thrust/scan.h"
+# include "../../graphics-origin/extlibs/thrust/system/omp/execution_policy.h"
+
+# include <algorithm>
+# include <atomic>
+# include <cmath>
+# include <memory>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    /**Cell coordinates are packed in 21 bits each to make a cell key. */
+    const int64_t max_resolution = int64_t(1) << 21;
+
+    inline uint64_t make_cell_key( int64_t x, int64_t y, int64_t z )
+    {
+      return ( uint64_t( x ) << 42 ) | ( uint64_t( y ) << 21 ) | uint64_t( z );
+    }
+  }
+
+  spatial_grid::spatial_grid( const real* points, size_t npoints, real cell_size )
+    : m_cell_size{ cell_size }
+  {
+    build( points, npoints );
+  }
+
+  spatial_grid::spatial_grid( const vec3* points, size_t npoints, real cell_size )
+    : m_cell_size{ cell_size }
+  {
+    build( npoints ? &points[0].x : nullptr, npoints );
+  }
+
+  size_t
+  spatial_grid::get_bucket( int64_t x, int64_t y, int64_t z ) const
+  {
+    if( m_dense )
+      return size_t( ( x * m_resolution[1] + y ) * m_resolution[2] + z );
+    return size_t( ( x * 73856093 ) ^ ( y * 19349663 ) ^ ( z * 83492791 ) ) & m_bucket_mask;
+  }
+
+  void
+  spatial_grid::get_cell_range( const vec3& location, real radius, cell_range& range ) const
+  {
+    for( int d = 0; d < 3; ++ d )
+      {
+        const real low = std::floor( ( location[d] - radius - m_origin[d] ) * m_inv_cell_size );
+        const real high = std::floor( ( location[d] + radius - m_origin[d] ) * m_inv_cell_size );
+        range.low[d] = int64_t( std::max( low, real(0) ) );
+        range.high[d] = int64_t( std::min( high, real( m_resolution[d] - 1 ) ) );
+      }
+  }
+
+  void
+  spatial_grid::build( const real* points, size_t npoints )
+  {
+    // bounding box and resolution
+    vec3 minp{ REAL_MAX, REAL_MAX, REAL_MAX };
+    vec3 maxp{ -REAL_MAX, -REAL_MAX, -REAL_MAX };
+    # pragma omp parallel
+    {
+      vec3 thread_minp = minp, thread_maxp = maxp;
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp for
+      for( long i = 0; i < long(npoints); ++ i )
+      # else
+      #   pragma omp for
+      for( size_t i = 0; i < npoints; ++ i )
+      # endif
+        {
+          const vec3 p{ points[ 3 * i ], points[ 3 * i + 1 ], points[ 3 * i + 2 ] };
+          thread_minp = min( thread_minp, p );
+          thread_maxp = max( thread_maxp, p );
+        }
+      # pragma omp critical
+      {
+        minp = min( minp, thread_minp );
+        maxp = max( maxp, thread_maxp );
+      }
+    }
+    if( !npoints )
+      minp = maxp = vec3{ 0, 0, 0 };
+    m_bounding_box = aabox( minp, maxp );
+    m_origin = minp;
+
+    const real max_extent = max( maxp - minp );
+    if( !( m_cell_size > 0 ) || max_extent / m_cell_size >= real( max_resolution - 1 ) )
+      {
+        const real cell_size = std::max( max_extent / real( max_resolution - 2 ), real(1e-12) );
+        LOG( warning, "spatial grid cell size " << m_cell_size << " is too small for the point extent, using " << cell_size << " instead");
+        m_cell_size = cell_size;
+      }
+    m_inv_cell_size = real(1) / m_cell_size;
+    for( int d = 0; d < 3; ++ d )
+      m_resolution[d] = int64_t( ( maxp[d] - minp[d] ) * m_inv_cell_size ) + 1;
+
+    // one bucket per cell if there are not too many cells, otherwise cells
+    // are hashed into a table with at least twice as many buckets as points
+    const real ncells = real( m_resolution[0] ) * real( m_resolution[1] ) * real( m_resolution[2] );
+    size_t nbuckets = 1;
+    m_dense = ncells <= real( 4 * npoints + 1024 );
+    if( m_dense )
+      nbuckets = size_t( ncells );
+    else
+      {
+        while( nbuckets < 2 * npoints )
+          nbuckets <<= 1;
+      }
+    m_bucket_mask = nbuckets - 1;
+
+    // counting sort of points by bucket
+    std::vector< uint64_t > keys( m_dense ? 0 : npoints );
+    std::vector< uint32_t > buckets( npoints );
+    std::unique_ptr< std::atomic< uint32_t >[] > counters( new std::atomic< uint32_t >[ nbuckets ] );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nbuckets); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nbuckets; ++ i )
+    # endif
+      counters[ i ].store( 0, std::memory_order_relaxed );
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(npoints); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < npoints; ++ i )
+    # endif
+      {
+        int64_t c[3];
+        for( int d = 0; d < 3; ++ d )
+          c[d] = std::min( int64_t( ( points[ 3 * i + d ] - m_origin[d] ) * m_inv_cell_size ), m_resolution[d] - 1 );
+        if( !m_dense )
+          keys[ i ] = make_cell_key( c[0], c[1], c[2] );
+        buckets[ i ] = uint32_t( get_bucket( c[0], c[1], c[2] ) );
+        counters[ buckets[ i ] ].fetch_add( 1, std::memory_order_relaxed );
+      }
+
+    m_bucket_offsets.resize( nbuckets + 1 );
+    m_bucket_offsets[ 0 ] = 0;
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nbuckets); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nbuckets; ++ i )
+    # endif
+      m_bucket_offsets[ i + 1 ] = counters[ i ].load( std::memory_order_relaxed );
+    thrust::inclusive_scan( thrust::omp::par, m_bucket_offsets.begin(), m_bucket_offsets.end(), m_bucket_offsets.begin() );
+
+    // counters become insertion cursors
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nbuckets); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nbuckets; ++ i )
+    # endif
+      counters[ i ].store( m_bucket_offsets[ i ], std::memory_order_relaxed );
+
+    m_positions.resize( npoints );
+    m_cell_keys.resize( m_dense ? 0 : npoints );
+    m_indices.resize( npoints );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(npoints); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < npoints; ++ i )
+    # endif
+      {
+        const uint32_t slot = counters[ buckets[ i ] ].fetch_add( 1, std::memory_order_relaxed );
+        m_positions[ slot ] = vec3{ points[ 3 * i ], points[ 3 * i + 1 ], points[ 3 * i + 2 ] };
+        if( !m_dense )
+          m_cell_keys[ slot ] = keys[ i ];
+        m_indices[ slot ] = point_index( i );
+      }
+  }
+
+  template< typename visitor >
+  void spatial_grid::search( const vec3& location, real radius, visitor&& v ) const
+  {
+    if( m_positions.empty() )
+      return;
+    const real squared_radius = radius * radius;
+    cell_range range;
+    get_cell_range( location, radius, range );
+    for( int64_t x = range.low[0]; x <= range.high[0]; ++ x )
+      for( int64_t y = range.low[1]; y <= range.high[1]; ++ y )
+        {
+          if( m_dense )
+            {
+              // cells along z are consecutive, as are their points
+              const size_t begin = m_bucket_offsets[ get_bucket( x, y, range.low[2] ) ];
+              const size_t end = m_bucket_offsets[ get_bucket( x, y, range.high[2] ) + 1 ];
+              for( size_t i = begin; i < end; ++ i )
+                {
+                  const vec3 diff = m_positions[ i ] - location;
+                  const real d = dot( diff, diff );
+                  if( d <= squared_radius )
+                    v( m_indices[ i ], d );
+                }
+              continue;
+            }
+          for( int64_t z = range.low[2]; z <= range.high[2]; ++ z )
+            {
+              const uint64_t key = make_cell_key( x, y, z );
+              const size_t bucket = get_bucket( x, y, z );
+              for( uint32_t i = m_bucket_offsets[ bucket ], end = m_bucket_offsets[ bucket + 1 ]; i < end; ++ i )
+                {
+                  if( m_cell_keys[ i ] != key )
+                    continue;
+                  const vec3 diff = m_positions[ i ] - location;
+                  const real d = dot( diff, diff );
+                  if( d <= squared_radius )
+                    v( m_indices[ i ], d );
+                }
+            }
+        }
+  }
+
+  void
+  spatial_grid::radius_search(
+      const vec3& location, real radius,
+      std::vector< std::pair< point_index, real > >& indices_sdistances ) const
+  {
+    indices_sdistances.clear();
+    search( location, radius, [&indices_sdistances]( point_index i, real d )
+      {
+        indices_sdistances.push_back( std::make_pair( i, d ) );
+      });
+    std::sort( indices_sdistances.begin(), indices_sdistances.end(),
+      []( const std::pair< point_index, real >& a, const std::pair< point_index, real >& b )
+      {
+        return a.second < b.second;
+      });
+  }
+
+  size_t
+  spatial_grid::count_in_radius( const vec3& location, real radius ) const
+  {
+    size_t count = 0;
+    search( location, radius, [&count]( point_index, real )
+      {
+        ++ count;
+      });
+    return count;
+  }
+
+  size_t
+  spatial_grid::count_in_radius(
+      const vec3* locations, size_t nlocations, real radius, size_t* offsets ) const
+  {
+    offsets[ 0 ] = 0;
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( long i = 0; i < long(nlocations); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( size_t i = 0; i < nlocations; ++ i )
+    # endif
+      {
+        offsets[ i + 1 ] = count_in_radius( locations[ i ], radius );
+      }
+    thrust::inclusive_scan( thrust::omp::par, offsets, offsets + nlocations + 1, offsets );
+    return offsets[ nlocations ];
+  }
+
+  void
+  spatial_grid::radius_search(
+      const vec3* locations, size_t nlocations, real radius,
+      const size_t* offsets, point_index* indices, real* squared_distances ) const
+  {
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( long i = 0; i < long(nlocations); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( size_t i = 0; i < nlocations; ++ i )
+    # endif
+      {
+        point_index* result_indices = indices + offsets[ i ];
+        real* result_distances = squared_distances ? squared_distances + offsets[ i ] : nullptr;
+        search( locations[ i ], radius, [&result_indices,&result_distances]( point_index j, real d )
+          {
+            *result_indices ++ = j;
+            if( result_distances )
+              *result_distances ++ = d;
+          });
+      }
+  }
+
+  void
+  spatial_grid::radius_search(
+      const vec3* locations, size_t nlocations, real radius,
+      point_neighborhoods& neighborhoods ) const
+  {
+    neighborhoods.offsets.resize( nlocations + 1 );
+    const size_t total = count_in_radius( locations, nlocations, radius, neighborhoods.offsets.data() );
+    neighborhoods.indices.resize( total );
+    neighborhoods.squared_distances.resize( total );
+    radius_search( locations, nlocations, radius, neighborhoods.offsets.data(),
+        neighborhoods.indices.data(), neighborhoods.squared_distances.data() );
+  }
+
+  void
+  spatial_grid::compute_all_neighbors( real radius, point_neighborhoods& neighborhoods ) const
+  {
+    const size_t npoints = m_positions.size();
+    auto& offsets = neighborhoods.offsets;
+    offsets.resize( npoints + 1 );
+    offsets[ 0 ] = 0;
+
+    // points are visited in the grid order, results are stored in the input order
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( long i = 0; i < long(npoints); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( size_t i = 0; i < npoints; ++ i )
+    # endif
+      {
+        const point_index self = m_indices[ i ];
+        size_t count = 0;
+        search( m_positions[ i ], radius, [&count,self]( point_index j, real )
+          {
+            if( j != self )
+              ++ count;
+          });
+        offsets[ self + 1 ] = count;
+      }
+    thrust::inclusive_scan( thrust::omp::par, offsets.begin(), offsets.end(), offsets.begin() );
+
+    neighborhoods.indices.resize( offsets[ npoints ] );
+    neighborhoods.squared_distances.resize( offsets[ npoints ] );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( long i = 0; i < long(npoints); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,256)
+    for( size_t i = 0; i < npoints; ++ i )
+    # endif
+      {
+        const point_index self = m_indices[ i ];
+        point_index* result_indices = neighborhoods.indices.data() + offsets[ self ];
+        real* result_distances = neighborhoods.squared_distances.data() + offsets[ self ];
+        search( m_positions[ i ], radius, [&result_indices,&result_distances,self]( point_index j, real d )
+          {
+            if( j != self )
+              {
+                *result_indices ++ = j;
+                *result_distances ++ = d;
+              }
+          });
+      }
+  }
+
+} END_GO_NAMESPACE
@@ -0,0 +1,1074 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/streaming_mesh.h"
+# include "../../graphics-origin/tools/log.h"
+
+# include <boost/filesystem.hpp>
+# include <boost/interprocess/file_mapping.hpp>
+# include <boost/interprocess/mapped_region.hpp>
+
+# include <omp.h>
+# include <algorithm>
+# include <atomic>
+# include <cmath>
+# include <cstring>
+# include <fstream>
+# include <mutex>
+# include <sstream>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  namespace {
+    namespace bf = boost::filesystem;
+    namespace bi = boost::interprocess;
+
+    /**Resolution, along the largest side of the bounding box, of the grid
+     * used to estimate the distribution of faces. */
+    constexpr int64_t histogram_resolution = 128;
+    /**Owner of a vertex referenced by several tiles, before its shared
+     * index is assigned. */
+    constexpr uint32_t shared_owner = uint32_t(-1);
+    /**Bit set in the owner of a vertex to store its shared index. */
+    constexpr uint32_t shared_bit = uint32_t(1) << 31;
+    /**Number of locks to accumulate the normals of shared vertices. */
+    constexpr size_t number_of_normal_locks = 64;
+    /**Size of a face in output PLY files: a count and three indices. */
+    constexpr size_t ply_face_size = 1 + 3 * sizeof(int32_t);
+
+    static_assert(
+        sizeof( std::atomic< uint32_t > ) == sizeof( uint32_t ),
+        "Owners are stored in a mapped file and updated as atomic integers");
+
+    /**A face as written in a tile file: the indices of its vertices in the
+     * input file and their positions, at full precision so that tiles see
+     * the same positions as the input file. */
+    struct tile_face {
+      uint32_t vertices[3];
+      real positions[9];
+    };
+
+    /**Where to find vertices and faces in a binary PLY file. */
+    struct ply_layout {
+      ply_layout()
+        : nvertices{ 0 }, nfaces{ 0 }, vertex_offset{ 0 }, vertex_stride{ 0 },
+          position_offsets{ 0, 0, 0 }, position_sizes{ 0, 0, 0 },
+          face_offset{ 0 }, face_stride{ 0 }, count_offset{ 0 }, count_size{ 0 },
+          indices_offset{ 0 }
+      {}
+      size_t nvertices;
+      size_t nfaces;
+      size_t vertex_offset;
+      size_t vertex_stride;
+      size_t position_offsets[3];
+      /**Size of each coordinate, which is the size of a float or of a double. */
+      size_t position_sizes[3];
+      size_t face_offset;
+      size_t face_stride;
+      size_t count_offset;
+      size_t count_size;
+      size_t indices_offset;
+    };
+
+    size_t get_ply_type_size( const std::string& type )
+    {
+      if( type == "char" || type == "uchar" || type == "int8" || type == "uint8" )
+        return 1;
+      if( type == "short" || type == "ushort" || type == "int16" || type == "uint16" )
+        return 2;
+      if( type == "int" || type == "uint" || type == "int32" || type == "uint32"
+       || type == "float" || type == "float32" )
+        return 4;
+      if( type == "double" || type == "float64" )
+        return 8;
+      return 0;
+    }
+
+    bool parse_ply_header( const std::string& filename, ply_layout& layout )
+    {
+      std::ifstream input( filename, std::ios::binary );
+      if( !input )
+        {
+          LOG( error, "cannot open file " << filename );
+          return false;
+        }
+
+      struct element {
+        std::string name;
+        size_t count;
+        size_t stride;
+      };
+      std::vector< element > elements;
+      bool positions[3] = { false, false, false };
+      bool has_indices = false;
+      bool binary_little_endian = false;
+      std::string line;
+      std::getline( input, line );
+      if( line.compare( 0, 3, "ply" ) )
+        {
+          LOG( error, filename << " is not a PLY file");
+          return false;
+        }
+      while( std::getline( input, line ) )
+        {
+          if( !line.empty() && line.back() == '\r' )
+            line.pop_back();
+          std::istringstream words( line );
+          std::string keyword;
+          words >> keyword;
+          if( keyword == "end_header" )
+            break;
+          else if( keyword == "format" )
+            {
+              std::string format;
+              words >> format;
+              binary_little_endian = format == "binary_little_endian";
+            }
+          else if( keyword == "element" )
+            {
+              element e;
+              words >> e.name >> e.count;
+              e.stride = 0;
+              elements.push_back( e );
+            }
+          else if( keyword == "property" && !elements.empty() )
+            {
+              element& e = elements.back();
+              std::string type, name;
+              words >> type;
+              if( type == "list" )
+                {
+                  std::string count_type, index_type;
+                  words >> count_type >> index_type >> name;
+                  const size_t count_size = get_ply_type_size( count_type );
+                  if( e.name != "face" || ( name != "vertex_indices" && name != "vertex_index" )
+                   || !count_size || get_ply_type_size( index_type ) != sizeof(uint32_t) )
+                    {
+                      LOG( error, "unsupported list property " << name << " in " << filename );
+                      return false;
+                    }
+                  layout.count_offset = e.stride;
+                  layout.count_size = count_size;
+                  layout.indices_offset = e.stride + count_size;
+                  // faces are expected to be triangles
+                  e.stride += count_size + 3 * sizeof(uint32_t);
+                  has_indices = true;
+                }
+              else
+                {
+                  words >> name;
+                  const size_t size = get_ply_type_size( type );
+                  if( !size )
+                    {
+                      LOG( error, "unknown property type " << type << " in " << filename );
+                      return false;
+                    }
+                  if( e.name == "vertex" && name.size() == 1 && name[0] >= 'x' && name[0] <= 'z' )
+                    {
+                      if( size != sizeof(float) && size != sizeof(double) )
+                        {
+                          LOG( error, "vertex positions should be floats or doubles in " << filename );
+                          return false;
+                        }
+                      layout.position_offsets[ name[0] - 'x' ] = e.stride;
+                      layout.position_sizes[ name[0] - 'x' ] = size;
+                      positions[ name[0] - 'x' ] = true;
+                    }
+                  e.stride += size;
+                }
+            }
+        }
+      if( !input || !binary_little_endian )
+        {
+          LOG( error, "only binary little endian PLY files are supported, " << filename << " is not one of them");
+          return false;
+        }
+      if( !positions[0] || !positions[1] || !positions[2] || !has_indices )
+        {
+          LOG( error, "missing vertex positions or face indices in " << filename );
+          return false;
+        }
+
+      size_t offset = size_t( input.tellg() );
+      bool vertex_found = false, face_found = false;
+      for( auto& e : elements )
+        {
+          if( e.name == "vertex" )
+            {
+              layout.nvertices = e.count;
+              layout.vertex_offset = offset;
+              layout.vertex_stride = e.stride;
+              vertex_found = true;
+            }
+          else if( e.name == "face" )
+            {
+              layout.nfaces = e.count;
+              layout.face_offset = offset;
+              layout.face_stride = e.stride;
+              face_found = true;
+              // the size of faces is known only for triangles, so that no
+              // other element can be located after them.
+              break;
+            }
+          offset += e.count * e.stride;
+        }
+      if( !vertex_found || !face_found )
+        {
+          LOG( error, "vertices should be stored before faces in " << filename );
+          return false;
+        }
+      if( layout.nvertices >= shared_bit )
+        {
+          LOG( error, "too many vertices in " << filename );
+          return false;
+        }
+      return true;
+    }
+
+    /**Read the indices of a face. Return false if the face is not a triangle
+     * or if it references a vertex that does not exist. */
+    inline bool read_face( const char* record, const ply_layout& layout, uint32_t* indices )
+    {
+      uint64_t count = 0;
+      std::memcpy( &count, record + layout.count_offset, layout.count_size );
+      if( count != 3 )
+        return false;
+      std::memcpy( indices, record + layout.indices_offset, 3 * sizeof(uint32_t) );
+      return indices[0] < layout.nvertices
+          && indices[1] < layout.nvertices
+          && indices[2] < layout.nvertices;
+    }
+
+    /**Create a file of a given size and map it in memory. The content of the
+     * file is filled with zeros. */
+    bool create_mapped_file(
+        const std::string& filename, size_t size,
+        bi::file_mapping& file, bi::mapped_region& region )
+    {
+      try
+        {
+          {
+            std::ofstream output( filename, std::ios::binary | std::ios::trunc );
+            if( !output )
+              {
+                LOG( error, "cannot create file " << filename );
+                return false;
+              }
+          }
+          bf::resize_file( filename, std::max( size, size_t(1) ) );
+          file = bi::file_mapping( filename.c_str(), bi::read_write );
+          region = bi::mapped_region( file, bi::read_write );
+        }
+      catch( const std::exception& e )
+        {
+          LOG( error, "cannot map file " << filename << ": " << e.what() );
+          return false;
+        }
+      return true;
+    }
+
+    /**Add the contributions of a face to the normals of its vertices. */
+    inline void add_face_normal(
+        const vec3& a, const vec3& b, const vec3& c, normal_weighting weighting,
+        vec3& na, vec3& nb, vec3& nc )
+    {
+      const vec3 positions[3] = { a, b, c };
+      vec3 normal, weights;
+      if( !compute_face_contribution( positions, weighting, normal, weights ) )
+        return;
+      na += weights[0] * normal;
+      nb += weights[1] * normal;
+      nc += weights[2] * normal;
+    }
+
+    inline void store_position( const vec3& p, float* destination )
+    {
+      destination[0] = float( p.x );
+      destination[1] = float( p.y );
+      destination[2] = float( p.z );
+    }
+
+    inline void store_normal( const vec3& n, float* destination )
+    {
+      const real l = length( n );
+      store_position( l > 0 ? n / l : vec3{ 0, 0, 0 }, destination );
+    }
+  }
+
+  streaming_parameters::streaming_parameters()
+    : chunk_size{ 1 << 20 }, max_faces_per_tile{ 1 << 20 }, number_of_workers{ 0 }
+  {}
+
+  struct streaming_mesh::implementation {
+    struct tile_information {
+      std::string filename;
+      aabox bounding_box;
+      vec3 minp;
+      vec3 maxp;
+      size_t nfaces;
+    };
+
+    implementation()
+      : owners{ nullptr }
+    {}
+
+    ~implementation()
+    {
+      clear();
+    }
+
+    void clear()
+    {
+      input_region = bi::mapped_region();
+      input_file = bi::file_mapping();
+      owners_region = bi::mapped_region();
+      owners_file = bi::file_mapping();
+      owners = nullptr;
+      if( !directory.empty() )
+        {
+          boost::system::error_code error;
+          bf::remove_all( directory, error );
+          directory.clear();
+        }
+      layout = ply_layout();
+      tiles.clear();
+      shared_vertices.clear();
+      bounding_box = aabox();
+    }
+
+    inline vec3 get_position( size_t vertex ) const
+    {
+      const char* record = static_cast< const char* >( input_region.get_address() ) + vertex * layout.vertex_stride;
+      vec3 p;
+      for( int d = 0; d < 3; ++ d )
+        {
+          if( layout.position_sizes[d] == sizeof(double) )
+            {
+              double value;
+              std::memcpy( &value, record + layout.position_offsets[d], sizeof(double) );
+              p[d] = real( value );
+            }
+          else
+            {
+              float value;
+              std::memcpy( &value, record + layout.position_offsets[d], sizeof(float) );
+              p[d] = real( value );
+            }
+        }
+      return p;
+    }
+
+    inline std::atomic< uint32_t >& get_owner( size_t vertex ) const
+    {
+      return reinterpret_cast< std::atomic< uint32_t >* >( owners )[ vertex ];
+    }
+
+    inline int64_t get_histogram_cell( const vec3& p ) const
+    {
+      int64_t c[3];
+      for( int d = 0; d < 3; ++ d )
+        c[d] = std::min( std::max( int64_t( ( p[d] - histogram_origin[d] ) * histogram_inv_cell_size ), int64_t(0) ), histogram_dimensions[d] - 1 );
+      return ( c[2] * histogram_dimensions[1] + c[1] ) * histogram_dimensions[0] + c[0];
+    }
+
+    /**Read the faces of the input file by chunks. The function
+     * process( records, first, count ) is called for each chunk, where
+     * records points to count faces, the first one being the face first. */
+    template< typename chunk_processor >
+    bool for_each_chunk( chunk_processor&& process ) const
+    {
+      std::ifstream input( filename, std::ios::binary );
+      input.seekg( std::streamoff( layout.face_offset ) );
+      const size_t chunk_size = std::min( parameters.chunk_size, layout.nfaces );
+      std::vector< char > records( chunk_size * layout.face_stride );
+      for( size_t first = 0; first < layout.nfaces; first += chunk_size )
+        {
+          const size_t count = std::min( chunk_size, layout.nfaces - first );
+          if( !input.read( records.data(), std::streamsize( count * layout.face_stride ) ) )
+            {
+              LOG( error, "cannot read faces of " << filename );
+              return false;
+            }
+          if( !process( records.data(), first, count ) )
+            return false;
+        }
+      return true;
+    }
+
+    bool compute_bounding_box();
+    bool compute_histogram( std::vector< uint32_t >& histogram );
+    void build_tiles( const std::vector< uint32_t >& histogram, std::vector< uint32_t >& cell_tiles );
+    bool fill_tiles( const std::vector< uint32_t >& cell_tiles );
+    void assign_shared_indices();
+
+    streaming_parameters parameters;
+    std::string filename;
+    ply_layout layout;
+    bf::path directory;
+
+    bi::file_mapping input_file;
+    /**Vertex records of the input file. */
+    bi::mapped_region input_region;
+    bi::file_mapping owners_file;
+    bi::mapped_region owners_region;
+    /**For each input vertex: zero if it is not referenced, t + 1 if it is
+     * only referenced by the tile t, shared_bit | s if it is the shared
+     * vertex s. */
+    uint32_t* owners;
+
+    aabox bounding_box;
+    vec3 histogram_origin;
+    real histogram_inv_cell_size;
+    int64_t histogram_dimensions[3];
+    std::vector< tile_information > tiles;
+    /**Input index of each shared vertex. */
+    std::vector< vertex_index > shared_vertices;
+  };
+
+  bool
+  streaming_mesh::implementation::compute_bounding_box()
+  {
+    const size_t nvertices = layout.nvertices;
+    vec3 minp{ REAL_MAX, REAL_MAX, REAL_MAX };
+    vec3 maxp{ -REAL_MAX, -REAL_MAX, -REAL_MAX };
+    # pragma omp parallel
+    {
+      vec3 thread_minp = minp, thread_maxp = maxp;
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp for schedule(static)
+      for( long i = 0; i < long(nvertices); ++ i )
+      # else
+      #   pragma omp for schedule(static)
+      for( size_t i = 0; i < nvertices; ++ i )
+      # endif
+        {
+          const vec3 p = get_position( i );
+          thread_minp = min( thread_minp, p );
+          thread_maxp = max( thread_maxp, p );
+        }
+      # pragma omp critical
+      {
+        minp = min( minp, thread_minp );
+        maxp = max( maxp, thread_maxp );
+      }
+    }
+    if( !( minp.x <= maxp.x && minp.y <= maxp.y && minp.z <= maxp.z ) )
+      {
+        LOG( error, "invalid vertex positions in " << filename );
+        return false;
+      }
+    bounding_box = aabox( minp, maxp );
+
+    const vec3 extent = maxp - minp;
+    const real cell_size = std::max( max( extent ) / real( histogram_resolution ), real(1e-12) );
+    histogram_origin = minp;
+    histogram_inv_cell_size = real(1) / cell_size;
+    for( int d = 0; d < 3; ++ d )
+      histogram_dimensions[d] = std::min( std::max( int64_t( std::ceil( extent[d] / cell_size ) ), int64_t(1) ), histogram_resolution );
+    return true;
+  }
+
+  bool
+  streaming_mesh::implementation::compute_histogram( std::vector< uint32_t >& histogram )
+  {
+    const size_t ncells = size_t( histogram_dimensions[0] * histogram_dimensions[1] * histogram_dimensions[2] );
+    std::unique_ptr< std::atomic< uint32_t >[] > counters( new std::atomic< uint32_t >[ ncells ] );
+    for( size_t i = 0; i < ncells; ++ i )
+      counters[ i ].store( 0, std::memory_order_relaxed );
+
+    std::atomic< bool > valid_faces{ true };
+    const bool success = for_each_chunk( [&]( const char* records, size_t, size_t count )
+      {
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(count); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < count; ++ i )
+        # endif
+          {
+            uint32_t indices[3];
+            if( !read_face( records + i * layout.face_stride, layout, indices ) )
+              {
+                valid_faces.store( false, std::memory_order_relaxed );
+                continue;
+              }
+            const vec3 centroid = ( get_position( indices[0] ) + get_position( indices[1] ) + get_position( indices[2] ) ) / real(3);
+            counters[ get_histogram_cell( centroid ) ].fetch_add( 1, std::memory_order_relaxed );
+          }
+        if( !valid_faces.load( std::memory_order_relaxed ) )
+          {
+            LOG( error, "faces should be triangles with valid vertex indices in " << filename );
+            return false;
+          }
+        return true;
+      });
+
+    histogram.resize( ncells );
+    for( size_t i = 0; i < ncells; ++ i )
+      histogram[ i ] = counters[ i ].load( std::memory_order_relaxed );
+    return success;
+  }
+
+  void
+  streaming_mesh::implementation::build_tiles(
+      const std::vector< uint32_t >& histogram, std::vector< uint32_t >& cell_tiles )
+  {
+    // Cells of the histogram are split recursively, at the median of the
+    // largest side, until each region has few enough faces.
+    struct region {
+      int64_t low[3];
+      int64_t high[3];
+    };
+    cell_tiles.assign( histogram.size(), uint32_t(-1) );
+    std::vector< region > regions( 1 );
+    for( int d = 0; d < 3; ++ d )
+      {
+        regions.back().low[d] = 0;
+        regions.back().high[d] = histogram_dimensions[d];
+      }
+    std::vector< size_t > slabs;
+    while( !regions.empty() )
+      {
+        const region r = regions.back();
+        regions.pop_back();
+
+        int axis = 0;
+        for( int d = 1; d < 3; ++ d )
+          if( r.high[d] - r.low[d] > r.high[axis] - r.low[axis] )
+            axis = d;
+
+        slabs.assign( size_t( r.high[axis] - r.low[axis] ), 0 );
+        size_t nfaces = 0;
+        int64_t c[3];
+        for( c[2] = r.low[2]; c[2] < r.high[2]; ++ c[2] )
+          for( c[1] = r.low[1]; c[1] < r.high[1]; ++ c[1] )
+            for( c[0] = r.low[0]; c[0] < r.high[0]; ++ c[0] )
+              {
+                const uint32_t count = histogram[ size_t( ( c[2] * histogram_dimensions[1] + c[1] ) * histogram_dimensions[0] + c[0] ) ];
+                slabs[ size_t( c[axis] - r.low[axis] ) ] += count;
+                nfaces += count;
+              }
+        if( !nfaces )
+          continue;
+
+        if( nfaces <= parameters.max_faces_per_tile || slabs.size() == 1 )
+          {
+            const uint32_t tile = uint32_t( tiles.size() );
+            for( c[2] = r.low[2]; c[2] < r.high[2]; ++ c[2] )
+              for( c[1] = r.low[1]; c[1] < r.high[1]; ++ c[1] )
+                for( c[0] = r.low[0]; c[0] < r.high[0]; ++ c[0] )
+                  cell_tiles[ size_t( ( c[2] * histogram_dimensions[1] + c[1] ) * histogram_dimensions[0] + c[0] ) ] = tile;
+            tile_information information;
+            information.filename = ( directory / ( "tile" + std::to_string( tile ) + ".bin" ) ).string();
+            information.minp = vec3{ REAL_MAX, REAL_MAX, REAL_MAX };
+            information.maxp = vec3{ -REAL_MAX, -REAL_MAX, -REAL_MAX };
+            information.nfaces = 0;
+            tiles.push_back( information );
+            continue;
+          }
+
+        size_t split = 1, below = slabs[0];
+        while( split + 1 < slabs.size() && 2 * below < nfaces )
+          below += slabs[ split ++ ];
+        region left = r, right = r;
+        left.high[axis] = right.low[axis] = r.low[axis] + int64_t( split );
+        regions.push_back( left );
+        regions.push_back( right );
+      }
+  }
+
+  bool
+  streaming_mesh::implementation::fill_tiles( const std::vector< uint32_t >& cell_tiles )
+  {
+    const size_t ntiles = tiles.size();
+    std::vector< uint32_t > face_tiles;
+    std::vector< tile_face > faces;
+    std::vector< tile_face > sorted_faces;
+    std::vector< size_t > offsets( ntiles + 1 );
+    const bool success = for_each_chunk( [&]( const char* records, size_t, size_t count )
+      {
+        face_tiles.resize( count );
+        faces.resize( count );
+        sorted_faces.resize( count );
+        # ifdef _MSC_VER
+        GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+        #   pragma omp parallel for schedule(static)
+        for( long i = 0; i < long(count); ++ i )
+        # else
+        #   pragma omp parallel for schedule(static)
+        for( size_t i = 0; i < count; ++ i )
+        # endif
+          {
+            tile_face& face = faces[ i ];
+            read_face( records + i * layout.face_stride, layout, face.vertices );
+            vec3 centroid{ 0, 0, 0 };
+            for( int k = 0; k < 3; ++ k )
+              {
+                const vec3 p = get_position( face.vertices[ k ] );
+                face.positions[ 3 * k ] = p.x;
+                face.positions[ 3 * k + 1 ] = p.y;
+                face.positions[ 3 * k + 2 ] = p.z;
+                centroid += p;
+              }
+            const uint32_t tile = cell_tiles[ size_t( get_histogram_cell( centroid / real(3) ) ) ];
+            face_tiles[ i ] = tile;
+
+            // a vertex referenced by two different tiles becomes shared
+            const uint32_t owner = tile + 1;
+            for( int k = 0; k < 3; ++ k )
+              {
+                std::atomic< uint32_t >& o = get_owner( face.vertices[ k ] );
+                uint32_t current = o.load( std::memory_order_relaxed );
+                while( current != owner && current != shared_owner
+                    && !o.compare_exchange_weak( current, current ? shared_owner : owner, std::memory_order_relaxed ) )
+                  {}
+              }
+          }
+
+        // counting sort of the chunk by tile
+        std::fill( offsets.begin(), offsets.end(), 0 );
+        for( size_t i = 0; i < count; ++ i )
+          ++ offsets[ face_tiles[ i ] + 1 ];
+        for( size_t t = 0; t < ntiles; ++ t )
+          offsets[ t + 1 ] += offsets[ t ];
+        for( size_t i = 0; i < count; ++ i )
+          {
+            const tile_face& face = faces[ i ];
+            tile_information& tile = tiles[ face_tiles[ i ] ];
+            for( int k = 0; k < 3; ++ k )
+              {
+                const vec3 p{ face.positions[ 3 * k ], face.positions[ 3 * k + 1 ], face.positions[ 3 * k + 2 ] };
+                tile.minp = min( tile.minp, p );
+                tile.maxp = max( tile.maxp, p );
+              }
+            sorted_faces[ offsets[ face_tiles[ i ] ] ++ ] = face;
+          }
+
+        // after the scatter, offsets[t] is the end of the faces of the tile t
+        size_t begin = 0;
+        for( size_t t = 0; t < ntiles; ++ t )
+          {
+            const size_t end = offsets[ t ];
+            if( end == begin )
+              continue;
+            std::ofstream output( tiles[ t ].filename, std::ios::binary | std::ios::app );
+            output.write( reinterpret_cast< const char* >( sorted_faces.data() + begin ), std::streamsize( ( end - begin ) * sizeof(tile_face) ) );
+            if( !output )
+              {
+                LOG( error, "cannot write tile " << tiles[ t ].filename );
+                return false;
+              }
+            tiles[ t ].nfaces += end - begin;
+            begin = end;
+          }
+        return true;
+      });
+
+    for( auto& tile : tiles )
+      tile.bounding_box = aabox( tile.minp, tile.maxp );
+    return success;
+  }
+
+  void
+  streaming_mesh::implementation::assign_shared_indices()
+  {
+    const size_t nvertices = layout.nvertices;
+    for( size_t i = 0; i < nvertices; ++ i )
+      if( owners[ i ] == shared_owner )
+        {
+          owners[ i ] = shared_bit | uint32_t( shared_vertices.size() );
+          shared_vertices.push_back( vertex_index( i ) );
+        }
+  }
+
+  streaming_mesh::streaming_mesh()
+    : m_implementation{ new implementation }
+  {}
+
+  streaming_mesh::~streaming_mesh()
+  {}
+
+  bool
+  streaming_mesh::load( const std::string& filename, const streaming_parameters& parameters )
+  {
+    clear();
+    implementation& impl = *m_implementation;
+    impl.parameters = parameters;
+    impl.parameters.chunk_size = std::max( parameters.chunk_size, size_t(1) );
+    impl.parameters.max_faces_per_tile = std::max( parameters.max_faces_per_tile, size_t(1) );
+    impl.filename = filename;
+    if( !parse_ply_header( filename, impl.layout ) )
+      {
+        clear();
+        return false;
+      }
+    const ply_layout& layout = impl.layout;
+    if( !layout.nvertices || !layout.nfaces )
+      {
+        LOG( error, "no face to process in " << filename );
+        clear();
+        return false;
+      }
+
+    boost::system::error_code error;
+    const size_t file_size = bf::file_size( filename, error );
+    if( error || file_size < layout.face_offset + layout.nfaces * layout.face_stride )
+      {
+        LOG( error, "file " << filename << " is truncated");
+        clear();
+        return false;
+      }
+
+    try
+      {
+        impl.input_file = bi::file_mapping( filename.c_str(), bi::read_only );
+        impl.input_region = bi::mapped_region(
+            impl.input_file, bi::read_only,
+            bi::offset_t( layout.vertex_offset ), layout.nvertices * layout.vertex_stride );
+      }
+    catch( const std::exception& e )
+      {
+        LOG( error, "cannot map file " << filename << ": " << e.what() );
+        clear();
+        return false;
+      }
+
+    const bf::path base = parameters.temporary_directory.empty()
+        ? bf::temp_directory_path( error ) : bf::path( parameters.temporary_directory );
+    impl.directory = base / bf::unique_path( "graphics-origin-%%%%-%%%%-%%%%-%%%%" );
+    if( !bf::create_directories( impl.directory, error ) )
+      {
+        LOG( error, "cannot create temporary directory " << impl.directory.string() );
+        impl.directory.clear();
+        clear();
+        return false;
+      }
+
+    if( !create_mapped_file( ( impl.directory / "owners.bin" ).string(), layout.nvertices * sizeof(uint32_t), impl.owners_file, impl.owners_region ) )
+      {
+        clear();
+        return false;
+      }
+    impl.owners = static_cast< uint32_t* >( impl.owners_region.get_address() );
+
+    std::vector< uint32_t > histogram, cell_tiles;
+    if( !impl.compute_bounding_box() || !impl.compute_histogram( histogram ) )
+      {
+        clear();
+        return false;
+      }
+    impl.build_tiles( histogram, cell_tiles );
+    if( !impl.fill_tiles( cell_tiles ) )
+      {
+        clear();
+        return false;
+      }
+    impl.assign_shared_indices();
+    LOG( debug, filename << " split into " << impl.tiles.size() << " tiles with " << impl.shared_vertices.size() << " shared vertices");
+    return true;
+  }
+
+  void
+  streaming_mesh::clear()
+  {
+    m_implementation->clear();
+  }
+
+  size_t
+  streaming_mesh::get_number_of_vertices() const noexcept
+  {
+    return m_implementation->layout.nvertices;
+  }
+
+  size_t
+  streaming_mesh::get_number_of_faces() const noexcept
+  {
+    return m_implementation->layout.nfaces;
+  }
+
+  size_t
+  streaming_mesh::get_number_of_shared_vertices() const noexcept
+  {
+    return m_implementation->shared_vertices.size();
+  }
+
+  size_t
+  streaming_mesh::get_number_of_tiles() const noexcept
+  {
+    return m_implementation->tiles.size();
+  }
+
+  const aabox&
+  streaming_mesh::get_bounding_box() const noexcept
+  {
+    return m_implementation->bounding_box;
+  }
+
+  const aabox&
+  streaming_mesh::get_tile_bounding_box( size_t tile ) const
+  {
+    return m_implementation->tiles[ tile ].bounding_box;
+  }
+
+  size_t
+  streaming_mesh::get_tile_number_of_faces( size_t tile ) const
+  {
+    return m_implementation->tiles[ tile ].nfaces;
+  }
+
+  bool
+  streaming_mesh::load_tile( size_t tile, streaming_tile& result ) const
+  {
+    const implementation::tile_information& information = m_implementation->tiles[ tile ];
+    const size_t nfaces = information.nfaces;
+    std::vector< tile_face > faces( nfaces );
+    std::ifstream input( information.filename, std::ios::binary );
+    if( !input.read( reinterpret_cast< char* >( faces.data() ), std::streamsize( nfaces * sizeof(tile_face) ) ) )
+      {
+        LOG( error, "cannot read tile " << information.filename );
+        return false;
+      }
+
+    result.index = tile;
+    result.bounding_box = information.bounding_box;
+    auto& global_indices = result.global_indices;
+    global_indices.resize( 3 * nfaces );
+    for( size_t i = 0; i < nfaces; ++ i )
+      for( int k = 0; k < 3; ++ k )
+        global_indices[ 3 * i + k ] = faces[ i ].vertices[ k ];
+    std::sort( global_indices.begin(), global_indices.end() );
+    global_indices.erase( std::unique( global_indices.begin(), global_indices.end() ), global_indices.end() );
+
+    const size_t nvertices = global_indices.size();
+    result.mesh.vertices.resize( nvertices );
+    result.mesh.indices.resize( 3 * nfaces );
+    for( size_t i = 0; i < nfaces; ++ i )
+      for( int k = 0; k < 3; ++ k )
+        {
+          const vertex_index local = vertex_index(
+              std::lower_bound( global_indices.begin(), global_indices.end(), faces[ i ].vertices[ k ] ) - global_indices.begin() );
+          result.mesh.indices[ 3 * i + k ] = local;
+          const real* p = faces[ i ].positions + 3 * k;
+          result.mesh.vertices[ local ] = vec3{ p[0], p[1], p[2] };
+        }
+
+    result.shared_indices.resize( nvertices );
+    for( size_t i = 0; i < nvertices; ++ i )
+      {
+        const uint32_t owner = m_implementation->owners[ global_indices[ i ] ];
+        result.shared_indices[ i ] = ( owner & shared_bit ) ? ( owner & ~shared_bit ) : indexed_mesh::invalid_index;
+      }
+    return true;
+  }
+
+  bool
+  streaming_mesh::process_tiles( const std::function< void( streaming_tile& ) >& worker ) const
+  {
+    const size_t ntiles = m_implementation->tiles.size();
+    const size_t nworkers = m_implementation->parameters.number_of_workers
+        ? m_implementation->parameters.number_of_workers : size_t( omp_get_max_threads() );
+    std::atomic< bool > success{ true };
+    # pragma omp parallel num_threads( int( nworkers ) )
+    {
+      streaming_tile tile;
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp for schedule(dynamic,1)
+      for( long i = 0; i < long(ntiles); ++ i )
+      # else
+      #   pragma omp for schedule(dynamic,1)
+      for( size_t i = 0; i < ntiles; ++ i )
+      # endif
+        {
+          if( load_tile( i, tile ) )
+            worker( tile );
+          else
+            success.store( false, std::memory_order_relaxed );
+        }
+    }
+    return success.load();
+  }
+
+  bool
+  streaming_mesh::process_tile_hierarchies(
+      const std::function< void( const streaming_tile&, const std::vector< triangle >&, const bvh< aabox >& ) >& worker ) const
+  {
+    return process_tiles( [&worker]( streaming_tile& tile )
+      {
+        const size_t nfaces = tile.mesh.get_number_of_faces();
+        if( nfaces < 2 )
+          return;
+        const auto& vertices = tile.mesh.vertices;
+        const auto& indices = tile.mesh.indices;
+        std::vector< triangle > triangles;
+        triangles.reserve( nfaces );
+        for( size_t i = 0; i < nfaces; ++ i )
+          triangles.emplace_back( vertices[ indices[ 3 * i ] ], vertices[ indices[ 3 * i + 1 ] ], vertices[ indices[ 3 * i + 2 ] ] );
+        bvh< aabox > hierarchy( triangles.data(), triangles.size() );
+        worker( tile, triangles, hierarchy );
+      });
+  }
+
+  bool
+  streaming_mesh::compute_vertex_normals( const std::string& filename, normal_weighting weighting ) const
+  {
+    const implementation& impl = *m_implementation;
+    const size_t nshared = impl.shared_vertices.size();
+    bi::file_mapping file;
+    bi::mapped_region region;
+    if( !create_mapped_file( filename, impl.layout.nvertices * 3 * sizeof(float), file, region ) )
+      return false;
+    float* normals = static_cast< float* >( region.get_address() );
+
+    // Contributions to shared vertices are accumulated until every tile is
+    // processed, so that they do not depend on the tile layout.
+    std::vector< vec3 > shared_normals( nshared, vec3{ 0, 0, 0 } );
+    std::unique_ptr< std::mutex[] > locks( new std::mutex[ number_of_normal_locks ] );
+    const bool success = process_tiles( [&]( streaming_tile& tile )
+      {
+        const auto& vertices = tile.mesh.vertices;
+        const auto& indices = tile.mesh.indices;
+        const size_t nfaces = tile.mesh.get_number_of_faces();
+        std::vector< vec3 > sums( vertices.size(), vec3{ 0, 0, 0 } );
+        for( size_t i = 0; i < nfaces; ++ i )
+          {
+            const vertex_index a = indices[ 3 * i ], b = indices[ 3 * i + 1 ], c = indices[ 3 * i + 2 ];
+            add_face_normal( vertices[ a ], vertices[ b ], vertices[ c ], weighting, sums[ a ], sums[ b ], sums[ c ] );
+          }
+        for( size_t i = 0; i < sums.size(); ++ i )
+          {
+            const vertex_index shared = tile.shared_indices[ i ];
+            if( shared == indexed_mesh::invalid_index )
+              store_normal( sums[ i ], normals + 3 * size_t( tile.global_indices[ i ] ) );
+            else
+              {
+                std::lock_guard< std::mutex > lock( locks[ shared % number_of_normal_locks ] );
+                shared_normals[ shared ] += sums[ i ];
+              }
+          }
+      });
+
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nshared); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nshared; ++ i )
+    # endif
+      store_normal( shared_normals[ i ], normals + 3 * size_t( impl.shared_vertices[ i ] ) );
+
+    return success && region.flush();
+  }
+
+  bool
+  streaming_mesh::simplify(
+      const std::string& filename, real ratio,
+      const simplification_parameters& parameters ) const
+  {
+    const implementation& impl = *m_implementation;
+    const size_t nshared = impl.shared_vertices.size();
+    bi::file_mapping vertices_file, faces_file;
+    bi::mapped_region vertices_region, faces_region;
+    const std::string vertices_filename = ( impl.directory / "simplified_vertices.bin" ).string();
+    const std::string faces_filename = ( impl.directory / "simplified_faces.bin" ).string();
+    if( !create_mapped_file( vertices_filename, impl.layout.nvertices * 3 * sizeof(float), vertices_file, vertices_region )
+     || !create_mapped_file( faces_filename, impl.layout.nfaces * ply_face_size, faces_file, faces_region ) )
+      return false;
+    float* output_vertices = static_cast< float* >( vertices_region.get_address() );
+    char* output_faces = static_cast< char* >( faces_region.get_address() );
+
+    // shared vertices are written first, with their input positions
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nshared); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nshared; ++ i )
+    # endif
+      store_position( impl.get_position( impl.shared_vertices[ i ] ), output_vertices + 3 * i );
+
+    std::atomic< size_t > next_vertex{ nshared }, next_face{ 0 };
+    const bool success = process_tiles( [&]( streaming_tile& tile )
+      {
+        const size_t nvertices = tile.mesh.get_number_of_vertices();
+        std::unique_ptr< bool[] > locked( new bool[ nvertices ] );
+        for( size_t i = 0; i < nvertices; ++ i )
+          locked[ i ] = tile.shared_indices[ i ] != indexed_mesh::invalid_index;
+
+        simplification_parameters tile_parameters = parameters;
+        tile_parameters.target_number_of_faces = size_t( ratio * real( tile.mesh.get_number_of_faces() ) );
+        tile_parameters.locked_vertices = locked.get();
+        std::vector< vertex_index > remap;
+        geometry::simplify( tile.mesh, tile_parameters, &remap );
+
+        // index of the remaining vertices in the output file
+        size_t ninterior = 0;
+        for( size_t i = 0; i < nvertices; ++ i )
+          if( remap[ i ] != indexed_mesh::invalid_index && !locked[ i ] )
+            ++ ninterior;
+        size_t output_index = next_vertex.fetch_add( ninterior );
+        std::vector< vertex_index > output_indices( tile.mesh.get_number_of_vertices() );
+        for( size_t i = 0; i < nvertices; ++ i )
+          {
+            const vertex_index j = remap[ i ];
+            if( j == indexed_mesh::invalid_index )
+              continue;
+            if( locked[ i ] )
+              output_indices[ j ] = tile.shared_indices[ i ];
+            else
+              {
+                store_position( tile.mesh.vertices[ j ], output_vertices + 3 * output_index );
+                output_indices[ j ] = vertex_index( output_index ++ );
+              }
+          }
+
+        const size_t nfaces = tile.mesh.get_number_of_faces();
+        char* record = output_faces + next_face.fetch_add( nfaces ) * ply_face_size;
+        for( size_t i = 0; i < nfaces; ++ i, record += ply_face_size )
+          {
+            int32_t face[3];
+            for( int k = 0; k < 3; ++ k )
+              face[ k ] = int32_t( output_indices[ tile.mesh.indices[ 3 * i + k ] ] );
+            record[0] = 3;
+            std::memcpy( record + 1, face, sizeof(face) );
+          }
+      });
+
+    const size_t nvertices = next_vertex.load();
+    const size_t nfaces = next_face.load();
+    std::ofstream output( filename, std::ios::binary | std::ios::trunc );
+    output << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "element vertex " << nvertices << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n"
+           << "element face " << nfaces << "\n"
+           << "property list uchar int vertex_indices\n"
+           << "end_header\n";
+    output.write( reinterpret_cast< const char* >( output_vertices ), std::streamsize( nvertices * 3 * sizeof(float) ) );
+    output.write( output_faces, std::streamsize( nfaces * ply_face_size ) );
+    output.close();
+
+    vertices_region = bi::mapped_region();
+    faces_region = bi::mapped_region();
+    vertices_file = bi::file_mapping();
+    faces_file = bi::file_mapping();
+    boost::system::error_code error;
+    bf::remove( vertices_filename, error );
+    bf::remove( faces_filename, error );
+
+    if( !output )
+      {
+        LOG( error, "cannot write file " << filename );
+        return false;
+      }
+    return success;
+  }
+
+} END_GO_NAMESPACE
@@ -192,7 +192,7 @@ namespace geometry {
     FINDMINMAX(v0[2],v1[2],v2[2],min,max);
     if(min>bb.hsides[2] || max<-bb.hsides[2]) return false;
 
-    return plane_overlap_box( normal, vertices[0], bb.hsides );
+    return plane_overlap_box( normal, v0, bb.hsides );
   }
 
 
@@ -253,7 +253,7 @@ namespace geometry {
 
     auto cross_v1_source_edge1 = cross( v1_source, edge1 );
     auto v = dot( r.get_direction(), cross_v1_source_edge1 ) * inv_determinant;
-    if( v < 0 || v > 1.0 ) return false;
+    if( v < 0 || u + v > 1.0 ) return false;
 
     t = dot( edge2, cross_v1_source_edge1 ) * inv_determinant;
     return t >= 0;
@@ -0,0 +1,560 @@
+/*  Created on: Oct 19, 2026
+ *      Author: T. Delame (tdelame@gmail.com)
+ */
+# include "../../graphics-origin/geometry/voxelizer.h"
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include "../../graphics-origin/geometry/triangle.h"
+# include "../../graphics-origin/geometry/box.h"
+
+# include "../../graphics-origin/extlibs/thrust/scan.h"
+# include "../../graphics-origin/extlibs/thrust/system/omp/execution_policy.h"
+
+# include <algorithm>
+# include <atomic>
+# include <bitset>
+# include <cmath>
+# include <memory>
+
+BEGIN_GO_NAMESPACE namespace geometry {
+
+  constexpr uint32_t voxel_brick_map::brick_size;
+  constexpr uint32_t voxel_brick_map::empty_brick;
+  constexpr uint32_t voxel_brick_map::full_brick;
+
+  namespace {
+    inline int64_t clamp_coordinate( real v, int64_t resolution )
+    {
+      return int64_t( std::min( std::max( v, real(0) ), real( resolution - 1 ) ) );
+    }
+
+    /**Build, with a parallel counting sort, the list of triangles of each
+     * bin. The function for_each_bin( face, emit ) should call emit( bin )
+     * for each bin of a face, in the same way each time it is called. */
+    template< typename bin_enumerator >
+    void bin_triangles(
+        size_t nfaces, size_t nbins, bin_enumerator&& for_each_bin,
+        std::vector< uint32_t >& offsets, std::vector< uint32_t >& triangles )
+    {
+      std::unique_ptr< std::atomic< uint32_t >[] > counters( new std::atomic< uint32_t >[ nbins ] );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nbins); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nbins; ++ i )
+      # endif
+        counters[ i ].store( 0, std::memory_order_relaxed );
+
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(dynamic,256)
+      for( long i = 0; i < long(nfaces); ++ i )
+      # else
+      #   pragma omp parallel for schedule(dynamic,256)
+      for( size_t i = 0; i < nfaces; ++ i )
+      # endif
+        for_each_bin( i, [&counters]( size_t bin )
+          {
+            counters[ bin ].fetch_add( 1, std::memory_order_relaxed );
+          });
+
+      offsets.resize( nbins + 1 );
+      offsets[ 0 ] = 0;
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nbins); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nbins; ++ i )
+      # endif
+        offsets[ i + 1 ] = counters[ i ].load( std::memory_order_relaxed );
+      thrust::inclusive_scan( thrust::omp::par, offsets.begin(), offsets.end(), offsets.begin() );
+
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(static)
+      for( long i = 0; i < long(nbins); ++ i )
+      # else
+      #   pragma omp parallel for schedule(static)
+      for( size_t i = 0; i < nbins; ++ i )
+      # endif
+        counters[ i ].store( offsets[ i ], std::memory_order_relaxed );
+
+      triangles.resize( offsets[ nbins ] );
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp parallel for schedule(dynamic,256)
+      for( long i = 0; i < long(nfaces); ++ i )
+      # else
+      #   pragma omp parallel for schedule(dynamic,256)
+      for( size_t i = 0; i < nfaces; ++ i )
+      # endif
+        for_each_bin( i, [&counters,&triangles,i]( size_t bin )
+          {
+            triangles[ counters[ bin ].fetch_add( 1, std::memory_order_relaxed ) ] = uint32_t( i );
+          });
+    }
+
+    /**Set the bits [first,last] of a row of voxels. */
+    inline void set_bits( uint8_t* row, int64_t first, int64_t last )
+    {
+      if( first > last )
+        return;
+      const int64_t first_byte = first >> 3, last_byte = last >> 3;
+      if( first_byte == last_byte )
+        {
+          row[ first_byte ] |= uint8_t( ( 0xFF << ( first & 7 ) ) & ( 0xFF >> ( 7 - ( last & 7 ) ) ) );
+          return;
+        }
+      row[ first_byte ] |= uint8_t( 0xFF << ( first & 7 ) );
+      std::fill( row + first_byte + 1, row + last_byte, uint8_t( 0xFF ) );
+      row[ last_byte ] |= uint8_t( 0xFF >> ( 7 - ( last & 7 ) ) );
+    }
+
+    /**2D edge function of the edge p->q at r, computed the same way for p->q
+     * and q->p up to the sign, so that shared edges are classified
+     * consistently by their two triangles. */
+    inline real edge_function( const vec2& p, const vec2& q, const vec2& r )
+    {
+      if( p.x > q.x || ( p.x == q.x && p.y > q.y ) )
+        return -( ( p.x - q.x ) * ( r.y - q.y ) - ( p.y - q.y ) * ( r.x - q.x ) );
+      return ( q.x - p.x ) * ( r.y - p.y ) - ( q.y - p.y ) * ( r.x - p.x );
+    }
+
+    /**Top-left rule: a point on the edge p->q of a counter-clockwise
+     * triangle belongs to the triangle if the edge is a top or left edge. Of
+     * the two orientations of an edge, exactly one is accepted. */
+    inline bool is_top_left( const vec2& p, const vec2& q )
+    {
+      const vec2 d = q - p;
+      return d.y > 0 || ( d.y == 0 && d.x < 0 );
+    }
+
+    struct crossing {
+      uint32_t column;
+      int32_t sign;
+      real x;
+      bool operator<( const crossing& other ) const
+      {
+        return column < other.column || ( column == other.column && x < other.x );
+      }
+    };
+  }
+
+  voxel_grid::voxel_grid()
+    : origin{ 0, 0, 0 }, voxel_size{ 0 }, resolution{ 0, 0, 0 }, row_size{ 0 }
+  {}
+
+  size_t
+  voxel_grid::count_voxels() const
+  {
+    size_t count = 0;
+    const size_t nbytes = bits.size();
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static) reduction(+:count)
+    for( long i = 0; i < long(nbytes); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static) reduction(+:count)
+    for( size_t i = 0; i < nbytes; ++ i )
+    # endif
+      count += std::bitset< 8 >( bits[ i ] ).count();
+    return count;
+  }
+
+  real
+  voxel_grid::compute_volume() const
+  {
+    return real( count_voxels() ) * voxel_size * voxel_size * voxel_size;
+  }
+
+  voxel_brick_map::voxel_brick_map()
+    : origin{ 0, 0, 0 }, voxel_size{ 0 }, resolution{ 0, 0, 0 }, brick_resolution{ 0, 0, 0 }
+  {}
+
+  size_t
+  voxel_brick_map::count_voxels() const
+  {
+    size_t count = 0;
+    const size_t nbricks = brick_indices.size();
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static) reduction(+:count)
+    for( long i = 0; i < long(nbricks); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static) reduction(+:count)
+    for( size_t i = 0; i < nbricks; ++ i )
+    # endif
+      {
+        const uint32_t index = brick_indices[ i ];
+        if( index == full_brick )
+          count += brick_size * brick_size * brick_size;
+        else if( index != empty_brick )
+          for( auto word : bricks[ index ] )
+            count += std::bitset< 64 >( word ).count();
+      }
+    return count;
+  }
+
+  real
+  voxel_brick_map::compute_volume() const
+  {
+    return real( count_voxels() ) * voxel_size * voxel_size * voxel_size;
+  }
+
+  void
+  voxel_brick_map::to_dense( voxel_grid& grid ) const
+  {
+    grid.origin = origin;
+    grid.voxel_size = voxel_size;
+    for( int d = 0; d < 3; ++ d )
+      grid.resolution[d] = resolution[d];
+    grid.row_size = brick_resolution[0];
+    grid.bits.assign( grid.row_size * resolution[1] * resolution[2], 0 );
+
+    // a row of a brick is exactly one byte of the dense grid, so bricks can
+    // be written in parallel
+    const size_t nbricks = brick_indices.size();
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nbricks); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nbricks; ++ i )
+    # endif
+      {
+        const uint32_t index = brick_indices[ i ];
+        if( index == empty_brick )
+          continue;
+        const size_t bx = i % brick_resolution[0];
+        const size_t by = ( i / brick_resolution[0] ) % brick_resolution[1];
+        const size_t bz = i / ( size_t( brick_resolution[0] ) * brick_resolution[1] );
+        for( uint32_t lz = 0; lz < brick_size; ++ lz )
+          {
+            const size_t z = bz * brick_size + lz;
+            if( z >= resolution[2] )
+              break;
+            for( uint32_t ly = 0; ly < brick_size; ++ ly )
+              {
+                const size_t y = by * brick_size + ly;
+                if( y >= resolution[1] )
+                  break;
+                grid.bits[ ( z * resolution[1] + y ) * grid.row_size + bx ] =
+                  index == full_brick ? uint8_t( 0xFF ) : uint8_t( bricks[ index ][ lz ] >> ( 8 * ly ) );
+              }
+          }
+      }
+  }
+
+  void
+  voxelize(
+      const indexed_mesh& m, uint32_t resolution, voxelization_mode mode,
+      voxel_brick_map& result )
+  {
+    const uint32_t bs = voxel_brick_map::brick_size;
+    const size_t nfaces = m.get_number_of_faces();
+    const uint32_t* indices = m.indices.data();
+    const vec3* positions = m.vertices.data();
+
+    // grid layout
+    aabox box;
+    m.compute_bounding_box( box );
+    const vec3 lower = box.get_min(), extent = box.get_max() - lower;
+    resolution = std::max( resolution, uint32_t(1) );
+    result.origin = lower;
+    result.voxel_size = std::max( max( extent ) / real( resolution ), real(1e-12) );
+    const real inv_size = real(1) / result.voxel_size;
+    for( int d = 0; d < 3; ++ d )
+      {
+        result.resolution[d] = std::min( resolution,
+          std::max( uint32_t(1), uint32_t( std::ceil( extent[d] * inv_size ) ) ) );
+        result.brick_resolution[d] = ( result.resolution[d] + bs - 1 ) / bs;
+      }
+    const int64_t res[3] = { result.resolution[0], result.resolution[1], result.resolution[2] };
+    const size_t brx = result.brick_resolution[0], bry = result.brick_resolution[1], brz = result.brick_resolution[2];
+    const size_t nbricks = brx * bry * brz;
+    result.brick_indices.assign( nbricks, voxel_brick_map::empty_brick );
+    result.bricks.clear();
+
+    std::vector< triangle > triangles( nfaces );
+    std::vector< char > valid( nfaces );
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(static)
+    for( long i = 0; i < long(nfaces); ++ i )
+    # else
+    #   pragma omp parallel for schedule(static)
+    for( size_t i = 0; i < nfaces; ++ i )
+    # endif
+      {
+        const uint32_t* f = indices + 3 * i;
+        valid[ i ] = f[0] != indexed_mesh::invalid_index;
+        if( valid[ i ] )
+          triangles[ i ] = triangle( positions[ f[0] ], positions[ f[1] ], positions[ f[2] ] );
+      }
+
+    auto get_voxel_range = [&]( size_t face, int64_t* low, int64_t* high )
+      {
+        const uint32_t* f = indices + 3 * face;
+        const vec3 tmin = min( positions[ f[0] ], min( positions[ f[1] ], positions[ f[2] ] ) );
+        const vec3 tmax = max( positions[ f[0] ], max( positions[ f[1] ], positions[ f[2] ] ) );
+        for( int d = 0; d < 3; ++ d )
+          {
+            low[d] = clamp_coordinate( std::floor( ( tmin[d] - lower[d] ) * inv_size ), res[d] );
+            high[d] = clamp_coordinate( std::floor( ( tmax[d] - lower[d] ) * inv_size ), res[d] );
+          }
+      };
+
+    // surface: bin triangles into the bricks they intersect
+    std::vector< uint32_t > offsets, binned;
+    bin_triangles( nfaces, nbricks,
+      [&]( size_t face, auto&& emit )
+      {
+        if( !valid[ face ] )
+          return;
+        int64_t low[3], high[3];
+        get_voxel_range( face, low, high );
+        for( int d = 0; d < 3; ++ d )
+          {
+            low[d] /= bs;
+            high[d] /= bs;
+          }
+        const bool single = low[0] == high[0] && low[1] == high[1] && low[2] == high[2];
+        for( int64_t bz = low[2]; bz <= high[2]; ++ bz )
+          for( int64_t by = low[1]; by <= high[1]; ++ by )
+            for( int64_t bx = low[0]; bx <= high[0]; ++ bx )
+              {
+                if( !single )
+                  {
+                    const vec3 bmin = lower + vec3{ bx, by, bz } * ( real( bs ) * result.voxel_size );
+                    if( !triangles[ face ].intersect( aabox( bmin, bmin + vec3{ 1, 1, 1 } * ( real( bs ) * result.voxel_size ) ) ) )
+                      continue;
+                  }
+                emit( ( size_t( bz ) * bry + size_t( by ) ) * brx + size_t( bx ) );
+              }
+      }, offsets, binned );
+
+    std::vector< uint32_t > surface_bricks;
+    for( size_t b = 0; b < nbricks; ++ b )
+      if( offsets[ b + 1 ] > offsets[ b ] )
+        {
+          result.brick_indices[ b ] = uint32_t( surface_bricks.size() );
+          surface_bricks.push_back( uint32_t( b ) );
+        }
+    result.bricks.resize( surface_bricks.size() );
+
+    // each brick is rasterized by a single thread
+    const size_t nsurface_bricks = surface_bricks.size();
+    # ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    #   pragma omp parallel for schedule(dynamic,16)
+    for( long i = 0; i < long(nsurface_bricks); ++ i )
+    # else
+    #   pragma omp parallel for schedule(dynamic,16)
+    for( size_t i = 0; i < nsurface_bricks; ++ i )
+    # endif
+      {
+        const size_t b = surface_bricks[ i ];
+        const int64_t brick_low[3] = {
+          int64_t( b % brx ) * bs,
+          int64_t( ( b / brx ) % bry ) * bs,
+          int64_t( b / ( brx * bry ) ) * bs };
+        auto& mask = result.bricks[ i ];
+        mask.fill( 0 );
+        for( uint32_t j = offsets[ b ]; j < offsets[ b + 1 ]; ++ j )
+          {
+            const uint32_t face = binned[ j ];
+            int64_t low[3], high[3];
+            get_voxel_range( face, low, high );
+            for( int d = 0; d < 3; ++ d )
+              {
+                low[d] = std::max( low[d], brick_low[d] ) - brick_low[d];
+                high[d] = std::min( high[d], brick_low[d] + bs - 1 ) - brick_low[d];
+              }
+            for( int64_t z = low[2]; z <= high[2]; ++ z )
+              for( int64_t y = low[1]; y <= high[1]; ++ y )
+                for( int64_t x = low[0]; x <= high[0]; ++ x )
+                  {
+                    const uint64_t bit = uint64_t(1) << ( y * 8 + x );
+                    if( mask[ z ] & bit )
+                      continue;
+                    const vec3 vmin = lower + vec3{ brick_low[0] + x, brick_low[1] + y, brick_low[2] + z } * result.voxel_size;
+                    if( triangles[ face ].intersect( aabox( vmin, vmin + vec3{ result.voxel_size, result.voxel_size, result.voxel_size } ) ) )
+                      mask[ z ] |= bit;
+                  }
+          }
+      }
+
+    if( mode == voxelization_mode::surface )
+      return;
+
+    // solid: bin triangles into tiles of 8x8 columns along x, according to
+    // the column centers covered by their projection
+    auto get_column_range = [&]( size_t face, int64_t* low, int64_t* high )
+      {
+        const uint32_t* f = indices + 3 * face;
+        for( int d = 1; d < 3; ++ d )
+          {
+            const real tmin = std::min( positions[ f[0] ][d], std::min( positions[ f[1] ][d], positions[ f[2] ][d] ) );
+            const real tmax = std::max( positions[ f[0] ][d], std::max( positions[ f[1] ][d], positions[ f[2] ][d] ) );
+            low[d] = std::max( int64_t( std::ceil( ( tmin - lower[d] ) * inv_size - real(0.5) ) ), int64_t(0) );
+            high[d] = std::min( int64_t( std::floor( ( tmax - lower[d] ) * inv_size - real(0.5) ) ), res[d] - 1 );
+          }
+        return low[1] <= high[1] && low[2] <= high[2];
+      };
+    bin_triangles( nfaces, bry * brz,
+      [&]( size_t face, auto&& emit )
+      {
+        int64_t low[3], high[3];
+        if( !valid[ face ] || !get_column_range( face, low, high ) )
+          return;
+        for( int64_t tz = low[2] / bs; tz <= high[2] / bs; ++ tz )
+          for( int64_t ty = low[1] / bs; ty <= high[1] / bs; ++ ty )
+            emit( size_t( tz ) * bry + size_t( ty ) );
+      }, offsets, binned );
+
+    const size_t ntiles = bry * brz;
+    const size_t row_size = brx;
+    # pragma omp parallel
+    {
+      std::vector< crossing > crossings;
+      std::vector< uint8_t > rows( bs * bs * row_size );
+      std::vector< std::pair< size_t, voxel_brick_map::brick > > new_bricks;
+
+      # ifdef _MSC_VER
+      GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+      #   pragma omp for schedule(dynamic)
+      for( long t = 0; t < long(ntiles); ++ t )
+      # else
+      #   pragma omp for schedule(dynamic)
+      for( size_t t = 0; t < ntiles; ++ t )
+      # endif
+        {
+          if( offsets[ t + 1 ] == offsets[ t ] )
+            continue;
+          const int64_t ty = int64_t( t % bry ), tz = int64_t( t / bry );
+
+          // crossings of the tile columns with triangles
+          crossings.clear();
+          for( uint32_t j = offsets[ t ]; j < offsets[ t + 1 ]; ++ j )
+            {
+              const uint32_t face = binned[ j ];
+              const uint32_t* f = indices + 3 * face;
+              vec2 p[3];
+              for( int k = 0; k < 3; ++ k )
+                p[k] = vec2{ positions[ f[k] ].y, positions[ f[k] ].z };
+              const real area = edge_function( p[0], p[1], p[2] );
+              if( area == real(0) )
+                continue;
+              // counter-clockwise order in the (y,z) plane
+              const int order[3] = { 0, area > 0 ? 1 : 2, area > 0 ? 2 : 1 };
+              const vec2 q[3] = { p[ order[0] ], p[ order[1] ], p[ order[2] ] };
+              const real x[3] = {
+                positions[ f[ order[0] ] ].x, positions[ f[ order[1] ] ].x, positions[ f[ order[2] ] ].x };
+              const bool top_left[3] = {
+                is_top_left( q[1], q[2] ), is_top_left( q[2], q[0] ), is_top_left( q[0], q[1] ) };
+
+              int64_t low[3], high[3];
+              get_column_range( face, low, high );
+              low[1] = std::max( low[1], ty * bs );
+              low[2] = std::max( low[2], tz * bs );
+              high[1] = std::min( high[1], ty * bs + bs - 1 );
+              high[2] = std::min( high[2], tz * bs + bs - 1 );
+              for( int64_t cz = low[2]; cz <= high[2]; ++ cz )
+                for( int64_t cy = low[1]; cy <= high[1]; ++ cy )
+                  {
+                    const vec2 c{ lower.y + ( real( cy ) + real(0.5) ) * result.voxel_size,
+                                  lower.z + ( real( cz ) + real(0.5) ) * result.voxel_size };
+                    const real w[3] = {
+                      edge_function( q[1], q[2], c ),
+                      edge_function( q[2], q[0], c ),
+                      edge_function( q[0], q[1], c ) };
+                    bool inside = true;
+                    for( int k = 0; k < 3 && inside; ++ k )
+                      inside = w[k] > 0 || ( w[k] == 0 && top_left[k] );
+                    if( !inside )
+                      continue;
+                    const real sum = w[0] + w[1] + w[2];
+                    crossing cr;
+                    cr.column = uint32_t( ( cz - tz * bs ) * bs + ( cy - ty * bs ) );
+                    // entering the solid along x when the face looks toward -x
+                    cr.sign = area > 0 ? -1 : 1;
+                    cr.x = ( w[0] * x[0] + w[1] * x[1] + w[2] * x[2] ) / sum;
+                    crossings.push_back( cr );
+                  }
+            }
+          std::sort( crossings.begin(), crossings.end() );
+
+          // fill the voxels whose center is inside
+          std::fill( rows.begin(), rows.end(), uint8_t(0) );
+          for( size_t begin = 0, end = 0; begin < crossings.size(); begin = end )
+            {
+              const uint32_t column = crossings[ begin ].column;
+              int32_t winding = 0;
+              for( end = begin; end < crossings.size() && crossings[ end ].column == column; ++ end )
+                {
+                  winding += crossings[ end ].sign;
+                  const bool inside = mode == voxelization_mode::parity ? ( ( end - begin ) & 1 ) == 0 : winding != 0;
+                  if( !inside || end + 1 == crossings.size() || crossings[ end + 1 ].column != column )
+                    continue;
+                  const int64_t first = int64_t( std::floor( ( crossings[ end ].x - lower.x ) * inv_size - real(0.5) ) ) + 1;
+                  const int64_t last = int64_t( std::floor( ( crossings[ end + 1 ].x - lower.x ) * inv_size - real(0.5) ) );
+                  set_bits( rows.data() + column * row_size, std::max( first, int64_t(0) ), std::min( last, res[0] - 1 ) );
+                }
+            }
+
+          // gather the rows into bricks
+          for( size_t bx = 0; bx < brx; ++ bx )
+            {
+              voxel_brick_map::brick mask;
+              bool empty = true, full = true;
+              for( uint32_t lz = 0; lz < bs; ++ lz )
+                {
+                  uint64_t word = 0;
+                  for( uint32_t ly = 0; ly < bs; ++ ly )
+                    word |= uint64_t( rows[ ( lz * bs + ly ) * row_size + bx ] ) << ( 8 * ly );
+                  mask[ lz ] = word;
+                  empty = empty && !word;
+                  full = full && word == ~uint64_t(0);
+                }
+              if( empty )
+                continue;
+              const size_t b = ( size_t( tz ) * bry + size_t( ty ) ) * brx + bx;
+              const uint32_t index = result.brick_indices[ b ];
+              if( index != voxel_brick_map::empty_brick )
+                {
+                  for( uint32_t lz = 0; lz < bs; ++ lz )
+                    result.bricks[ index ][ lz ] |= mask[ lz ];
+                }
+              else if( full )
+                result.brick_indices[ b ] = voxel_brick_map::full_brick;
+              else
+                new_bricks.push_back( std::make_pair( b, mask ) );
+            }
+        }
+
+      # pragma omp critical
+      {
+        for( auto& nb : new_bricks )
+          {
+            result.brick_indices[ nb.first ] = uint32_t( result.bricks.size() );
+            result.bricks.push_back( nb.second );
+          }
+      }
+    }
+  }
+
+  void
+  voxelize(
+      const indexed_mesh& m, uint32_t resolution, voxelization_mode mode,
+      voxel_grid& result )
+  {
+    voxel_brick_map bricks;
+    voxelize( m, resolution, mode, bricks );
+    bricks.to_dense( result );
+  }
+
+} END_GO_NAMESPACE
@@ -0,0 +1,217 @@
+# include "../graphics-origin/graphics_origin.h"
+# include "../graphics-origin/tools/memory.h"
+
+# include <algorithm>
+# include <chrono>
+# include <cstring>
+# include <iomanip>
+# include <iostream>
+# include <numeric>
+# include <random>
+# include <vector>
+
+# ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+# endif
+
+namespace graphics_origin {
+
+  namespace test {
+
+    static constexpr size_t buffer_size = size_t(512) << 20;
+    static constexpr size_t lookups = size_t(1) << 24;
+
+    typedef std::chrono::high_resolution_clock clock;
+
+    /**Count the data TLB misses of the calling thread, when the kernel
+     * lets us read the hardware counters. */
+    class tlb_miss_counter {
+    public:
+      tlb_miss_counter()
+        : descriptor{ -1 }
+      {
+# ifdef __linux__
+        perf_event_attr attributes;
+        std::memset( &attributes, 0, sizeof(attributes) );
+        attributes.type = PERF_TYPE_HW_CACHE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CACHE_DTLB
+            | ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+            | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        descriptor = int( syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+# endif
+      }
+
+      ~tlb_miss_counter()
+      {
+# ifdef __linux__
+        if( descriptor >= 0 )
+          close( descriptor );
+# endif
+      }
+
+      void start()
+      {
+# ifdef __linux__
+        if( descriptor >= 0 )
+          {
+            ioctl( descriptor, PERF_EVENT_IOC_RESET, 0 );
+            ioctl( descriptor, PERF_EVENT_IOC_ENABLE, 0 );
+          }
+# endif
+      }
+
+      /**@return The number of misses since start(), or -1 if unavailable. */
+      long long stop()
+      {
+        long long count = -1;
+# ifdef __linux__
+        if( descriptor >= 0 )
+          {
+            ioctl( descriptor, PERF_EVENT_IOC_DISABLE, 0 );
+            if( read( descriptor, &count, sizeof(count) ) != sizeof(count) )
+              count = -1;
+          }
+# endif
+        return count;
+      }
+
+    private:
+      int descriptor;
+    };
+
+    struct bvh_node {
+      float bounds[6];
+      uint32_t children[2];
+    };
+
+    struct result {
+      double seconds;
+      long long tlb_misses;
+    };
+
+    /**Visit random nodes of a BVH, one after the other as in a traversal:
+     * the next node depends on the current one, so the latency of each
+     * access, including its TLB miss, cannot be hidden. */
+    static result traverse_bvh( bvh_node* nodes, size_t nnodes, tlb_miss_counter& counter )
+    {
+      std::mt19937 generator( 5 );
+      std::vector< uint32_t > order( nnodes );
+      std::iota( order.begin(), order.end(), 0 );
+      std::shuffle( order.begin(), order.end(), generator );
+      for( size_t i = 0; i < nnodes; ++ i )
+        {
+          auto& node = nodes[ order[ i ] ];
+          std::fill( node.bounds, node.bounds + 6, float( i ) );
+          node.children[0] = order[ ( i + 1 ) % nnodes ];
+          node.children[1] = order[ ( i + 2 ) % nnodes ];
+        }
+
+      counter.start();
+      const auto start = clock::now();
+      uint32_t current = order[0];
+      float sum = 0;
+      for( size_t i = 0; i < lookups; ++ i )
+        {
+          const bvh_node& node = nodes[ current ];
+          sum += node.bounds[ i % 6 ];
+          current = node.children[ i & 1 ];
+        }
+      const auto end = clock::now();
+      result r{ std::chrono::duration< double >( end - start ).count(), counter.stop() };
+      if( sum == 42.0f )
+        std::cout << "";
+      return r;
+    }
+
+    /**Gather the vertices of a mesh through a random index buffer. */
+    static result gather_vertices( float* positions, size_t nvertices, tlb_miss_counter& counter )
+    {
+      std::mt19937 generator( 11 );
+      std::vector< uint32_t > indices( lookups );
+      for( auto& index : indices )
+        index = uint32_t( generator() % nvertices );
+      for( size_t i = 0; i < nvertices * 3; ++ i )
+        positions[ i ] = float( i );
+
+      counter.start();
+      const auto start = clock::now();
+      float sum = 0;
+      for( auto index : indices )
+        sum += positions[ 3 * index ] + positions[ 3 * index + 1 ] + positions[ 3 * index + 2 ];
+      const auto end = clock::now();
+      result r{ std::chrono::duration< double >( end - start ).count(), counter.stop() };
+      if( sum == 42.0f )
+        std::cout << "";
+      return r;
+    }
+
+    template< class function >
+    static result run( tools::virtual_memory::page_kind kind, function f )
+    {
+      char* start = static_cast< char* >( tools::virtual_memory::allocate_address_space( buffer_size, kind ) );
+      if( !start || !tools::virtual_memory::commit_memory( start, buffer_size ) )
+        {
+          std::cout << "cannot get " << buffer_size << " bytes" << std::endl;
+          return result{ 0, -1 };
+        }
+      result r = f( start );
+      tools::virtual_memory::free_address_space( start, buffer_size, kind );
+      return r;
+    }
+
+    static void print( const char* name, const result& normal, const result& huge )
+    {
+      std::cout << std::setw( 20 ) << name << std::fixed << std::setprecision( 1 )
+                << std::setw( 14 ) << normal.seconds * 1e9 / double( lookups )
+                << std::setw( 14 ) << huge.seconds * 1e9 / double( lookups );
+      if( normal.tlb_misses >= 0 && huge.tlb_misses >= 0 )
+        std::cout << std::setw( 16 ) << normal.tlb_misses
+                  << std::setw( 16 ) << huge.tlb_misses;
+      else
+        std::cout << std::setw( 16 ) << "n/a" << std::setw( 16 ) << "n/a";
+      std::cout << std::endl;
+    }
+
+    static int execute( int argc, char* argv[] )
+    {
+      (void)argc;
+      (void)argv;
+
+      std::cout << "page size      = " << tools::virtual_memory::get_page_size() << "\n"
+                << "huge page size = " << tools::virtual_memory::get_huge_page_size() << "\n"
+                << "buffer size    = " << ( buffer_size >> 20 ) << " MB, "
+                << lookups << " dependent or random accesses\n\n";
+
+      tlb_miss_counter counter;
+      const auto bvh = [&]( char* memory ){
+        return traverse_bvh( reinterpret_cast< bvh_node* >( memory ), buffer_size / sizeof(bvh_node), counter ); };
+      const auto mesh = [&]( char* memory ){
+        return gather_vertices( reinterpret_cast< float* >( memory ), buffer_size / ( 3 * sizeof(float) ), counter ); };
+
+      const result bvh_normal = run( tools::virtual_memory::page_kind::normal, bvh );
+      const result bvh_huge = run( tools::virtual_memory::page_kind::transparent_huge, bvh );
+      const result mesh_normal = run( tools::virtual_memory::page_kind::normal, mesh );
+      const result mesh_huge = run( tools::virtual_memory::page_kind::transparent_huge, mesh );
+
+      std::cout << std::setw( 20 ) << "access"
+                << std::setw( 14 ) << "ns (4kB)"
+                << std::setw( 14 ) << "ns (huge)"
+                << std::setw( 16 ) << "dTLB (4kB)"
+                << std::setw( 16 ) << "dTLB (huge)" << std::endl;
+      print( "BVH traversal", bvh_normal, bvh_huge );
+      print( "vertex gather", mesh_normal, mesh_huge );
+      return 0;
+    }
+  }
+}
+
+
+int main( int argc, char* argv[] )
+{
+  return graphics_origin::test::execute( argc, argv );
+}
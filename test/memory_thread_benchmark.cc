@@ -0,0 +1,132 @@
+# include "../graphics-origin/graphics_origin.h"
+# include "../graphics-origin/tools/memory.h"
+
+# include <omp.h>
+# include <chrono>
+# include <cstdlib>
+# include <iomanip>
+# include <iostream>
+# include <vector>
+
+namespace graphics_origin {
+
+  namespace test {
+
+    static constexpr int rounds = 20;
+    static constexpr int allocations_per_thread = 20000;
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    typedef std::chrono::high_resolution_clock clock;
+
+    /**Size of an allocation, between 8 and 256 bytes. */
+    static inline size_t get_size( int i )
+    {
+      return 8 + ( ( uint32_t( i ) * 2654435761u ) >> 24 );
+    }
+
+    /**Measure the mean time of a round of allocations, in milliseconds. Each
+     * thread makes its allocations, writes into them, then frees them. */
+    template< class allocate_function, class deallocate_function, class reset_function >
+    static double measure( int threads, allocate_function allocate, deallocate_function deallocate, reset_function reset )
+    {
+      std::vector< std::vector< char* > > allocations( threads, std::vector< char* >( allocations_per_thread ) );
+      double total = 0;
+      for( int round = 0; round < rounds; ++ round )
+        {
+          const auto start = clock::now();
+          # pragma omp parallel num_threads(threads)
+          {
+            std::vector< char* >& thread_allocations = allocations[ omp_get_thread_num() ];
+            for( int i = 0; i < allocations_per_thread; ++ i )
+              {
+                thread_allocations[ i ] = allocate( get_size( i ) );
+                thread_allocations[ i ][ 0 ] = char( i );
+              }
+            for( int i = allocations_per_thread - 1; i >= 0; -- i )
+              deallocate( thread_allocations[ i ] );
+          }
+          reset();
+          total += std::chrono::duration< double, std::milli >( clock::now() - start ).count();
+        }
+      return total / rounds;
+    }
+
+    template< class thread_policy >
+    static double measure_locked_arena( int threads )
+    {
+      tools::memory_area::on_heap area( size_t( threads ) * allocations_per_thread * 512 );
+      tools::allocation_policy::linear allocator( area );
+      tools::memory_arena<
+        tools::allocation_policy::linear,
+        thread_policy,
+        tools::bounds_checking_policy::no,
+        tools::memory_tracking_policy::no,
+        tools::memory_tagging_policy::no > arena( &allocator );
+      return measure( threads,
+        [&]( size_t size ){ return static_cast< char* >( arena.allocate( size, 8, nullptr, nullptr, nullptr ) ); },
+        [&]( char* ptr ){ arena.deallocate( ptr ); },
+        [&](){ allocator.reset(); } );
+    }
+
+    static double measure_thread_cache( int threads )
+    {
+      typedef tools::memory_arena<
+        tools::allocation_policy::linear,
+        tools::thread_policy::mutex,
+        tools::bounds_checking_policy::no,
+        tools::memory_tracking_policy::no,
+        tools::memory_tagging_policy::no > parent_arena;
+      tools::memory_area::on_heap area( size_t( threads ) * allocations_per_thread * 512 );
+      tools::allocation_policy::linear allocator( area );
+      parent_arena parent( &allocator );
+      tools::allocation_policy::thread_cache< parent_arena > cache( parent, chunk_size, 64 );
+      tools::memory_arena<
+        tools::allocation_policy::thread_cache< parent_arena >,
+        tools::thread_policy::single_thread,
+        tools::bounds_checking_policy::no,
+        tools::memory_tracking_policy::no,
+        tools::memory_tagging_policy::no > arena( &cache );
+      return measure( threads,
+        [&]( size_t size ){ return static_cast< char* >( arena.allocate( size, 8, nullptr, nullptr, nullptr ) ); },
+        [&]( char* ptr ){ arena.deallocate( ptr ); },
+        [&](){ cache.reset(); } );
+    }
+
+    static double measure_malloc( int threads )
+    {
+      return measure( threads,
+        []( size_t size ){ return static_cast< char* >( std::malloc( size ) ); },
+        []( char* ptr ){ std::free( ptr ); },
+        [](){} );
+    }
+
+    static int execute( int argc, char* argv[] )
+    {
+      (void)argc;
+      (void)argv;
+
+      std::cout << allocations_per_thread << " allocations and deallocations per thread, "
+                << "mean time of " << rounds << " rounds in ms\n"
+                << std::setw( 8 ) << "threads"
+                << std::setw( 12 ) << "malloc"
+                << std::setw( 12 ) << "mutex"
+                << std::setw( 12 ) << "spinlock"
+                << std::setw( 12 ) << "cache" << std::endl;
+      for( int threads = 1; threads <= 64; threads <<= 1 )
+        {
+          std::cout << std::setw( 8 ) << threads << std::fixed << std::setprecision( 3 )
+                    << std::setw( 12 ) << measure_malloc( threads )
+                    << std::setw( 12 ) << measure_locked_arena< tools::thread_policy::mutex >( threads )
+                    << std::setw( 12 ) << measure_locked_arena< tools::thread_policy::spinlock >( threads )
+                    << std::setw( 12 ) << measure_thread_cache( threads ) << std::endl;
+        }
+      return 0;
+    }
+  }
+}
+
+
+int main( int argc, char* argv[] )
+{
+  return graphics_origin::test::execute( argc, argv );
+}
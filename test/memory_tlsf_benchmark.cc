@@ -0,0 +1,151 @@
+# include "../graphics-origin/graphics_origin.h"
+# include "../graphics-origin/tools/memory.h"
+
+# include <algorithm>
+# include <chrono>
+# include <cmath>
+# include <cstdlib>
+# include <iomanip>
+# include <iostream>
+# include <random>
+# include <vector>
+
+namespace graphics_origin {
+
+  namespace test {
+
+    static constexpr int operations = 1000000;
+    static constexpr size_t max_live_allocations = 4096;
+    static constexpr size_t area_size = size_t(512) << 20;
+
+    typedef std::chrono::high_resolution_clock clock;
+
+    struct latencies {
+      latencies()
+        : allocations{}, deallocations{}
+      {}
+      std::vector< double > allocations;
+      std::vector< double > deallocations;
+    };
+
+    /**Replay the same sequence of allocations and deallocations of random
+     * sizes, with random lifetimes, and measure the latency of each
+     * operation, in nanoseconds. The sizes follow a log-uniform distribution
+     * between 16 bytes and 64 kB, as do the attributes buffers of meshes. */
+    template< class allocate_function, class deallocate_function, class sample_function >
+    static latencies measure( allocate_function allocate, deallocate_function deallocate, sample_function sample )
+    {
+      std::mt19937_64 generator( 7 );
+      std::uniform_real_distribution< double > log_size( std::log( 16.0 ), std::log( 65536.0 ) );
+      std::vector< char* > live;
+      live.reserve( max_live_allocations );
+      latencies result;
+      result.allocations.reserve( operations );
+      result.deallocations.reserve( operations );
+
+      for( int i = 0; i < operations; ++ i )
+        {
+          if( live.size() < max_live_allocations && ( live.empty() || generator() % 2 ) )
+            {
+              const size_t size = size_t( std::exp( log_size( generator ) ) );
+              const auto start = clock::now();
+              char* ptr = allocate( size );
+              const auto end = clock::now();
+              if( !ptr )
+                {
+                  std::cout << "allocation of " << size << " bytes failed" << std::endl;
+                  break;
+                }
+              ptr[0] = char( i );
+              result.allocations.push_back( std::chrono::duration< double, std::nano >( end - start ).count() );
+              live.push_back( ptr );
+            }
+          else
+            {
+              const size_t index = generator() % live.size();
+              const auto start = clock::now();
+              deallocate( live[ index ] );
+              const auto end = clock::now();
+              result.deallocations.push_back( std::chrono::duration< double, std::nano >( end - start ).count() );
+              live[ index ] = live.back();
+              live.pop_back();
+            }
+          if( i % ( operations / 10 ) == 0 )
+            sample( i );
+        }
+      for( auto ptr : live )
+        deallocate( ptr );
+      return result;
+    }
+
+    static void print( const char* name, std::vector< double >& values )
+    {
+      std::sort( values.begin(), values.end() );
+      double mean = 0;
+      for( auto v : values )
+        mean += v;
+      mean /= double( values.size() );
+      std::cout << std::setw( 20 ) << name << std::fixed << std::setprecision( 1 )
+                << std::setw( 12 ) << mean
+                << std::setw( 12 ) << values[ values.size() / 2 ]
+                << std::setw( 12 ) << values[ size_t( double( values.size() ) * 0.999 ) ]
+                << std::setw( 12 ) << values.back() << std::endl;
+    }
+
+    static int execute( int argc, char* argv[] )
+    {
+      (void)argc;
+      (void)argv;
+
+      tools::memory_area::on_heap area( area_size );
+      tools::allocation_policy::tlsf allocator( area );
+      tools::memory_arena<
+        tools::allocation_policy::tlsf,
+        tools::thread_policy::single_thread,
+        tools::bounds_checking_policy::no,
+        tools::memory_tracking_policy::no,
+        tools::memory_tagging_policy::no > arena( &allocator );
+
+      std::cout << "fragmentation of the TLSF allocator\n"
+                << std::setw( 12 ) << "operation"
+                << std::setw( 16 ) << "used (kB)"
+                << std::setw( 16 ) << "free blocks"
+                << std::setw( 20 ) << "largest free (kB)"
+                << std::setw( 16 ) << "fragmentation" << std::endl;
+      latencies tlsf_latencies = measure(
+        [&]( size_t size ){ return static_cast< char* >( arena.allocate( size, 16, nullptr, nullptr, nullptr ) ); },
+        [&]( char* ptr ){ arena.deallocate( ptr ); },
+        [&]( int i )
+        {
+          std::cout << std::setw( 12 ) << i
+                    << std::setw( 16 ) << ( allocator.get_managed_memory() - allocator.get_free_memory() ) / 1024
+                    << std::setw( 16 ) << allocator.get_number_of_free_blocks()
+                    << std::setw( 20 ) << allocator.get_largest_free_block() / 1024
+                    << std::setw( 16 ) << std::setprecision( 6 ) << allocator.get_fragmentation() << std::endl;
+        });
+
+      latencies malloc_latencies = measure(
+        []( size_t size ){ return static_cast< char* >( std::malloc( size ) ); },
+        []( char* ptr ){ std::free( ptr ); },
+        []( int ){} );
+
+      std::cout << "\nlatencies in ns\n"
+                << std::setw( 20 ) << "operation"
+                << std::setw( 12 ) << "mean"
+                << std::setw( 12 ) << "median"
+                << std::setw( 12 ) << "99.9%"
+                << std::setw( 12 ) << "max" << std::endl;
+      print( "tlsf allocate", tlsf_latencies.allocations );
+      print( "tlsf deallocate", tlsf_latencies.deallocations );
+      print( "malloc", malloc_latencies.allocations );
+      print( "free", malloc_latencies.deallocations );
+      return 0;
+    }
+  }
+}
+
+
+int main( int argc, char* argv[] )
+{
+  return graphics_origin::test::execute( argc, argv );
+}
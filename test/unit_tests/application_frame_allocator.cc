@@ -0,0 +1,99 @@
+# include "common.h"
+# include "../../graphics-origin/application/frame_allocator.h"
+namespace graphics_origin {
+  namespace application {
+    namespace test {
+
+      static void frame_allocator_memory_lives_two_frames()
+      {
+        frame_allocator allocator( 1 << 12 );
+        frame_vector< uint32_t > first( 100, allocator );
+        for( uint32_t i = 0; i < 100; ++ i )
+          first[ i ] = i;
+
+        // the memory of a frame is still valid during the next one
+        allocator.next_frame();
+        frame_vector< uint32_t > second( 100, 7, allocator );
+        for( uint32_t i = 0; i < 100; ++ i )
+          BOOST_REQUIRE_EQUAL( first[ i ], i );
+
+        // the arena of the first frame is reused two frames later
+        allocator.next_frame();
+        frame_vector< uint32_t > third( 100, allocator );
+        BOOST_REQUIRE_EQUAL( third.data(), first.data() );
+        BOOST_REQUIRE( second.data() != first.data() );
+      }
+
+      static void frame_allocator_statistics()
+      {
+        frame_allocator allocator( 1 << 12 );
+        for( int i = 0; i < 10; ++ i )
+          allocator.allocate( 64, 16, nullptr, nullptr, nullptr );
+        const auto& current = allocator.get_current_frame_statistics();
+        BOOST_REQUIRE_EQUAL( current.frame, 0u );
+        BOOST_REQUIRE_EQUAL( current.number_of_allocations, 10u );
+        BOOST_REQUIRE_EQUAL( current.number_of_overflows, 0u );
+        BOOST_REQUIRE_GE( current.used_bytes, 640u );
+        BOOST_REQUIRE_EQUAL( current.capacity, 1u << 12 );
+
+        const size_t used = current.used_bytes;
+        allocator.next_frame();
+        BOOST_REQUIRE_EQUAL( allocator.get_last_frame_statistics().frame, 0u );
+        BOOST_REQUIRE_EQUAL( allocator.get_last_frame_statistics().used_bytes, used );
+        BOOST_REQUIRE_EQUAL( allocator.get_current_frame_statistics().frame, 1u );
+        BOOST_REQUIRE_EQUAL( allocator.get_current_frame_statistics().number_of_allocations, 0u );
+        BOOST_REQUIRE_EQUAL( allocator.get_peak_usage(), used );
+      }
+
+      static void frame_allocator_grows_after_overflow()
+      {
+        frame_allocator allocator( 1 << 10 );
+        for( int frame = 0; frame < 4; ++ frame )
+          {
+            frame_vector< double > values( allocator );
+            for( int i = 0; i < 1000; ++ i )
+              values.push_back( double( i ) );
+            BOOST_REQUIRE_EQUAL( values[ 999 ], 999.0 );
+            if( frame < 2 )
+              BOOST_REQUIRE_GT( allocator.get_current_frame_statistics().number_of_overflows, 0u );
+            else
+              {
+                // both arenas have been enlarged: no more heap allocations
+                BOOST_REQUIRE_EQUAL( allocator.get_current_frame_statistics().number_of_overflows, 0u );
+                BOOST_REQUIRE_GT( allocator.get_current_frame_statistics().capacity, 1u << 10 );
+              }
+            allocator.next_frame();
+          }
+      }
+
+      static void frame_allocator_shrinks_after_quiet_frames()
+      {
+        frame_allocator allocator( 1 << 10 );
+        for( int frame = 0; frame < 2; ++ frame )
+          {
+            frame_vector< double > values( allocator );
+            for( int i = 0; i < 1000; ++ i )
+              values.push_back( double( i ) );
+            allocator.next_frame();
+          }
+        BOOST_REQUIRE_GT( allocator.get_current_frame_statistics().capacity, 1u << 10 );
+
+        const size_t quiet_frames = frame_allocator::quiet_frames_before_shrinking;
+        for( size_t frame = 0; frame < quiet_frames + 2; ++ frame )
+          allocator.next_frame();
+        BOOST_REQUIRE_EQUAL( allocator.get_current_frame_statistics().capacity, 1u << 10 );
+      }
+
+      test_suite* frame_allocator_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("frame allocator");
+        ADD_TEST_CASE( frame_allocator_memory_lives_two_frames );
+        ADD_TEST_CASE( frame_allocator_statistics );
+        ADD_TEST_CASE( frame_allocator_grows_after_overflow );
+        ADD_TEST_CASE( frame_allocator_shrinks_after_quiet_frames );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -4,9 +4,12 @@ namespace graphics_origin {
   namespace application {
     namespace test {
 
+      extern test_suite* frame_allocator_test_suite();
+
       void add_test_suite()
       {
         test_suite* suite = BOOST_TEST_SUITE("APPLICATION LIBRARY");
+        ADD_TO_SUITE( frame_allocator_test_suite );
         ADD_TO_MASTER( suite );
       }
 
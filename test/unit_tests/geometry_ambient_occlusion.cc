@@ -0,0 +1,141 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/ambient_occlusion.h"
+# include "../../graphics-origin/geometry/mesh.h"
+# include <omp.h>
+# include <algorithm>
+# include <cmath>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      /**Build a square in the plane z = 0, facing +z. */
+      static void make_square( indexed_mesh& m, real half_side )
+      {
+        m.vertices = {
+          vec3{ -half_side, -half_side, 0 }, vec3{ half_side, -half_side, 0 },
+          vec3{ -half_side,  half_side, 0 }, vec3{ half_side,  half_side, 0 } };
+        m.indices = { 0, 1, 2,  1, 3, 2 };
+      }
+
+      static void unoccluded_plane_bakes_to_zero()
+      {
+        indexed_mesh square;
+        make_square( square, 1 );
+        mesh m;
+        square.to_mesh( m );
+        const mesh_spatial_optimization optimization( m, false, true );
+
+        const std::vector< vec3 > points = { vec3{ 0, 0, 0 }, vec3{ 0.5, -0.25, 0 }, vec3{ -0.9, 0.9, 0 } };
+        const std::vector< vec3 > normals( points.size(), vec3{ 0, 0, 1 } );
+        std::vector< real > occlusion( points.size() );
+        std::vector< vec3 > bent_normals( points.size() );
+        std::vector< uint32_t > nrays( points.size() );
+        const ambient_occlusion_parameters parameters;
+        bake_ambient_occlusion( optimization, points.data(), normals.data(), points.size(), parameters,
+            occlusion.data(), bent_normals.data(), nrays.data() );
+        for( size_t i = 0; i < points.size(); ++ i )
+          {
+            BOOST_REQUIRE_EQUAL( occlusion[ i ], 0 );
+            // a point without variance stops after the first round
+            BOOST_REQUIRE_EQUAL( nrays[ i ], parameters.min_rays );
+            BOOST_REQUIRE_GT( dot( bent_normals[ i ], normals[ i ] ), 0.9 );
+          }
+      }
+
+      static void inside_of_a_box_bakes_to_one()
+      {
+        // the faces of the box are flipped to face its inside
+        indexed_mesh box;
+        make_box( box, vec3{ 0, 0, 0 }, vec3{ 1, 1, 1 } );
+        for( size_t f = 0; f < box.get_number_of_faces(); ++ f )
+          std::swap( box.indices[ 3 * f + 1 ], box.indices[ 3 * f + 2 ] );
+        mesh m;
+        box.to_mesh( m );
+        const mesh_spatial_optimization optimization( m, false, true );
+
+        const std::vector< vec3 > points = {
+          vec3{ 0.5, 0.5, 0 }, vec3{ 0.5, 0.5, 1 }, vec3{ 0.5, 0, 0.5 },
+          vec3{ 0.5, 1, 0.5 }, vec3{ 0, 0.5, 0.5 }, vec3{ 1, 0.5, 0.5 } };
+        const std::vector< vec3 > normals = {
+          vec3{ 0, 0, 1 }, vec3{ 0, 0, -1 }, vec3{ 0, 1, 0 },
+          vec3{ 0, -1, 0 }, vec3{ 1, 0, 0 }, vec3{ -1, 0, 0 } };
+        std::vector< real > occlusion( points.size() );
+        std::vector< vec3 > bent_normals( points.size() );
+        bake_ambient_occlusion( optimization, points.data(), normals.data(), points.size(), ambient_occlusion_parameters{},
+            occlusion.data(), bent_normals.data() );
+        for( size_t i = 0; i < points.size(); ++ i )
+          {
+            BOOST_REQUIRE_EQUAL( occlusion[ i ], 1 );
+            BOOST_REQUIRE( bent_normals[ i ] == normals[ i ] );
+          }
+      }
+
+      static void ambient_occlusion_only_depends_on_the_seed()
+      {
+        // a box on a square: points of the square around the box are in penumbra
+        indexed_mesh scene, box;
+        make_square( scene, 2 );
+        make_box( box, vec3{ -0.5, -0.5, 0 }, vec3{ 0.5, 0.5, 1 } );
+        const uint32_t offset = uint32_t( scene.vertices.size() );
+        scene.vertices.insert( scene.vertices.end(), box.vertices.begin(), box.vertices.end() );
+        for( auto i : box.indices )
+          scene.indices.push_back( i + offset );
+        mesh m;
+        scene.to_mesh( m );
+        const mesh_spatial_optimization optimization( m, false, true );
+
+        std::vector< vec3 > points;
+        for( int i = 0; i < 40; ++ i )
+          for( int j = 0; j < 40; ++ j )
+            {
+              const vec3 p{ real( i ) / 10 - real(1.95), real( j ) / 10 - real(1.95), 0 };
+              if( std::max( std::abs( p.x ), std::abs( p.y ) ) > real(0.5) )
+                points.push_back( p );
+            }
+        const std::vector< vec3 > normals( points.size(), vec3{ 0, 0, 1 } );
+        ambient_occlusion_parameters parameters;
+        parameters.seed = 17;
+        const int nthreads = omp_get_max_threads();
+        const int thread_counts[3] = { 1, std::max( nthreads, 4 ), std::max( nthreads, 4 ) };
+
+        std::vector< real > occlusion[3];
+        std::vector< vec3 > bent_normals[3];
+        std::vector< uint32_t > nrays[3];
+        for( int run = 0; run < 3; ++ run )
+          {
+            omp_set_num_threads( thread_counts[ run ] );
+            occlusion[ run ].resize( points.size() );
+            bent_normals[ run ].resize( points.size() );
+            nrays[ run ].resize( points.size() );
+            bake_ambient_occlusion( optimization, points.data(), normals.data(), points.size(), parameters,
+                occlusion[ run ].data(), bent_normals[ run ].data(), nrays[ run ].data() );
+          }
+        omp_set_num_threads( nthreads );
+
+        for( int run = 1; run < 3; ++ run )
+          {
+            BOOST_REQUIRE( occlusion[ run ] == occlusion[0] );
+            BOOST_REQUIRE( bent_normals[ run ] == bent_normals[0] );
+            BOOST_REQUIRE( nrays[ run ] == nrays[0] );
+          }
+
+        // the points next to the box are partially occluded and cast more rays
+        const auto partial = std::count_if( occlusion[0].begin(), occlusion[0].end(), []( real o ) { return o > 0 && o < 1; } );
+        BOOST_REQUIRE_GT( partial, 0 );
+        BOOST_REQUIRE_GT( *std::max_element( nrays[0].begin(), nrays[0].end() ), parameters.min_rays );
+      }
+
+      test_suite* ambient_occlusion_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("ambient occlusion");
+        ADD_TEST_CASE( unoccluded_plane_bakes_to_zero );
+        ADD_TEST_CASE( inside_of_a_box_bakes_to_one );
+        ADD_TEST_CASE( ambient_occlusion_only_depends_on_the_seed );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,90 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/mesh_distance.h"
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static void distance_between_identical_meshes_is_null()
+      {
+        indexed_mesh first, second;
+        make_sphere( first, 48, 24 );
+        make_sphere( second, 48, 24 );
+        mesh_distance result;
+        compute_distance( first, second, distance_parameters{}, result );
+        BOOST_REQUIRE_SMALL( result.get_hausdorff(), 1e-12 );
+        BOOST_REQUIRE_SMALL( result.forward.mean, 1e-12 );
+        BOOST_REQUIRE_SMALL( result.forward.rms, 1e-12 );
+        BOOST_REQUIRE_SMALL( result.backward.mean, 1e-12 );
+        BOOST_REQUIRE_GT( result.forward.number_of_samples, first.get_number_of_vertices() );
+      }
+
+      static void distance_between_offset_spheres()
+      {
+        // the inner sphere is at 0.1 of the outer one, while the farthest
+        // point of a translated sphere is at the translation length
+        indexed_mesh inner, outer, translated;
+        make_sphere( inner, 48, 24, 1 );
+        make_sphere( outer, 48, 24, 1.1 );
+        make_sphere( translated, 48, 24, 1, vec3{ 0.25, 0, 0 } );
+
+        mesh_distance result;
+        compute_distance( inner, outer, distance_parameters{}, result );
+        BOOST_REQUIRE_CLOSE( result.forward.hausdorff, 0.1, 2 );
+        BOOST_REQUIRE_CLOSE( result.backward.hausdorff, 0.1, 2 );
+        BOOST_REQUIRE_LE( result.forward.mean, result.forward.rms );
+        BOOST_REQUIRE_LE( result.forward.rms, result.forward.hausdorff );
+
+        compute_distance( inner, translated, distance_parameters{}, result );
+        BOOST_REQUIRE_CLOSE( result.get_hausdorff(), 0.25, 2 );
+        BOOST_REQUIRE_CLOSE( length( result.forward.source_location - result.forward.target_location ), result.forward.hausdorff, 1e-6 );
+      }
+
+      static void distance_to_an_empty_mesh()
+      {
+        indexed_mesh sphere, empty;
+        make_sphere( sphere, 16, 8 );
+        one_sided_distance result;
+        result.number_of_samples = 1;
+        compute_one_sided_distance( sphere, empty, distance_parameters{}, result );
+        BOOST_REQUIRE_EQUAL( result.number_of_samples, 0u );
+        BOOST_REQUIRE_EQUAL( result.hausdorff, 0.0 );
+      }
+
+      static void distance_to_a_single_triangle()
+      {
+        // the source is the target triangle lifted, with an isolated vertex far away
+        indexed_mesh source, target;
+        target.vertices = { vec3{ 0, 0, 0 }, vec3{ 1, 0, 0 }, vec3{ 0, 1, 0 } };
+        target.indices = { 0, 1, 2 };
+        source.vertices = { vec3{ 0, 0, 0.5 }, vec3{ 1, 0, 0.5 }, vec3{ 0, 1, 0.5 }, vec3{ 0, 0, 100 } };
+        source.indices = { 0, 1, 2 };
+
+        one_sided_distance result;
+        compute_one_sided_distance( source, target, distance_parameters{}, result );
+        BOOST_REQUIRE_CLOSE( result.hausdorff, 0.5, 1e-9 );
+        BOOST_REQUIRE_CLOSE( result.mean, 0.5, 1e-9 );
+        BOOST_REQUIRE_CLOSE( result.rms, 0.5, 1e-9 );
+        BOOST_REQUIRE_CLOSE( result.target_location.z, 0.0, 1e-9 );
+
+        // without samples in faces, the mean is computed on referenced vertices
+        distance_parameters parameters;
+        parameters.number_of_samples = 0;
+        compute_one_sided_distance( source, target, parameters, result );
+        BOOST_REQUIRE_CLOSE( result.mean, 0.5, 1e-9 );
+        BOOST_REQUIRE_EQUAL( result.number_of_samples, 3u );
+      }
+
+      test_suite* distance_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("distance");
+        ADD_TEST_CASE( distance_between_identical_meshes_is_null );
+        ADD_TEST_CASE( distance_between_offset_spheres );
+        ADD_TEST_CASE( distance_to_an_empty_mesh );
+        ADD_TEST_CASE( distance_to_a_single_triangle );
+        return suite;
+      }
+
+    }
+  }
+}
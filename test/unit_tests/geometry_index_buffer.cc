@@ -0,0 +1,74 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/index_buffer_optimization.h"
+# include <algorithm>
+# include <array>
+# include <random>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static std::vector< std::array< uint32_t, 3 > > sorted_triangles( const std::vector< uint32_t >& indices )
+      {
+        std::vector< std::array< uint32_t, 3 > > triangles( indices.size() / 3 );
+        for( size_t i = 0; i < triangles.size(); ++ i )
+          triangles[ i ] = { indices[ 3 * i ], indices[ 3 * i + 1 ], indices[ 3 * i + 2 ] };
+        std::sort( triangles.begin(), triangles.end() );
+        return triangles;
+      }
+
+      static void index_buffer_vertex_cache_output_is_a_permutation()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 64, 32 );
+        std::vector< std::array< uint32_t, 3 > > triangles( sphere.get_number_of_faces() );
+        for( size_t i = 0; i < triangles.size(); ++ i )
+          triangles[ i ] = { sphere.indices[ 3 * i ], sphere.indices[ 3 * i + 1 ], sphere.indices[ 3 * i + 2 ] };
+        std::mt19937 generator( 3 );
+        std::shuffle( triangles.begin(), triangles.end(), generator );
+        std::vector< uint32_t > indices;
+        for( const auto& t : triangles )
+          indices.insert( indices.end(), t.begin(), t.end() );
+
+        std::vector< uint32_t > optimized( indices.size(), indexed_mesh::vertex_index(-1) );
+        std::vector< uint32_t > clusters( triangles.size() );
+        const size_t nclusters = optimize_vertex_cache(
+            optimized.data(), indices.data(), indices.size(), sphere.get_number_of_vertices(), 16, clusters.data() );
+        BOOST_REQUIRE( sorted_triangles( optimized ) == sorted_triangles( indices ) );
+        BOOST_REQUIRE_GT( nclusters, 0u );
+        BOOST_REQUIRE_LE( nclusters, triangles.size() );
+        clusters.resize( nclusters );
+
+        BOOST_REQUIRE( !clusters.empty() );
+        BOOST_REQUIRE_EQUAL( clusters.front(), 0u );
+        BOOST_REQUIRE( std::is_sorted( clusters.begin(), clusters.end() ) );
+        BOOST_REQUIRE_LT( clusters.back(), triangles.size() );
+
+        const auto before = analyze_vertex_cache( indices.data(), indices.size(), sphere.get_number_of_vertices() );
+        const auto after = analyze_vertex_cache( optimized.data(), optimized.size(), sphere.get_number_of_vertices() );
+        BOOST_REQUIRE_LT( after.acmr, before.acmr );
+        BOOST_REQUIRE_LT( after.acmr, 1.0 );
+      }
+
+      static void index_buffer_vertex_cache_keeps_degenerate_triangles()
+      {
+        // the degenerate triangle is only reachable through vertex 0, which
+        // is not the first vertex of the index buffer
+        const std::vector< uint32_t > indices = { 1, 2, 3, 0, 0, 0, 3, 2, 4 };
+        std::vector< uint32_t > optimized( indices.size(), indexed_mesh::vertex_index(-1) );
+        optimize_vertex_cache( optimized.data(), indices.data(), indices.size(), 5 );
+        BOOST_REQUIRE( sorted_triangles( optimized ) == sorted_triangles( indices ) );
+      }
+
+      test_suite* index_buffer_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("index buffer");
+        ADD_TEST_CASE( index_buffer_vertex_cache_output_is_a_permutation );
+        ADD_TEST_CASE( index_buffer_vertex_cache_keeps_degenerate_triangles );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,104 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/mesh_intersection.h"
+# include "../../graphics-origin/geometry/triangle.h"
+# include <cmath>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static triangle get_triangle( const indexed_mesh& m, size_t face )
+      {
+        const uint32_t* f = m.indices.data() + 3 * face;
+        return triangle( m.vertices[ f[0] ], m.vertices[ f[1] ], m.vertices[ f[2] ] );
+      }
+
+      static void intersection_of_a_closed_mesh_is_empty()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 48, 24 );
+        face_intersections result;
+        find_self_intersections( sphere, result, true );
+        BOOST_REQUIRE_EQUAL( result.size(), 0u );
+        BOOST_REQUIRE_EQUAL( result.segments.size(), 0u );
+      }
+
+      static void intersection_of_overlapping_spheres_matches_brute_force()
+      {
+        const vec3 center{ 1, 0, 0 };
+        indexed_mesh first, second;
+        make_sphere( first, 24, 12 );
+        make_sphere( second, 20, 10, 1, center );
+
+        // brute force on the faces of two distinct components
+        std::vector< std::pair< uint32_t, uint32_t > > expected;
+        for( size_t i = 0; i < first.get_number_of_faces(); ++ i )
+          for( size_t j = 0; j < second.get_number_of_faces(); ++ j )
+            if( intersect( get_triangle( first, i ), get_triangle( second, j ) ) )
+              expected.emplace_back( uint32_t( i ), uint32_t( j ) );
+        BOOST_REQUIRE( !expected.empty() );
+
+        face_intersections result;
+        find_intersections( first, second, result, true );
+        BOOST_REQUIRE( result.faces == expected );
+        BOOST_REQUIRE_EQUAL( result.segments.size(), expected.size() );
+        for( const auto& s : result.segments )
+          {
+            // the spheres meet on the circle of the plane x = 0.5
+            BOOST_REQUIRE_SMALL( s.first.x - real(0.5), real(0.1) );
+            BOOST_REQUIRE_SMALL( s.second.x - real(0.5), real(0.1) );
+          }
+
+        // merge both spheres into a single mesh: the second sphere faces
+        // come after the first sphere faces
+        indexed_mesh merged = first;
+        const uint32_t offset = uint32_t( first.get_number_of_vertices() );
+        merged.vertices.insert( merged.vertices.end(), second.vertices.begin(), second.vertices.end() );
+        for( auto index : second.indices )
+          merged.indices.push_back( index + offset );
+        const uint32_t face_offset = uint32_t( first.get_number_of_faces() );
+        for( auto& pair : expected )
+          pair.second += face_offset;
+
+        find_self_intersections( merged, result );
+        BOOST_REQUIRE( result.faces == expected );
+        BOOST_REQUIRE( result.segments.empty() );
+      }
+
+      static void intersection_of_touching_faces()
+      {
+        // two faces sharing an edge are never reported, two faces sharing a
+        // vertex only if they intersect elsewhere
+        indexed_mesh m;
+        m.vertices = {
+          vec3{ 0, 0, 0 }, vec3{ 1, 0, 0 }, vec3{ 0, 1, 0 },
+          vec3{ 1, 1, 0 },
+          vec3{ 0, 0, 1 }, vec3{ -1, -1, 0 } };
+        m.indices = { 0, 1, 2,  1, 3, 2,  0, 4, 5 };
+        face_intersections result;
+        find_self_intersections( m, result );
+        BOOST_REQUIRE_EQUAL( result.size(), 0u );
+
+        // a face sharing the vertex 0 and crossing the first face
+        m.vertices.push_back( vec3{ 0.5, 0.2, -1 } );
+        m.vertices.push_back( vec3{ 0.2, 0.5, 1 } );
+        m.indices.insert( m.indices.end(), { 0, 6, 7 } );
+        find_self_intersections( m, result );
+        BOOST_REQUIRE_EQUAL( result.size(), 1u );
+        BOOST_REQUIRE_EQUAL( result.faces[0].first, 0u );
+        BOOST_REQUIRE_EQUAL( result.faces[0].second, 3u );
+      }
+
+      test_suite* intersection_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("intersection");
+        ADD_TEST_CASE( intersection_of_a_closed_mesh_is_empty );
+        ADD_TEST_CASE( intersection_of_overlapping_spheres_matches_brute_force );
+        ADD_TEST_CASE( intersection_of_touching_faces );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,132 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/isosurface.h"
+# include <cmath>
+# include <random>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static const vec3 sphere_center{ 0.05, -0.1, 0.02 };
+      static const real sphere_radius = 0.7;
+
+      static real sphere_distance( const vec3& p )
+      {
+        return length( p - sphere_center ) - sphere_radius;
+      }
+
+      static isosurface_parameters make_parameters( isosurface_method method )
+      {
+        isosurface_parameters parameters;
+        parameters.origin = vec3{ -1, -1, -1 };
+        parameters.cell_size = 0.05;
+        parameters.resolution[0] = parameters.resolution[1] = parameters.resolution[2] = 40;
+        parameters.isovalue = 0;
+        parameters.block_size = 8;
+        parameters.lipschitz_constant = 1;
+        parameters.method = method;
+        return parameters;
+      }
+
+      static void isosurface_of_a_sphere()
+      {
+        const real pi = real( 3.14159265358979323846 );
+        const isosurface_method methods[] = {
+          isosurface_method::marching_cubes, isosurface_method::marching_tetrahedra, isosurface_method::dual_contouring };
+        for( auto method : methods )
+          {
+            const auto parameters = make_parameters( method );
+            indexed_mesh sphere;
+            BOOST_REQUIRE( extract_isosurface( sphere_distance, parameters, sphere ) );
+            BOOST_REQUIRE_GT( sphere.get_number_of_faces(), 1000u );
+            BOOST_REQUIRE( is_closed_manifold( sphere ) );
+            BOOST_REQUIRE_EQUAL( sphere.get_number_of_vertices() * 2, sphere.get_number_of_faces() + 4 );
+            for( const auto& v : sphere.vertices )
+              BOOST_REQUIRE_SMALL( sphere_distance( v ), parameters.cell_size * real(0.1) );
+            // faces are oriented outward
+            BOOST_REQUIRE_CLOSE( compute_signed_volume( sphere ), real(4) / real(3) * pi * std::pow( sphere_radius, 3 ), 2 );
+          }
+      }
+
+      static void marching_cubes_is_the_default_method()
+      {
+        BOOST_REQUIRE( isosurface_parameters{}.method == isosurface_method::marching_cubes );
+
+        // marching cubes has fewer faces than marching tetrahedra
+        indexed_mesh cubes, tetrahedra;
+        BOOST_REQUIRE( extract_isosurface( sphere_distance, make_parameters( isosurface_method::marching_cubes ), cubes ) );
+        BOOST_REQUIRE( extract_isosurface( sphere_distance, make_parameters( isosurface_method::marching_tetrahedra ), tetrahedra ) );
+        BOOST_REQUIRE_LT( 2 * cubes.get_number_of_faces(), tetrahedra.get_number_of_faces() );
+      }
+
+      static void marching_cubes_has_no_crack_on_ambiguous_faces()
+      {
+        // random samples inside a domain whose border is above the isovalue
+        // go through all the configurations of a cell, ambiguous ones included
+        isosurface_parameters parameters;
+        parameters.resolution[0] = parameters.resolution[1] = parameters.resolution[2] = 24;
+        parameters.block_size = 5;
+        const uint32_t side = parameters.resolution[0] + 1;
+        std::mt19937 generator( 5 );
+        std::uniform_real_distribution< real > distribution( -1, 1 );
+        std::vector< real > values;
+        for( uint32_t z = 0; z < side; ++ z )
+          for( uint32_t y = 0; y < side; ++ y )
+            for( uint32_t x = 0; x < side; ++ x )
+              {
+                const bool border = !x || !y || !z || x + 1 == side || y + 1 == side || z + 1 == side;
+                values.push_back( border ? real(1) : distribution( generator ) );
+              }
+
+        indexed_mesh m;
+        BOOST_REQUIRE( extract_isosurface( values.data(), parameters, m ) );
+        BOOST_REQUIRE_GT( m.get_number_of_faces(), 1000u );
+        BOOST_REQUIRE( is_closed_manifold( m ) );
+      }
+
+      static void isosurface_does_not_depend_on_skipping()
+      {
+        const auto parameters = make_parameters( isosurface_method::marching_cubes );
+        indexed_mesh skipped, evaluated, sampled;
+        BOOST_REQUIRE( extract_isosurface( sphere_distance, parameters, skipped ) );
+
+        auto without_lipschitz = parameters;
+        without_lipschitz.lipschitz_constant = 0;
+        BOOST_REQUIRE( extract_isosurface( sphere_distance, without_lipschitz, evaluated ) );
+
+        std::vector< real > values;
+        for( uint32_t z = 0; z <= parameters.resolution[2]; ++ z )
+          for( uint32_t y = 0; y <= parameters.resolution[1]; ++ y )
+            for( uint32_t x = 0; x <= parameters.resolution[0]; ++ x )
+              values.push_back( sphere_distance( parameters.origin + vec3{ x, y, z } * parameters.cell_size ) );
+        BOOST_REQUIRE( extract_isosurface( values.data(), parameters, sampled ) );
+
+        BOOST_REQUIRE( skipped.indices == evaluated.indices );
+        BOOST_REQUIRE( skipped.vertices == evaluated.vertices );
+        BOOST_REQUIRE( sampled.indices == evaluated.indices );
+        BOOST_REQUIRE( sampled.vertices == evaluated.vertices );
+      }
+
+      static void isosurface_rejects_invalid_parameters()
+      {
+        auto parameters = make_parameters( isosurface_method::marching_tetrahedra );
+        parameters.cell_size = 0;
+        indexed_mesh output;
+        BOOST_REQUIRE( !extract_isosurface( sphere_distance, parameters, output ) );
+      }
+
+      test_suite* isosurface_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("isosurface");
+        ADD_TEST_CASE( isosurface_of_a_sphere );
+        ADD_TEST_CASE( marching_cubes_is_the_default_method );
+        ADD_TEST_CASE( marching_cubes_has_no_crack_on_ambiguous_faces );
+        ADD_TEST_CASE( isosurface_does_not_depend_on_skipping );
+        ADD_TEST_CASE( isosurface_rejects_invalid_parameters );
+        return suite;
+      }
+
+    }
+  }
+}
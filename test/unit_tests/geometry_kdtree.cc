@@ -0,0 +1,104 @@
+# include "common.h"
+# include "geometry_points.h"
+# include "../../graphics-origin/geometry/kdtree.h"
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static void kdtree_k_nearest_matches_brute_force()
+      {
+        const auto points = make_points( 5000, 11 );
+        const kdtree tree( points.data(), points.size(), 8 );
+        BOOST_REQUIRE_EQUAL( tree.get_number_of_points(), points.size() );
+
+        const auto locations = make_points( 300, 12 );
+        const uint32_t k = 10;
+        std::vector< kdtree::point_index > indices( locations.size() * k );
+        std::vector< real > squared_distances( locations.size() * k );
+        tree.k_nearest( locations.data(), locations.size(), k, indices.data(), squared_distances.data() );
+
+        kdtree::point_index single_indices[ k ];
+        real single_squared_distances[ k ];
+        for( size_t i = 0; i < locations.size(); ++ i )
+          {
+            const auto expected = brute_force_radius_search( points, locations[ i ], 4 );
+            BOOST_REQUIRE_EQUAL( tree.k_nearest( locations[ i ], k, single_indices, single_squared_distances ), size_t( k ) );
+            for( uint32_t j = 0; j < k; ++ j )
+              {
+                // ties between duplicated points can be reported in any order
+                BOOST_REQUIRE_EQUAL( single_squared_distances[ j ], expected[ j ].second );
+                BOOST_REQUIRE_EQUAL( squared_distances[ i * k + j ], expected[ j ].second );
+                const vec3 d = points[ single_indices[ j ] ] - locations[ i ];
+                BOOST_REQUIRE_EQUAL( dot( d, d ), expected[ j ].second );
+                const vec3 e = points[ indices[ i * k + j ] ] - locations[ i ];
+                BOOST_REQUIRE_EQUAL( dot( e, e ), expected[ j ].second );
+              }
+          }
+      }
+
+      static void kdtree_k_nearest_with_less_points_than_k()
+      {
+        const auto points = make_points( 5, 13 );
+        const kdtree tree( points.data(), points.size() );
+        const vec3 location{ 0, 0, 0 };
+        const uint32_t k = 8;
+        kdtree::point_index indices[ k ];
+        real squared_distances[ k ];
+        BOOST_REQUIRE_EQUAL( tree.k_nearest( location, k, indices, squared_distances ), points.size() );
+
+        tree.k_nearest( &location, 1, k, indices, squared_distances );
+        for( uint32_t j = uint32_t( points.size() ); j < k; ++ j )
+          {
+            BOOST_REQUIRE_EQUAL( indices[ j ], kdtree::point_index(-1) );
+            BOOST_REQUIRE_EQUAL( squared_distances[ j ], REAL_MAX );
+          }
+      }
+
+      static void kdtree_radius_search_matches_brute_force()
+      {
+        const auto points = make_points( 5000, 14 );
+        const kdtree tree( points.data(), points.size() );
+        const auto locations = make_points( 300, 15 );
+        const real radius = 0.2;
+
+        std::vector< std::pair< kdtree::point_index, real > > neighbors;
+        std::vector< size_t > offsets( locations.size() + 1 );
+        size_t total = 0;
+        for( size_t i = 0; i < locations.size(); ++ i )
+          {
+            const auto expected = brute_force_radius_search( points, locations[ i ], radius );
+            total += expected.size();
+            BOOST_REQUIRE_EQUAL( tree.count_in_radius( locations[ i ], radius ), expected.size() );
+            tree.radius_search( locations[ i ], radius, neighbors );
+            BOOST_REQUIRE_EQUAL( neighbors.size(), expected.size() );
+            for( size_t j = 0; j < neighbors.size(); ++ j )
+              BOOST_REQUIRE_EQUAL( neighbors[ j ].second, expected[ j ].second );
+          }
+        BOOST_REQUIRE_EQUAL( tree.count_in_radius( locations.data(), locations.size(), radius, offsets.data() ), total );
+
+        point_neighborhoods neighborhoods;
+        tree.radius_search( locations.data(), locations.size(), radius, neighborhoods );
+        BOOST_REQUIRE( neighborhoods.offsets == offsets );
+        for( size_t i = 0; i < locations.size(); ++ i )
+          {
+            std::vector< uint32_t > expected;
+            for( const auto& n : brute_force_radius_search( points, locations[ i ], radius ) )
+              expected.push_back( n.first );
+            std::sort( expected.begin(), expected.end() );
+            BOOST_REQUIRE( sorted_indices( neighborhoods.begin( i ), neighborhoods.end( i ) ) == expected );
+          }
+      }
+
+      test_suite* kdtree_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("kdtree");
+        ADD_TEST_CASE( kdtree_k_nearest_matches_brute_force );
+        ADD_TEST_CASE( kdtree_k_nearest_with_less_points_than_k );
+        ADD_TEST_CASE( kdtree_radius_search_matches_brute_force );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -3,9 +3,41 @@
 namespace graphics_origin {
   namespace geometry {
     namespace test {
+
+      extern test_suite* ray_queries_test_suite();
+      extern test_suite* simplification_test_suite();
+      extern test_suite* index_buffer_test_suite();
+      extern test_suite* normals_test_suite();
+      extern test_suite* kdtree_test_suite();
+      extern test_suite* spatial_grid_test_suite();
+      extern test_suite* voxelizer_test_suite();
+      extern test_suite* streaming_mesh_test_suite();
+      extern test_suite* intersection_test_suite();
+      extern test_suite* distance_test_suite();
+      extern test_suite* isosurface_test_suite();
+      extern test_suite* space_filling_curve_test_suite();
+      extern test_suite* mesh_sampling_test_suite();
+      extern test_suite* medial_axis_test_suite();
+      extern test_suite* ambient_occlusion_test_suite();
+
       void add_test_suite()
       {
         test_suite* suite = BOOST_TEST_SUITE("GEOMETRY LIBRARY");
+        ADD_TO_SUITE( ray_queries_test_suite );
+        ADD_TO_SUITE( simplification_test_suite );
+        ADD_TO_SUITE( index_buffer_test_suite );
+        ADD_TO_SUITE( normals_test_suite );
+        ADD_TO_SUITE( kdtree_test_suite );
+        ADD_TO_SUITE( spatial_grid_test_suite );
+        ADD_TO_SUITE( voxelizer_test_suite );
+        ADD_TO_SUITE( streaming_mesh_test_suite );
+        ADD_TO_SUITE( intersection_test_suite );
+        ADD_TO_SUITE( distance_test_suite );
+        ADD_TO_SUITE( isosurface_test_suite );
+        ADD_TO_SUITE( space_filling_curve_test_suite );
+        ADD_TO_SUITE( mesh_sampling_test_suite );
+        ADD_TO_SUITE( medial_axis_test_suite );
+        ADD_TO_SUITE( ambient_occlusion_test_suite );
         ADD_TO_MASTER( suite );
       }
 
@@ -0,0 +1,100 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/medial_axis.h"
+# include "../../graphics-origin/geometry/mesh_sampling.h"
+# include <algorithm>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static void shrinking_balls_of_a_sphere_converge_to_the_sphere()
+      {
+        const vec3 center{ 1, -2, 0.5 };
+        const real radius = 3;
+        indexed_mesh sphere;
+        make_sphere( sphere, 32, 16, radius, center );
+        const std::vector< vec3 >& points = sphere.vertices;
+        std::vector< vec3 > normals( points.size() );
+        for( size_t i = 0; i < points.size(); ++ i )
+          normals[ i ] = normalize( points[ i ] - center );
+        const kdtree tree( points.data(), points.size() );
+
+        std::vector< ball > balls;
+        std::vector< uint32_t > sources;
+        compute_shrinking_balls( points.data(), normals.data(), points.size(), tree, shrinking_ball_parameters{}, balls, &sources );
+        BOOST_REQUIRE_EQUAL( balls.size(), points.size() );
+        BOOST_REQUIRE_EQUAL( sources.size(), points.size() );
+        for( size_t i = 0; i < balls.size(); ++ i )
+          {
+            BOOST_REQUIRE_EQUAL( sources[ i ], i );
+            BOOST_REQUIRE_SMALL( length( vec3( balls[ i ] ) - center ), 1e-6 );
+            BOOST_REQUIRE_CLOSE( balls[ i ].w, radius, 1e-6 );
+          }
+      }
+
+      static void shrinking_balls_skip_coincident_points()
+      {
+        // samples of a box, each one being duplicated
+        indexed_mesh box;
+        make_box( box, vec3{ 0, 0, 0 }, vec3{ 1, 2, 3 } );
+        const size_t nsamples = 2000;
+        std::vector< vec3 > points( 2 * nsamples ), normals( 2 * nsamples );
+        sample_uniformly( box, nsamples, 5, points.data(), normals.data() );
+        std::copy( points.begin(), points.begin() + nsamples, points.begin() + nsamples );
+        std::copy( normals.begin(), normals.begin() + nsamples, normals.begin() + nsamples );
+        const kdtree tree( points.data(), points.size() );
+
+        std::vector< ball > balls;
+        std::vector< uint32_t > sources;
+        compute_shrinking_balls( points.data(), normals.data(), points.size(), tree, shrinking_ball_parameters{}, balls, &sources );
+        BOOST_REQUIRE_EQUAL( balls.size(), points.size() );
+        // both copies of a point get the same ball
+        for( size_t i = 0; i < nsamples; ++ i )
+          {
+            BOOST_REQUIRE_SMALL( length( vec3( balls[ i ] ) - vec3( balls[ i + nsamples ] ) ), 1e-9 );
+            BOOST_REQUIRE_CLOSE( balls[ i ].w, balls[ i + nsamples ].w, 1e-6 );
+          }
+      }
+
+      static void included_balls_are_removed()
+      {
+        std::vector< ball > balls = {
+          ball( vec3{ 0, 0, 0 }, 1 ),
+          ball( vec3{ 0.2, 0, 0 }, 0.5 ),   // included in the first ball
+          ball( vec3{ 2, 0, 0 }, 0.5 ),     // disjoint from the others
+          ball( vec3{ 5, 0, 0 }, 1 ),
+          ball( vec3{ 5, 0, 0 }, 1 ),       // equal to the previous ball
+          ball( vec3{ 0.6, 0, 0 }, 0.45 ) };// slightly out of the first ball
+        std::vector< uint32_t > sources = { 10, 11, 12, 13, 14, 15 };
+
+        std::vector< ball > result = balls;
+        std::vector< uint32_t > result_sources = sources;
+        BOOST_REQUIRE_EQUAL( remove_included_balls( result, 0, 16, &result_sources ), 2u );
+        const size_t expected[] = { 0, 2, 3, 5 };
+        BOOST_REQUIRE_EQUAL( result.size(), 4u );
+        BOOST_REQUIRE_EQUAL( result_sources.size(), 4u );
+        for( size_t i = 0; i < 4; ++ i )
+          {
+            BOOST_REQUIRE( vec4( result[ i ] ) == vec4( balls[ expected[ i ] ] ) );
+            BOOST_REQUIRE_EQUAL( result_sources[ i ], sources[ expected[ i ] ] );
+          }
+
+        // the tolerance makes the last ball included
+        result = balls;
+        BOOST_REQUIRE_EQUAL( remove_included_balls( result, 0.1 ), 3u );
+        BOOST_REQUIRE_EQUAL( result.size(), 3u );
+      }
+
+      test_suite* medial_axis_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("medial axis");
+        ADD_TEST_CASE( shrinking_balls_of_a_sphere_converge_to_the_sphere );
+        ADD_TEST_CASE( shrinking_balls_skip_coincident_points );
+        ADD_TEST_CASE( included_balls_are_removed );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,183 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/mesh_sampling.h"
+# include <omp.h>
+# include <algorithm>
+# include <cmath>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      /**Number of threads used to check that results do not depend on it. */
+      static int get_number_of_test_threads()
+      {
+        return std::max( omp_get_max_threads(), 4 );
+      }
+
+      static real compute_face_area( const indexed_mesh& m, size_t face )
+      {
+        const uint32_t* f = m.indices.data() + 3 * face;
+        return real(0.5) * length( cross( m.vertices[ f[1] ] - m.vertices[ f[0] ], m.vertices[ f[2] ] - m.vertices[ f[0] ] ) );
+      }
+
+      /**Check that a point lies in a face, up to a tolerance. */
+      static bool is_on_face( const indexed_mesh& m, size_t face, const vec3& p )
+      {
+        const uint32_t* f = m.indices.data() + 3 * face;
+        const vec3& a = m.vertices[ f[0] ];
+        const vec3& b = m.vertices[ f[1] ];
+        const vec3& c = m.vertices[ f[2] ];
+        const vec3 n = cross( b - a, c - a );
+        if( std::abs( dot( p - a, normalize( n ) ) ) > 1e-9 )
+          return false;
+        // barycentric coordinates are the signed areas of the sub-triangles
+        const real u = dot( cross( c - b, p - b ), n ) / dot( n, n );
+        const real v = dot( cross( a - c, p - c ), n ) / dot( n, n );
+        const real w = 1 - u - v;
+        return u >= -1e-9 && v >= -1e-9 && w >= -1e-9;
+      }
+
+      static void uniform_sampling_is_independent_of_the_number_of_threads()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 32, 16, 2 );
+        const size_t nsamples = 3 * 4096 + 17;
+        const int nthreads = omp_get_max_threads();
+
+        std::vector< vec3 > positions[2], normals[2];
+        std::vector< uint32_t > faces[2];
+        const int thread_counts[2] = { 1, get_number_of_test_threads() };
+        for( int run = 0; run < 2; ++ run )
+          {
+            omp_set_num_threads( thread_counts[ run ] );
+            positions[ run ].resize( nsamples );
+            normals[ run ].resize( nsamples );
+            faces[ run ].resize( nsamples );
+            BOOST_REQUIRE( sample_uniformly( sphere, nsamples, 42, positions[ run ].data(), normals[ run ].data(), faces[ run ].data() ) );
+          }
+        omp_set_num_threads( nthreads );
+
+        BOOST_REQUIRE( positions[0] == positions[1] );
+        BOOST_REQUIRE( normals[0] == normals[1] );
+        BOOST_REQUIRE( faces[0] == faces[1] );
+        for( size_t i = 0; i < nsamples; ++ i )
+          BOOST_REQUIRE( is_on_face( sphere, faces[0][ i ], positions[0][ i ] ) );
+
+        // another seed gives other samples
+        std::vector< vec3 > other( nsamples );
+        sample_uniformly( sphere, nsamples, 43, other.data() );
+        BOOST_REQUIRE( other != positions[0] );
+      }
+
+      static void uniform_sampling_follows_face_areas()
+      {
+        // faces of a box with different sides have different areas
+        indexed_mesh box;
+        make_box( box, vec3{ 0, 0, 0 }, vec3{ 1, 2, 4 } );
+        // a face without vertices must never be sampled
+        box.indices.insert( box.indices.end(), { indexed_mesh::invalid_index, indexed_mesh::invalid_index, indexed_mesh::invalid_index } );
+        const size_t nfaces = box.get_number_of_faces();
+        const size_t nsamples = 200000;
+        std::vector< vec3 > positions( nsamples );
+        std::vector< uint32_t > faces( nsamples );
+        BOOST_REQUIRE( sample_uniformly( box, nsamples, 7, positions.data(), nullptr, faces.data() ) );
+
+        std::vector< size_t > counts( nfaces, 0 );
+        for( size_t i = 0; i < nsamples; ++ i )
+          {
+            BOOST_REQUIRE_LT( faces[ i ], nfaces - 1 );
+            BOOST_REQUIRE( is_on_face( box, faces[ i ], positions[ i ] ) );
+            ++ counts[ faces[ i ] ];
+          }
+
+        const real total_area = 2 * ( 1 * 2 + 1 * 4 + 2 * 4 );
+        for( size_t f = 0; f + 1 < nfaces; ++ f )
+          {
+            // the count of a face follows a binomial law: allow five standard deviations
+            const real p = compute_face_area( box, f ) / total_area;
+            const real expected = p * real( nsamples );
+            BOOST_REQUIRE_SMALL( real( counts[ f ] ) - expected, 5 * std::sqrt( expected * ( 1 - p ) ) );
+          }
+      }
+
+      static void uniform_sampling_needs_a_surface()
+      {
+        indexed_mesh flat;
+        flat.vertices = { vec3{ 0, 0, 0 }, vec3{ 1, 0, 0 }, vec3{ 2, 0, 0 } };
+        flat.indices = { 0, 1, 2 };
+        vec3 position;
+        BOOST_REQUIRE( !sample_uniformly( flat, 1, 0, &position ) );
+      }
+
+      static void poisson_disk_sampling_respects_the_radius()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 64, 32 );
+        poisson_disk_parameters parameters;
+        parameters.radius = 0.1;
+        parameters.seed = 3;
+
+        const size_t nsamples = sample_poisson_disk( sphere, parameters, 0, nullptr );
+        BOOST_REQUIRE_GT( nsamples, 0u );
+        std::vector< vec3 > positions( nsamples );
+        std::vector< uint32_t > faces( nsamples );
+        BOOST_REQUIRE_EQUAL( sample_poisson_disk( sphere, parameters, nsamples, positions.data(), nullptr, faces.data() ), nsamples );
+
+        // check all pairs
+        for( size_t i = 0; i < nsamples; ++ i )
+          {
+            BOOST_REQUIRE( is_on_face( sphere, faces[ i ], positions[ i ] ) );
+            for( size_t j = i + 1; j < nsamples; ++ j )
+              BOOST_REQUIRE_GE( length( positions[ i ] - positions[ j ] ), parameters.radius );
+          }
+
+        // a maximal sampling covers the surface: a disk of radius r/2 per sample
+        // does not overlap any other, and a disk of radius r per sample covers
+        // the whole sphere
+        const real pi = real( 3.14159265358979323846 );
+        const real area = 4 * pi;
+        BOOST_REQUIRE_LT( real( nsamples ) * pi * parameters.radius * parameters.radius * real(0.25), area );
+        BOOST_REQUIRE_GT( real( nsamples ) * pi * parameters.radius * parameters.radius, area );
+      }
+
+      static void poisson_disk_sampling_is_independent_of_the_number_of_threads()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 64, 32 );
+        poisson_disk_parameters parameters;
+        parameters.radius = 0.05;
+        parameters.seed = 11;
+        const int nthreads = omp_get_max_threads();
+
+        std::vector< vec3 > positions[2];
+        const int thread_counts[2] = { 1, get_number_of_test_threads() };
+        for( int run = 0; run < 2; ++ run )
+          {
+            omp_set_num_threads( thread_counts[ run ] );
+            positions[ run ].resize( sample_poisson_disk( sphere, parameters, 0, nullptr ) );
+            sample_poisson_disk( sphere, parameters, positions[ run ].size(), positions[ run ].data() );
+          }
+        omp_set_num_threads( nthreads );
+        BOOST_REQUIRE( positions[0] == positions[1] );
+
+        // a smaller capacity gives the beginning of the same sampling
+        std::vector< vec3 > truncated( positions[0].size() / 2 );
+        BOOST_REQUIRE_EQUAL( sample_poisson_disk( sphere, parameters, truncated.size(), truncated.data() ), positions[0].size() );
+        BOOST_REQUIRE( std::equal( truncated.begin(), truncated.end(), positions[0].begin() ) );
+      }
+
+      test_suite* mesh_sampling_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("mesh sampling");
+        ADD_TEST_CASE( uniform_sampling_is_independent_of_the_number_of_threads );
+        ADD_TEST_CASE( uniform_sampling_follows_face_areas );
+        ADD_TEST_CASE( uniform_sampling_needs_a_surface );
+        ADD_TEST_CASE( poisson_disk_sampling_respects_the_radius );
+        ADD_TEST_CASE( poisson_disk_sampling_is_independent_of_the_number_of_threads );
+        return suite;
+      }
+
+    }
+  }
+}
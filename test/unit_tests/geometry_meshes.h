@@ -0,0 +1,101 @@
+# ifndef GRAPHICS_ORIGIN_TESTS_GEOMETRY_MESHES_H_
+# define GRAPHICS_ORIGIN_TESTS_GEOMETRY_MESHES_H_
+# include "../../graphics-origin/geometry/indexed_mesh.h"
+# include <cmath>
+# include <map>
+# include <utility>
+
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      /**Build a closed UV sphere, with outward oriented faces. */
+      inline void make_sphere(
+          indexed_mesh& m, uint32_t slices, uint32_t stacks,
+          real radius = 1, const vec3& center = vec3{} )
+      {
+        const real pi = real( 3.14159265358979323846 );
+        m.vertices.clear();
+        m.indices.clear();
+        m.vertices.push_back( center + vec3{ 0, 0, radius } );
+        for( uint32_t i = 1; i < stacks; ++ i )
+          for( uint32_t j = 0; j < slices; ++ j )
+            {
+              const real theta = pi * real( i ) / real( stacks );
+              const real phi = 2 * pi * real( j ) / real( slices );
+              m.vertices.push_back( center + radius * vec3{
+                std::sin( theta ) * std::cos( phi ),
+                std::sin( theta ) * std::sin( phi ),
+                std::cos( theta ) } );
+            }
+        m.vertices.push_back( center - vec3{ 0, 0, radius } );
+        const uint32_t south = uint32_t( m.vertices.size() - 1 );
+        auto vertex = [slices]( uint32_t i, uint32_t j )
+          {
+            return 1 + ( i - 1 ) * slices + j % slices;
+          };
+        for( uint32_t j = 0; j < slices; ++ j )
+          m.indices.insert( m.indices.end(), { 0u, vertex( 1, j ), vertex( 1, j + 1 ) } );
+        for( uint32_t i = 1; i + 1 < stacks; ++ i )
+          for( uint32_t j = 0; j < slices; ++ j )
+            {
+              m.indices.insert( m.indices.end(), { vertex( i, j ), vertex( i + 1, j ), vertex( i + 1, j + 1 ) } );
+              m.indices.insert( m.indices.end(), { vertex( i, j ), vertex( i + 1, j + 1 ), vertex( i, j + 1 ) } );
+            }
+        for( uint32_t j = 0; j < slices; ++ j )
+          m.indices.insert( m.indices.end(), { vertex( stacks - 1, j ), south, vertex( stacks - 1, j + 1 ) } );
+      }
+
+      /**Build a closed axis aligned box made of 12 outward oriented faces. */
+      inline void make_box( indexed_mesh& m, const vec3& low, const vec3& high )
+      {
+        m.vertices.clear();
+        for( uint32_t i = 0; i < 8; ++ i )
+          m.vertices.push_back( vec3{
+            i & 1 ? high.x : low.x,
+            i & 2 ? high.y : low.y,
+            i & 4 ? high.z : low.z } );
+        m.indices = {
+            0, 2, 1,  1, 2, 3,   // z = low
+            4, 5, 6,  5, 7, 6,   // z = high
+            0, 1, 4,  1, 5, 4,   // y = low
+            2, 6, 3,  3, 6, 7,   // y = high
+            0, 4, 2,  2, 4, 6,   // x = low
+            1, 3, 5,  3, 7, 5 }; // x = high
+      }
+
+      /**Check that every edge is shared by exactly two faces with opposite orientations. */
+      inline bool is_closed_manifold( const indexed_mesh& m )
+      {
+        std::map< std::pair< uint32_t, uint32_t >, int > edges;
+        for( size_t f = 0; f < m.get_number_of_faces(); ++ f )
+          for( int k = 0; k < 3; ++ k )
+            ++edges[ std::make_pair( m.indices[ 3 * f + k ], m.indices[ 3 * f + ( k + 1 ) % 3 ] ) ];
+        for( const auto& e : edges )
+          {
+            if( e.second != 1 )
+              return false;
+            const auto opposite = edges.find( std::make_pair( e.first.second, e.first.first ) );
+            if( opposite == edges.end() || opposite->second != 1 )
+              return false;
+          }
+        return true;
+      }
+
+      /**Compute the volume enclosed by a closed mesh, which is positive when
+       * faces are oriented outward. */
+      inline real compute_signed_volume( const indexed_mesh& m )
+      {
+        real volume = 0;
+        for( size_t f = 0; f < m.get_number_of_faces(); ++ f )
+          {
+            const uint32_t* i = m.indices.data() + 3 * f;
+            volume += dot( m.vertices[ i[0] ], cross( m.vertices[ i[1] ], m.vertices[ i[2] ] ) );
+          }
+        return volume / real(6);
+      }
+
+    }
+  }
+}
+# endif
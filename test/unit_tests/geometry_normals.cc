@@ -0,0 +1,68 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/mesh.h"
+# include "../../graphics-origin/geometry/mesh_normals.h"
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static void normals_of_mesh_match_indexed_mesh()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 32, 16, 2, vec3{ 1, -1, 0.5 } );
+        mesh m;
+        sphere.to_mesh( m );
+
+        const normal_weighting weightings[] = { normal_weighting::uniform, normal_weighting::area, normal_weighting::angle };
+        for( auto weighting : weightings )
+          {
+            std::vector< vec3 > expected;
+            compute_vertex_normals( sphere, expected, weighting );
+            update_normals( m, weighting );
+            for( size_t i = 0; i < expected.size(); ++ i )
+              {
+                const auto& n = m.normal( mesh::VertexHandle( i ) );
+                BOOST_REQUIRE_SMALL( length( vec3{ n[0], n[1], n[2] } - expected[ i ] ), 1e-12 );
+                // outward normals of a sphere are close to the radial direction
+                BOOST_REQUIRE_GT( dot( expected[ i ], normalize( sphere.vertices[ i ] - vec3{ 1, -1, 0.5 } ) ), 0.99 );
+              }
+
+            std::vector< vec3 > face_normals( sphere.get_number_of_faces() );
+            compute_face_normals( sphere.vertices.data(), sphere.indices.data(), sphere.get_number_of_faces(), face_normals.data() );
+            for( size_t i = 0; i < face_normals.size(); ++ i )
+              {
+                const auto& n = m.normal( mesh::FaceHandle( i ) );
+                BOOST_REQUIRE_SMALL( length( vec3{ n[0], n[1], n[2] } - face_normals[ i ] ), 1e-12 );
+              }
+          }
+      }
+
+      static void normals_of_converted_mesh_are_uniformly_weighted()
+      {
+        // on a box, each weighting gives a different corner normal
+        indexed_mesh box;
+        make_box( box, vec3{ 0, 0, 0 }, vec3{ 1, 2, 3 } );
+        mesh m;
+        box.to_mesh( m );
+
+        std::vector< vec3 > expected;
+        compute_vertex_normals( box, expected, normal_weighting::uniform );
+        for( size_t i = 0; i < expected.size(); ++ i )
+          {
+            const auto& n = m.normal( mesh::VertexHandle( i ) );
+            BOOST_REQUIRE_SMALL( length( vec3{ n[0], n[1], n[2] } - expected[ i ] ), 1e-12 );
+          }
+      }
+
+      test_suite* normals_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("normals");
+        ADD_TEST_CASE( normals_of_mesh_match_indexed_mesh );
+        ADD_TEST_CASE( normals_of_converted_mesh_are_uniformly_weighted );
+        return suite;
+      }
+
+    }
+  }
+}
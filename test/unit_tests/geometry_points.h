@@ -0,0 +1,66 @@
+# ifndef GRAPHICS_ORIGIN_TESTS_GEOMETRY_POINTS_H_
+# define GRAPHICS_ORIGIN_TESTS_GEOMETRY_POINTS_H_
+# include "../../graphics-origin/geometry/vec.h"
+# include <algorithm>
+# include <random>
+# include <utility>
+# include <vector>
+
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      /**Build a point set made of uniform points in [-1,1]^3, a dense cluster
+       * and some duplicated points, to stress spatial structures. */
+      inline std::vector< vec3 > make_points( size_t npoints, unsigned int seed )
+      {
+        std::mt19937 generator( seed );
+        std::uniform_real_distribution< real > coordinate( -1, 1 );
+        std::vector< vec3 > points;
+        points.reserve( npoints );
+        for( size_t i = 0; points.size() < npoints; ++ i )
+          {
+            const vec3 p{ coordinate( generator ), coordinate( generator ), coordinate( generator ) };
+            if( i % 7 == 0 && !points.empty() )
+              points.push_back( points[ i / 2 ] );
+            else if( i % 3 == 0 )
+              points.push_back( vec3{ 0.5, 0.5, 0.5 } + p * real(0.01) );
+            else
+              points.push_back( p );
+          }
+        return points;
+      }
+
+      /**Find the points in a ball by checking them all, sorted by increasing
+       * distances then indices. */
+      inline std::vector< std::pair< uint32_t, real > > brute_force_radius_search(
+          const std::vector< vec3 >& points, const vec3& location, real radius )
+      {
+        std::vector< std::pair< uint32_t, real > > result;
+        for( size_t i = 0; i < points.size(); ++ i )
+          {
+            const vec3 d = points[ i ] - location;
+            const real sqd = dot( d, d );
+            if( sqd <= radius * radius )
+              result.emplace_back( uint32_t( i ), sqd );
+          }
+        std::sort( result.begin(), result.end(),
+          []( const std::pair< uint32_t, real >& a, const std::pair< uint32_t, real >& b )
+          {
+            return a.second < b.second || ( a.second == b.second && a.first < b.first );
+          });
+        return result;
+      }
+
+      /**Sort a neighborhood by indices, to compare unsorted outputs. */
+      inline std::vector< uint32_t > sorted_indices( const uint32_t* begin, const uint32_t* end )
+      {
+        std::vector< uint32_t > result( begin, end );
+        std::sort( result.begin(), result.end() );
+        return result;
+      }
+
+    }
+  }
+}
+# endif
@@ -0,0 +1,114 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/mesh.h"
+# include "../../graphics-origin/geometry/ray.h"
+# include "../../graphics-origin/geometry/triangle.h"
+# include <algorithm>
+# include <memory>
+# include <random>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static std::vector< ray > make_random_rays( size_t nrays )
+      {
+        std::mt19937 generator( 7 );
+        std::uniform_real_distribution< real > coordinate( -2, 2 );
+        std::vector< ray > rays;
+        for( size_t i = 0; i < nrays; ++ i )
+          {
+            const vec3 origin{ coordinate( generator ), coordinate( generator ), coordinate( generator ) };
+            const vec3 target{ coordinate( generator ) * real(0.4), coordinate( generator ) * real(0.4), coordinate( generator ) * real(0.4) };
+            rays.emplace_back( origin, normalize( target - origin ) );
+          }
+        return rays;
+      }
+
+      static std::vector< real > brute_force_hits( const mesh_spatial_optimization& optimization, const ray& r )
+      {
+        std::vector< real > hits;
+        for( size_t i = 0; i < optimization.get_number_of_triangles(); ++ i )
+          {
+            real t = REAL_MAX;
+            if( optimization.get_triangle( uint32_t( i ) ).intersect( r, t ) )
+              hits.push_back( t );
+          }
+        std::sort( hits.begin(), hits.end() );
+        return hits;
+      }
+
+      static void ray_queries_occlude_matches_brute_force()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 48, 24 );
+        mesh m;
+        sphere.to_mesh( m );
+        mesh_spatial_optimization optimization( m, false, true );
+
+        const auto rays = make_random_rays( 2000 );
+        std::vector< real > max_distances( rays.size() );
+        std::vector< char > expected( rays.size() );
+        for( size_t i = 0; i < rays.size(); ++ i )
+          {
+            max_distances[ i ] = real( i % 5 ) * real(0.75);
+            const auto hits = brute_force_hits( optimization, rays[ i ] );
+            expected[ i ] = !hits.empty() && hits.front() <= max_distances[ i ];
+            BOOST_REQUIRE_EQUAL( optimization.occlude( rays[ i ], max_distances[ i ] ), bool( expected[ i ] ) );
+            BOOST_REQUIRE_EQUAL( optimization.occlude( rays[ i ] ), !hits.empty() );
+          }
+
+        std::unique_ptr< bool[] > occluded( new bool[ rays.size() ] );
+        const size_t noccluded = optimization.occlude( rays.data(), max_distances.data(), rays.size(), occluded.get() );
+        BOOST_REQUIRE_EQUAL( noccluded, size_t( std::count( expected.begin(), expected.end(), 1 ) ) );
+        for( size_t i = 0; i < rays.size(); ++ i )
+          BOOST_REQUIRE_EQUAL( occluded[ i ], bool( expected[ i ] ) );
+      }
+
+      static void ray_queries_intersect_all_matches_brute_force()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 48, 24 );
+        mesh m;
+        sphere.to_mesh( m );
+        mesh_spatial_optimization optimization( m, false, true );
+
+        const size_t capacity = 8;
+        const auto rays = make_random_rays( 1000 );
+        std::vector< real > distances( rays.size() * capacity );
+        std::vector< size_t > faces( rays.size() * capacity );
+        std::vector< size_t > counts( rays.size() );
+        optimization.intersect_all( rays.data(), rays.size(), distances.data(), faces.data(), capacity, counts.data() );
+        for( size_t i = 0; i < rays.size(); ++ i )
+          {
+            const auto hits = brute_force_hits( optimization, rays[ i ] );
+            BOOST_REQUIRE_EQUAL( counts[ i ], hits.size() );
+            for( size_t j = 0; j < std::min( capacity, hits.size() ); ++ j )
+              {
+                BOOST_REQUIRE_CLOSE( distances[ i * capacity + j ], hits[ j ], 1e-6 );
+                real t = REAL_MAX;
+                BOOST_REQUIRE( optimization.get_triangle( uint32_t( faces[ i * capacity + j ] ) ).intersect( rays[ i ], t ) );
+              }
+          }
+
+        // with a single slot, the closest hit is kept
+        real closest = REAL_MAX;
+        size_t face = 0;
+        const ray r( vec3{ 0.013, 0.021, -3 }, vec3{ 0, 0, 1 } );
+        const auto hits = brute_force_hits( optimization, r );
+        BOOST_REQUIRE_EQUAL( hits.size(), 2u );
+        BOOST_REQUIRE_EQUAL( optimization.intersect_all( r, &closest, &face, 1 ), 2u );
+        BOOST_REQUIRE_CLOSE( closest, hits.front(), 1e-6 );
+      }
+
+      test_suite* ray_queries_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("ray queries");
+        ADD_TEST_CASE( ray_queries_occlude_matches_brute_force );
+        ADD_TEST_CASE( ray_queries_intersect_all_matches_brute_force );
+        return suite;
+      }
+
+    }
+  }
+}
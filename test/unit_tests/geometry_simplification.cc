@@ -0,0 +1,146 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/mesh_simplification.h"
+# include <cmath>
+# include <map>
+# include <tuple>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      /**Build the unit cube [-1,1]^3 with each side split into n x n quads. */
+      static void make_subdivided_cube( indexed_mesh& m, uint32_t n )
+      {
+        m.vertices.clear();
+        m.indices.clear();
+        std::map< std::tuple< int, int, int >, uint32_t > vertices;
+        auto vertex = [&]( int x, int y, int z )
+          {
+            const auto key = std::make_tuple( x, y, z );
+            auto it = vertices.find( key );
+            if( it != vertices.end() )
+              return it->second;
+            const uint32_t index = uint32_t( m.vertices.size() );
+            m.vertices.push_back( vec3{ x, y, z } * real( 2.0 / n ) - vec3{ 1, 1, 1 } );
+            vertices[ key ] = index;
+            return index;
+          };
+        const int size = int( n );
+        for( int axis = 0; axis < 3; ++ axis )
+          for( int side = 0; side < 2; ++ side )
+            for( int i = 0; i < size; ++ i )
+              for( int j = 0; j < size; ++ j )
+                {
+                  uint32_t corners[4];
+                  for( int c = 0; c < 4; ++ c )
+                    {
+                      int p[3];
+                      p[ axis ] = side * size;
+                      p[ ( axis + 1 ) % 3 ] = i + ( c == 1 || c == 2 );
+                      p[ ( axis + 2 ) % 3 ] = j + ( c >= 2 );
+                      corners[ c ] = vertex( p[0], p[1], p[2] );
+                    }
+                  if( side )
+                    m.indices.insert( m.indices.end(), { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] } );
+                  else
+                    m.indices.insert( m.indices.end(), { corners[0], corners[2], corners[1], corners[0], corners[3], corners[2] } );
+                }
+      }
+
+      static void simplification_reaches_target_number_of_faces()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 64, 32 );
+        const size_t nfaces = sphere.get_number_of_faces();
+        BOOST_REQUIRE( is_closed_manifold( sphere ) );
+
+        simplification_parameters parameters;
+        parameters.target_number_of_faces = 500;
+        std::vector< indexed_mesh::vertex_index > remap;
+        const real error = simplify( sphere, parameters, &remap );
+
+        BOOST_REQUIRE_LE( sphere.get_number_of_faces(), 500u );
+        BOOST_REQUIRE_GT( sphere.get_number_of_faces(), 250u );
+        BOOST_REQUIRE( is_closed_manifold( sphere ) );
+        BOOST_REQUIRE_GE( error, 0.0 );
+        BOOST_REQUIRE_LE( error, parameters.max_error );
+        // Euler characteristic of a sphere
+        BOOST_REQUIRE_EQUAL( sphere.get_number_of_vertices() * 2, sphere.get_number_of_faces() + 4 );
+
+        BOOST_REQUIRE_EQUAL( remap.size(), size_t( 64 * 31 + 2 ) );
+        size_t kept = 0;
+        for( auto index : remap )
+          if( index != indexed_mesh::invalid_index )
+            {
+              BOOST_REQUIRE_LT( index, sphere.get_number_of_vertices() );
+              ++kept;
+            }
+        BOOST_REQUIRE_EQUAL( kept, sphere.get_number_of_vertices() );
+        BOOST_REQUIRE_LT( sphere.get_number_of_faces(), nfaces );
+      }
+
+      static void simplification_respects_error_bound()
+      {
+        indexed_mesh cube;
+        make_subdivided_cube( cube, 8 );
+        BOOST_REQUIRE( is_closed_manifold( cube ) );
+        const size_t nfaces = cube.get_number_of_faces();
+
+        // flat regions collapse for free, but the corners and edges of the cube stay
+        simplification_parameters parameters;
+        parameters.target_number_of_faces = 0;
+        parameters.max_error = 1e-10;
+        const real error = simplify( cube, parameters );
+        BOOST_REQUIRE_LE( error, parameters.max_error );
+        BOOST_REQUIRE_LT( cube.get_number_of_faces(), nfaces / 4 );
+        BOOST_REQUIRE( is_closed_manifold( cube ) );
+        for( const auto& v : cube.vertices )
+          {
+            const real distance_to_surface = std::abs( std::max( std::abs( v.x ), std::max( std::abs( v.y ), std::abs( v.z ) ) ) - 1 );
+            BOOST_REQUIRE_SMALL( distance_to_surface, 1e-6 );
+          }
+        for( int corner = 0; corner < 8; ++ corner )
+          {
+            const vec3 c{ corner & 1 ? 1 : -1, corner & 2 ? 1 : -1, corner & 4 ? 1 : -1 };
+            bool found = false;
+            for( const auto& v : cube.vertices )
+              found = found || length( v - c ) < 1e-6;
+            BOOST_REQUIRE( found );
+          }
+      }
+
+      static void simplification_level_of_detail_chain()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 64, 32 );
+        simplification_parameters parameters;
+        level_of_detail_chain chain;
+        build_level_of_detail_chain( sphere, { 2000, 1000, 200 }, parameters, chain );
+
+        BOOST_REQUIRE_EQUAL( chain.levels.size(), 4u );
+        BOOST_REQUIRE_EQUAL( chain.errors.size(), 4u );
+        BOOST_REQUIRE_EQUAL( chain.levels[0].get_number_of_faces(), sphere.get_number_of_faces() );
+        BOOST_REQUIRE_EQUAL( chain.errors[0], 0.0 );
+        const size_t targets[] = { 2000, 1000, 200 };
+        for( size_t i = 1; i < chain.levels.size(); ++ i )
+          {
+            BOOST_REQUIRE_LE( chain.levels[i].get_number_of_faces(), targets[ i - 1 ] );
+            BOOST_REQUIRE_GE( chain.errors[i], chain.errors[ i - 1 ] );
+            BOOST_REQUIRE( is_closed_manifold( chain.levels[i] ) );
+          }
+        BOOST_REQUIRE_EQUAL( chain.select_by_faces( 1500 ), 2u );
+        BOOST_REQUIRE_EQUAL( chain.select_by_error( chain.errors[3] * 2 ), 3u );
+      }
+
+      test_suite* simplification_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("simplification");
+        ADD_TEST_CASE( simplification_reaches_target_number_of_faces );
+        ADD_TEST_CASE( simplification_respects_error_bound );
+        ADD_TEST_CASE( simplification_level_of_detail_chain );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,173 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "geometry_points.h"
+# include "../../graphics-origin/geometry/space_filling_curve.h"
+# include "../../graphics-origin/geometry/box.h"
+# include "../../graphics-origin/geometry/mesh.h"
+# include <algorithm>
+# include <array>
+# include <map>
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      /**Center of a cell of the grid used by space filling curves. */
+      static vec3 cell_center( uint64_t x, uint64_t y, uint64_t z )
+      {
+        const real max_coordinate = real( ( uint64_t(1) << space_filling_curve_bits ) - 1 );
+        return vec3{ real( x ) + real(0.5), real( y ) + real(0.5), real( z ) + real(0.5) } / max_coordinate;
+      }
+
+      static bool is_permutation( const std::vector< uint32_t >& order, size_t size )
+      {
+        if( order.size() != size )
+          return false;
+        std::vector< bool > seen( size, false );
+        for( auto i : order )
+          {
+            if( i >= size || seen[ i ] )
+              return false;
+            seen[ i ] = true;
+          }
+        return true;
+      }
+
+      /**Triangles of a mesh as sorted triplets of vertex indices in a reference
+       * vertex set, rotated to start at their smallest index. */
+      static std::vector< std::array< uint32_t, 3 > > get_triangles(
+          const indexed_mesh& m, const std::map< std::array< real, 3 >, uint32_t >& reference )
+      {
+        std::vector< std::array< uint32_t, 3 > > result;
+        for( size_t f = 0; f < m.get_number_of_faces(); ++ f )
+          {
+            std::array< uint32_t, 3 > t;
+            for( int k = 0; k < 3; ++ k )
+              {
+                const vec3& p = m.vertices[ m.indices[ 3 * f + k ] ];
+                t[ k ] = reference.at( std::array< real, 3 >{{ p.x, p.y, p.z }} );
+              }
+            std::rotate( t.begin(), std::min_element( t.begin(), t.end() ), t.end() );
+            result.push_back( t );
+          }
+        std::sort( result.begin(), result.end() );
+        return result;
+      }
+
+      static std::map< std::array< real, 3 >, uint32_t > index_positions( const indexed_mesh& m )
+      {
+        std::map< std::array< real, 3 >, uint32_t > result;
+        for( size_t i = 0; i < m.vertices.size(); ++ i )
+          result[ std::array< real, 3 >{{ m.vertices[ i ].x, m.vertices[ i ].y, m.vertices[ i ].z }} ] = uint32_t( i );
+        return result;
+      }
+
+      static void morton_code_interleaves_coordinates()
+      {
+        BOOST_REQUIRE_EQUAL( compute_morton_code( vec3{ 0, 0, 0 } ), 0u );
+        BOOST_REQUIRE_EQUAL( compute_morton_code( vec3{ 1, 1, 1 } ), ( uint64_t(1) << 63 ) - 1 );
+        BOOST_REQUIRE_EQUAL( compute_morton_code( cell_center( 1, 0, 0 ) ), 4u );
+        BOOST_REQUIRE_EQUAL( compute_morton_code( cell_center( 0, 1, 0 ) ), 2u );
+        BOOST_REQUIRE_EQUAL( compute_morton_code( cell_center( 0, 0, 1 ) ), 1u );
+        BOOST_REQUIRE_EQUAL( compute_morton_code( cell_center( 3, 2, 1 ) ), 0x35u );
+        // coordinates outside [0,1] are clamped
+        BOOST_REQUIRE_EQUAL( compute_morton_code( vec3{ -1, 2, 0 } ), compute_morton_code( vec3{ 0, 1, 0 } ) );
+      }
+
+      static void consecutive_hilbert_codes_are_adjacent_cells()
+      {
+        // the first 8^3 codes of the curve fill the 8x8x8 cells at the origin
+        const uint64_t side = 8;
+        std::vector< std::pair< uint64_t, std::array< uint64_t, 3 > > > cells;
+        for( uint64_t x = 0; x < side; ++ x )
+          for( uint64_t y = 0; y < side; ++ y )
+            for( uint64_t z = 0; z < side; ++ z )
+              cells.push_back( std::make_pair( compute_hilbert_code( cell_center( x, y, z ) ), std::array< uint64_t, 3 >{{ x, y, z }} ) );
+        std::sort( cells.begin(), cells.end() );
+
+        for( size_t i = 0; i < cells.size(); ++ i )
+          {
+            BOOST_REQUIRE_EQUAL( cells[ i ].first, i );
+            if( !i )
+              continue;
+            uint64_t distance = 0;
+            for( int k = 0; k < 3; ++ k )
+              {
+                const uint64_t a = cells[ i - 1 ].second[ k ], b = cells[ i ].second[ k ];
+                distance += a > b ? a - b : b - a;
+              }
+            BOOST_REQUIRE_EQUAL( distance, 1u );
+          }
+      }
+
+      static void spatial_order_sorts_points_by_code()
+      {
+        const std::vector< vec3 > points = make_points( 5000, 29 );
+        const aabox box( vec3{ -1, -1, -1 }, vec3{ 1, 1, 1 } );
+        const space_filling_curve curves[] = { space_filling_curve::morton, space_filling_curve::hilbert };
+        for( auto curve : curves )
+          {
+            std::vector< uint32_t > order;
+            compute_spatial_order( points.data(), points.size(), box, curve, order );
+            BOOST_REQUIRE( is_permutation( order, points.size() ) );
+
+            uint64_t previous = 0;
+            for( auto i : order )
+              {
+                const vec3 p = ( points[ i ] - vec3{ -1, -1, -1 } ) * real(0.5);
+                const uint64_t code = curve == space_filling_curve::morton ? compute_morton_code( p ) : compute_hilbert_code( p );
+                BOOST_REQUIRE_LE( previous, code );
+                previous = code;
+              }
+          }
+      }
+
+      static void reordered_indexed_mesh_has_the_same_triangles()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 48, 24 );
+        const auto reference = index_positions( sphere );
+        const auto expected = get_triangles( sphere, reference );
+
+        indexed_mesh m = sphere;
+        std::vector< uint32_t > vertex_order, face_order;
+        spatially_reorder( m, space_filling_curve::hilbert, &vertex_order, &face_order );
+        BOOST_REQUIRE( is_permutation( vertex_order, sphere.get_number_of_vertices() ) );
+        BOOST_REQUIRE( is_permutation( face_order, sphere.get_number_of_faces() ) );
+        for( size_t i = 0; i < vertex_order.size(); ++ i )
+          BOOST_REQUIRE( m.vertices[ i ] == sphere.vertices[ vertex_order[ i ] ] );
+        for( size_t i = 0; i < face_order.size(); ++ i )
+          for( int k = 0; k < 3; ++ k )
+            BOOST_REQUIRE( m.vertices[ m.indices[ 3 * i + k ] ] == sphere.vertices[ sphere.indices[ 3 * face_order[ i ] + k ] ] );
+        BOOST_REQUIRE( get_triangles( m, reference ) == expected );
+        BOOST_REQUIRE( is_closed_manifold( m ) );
+      }
+
+      static void reordered_mesh_has_the_same_triangles()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 48, 24 );
+        const auto reference = index_positions( sphere );
+        const auto expected = get_triangles( sphere, reference );
+
+        mesh m;
+        sphere.to_mesh( m );
+        BOOST_REQUIRE_EQUAL( spatially_reorder( m, space_filling_curve::morton ), 0u );
+        BOOST_REQUIRE_EQUAL( m.n_vertices(), sphere.get_number_of_vertices() );
+        BOOST_REQUIRE( get_triangles( indexed_mesh( m ), reference ) == expected );
+      }
+
+      test_suite* space_filling_curve_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("space filling curve");
+        ADD_TEST_CASE( morton_code_interleaves_coordinates );
+        ADD_TEST_CASE( consecutive_hilbert_codes_are_adjacent_cells );
+        ADD_TEST_CASE( spatial_order_sorts_points_by_code );
+        ADD_TEST_CASE( reordered_indexed_mesh_has_the_same_triangles );
+        ADD_TEST_CASE( reordered_mesh_has_the_same_triangles );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,78 @@
+# include "common.h"
+# include "geometry_points.h"
+# include "../../graphics-origin/geometry/spatial_grid.h"
+# include <vector>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static void spatial_grid_radius_search_matches_brute_force()
+      {
+        const auto points = make_points( 5000, 21 );
+        const auto locations = make_points( 300, 22 );
+        // queries smaller, equal and larger than the cells
+        const real radii[] = { 0.05, 0.1, 0.35 };
+        const spatial_grid grid( points.data(), points.size(), 0.1 );
+        BOOST_REQUIRE_EQUAL( grid.get_number_of_points(), points.size() );
+
+        std::vector< std::pair< spatial_grid::point_index, real > > neighbors;
+        for( auto radius : radii )
+          {
+            std::vector< size_t > offsets( locations.size() + 1 );
+            size_t total = 0;
+            for( size_t i = 0; i < locations.size(); ++ i )
+              {
+                const auto expected = brute_force_radius_search( points, locations[ i ], radius );
+                total += expected.size();
+                BOOST_REQUIRE_EQUAL( grid.count_in_radius( locations[ i ], radius ), expected.size() );
+                grid.radius_search( locations[ i ], radius, neighbors );
+                BOOST_REQUIRE_EQUAL( neighbors.size(), expected.size() );
+                for( size_t j = 0; j < neighbors.size(); ++ j )
+                  BOOST_REQUIRE_EQUAL( neighbors[ j ].second, expected[ j ].second );
+              }
+            BOOST_REQUIRE_EQUAL( grid.count_in_radius( locations.data(), locations.size(), radius, offsets.data() ), total );
+
+            point_neighborhoods neighborhoods;
+            grid.radius_search( locations.data(), locations.size(), radius, neighborhoods );
+            BOOST_REQUIRE( neighborhoods.offsets == offsets );
+            for( size_t i = 0; i < locations.size(); ++ i )
+              {
+                std::vector< uint32_t > expected;
+                for( const auto& n : brute_force_radius_search( points, locations[ i ], radius ) )
+                  expected.push_back( n.first );
+                std::sort( expected.begin(), expected.end() );
+                BOOST_REQUIRE( sorted_indices( neighborhoods.begin( i ), neighborhoods.end( i ) ) == expected );
+              }
+          }
+      }
+
+      static void spatial_grid_all_neighbors_match_brute_force()
+      {
+        const auto points = make_points( 3000, 23 );
+        const real radius = 0.1;
+        const spatial_grid grid( points.data(), points.size(), radius );
+        point_neighborhoods neighborhoods;
+        grid.compute_all_neighbors( radius, neighborhoods );
+        BOOST_REQUIRE_EQUAL( neighborhoods.offsets.size(), points.size() + 1 );
+        for( size_t i = 0; i < points.size(); ++ i )
+          {
+            std::vector< uint32_t > expected;
+            for( const auto& n : brute_force_radius_search( points, points[ i ], radius ) )
+              if( n.first != i )
+                expected.push_back( n.first );
+            std::sort( expected.begin(), expected.end() );
+            BOOST_REQUIRE( sorted_indices( neighborhoods.begin( i ), neighborhoods.end( i ) ) == expected );
+          }
+      }
+
+      test_suite* spatial_grid_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("spatial grid");
+        ADD_TEST_CASE( spatial_grid_radius_search_matches_brute_force );
+        ADD_TEST_CASE( spatial_grid_all_neighbors_match_brute_force );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,216 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/streaming_mesh.h"
+# include <boost/filesystem.hpp>
+# include <algorithm>
+# include <fstream>
+# include <map>
+# include <sstream>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      namespace bf = boost::filesystem;
+
+      /**Write a binary PLY file with properties that the streaming mesh
+       * must skip: a color before the position and a quality per face. If
+       * mixed_types is true, x and z are stored as doubles and y as a float. */
+      static void write_binary_ply( const indexed_mesh& m, const std::string& filename, bool mixed_types = false )
+      {
+        std::ofstream output( filename, std::ios::binary );
+        const char* xz_type = mixed_types ? "double" : "float";
+        output << "ply\nformat binary_little_endian 1.0\n"
+               << "element vertex " << m.get_number_of_vertices() << "\n"
+               << "property uchar red\nproperty " << xz_type << " x\nproperty float y\nproperty " << xz_type << " z\n"
+               << "element face " << m.get_number_of_faces() << "\n"
+               << "property list uchar int vertex_indices\nproperty float quality\n"
+               << "end_header\n";
+        for( const auto& v : m.vertices )
+          {
+            const unsigned char red = 255;
+            output.write( reinterpret_cast< const char* >( &red ), 1 );
+            if( mixed_types )
+              {
+                const double x = v.x, z = v.z;
+                const float y = float( v.y );
+                output.write( reinterpret_cast< const char* >( &x ), sizeof( x ) );
+                output.write( reinterpret_cast< const char* >( &y ), sizeof( y ) );
+                output.write( reinterpret_cast< const char* >( &z ), sizeof( z ) );
+              }
+            else
+              {
+                const float p[3] = { float( v.x ), float( v.y ), float( v.z ) };
+                output.write( reinterpret_cast< const char* >( p ), sizeof( p ) );
+              }
+          }
+        for( size_t f = 0; f < m.get_number_of_faces(); ++ f )
+          {
+            const unsigned char n = 3;
+            const int32_t indices[3] = { int32_t( m.indices[ 3 * f ] ), int32_t( m.indices[ 3 * f + 1 ] ), int32_t( m.indices[ 3 * f + 2 ] ) };
+            const float quality = 1;
+            output.write( reinterpret_cast< const char* >( &n ), 1 );
+            output.write( reinterpret_cast< const char* >( indices ), sizeof( indices ) );
+            output.write( reinterpret_cast< const char* >( &quality ), sizeof( quality ) );
+          }
+      }
+
+      /**Read a binary PLY file as written by streaming_mesh::simplify(). */
+      static bool read_binary_ply( const std::string& filename, indexed_mesh& m )
+      {
+        std::ifstream input( filename, std::ios::binary );
+        std::string line;
+        size_t nvertices = 0, nfaces = 0;
+        while( std::getline( input, line ) && line != "end_header" )
+          {
+            std::istringstream words( line );
+            std::string keyword, name;
+            words >> keyword >> name;
+            if( keyword == "element" && name == "vertex" )
+              words >> nvertices;
+            else if( keyword == "element" && name == "face" )
+              words >> nfaces;
+          }
+        m.vertices.resize( nvertices );
+        m.indices.resize( 3 * nfaces );
+        for( auto& v : m.vertices )
+          {
+            float p[3];
+            input.read( reinterpret_cast< char* >( p ), sizeof( p ) );
+            v = vec3{ p[0], p[1], p[2] };
+          }
+        for( size_t f = 0; f < nfaces; ++ f )
+          {
+            unsigned char n = 0;
+            int32_t indices[3];
+            input.read( reinterpret_cast< char* >( &n ), 1 );
+            input.read( reinterpret_cast< char* >( indices ), sizeof( indices ) );
+            if( n != 3 )
+              return false;
+            for( int k = 0; k < 3; ++ k )
+              m.indices[ 3 * f + k ] = uint32_t( indices[ k ] );
+          }
+        return bool( input );
+      }
+
+      static void streaming_mesh_round_trip()
+      {
+        const bf::path directory = bf::temp_directory_path() / bf::unique_path( "graphics-origin-test-%%%%-%%%%" );
+        BOOST_REQUIRE( bf::create_directories( directory ) );
+        const std::string input_filename = ( directory / "input.ply" ).string();
+
+        // an ellipsoid whose positions are exactly representable as floats
+        indexed_mesh sphere;
+        make_sphere( sphere, 64, 32 );
+        for( auto& v : sphere.vertices )
+          v = vec3{ float( v.x * 2 ), float( v.y ), float( v.z * real(0.5) ) };
+        write_binary_ply( sphere, input_filename );
+
+        {
+          streaming_parameters parameters;
+          parameters.chunk_size = 300;
+          parameters.max_faces_per_tile = 200;
+          parameters.temporary_directory = directory.string();
+          streaming_mesh streamed;
+          BOOST_REQUIRE( streamed.load( input_filename, parameters ) );
+          BOOST_REQUIRE_EQUAL( streamed.get_number_of_vertices(), sphere.get_number_of_vertices() );
+          BOOST_REQUIRE_EQUAL( streamed.get_number_of_faces(), sphere.get_number_of_faces() );
+          BOOST_REQUIRE_GT( streamed.get_number_of_tiles(), 10u );
+          BOOST_REQUIRE_GT( streamed.get_number_of_shared_vertices(), 0u );
+          size_t nfaces = 0;
+          for( size_t i = 0; i < streamed.get_number_of_tiles(); ++ i )
+            nfaces += streamed.get_tile_number_of_faces( i );
+          BOOST_REQUIRE_EQUAL( nfaces, sphere.get_number_of_faces() );
+
+          // normals of shared vertices gather the contributions of all tiles
+          const std::string normals_filename = ( directory / "normals.bin" ).string();
+          BOOST_REQUIRE( streamed.compute_vertex_normals( normals_filename ) );
+          std::vector< vec3 > expected;
+          compute_vertex_normals( sphere, expected );
+          std::vector< float > normals( 3 * expected.size() );
+          std::ifstream( normals_filename, std::ios::binary ).read( reinterpret_cast< char* >( normals.data() ), normals.size() * sizeof( float ) );
+          for( size_t i = 0; i < expected.size(); ++ i )
+            BOOST_REQUIRE_SMALL( length( vec3{ normals[ 3 * i ], normals[ 3 * i + 1 ], normals[ 3 * i + 2 ] } - expected[ i ] ), 1e-5 );
+
+          // shared vertices are locked, so the decimated mesh stays closed
+          const std::string decimated_filename = ( directory / "decimated.ply" ).string();
+          BOOST_REQUIRE( streamed.simplify( decimated_filename, 0.25 ) );
+          indexed_mesh decimated;
+          BOOST_REQUIRE( read_binary_ply( decimated_filename, decimated ) );
+          BOOST_REQUIRE_LT( decimated.get_number_of_faces(), sphere.get_number_of_faces() / 2 );
+          std::map< std::pair< uint32_t, uint32_t >, int > edges;
+          std::vector< bool > used( decimated.get_number_of_vertices(), false );
+          for( size_t f = 0; f < decimated.get_number_of_faces(); ++ f )
+            for( int k = 0; k < 3; ++ k )
+              {
+                const uint32_t a = decimated.indices[ 3 * f + k ];
+                BOOST_REQUIRE_LT( a, decimated.get_number_of_vertices() );
+                used[ a ] = true;
+                ++edges[ std::make_pair( a, decimated.indices[ 3 * f + ( k + 1 ) % 3 ] ) ];
+              }
+          for( const auto& e : edges )
+            {
+              BOOST_REQUIRE_EQUAL( e.second, 1 );
+              BOOST_REQUIRE( edges.count( std::make_pair( e.first.second, e.first.first ) ) );
+            }
+          BOOST_REQUIRE( std::find( used.begin(), used.end(), false ) == used.end() );
+          // Euler characteristic of a sphere
+          BOOST_REQUIRE_EQUAL( decimated.get_number_of_vertices() + decimated.get_number_of_faces(), edges.size() / 2 + 2 );
+
+          // tiles are removed with the streaming mesh
+          streamed.clear();
+          size_t nentries = 0;
+          for( bf::directory_iterator it( directory ), end; it != end; ++ it )
+            ++nentries;
+          BOOST_REQUIRE_EQUAL( nentries, 3u );
+        }
+        bf::remove_all( directory );
+      }
+
+      static void streaming_mesh_reads_each_coordinate_type()
+      {
+        const bf::path directory = bf::temp_directory_path() / bf::unique_path( "graphics-origin-test-%%%%-%%%%" );
+        BOOST_REQUIRE( bf::create_directories( directory ) );
+        const std::string input_filename = ( directory / "input.ply" ).string();
+        indexed_mesh sphere;
+        make_sphere( sphere, 32, 16 );
+        write_binary_ply( sphere, input_filename, true );
+
+        {
+          streaming_parameters parameters;
+          parameters.max_faces_per_tile = 200;
+          parameters.temporary_directory = directory.string();
+          streaming_mesh streamed;
+          BOOST_REQUIRE( streamed.load( input_filename, parameters ) );
+
+          // tiles keep the positions of the file at full precision
+          size_t nvertices = 0;
+          for( size_t t = 0; t < streamed.get_number_of_tiles(); ++ t )
+            {
+              streaming_tile tile;
+              BOOST_REQUIRE( streamed.load_tile( t, tile ) );
+              for( size_t i = 0; i < tile.mesh.get_number_of_vertices(); ++ i )
+                {
+                  const vec3& expected = sphere.vertices[ tile.global_indices[ i ] ];
+                  const vec3& p = tile.mesh.vertices[ i ];
+                  BOOST_REQUIRE_EQUAL( p.x, expected.x );
+                  BOOST_REQUIRE_EQUAL( p.y, real( float( expected.y ) ) );
+                  BOOST_REQUIRE_EQUAL( p.z, expected.z );
+                }
+              nvertices += tile.mesh.get_number_of_vertices();
+            }
+          BOOST_REQUIRE_GE( nvertices, sphere.get_number_of_vertices() );
+        }
+        bf::remove_all( directory );
+      }
+
+      test_suite* streaming_mesh_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("streaming mesh");
+        ADD_TEST_CASE( streaming_mesh_round_trip );
+        ADD_TEST_CASE( streaming_mesh_reads_each_coordinate_type );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,113 @@
+# include "common.h"
+# include "geometry_meshes.h"
+# include "../../graphics-origin/geometry/voxelizer.h"
+# include <cmath>
+namespace graphics_origin {
+  namespace geometry {
+    namespace test {
+
+      static const real pi = real( 3.14159265358979323846 );
+
+      static real ball_volume( real radius )
+      {
+        return real(4) / real(3) * pi * radius * radius * radius;
+      }
+
+      static void voxelizer_sphere_volumes()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 64, 32 );
+        const uint32_t resolution = 64;
+
+        voxel_grid surface, parity, winding;
+        voxelize( sphere, resolution, voxelization_mode::surface, surface );
+        voxelize( sphere, resolution, voxelization_mode::parity, parity );
+        voxelize( sphere, resolution, voxelization_mode::winding, winding );
+        const real v = surface.voxel_size;
+        BOOST_REQUIRE_CLOSE( v * resolution, 2.0, 1e-6 );
+
+        // every point of the sphere is in a surface voxel or in a voxel
+        // whose center is inside, and no voxel is too far from the sphere
+        const real inner_radius = std::cos( pi / 32 ) * std::cos( pi / 64 );
+        const real solid_volume = parity.compute_volume();
+        BOOST_REQUIRE_GT( solid_volume, ball_volume( inner_radius ) );
+        BOOST_REQUIRE_LT( solid_volume, ball_volume( 1 + std::sqrt( real(3) ) * v ) );
+
+        const real surface_volume = surface.compute_volume();
+        BOOST_REQUIRE_GT( surface_volume, 0 );
+        BOOST_REQUIRE_LT( surface_volume,
+          ball_volume( 1 + std::sqrt( real(3) ) * v ) - ball_volume( inner_radius - std::sqrt( real(3) ) * v ) );
+
+        // a single closed component has the same inside for both rules, and
+        // surface voxels are part of the solid
+        BOOST_REQUIRE( parity.bits == winding.bits );
+        for( uint32_t z = 0; z < resolution; ++ z )
+          for( uint32_t y = 0; y < resolution; ++ y )
+            for( uint32_t x = 0; x < resolution; ++ x )
+              if( surface.get( x, y, z ) )
+                BOOST_REQUIRE( parity.get( x, y, z ) );
+        BOOST_REQUIRE_LT( surface.count_voxels(), parity.count_voxels() );
+        BOOST_REQUIRE_CLOSE( solid_volume, real( parity.count_voxels() ) * v * v * v, 1e-9 );
+      }
+
+      static void voxelizer_brick_map_matches_dense_grid()
+      {
+        indexed_mesh sphere;
+        make_sphere( sphere, 48, 24, 1.5, vec3{ 0.3, -0.2, 0.1 } );
+        const voxelization_mode modes[] = { voxelization_mode::surface, voxelization_mode::parity };
+        for( auto mode : modes )
+          {
+            voxel_brick_map sparse;
+            voxel_grid dense;
+            voxelize( sphere, 70, mode, sparse );
+            voxelize( sphere, 70, mode, dense );
+            BOOST_REQUIRE_EQUAL( sparse.count_voxels(), dense.count_voxels() );
+            BOOST_REQUIRE_CLOSE( sparse.compute_volume(), dense.compute_volume(), 1e-9 );
+            for( uint32_t z = 0; z < dense.resolution[2]; ++ z )
+              for( uint32_t y = 0; y < dense.resolution[1]; ++ y )
+                for( uint32_t x = 0; x < dense.resolution[0]; ++ x )
+                  BOOST_REQUIRE_EQUAL( sparse.get( x, y, z ), dense.get( x, y, z ) );
+          }
+      }
+
+      static void voxelizer_overlapping_components()
+      {
+        // two overlapping boxes: their intersection is crossed twice along x,
+        // so it is empty with the parity rule and filled with the winding rule
+        indexed_mesh boxes, second;
+        make_box( boxes, vec3{ 0, 0, 0 }, vec3{ 2, 1, 1 } );
+        make_box( second, vec3{ 1, 0, 0 }, vec3{ 3, 1, 1 } );
+        const uint32_t offset = uint32_t( boxes.vertices.size() );
+        boxes.vertices.insert( boxes.vertices.end(), second.vertices.begin(), second.vertices.end() );
+        for( auto index : second.indices )
+          boxes.indices.push_back( index + offset );
+
+        voxel_grid parity, winding;
+        voxelize( boxes, 60, voxelization_mode::parity, parity );
+        voxelize( boxes, 60, voxelization_mode::winding, winding );
+        const real v = winding.voxel_size;
+        BOOST_REQUIRE_GE( winding.compute_volume(), real(3) );
+        BOOST_REQUIRE_LT( winding.compute_volume(), ( 3 + 2 * v ) * ( 1 + 2 * v ) * ( 1 + 2 * v ) );
+        // only surface voxels remain in the overlap with the parity rule
+        BOOST_REQUIRE_LT( parity.compute_volume(), winding.compute_volume() - std::pow( 1 - 4 * v, 3 ) );
+
+        // the center of the overlap
+        const uint32_t x = uint32_t( ( real(1.5) - winding.origin.x ) / v );
+        const uint32_t y = uint32_t( ( real(0.5) - winding.origin.y ) / v );
+        const uint32_t z = uint32_t( ( real(0.5) - winding.origin.z ) / v );
+        BOOST_REQUIRE( winding.get( x, y, z ) );
+        BOOST_REQUIRE( !parity.get( x, y, z ) );
+      }
+
+      test_suite* voxelizer_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("voxelizer");
+        ADD_TEST_CASE( voxelizer_sphere_volumes );
+        ADD_TEST_CASE( voxelizer_brick_map_matches_dense_grid );
+        ADD_TEST_CASE( voxelizer_overlapping_components );
+        return suite;
+      }
+
+    }
+  }
+}
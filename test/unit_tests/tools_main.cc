@@ -5,11 +5,15 @@ namespace graphics_origin {
     namespace test {
 
       extern test_suite* memory_test_suite();
+      extern test_suite* tight_buffer_manager_test_suite();
+      extern test_suite* tight_soa_buffer_manager_test_suite();
 
       void add_test_suite()
       {
         test_suite* suite = BOOST_TEST_SUITE("TOOLS LIBRARY");
         ADD_TO_SUITE( memory_test_suite );
+        ADD_TO_SUITE( tight_buffer_manager_test_suite );
+        ADD_TO_SUITE( tight_soa_buffer_manager_test_suite );
         ADD_TO_MASTER( suite );
       }
 
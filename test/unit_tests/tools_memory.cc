@@ -7,6 +7,12 @@ namespace graphics_origin {
       test_suite* memory_area_test_suite();
       test_suite* bounds_checking_test_suite();
       test_suite* memory_arena_test_suite();
+      test_suite* thread_policy_test_suite();
+      test_suite* pool_test_suite();
+      test_suite* tlsf_test_suite();
+      test_suite* memory_tracking_test_suite();
+      test_suite* arena_allocator_test_suite();
+      test_suite* virtual_memory_test_suite();
 
       test_suite* memory_test_suite()
       {
@@ -14,6 +20,12 @@ namespace graphics_origin {
         ADD_TO_SUITE( memory_area_test_suite );
         ADD_TO_SUITE( bounds_checking_test_suite );
         ADD_TO_SUITE( memory_arena_test_suite );
+        ADD_TO_SUITE( thread_policy_test_suite );
+        ADD_TO_SUITE( pool_test_suite );
+        ADD_TO_SUITE( tlsf_test_suite );
+        ADD_TO_SUITE( memory_tracking_test_suite );
+        ADD_TO_SUITE( arena_allocator_test_suite );
+        ADD_TO_SUITE( virtual_memory_test_suite );
         return suite;
       }
     }
@@ -0,0 +1,167 @@
+# include "common.h"
+# include "../../graphics-origin/tools/arena_allocator.h"
+# include <cstring>
+# include <unordered_map>
+# include <vector>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      typedef memory_arena<
+          allocation_policy::linear,
+          thread_policy::single_thread,
+          bounds_checking_policy::no,
+          memory_tracking_policy::no,
+          memory_tagging_policy::no > linear_arena;
+
+      typedef memory_arena<
+          allocation_policy::tlsf,
+          thread_policy::single_thread,
+          bounds_checking_policy::per_allocation,
+          memory_tracking_policy::per_callsite,
+          memory_tagging_policy::yes > tracked_arena;
+
+      static void arena_allocator_vector_in_linear_arena()
+      {
+        memory_area::on_stack< 4096 > area;
+        allocation_policy::linear allocator( area );
+        linear_arena arena( &allocator );
+
+        std::vector< uint32_t, arena_allocator< uint32_t, linear_arena > > values( arena );
+        values.reserve( 100 );
+        for( uint32_t i = 0; i < 100; ++ i )
+          values.push_back( i );
+
+        const char* begin = reinterpret_cast< const char* >( area.begin() );
+        const char* end = reinterpret_cast< const char* >( area.end() );
+        BOOST_REQUIRE( reinterpret_cast< const char* >( values.data() ) >= begin );
+        BOOST_REQUIRE( reinterpret_cast< const char* >( values.data() + values.size() ) <= end );
+        for( uint32_t i = 0; i < 100; ++ i )
+          BOOST_REQUIRE_EQUAL( values[ i ], i );
+      }
+
+      static void arena_allocator_throw_when_exhausted()
+      {
+        memory_area::on_stack< 256 > area;
+        allocation_policy::linear allocator( area );
+        linear_arena arena( &allocator );
+
+        std::vector< uint64_t, arena_allocator< uint64_t, linear_arena > > values( arena );
+        BOOST_REQUIRE_THROW( values.reserve( 1000 ), std::bad_alloc );
+      }
+
+      static void arena_allocator_unordered_map_frees_everything()
+      {
+        memory_area::on_heap area( 1 << 20 );
+        allocation_policy::tlsf allocator( area );
+        tracked_arena arena( &allocator );
+        {
+          typedef arena_allocator< std::pair< const int, double >, tracked_arena > allocator_type;
+          std::unordered_map< int, double, std::hash< int >, std::equal_to< int >, allocator_type >
+            map( 16, std::hash< int >(), std::equal_to< int >(), allocator_type( arena ) );
+          for( int i = 0; i < 1000; ++ i )
+            map[ i ] = double( i ) / 2;
+          for( int i = 0; i < 1000; i += 2 )
+            map.erase( i );
+          BOOST_REQUIRE_EQUAL( map.size(), 500u );
+          BOOST_REQUIRE_EQUAL( map[ 501 ], 250.5 );
+          BOOST_REQUIRE_GT( arena.get_memory_tracker().get_number_of_allocations(), 500u );
+        }
+        BOOST_REQUIRE_EQUAL( arena.get_memory_tracker().get_number_of_allocations(), 0u );
+      }
+
+      static void arena_allocator_propagation()
+      {
+        memory_area::on_heap area1( 1 << 16 ), area2( 1 << 16 );
+        allocation_policy::tlsf allocator1( area1 ), allocator2( area2 );
+        tracked_arena arena1( &allocator1 ), arena2( &allocator2 );
+        typedef arena_allocator< int, tracked_arena > allocator_type;
+        typedef std::vector< int, allocator_type > vector_type;
+
+        BOOST_REQUIRE(( allocator_type( arena1 ) == arena_allocator< double, tracked_arena >( arena1 ) ));
+        BOOST_REQUIRE( allocator_type( arena1 ) != allocator_type( arena2 ) );
+        {
+          vector_type a( 10, 1, allocator_type( arena1 ) );
+          vector_type b( 20, 2, allocator_type( arena2 ) );
+
+          // a copy constructed vector uses the same arena
+          vector_type c( a );
+          BOOST_REQUIRE( c.get_allocator() == a.get_allocator() );
+
+          // a copy assigned vector keeps its arena
+          c = b;
+          BOOST_REQUIRE( c.get_allocator().get_arena() == &arena1 );
+          BOOST_REQUIRE_EQUAL( c.size(), 20u );
+
+          // a move assigned vector takes the arena, and the memory, of the other
+          const int* data = b.data();
+          a = std::move( b );
+          BOOST_REQUIRE( a.get_allocator().get_arena() == &arena2 );
+          BOOST_REQUIRE_EQUAL( a.data(), data );
+
+          // swap exchanges the arenas
+          a.swap( c );
+          BOOST_REQUIRE( a.get_allocator().get_arena() == &arena1 );
+          BOOST_REQUIRE( c.get_allocator().get_arena() == &arena2 );
+        }
+        BOOST_REQUIRE_EQUAL( arena1.get_memory_tracker().get_number_of_allocations(), 0u );
+        BOOST_REQUIRE_EQUAL( arena2.get_memory_tracker().get_number_of_allocations(), 0u );
+      }
+
+      static void arena_allocator_reports_its_callsite()
+      {
+        memory_area::on_heap area( 1 << 16 );
+        allocation_policy::tlsf allocator( area );
+        tracked_arena arena( &allocator );
+        {
+          // the rebound allocators of the map keep the callsite
+          typedef std::pair< const int, int > value_type;
+          std::unordered_map< int, int, std::hash< int >, std::equal_to< int >, arena_allocator< value_type, tracked_arena > >
+            map( 16, std::hash< int >(), std::equal_to< int >(), go_arena_allocator( value_type, arena ) );
+          for( int i = 0; i < 100; ++ i )
+            map[ i ] = i;
+          const auto& callsites = arena.get_memory_tracker().get_callsites();
+          BOOST_REQUIRE_EQUAL( callsites.size(), 1u );
+          BOOST_REQUIRE_EQUAL( std::strcmp( callsites[0].file, __FILE__ ), 0 );
+          BOOST_REQUIRE_EQUAL( callsites[0].live_count, arena.get_memory_tracker().get_number_of_allocations() );
+        }
+        BOOST_REQUIRE_EQUAL( arena.get_memory_tracker().get_number_of_allocations(), 0u );
+      }
+
+# ifdef GO_HAS_MEMORY_RESOURCE
+      static void arena_memory_resource_pmr_vector()
+      {
+        memory_area::on_heap area( 1 << 16 );
+        allocation_policy::tlsf allocator( area );
+        tracked_arena arena( &allocator );
+        arena_memory_resource< tracked_arena > resource( arena );
+        {
+          std::pmr::vector< double > values( &resource );
+          for( int i = 0; i < 1000; ++ i )
+            values.push_back( double( i ) );
+          BOOST_REQUIRE_EQUAL( values[ 999 ], 999.0 );
+          BOOST_REQUIRE_GT( arena.get_memory_tracker().get_number_of_allocations(), 0u );
+        }
+        BOOST_REQUIRE_EQUAL( arena.get_memory_tracker().get_number_of_allocations(), 0u );
+        BOOST_REQUIRE( resource.is_equal( resource ) );
+        BOOST_REQUIRE( !resource.is_equal( *std::pmr::new_delete_resource() ) );
+      }
+# endif
+
+      test_suite* arena_allocator_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("arena allocator");
+        ADD_TEST_CASE( arena_allocator_vector_in_linear_arena );
+        ADD_TEST_CASE( arena_allocator_throw_when_exhausted );
+        ADD_TEST_CASE( arena_allocator_unordered_map_frees_everything );
+        ADD_TEST_CASE( arena_allocator_propagation );
+        ADD_TEST_CASE( arena_allocator_reports_its_callsite );
+# ifdef GO_HAS_MEMORY_RESOURCE
+        ADD_TEST_CASE( arena_memory_resource_pmr_vector );
+# endif
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,162 @@
+# include "common.h"
+# include "../../graphics-origin/tools/memory.h"
+# include <set>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      struct alignas(16) pool_element {
+        pool_element( uint32_t i )
+          : value{ i }
+        {}
+        uint32_t value;
+        float data[5];
+      };
+
+      typedef memory_arena<
+          allocation_policy::pool,
+          thread_policy::single_thread,
+          bounds_checking_policy::per_allocation,
+          memory_tracking_policy::no,
+          memory_tagging_policy::yes > checked_pool_arena;
+
+      static void pool_aligned_allocations()
+      {
+        static constexpr size_t instances = 100;
+        memory_area::on_heap area( instances * 64 + 16 );
+        allocation_policy::pool allocator(
+            area,
+            allocation_policy::pool::get_slot_size< bounds_checking_policy::per_allocation >( sizeof(pool_element) ),
+            alignof(pool_element),
+            allocation_policy::pool::get_user_offset< bounds_checking_policy::per_allocation >() );
+        checked_pool_arena arena( &allocator );
+
+        for( size_t i = 0; i < instances; ++ i )
+          {
+            pool_element* e = go_new( pool_element, arena )( uint32_t( i ) );
+            BOOST_REQUIRE( e != nullptr );
+            BOOST_REQUIRE_EQUAL( reinterpret_cast< uintptr_t >( e ) & 15, 0u );
+            BOOST_REQUIRE_EQUAL( e->value, uint32_t( i ) );
+          }
+      }
+
+      static void pool_exhausted()
+      {
+        memory_area::on_heap area( 1024 );
+        allocation_policy::pool allocator( area, 64, 8, allocation_policy::pool::size_front );
+        size_t count = 0;
+        while( allocator.allocate( 64, 8, allocation_policy::pool::size_front ) )
+          ++ count;
+        BOOST_REQUIRE_EQUAL( count, 1024u / 64 );
+      }
+
+      static void pool_reuse_freed_slots()
+      {
+        memory_area::on_heap area( 1024 );
+        allocation_policy::pool allocator( area, 64, 8, allocation_policy::pool::size_front );
+        std::vector< void* > allocations;
+        while( void* ptr = allocator.allocate( 64, 8, allocation_policy::pool::size_front ) )
+          allocations.push_back( ptr );
+
+        // free in arbitrary order, then allocate again
+        std::set< void* > freed;
+        for( size_t i = 1; i < allocations.size(); i += 3 )
+          {
+            allocator.deallocate( allocations[ i ] );
+            freed.insert( allocations[ i ] );
+          }
+        for( size_t i = 0; i < freed.size(); ++ i )
+          {
+            void* ptr = allocator.allocate( 64, 8, allocation_policy::pool::size_front );
+            BOOST_REQUIRE( freed.count( ptr ) );
+          }
+        BOOST_REQUIRE( allocator.allocate( 64, 8, allocation_policy::pool::size_front ) == nullptr );
+      }
+
+      static void pool_allocation_size()
+      {
+        memory_area::on_heap area( 1024 );
+        allocation_policy::pool allocator( area, 64, 8, allocation_policy::pool::size_front );
+        void* ptr = allocator.allocate( 40, 8, allocation_policy::pool::size_front );
+        BOOST_REQUIRE_EQUAL( allocator.get_allocation_size( ptr ), 40u );
+      }
+
+      static void pool_keep_tags_of_freed_memory()
+      {
+        memory_area::on_heap area( 1024 );
+        allocation_policy::pool allocator(
+            area,
+            allocation_policy::pool::get_slot_size< bounds_checking_policy::per_allocation >( sizeof(uint64_t) ),
+            alignof(uint64_t),
+            allocation_policy::pool::get_user_offset< bounds_checking_policy::per_allocation >() );
+        checked_pool_arena arena( &allocator );
+
+        uint64_t* a = go_new( uint64_t, arena )( 1 );
+        uint64_t* b = go_new( uint64_t, arena )( 2 );
+        go_delete( a, arena );
+        go_delete( b, arena );
+        const uint32_t* words = reinterpret_cast< const uint32_t* >( a );
+        const uint32_t deallocated_word = memory_tagging_policy::yes::deallocated_word;
+        BOOST_REQUIRE_EQUAL( words[0], deallocated_word );
+        BOOST_REQUIRE_EQUAL( words[1], deallocated_word );
+
+        // bounds are checked again on the reused slots
+        uint64_t* c = go_new( uint64_t, arena )( 3 );
+        BOOST_REQUIRE( c == b );
+        go_delete( c, arena );
+      }
+
+      static void growing_pool_commit_on_demand()
+      {
+        const size_t page_size = virtual_memory::get_page_size();
+        allocation_policy::growing_pool allocator( page_size * 64, page_size, 64, 8, allocation_policy::growing_pool::size_front );
+        BOOST_REQUIRE_EQUAL( allocator.get_committed_memory(), 0u );
+
+        std::vector< uint64_t* > allocations;
+        for( size_t i = 0; i < page_size / 64; ++ i )
+          {
+            uint64_t* ptr = static_cast< uint64_t* >( allocator.allocate( 64, 8, allocation_policy::growing_pool::size_front ) );
+            ptr[1] = i;
+            allocations.push_back( ptr );
+          }
+        BOOST_REQUIRE_EQUAL( allocator.get_committed_memory(), page_size );
+
+        allocations.push_back( static_cast< uint64_t* >( allocator.allocate( 64, 8, allocation_policy::growing_pool::size_front ) ) );
+        BOOST_REQUIRE_EQUAL( allocator.get_committed_memory(), 2 * page_size );
+        for( size_t i = 0; i < page_size / 64; ++ i )
+          BOOST_REQUIRE_EQUAL( allocations[ i ][1], i );
+
+        // freed slots are reused before committing more memory
+        for( auto ptr : allocations )
+          allocator.deallocate( ptr );
+        for( size_t i = 0; i < allocations.size(); ++ i )
+          allocator.allocate( 64, 8, allocation_policy::growing_pool::size_front );
+        BOOST_REQUIRE_EQUAL( allocator.get_committed_memory(), 2 * page_size );
+      }
+
+      static void growing_pool_exhausted()
+      {
+        const size_t page_size = virtual_memory::get_page_size();
+        allocation_policy::growing_pool allocator( page_size * 2, page_size, 64, 8, allocation_policy::growing_pool::size_front );
+        size_t count = 0;
+        while( allocator.allocate( 64, 8, allocation_policy::growing_pool::size_front ) )
+          ++ count;
+        BOOST_REQUIRE_EQUAL( count, 2 * page_size / 64 );
+      }
+
+      test_suite* pool_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("pool");
+        ADD_TEST_CASE( pool_aligned_allocations );
+        ADD_TEST_CASE( pool_exhausted );
+        ADD_TEST_CASE( pool_reuse_freed_slots );
+        ADD_TEST_CASE( pool_allocation_size );
+        ADD_TEST_CASE( pool_keep_tags_of_freed_memory );
+        ADD_TEST_CASE( growing_pool_commit_on_demand );
+        ADD_TEST_CASE( growing_pool_exhausted );
+        return suite;
+      }
+
+    }
+  }
+}
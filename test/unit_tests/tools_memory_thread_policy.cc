@@ -0,0 +1,222 @@
+# include "common.h"
+# include "../../graphics-origin/tools/memory.h"
+# include <set>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      static constexpr int number_of_threads = 8;
+      static constexpr int increments_per_thread = 20000;
+
+      template< class policy >
+      static void check_mutual_exclusion()
+      {
+        policy guard;
+        // not atomic on purpose: only the critical section protects it
+        volatile int counter = 0;
+        # pragma omp parallel num_threads(number_of_threads)
+        {
+          for( int i = 0; i < increments_per_thread; ++ i )
+            {
+              guard.enter();
+                counter = counter + 1;
+              guard.leave();
+            }
+        }
+        BOOST_REQUIRE_EQUAL( counter, number_of_threads * increments_per_thread );
+      }
+
+      static void mutex_mutual_exclusion()
+      {
+        check_mutual_exclusion< thread_policy::mutex >();
+      }
+
+      static void spinlock_mutual_exclusion()
+      {
+        check_mutual_exclusion< thread_policy::spinlock >();
+      }
+
+      static void spinlock_arena_concurrent_allocations()
+      {
+        static constexpr int allocations_per_thread = 1000;
+        memory_area::on_heap area( number_of_threads * allocations_per_thread * 32 );
+        allocation_policy::linear allocator( area );
+        memory_arena<
+          allocation_policy::linear,
+          thread_policy::spinlock,
+          bounds_checking_policy::per_allocation,
+          memory_tracking_policy::no,
+          memory_tagging_policy::no > arena( &allocator );
+
+        std::vector< uint32_t* > allocations( number_of_threads * allocations_per_thread, nullptr );
+        # pragma omp parallel for num_threads(number_of_threads)
+        for( int i = 0; i < number_of_threads * allocations_per_thread; ++ i )
+          {
+            allocations[ i ] = go_new( uint32_t, arena );
+            *allocations[ i ] = uint32_t( i );
+          }
+
+        std::set< uint32_t* > distinct( allocations.begin(), allocations.end() );
+        BOOST_REQUIRE_EQUAL( distinct.size(), allocations.size() );
+        for( int i = 0; i < number_of_threads * allocations_per_thread; ++ i )
+          {
+            BOOST_REQUIRE_EQUAL( *allocations[ i ], uint32_t( i ) );
+            go_delete( allocations[ i ], arena );
+          }
+      }
+
+      typedef memory_arena<
+          allocation_policy::linear,
+          thread_policy::mutex,
+          bounds_checking_policy::no,
+          memory_tracking_policy::no,
+          memory_tagging_policy::no > parent_arena;
+
+      static void thread_cache_concurrent_allocations()
+      {
+        static constexpr int allocations_per_thread = 1000;
+        memory_area::on_heap area( 1 << 20 );
+        allocation_policy::linear allocator( area );
+        parent_arena parent( &allocator );
+        allocation_policy::thread_cache< parent_arena > cache( parent, 4096, number_of_threads );
+        memory_arena<
+          allocation_policy::thread_cache< parent_arena >,
+          thread_policy::single_thread,
+          bounds_checking_policy::per_allocation,
+          memory_tracking_policy::no,
+          memory_tagging_policy::no > arena( &cache );
+
+        std::vector< double* > allocations( number_of_threads * allocations_per_thread, nullptr );
+        # pragma omp parallel for num_threads(number_of_threads)
+        for( int i = 0; i < number_of_threads * allocations_per_thread; ++ i )
+          {
+            allocations[ i ] = go_new_align( double, 16, arena );
+            *allocations[ i ] = double( i );
+          }
+
+        std::set< double* > distinct( allocations.begin(), allocations.end() );
+        BOOST_REQUIRE_EQUAL( distinct.size(), allocations.size() );
+        for( int i = 0; i < number_of_threads * allocations_per_thread; ++ i )
+          {
+            BOOST_REQUIRE_EQUAL( reinterpret_cast< uintptr_t >( allocations[ i ] ) & 15, 0u );
+            BOOST_REQUIRE_EQUAL( *allocations[ i ], double( i ) );
+            go_delete( allocations[ i ], arena );
+          }
+      }
+
+      static void thread_cache_refills_only_when_exhausted()
+      {
+        memory_area::on_heap area( 1 << 20 );
+        allocation_policy::linear allocator( area );
+        parent_arena parent( &allocator );
+        allocation_policy::thread_cache< parent_arena > cache( parent, 1024, 1 );
+
+        BOOST_REQUIRE_EQUAL( cache.get_number_of_chunks(), 0u );
+        cache.allocate( 16, 8, allocation_policy::thread_cache< parent_arena >::size_front );
+        BOOST_REQUIRE_EQUAL( cache.get_number_of_chunks(), 1u );
+        for( int i = 0; i < 30; ++ i )
+          cache.allocate( 16, 8, allocation_policy::thread_cache< parent_arena >::size_front );
+        BOOST_REQUIRE_EQUAL( cache.get_number_of_chunks(), 1u );
+        for( int i = 0; i < 100; ++ i )
+          cache.allocate( 16, 8, allocation_policy::thread_cache< parent_arena >::size_front );
+        BOOST_REQUIRE_GT( cache.get_number_of_chunks(), 1u );
+      }
+
+      static void thread_cache_large_allocation()
+      {
+        memory_area::on_heap area( 1 << 20 );
+        allocation_policy::linear allocator( area );
+        parent_arena parent( &allocator );
+        allocation_policy::thread_cache< parent_arena > cache( parent, 1024, 1 );
+
+        char* ptr = static_cast< char* >( cache.allocate( 10000, 8, 0 ) );
+        BOOST_REQUIRE( ptr != nullptr );
+        BOOST_REQUIRE_EQUAL( cache.get_allocation_size( ptr ), 10000u );
+        // the large chunk must be usable entirely
+        for( size_t i = sizeof(uint32_t); i < 10000; ++ i )
+          ptr[ i ] = char( i );
+      }
+
+      static void thread_cache_reset_reuses_chunks()
+      {
+        memory_area::on_heap area( 1 << 20 );
+        allocation_policy::linear allocator( area );
+        parent_arena parent( &allocator );
+        allocation_policy::thread_cache< parent_arena > cache( parent, 1024, 1 );
+
+        void* first = cache.allocate( 256, 8, 0 );
+        for( int i = 0; i < 20; ++ i )
+          cache.allocate( 256, 8, 0 );
+        const size_t chunks = cache.get_number_of_chunks();
+
+        cache.reset();
+        BOOST_REQUIRE_EQUAL( cache.allocate( 256, 8, 0 ), first );
+        for( int i = 0; i < 20; ++ i )
+          cache.allocate( 256, 8, 0 );
+        BOOST_REQUIRE_EQUAL( cache.get_number_of_chunks(), chunks );
+      }
+
+      static void thread_cache_more_threads_than_slots()
+      {
+        static constexpr int allocations_per_thread = 500;
+        memory_area::on_heap area( 1 << 20 );
+        allocation_policy::linear allocator( area );
+        parent_arena parent( &allocator );
+        allocation_policy::thread_cache< parent_arena > cache( parent, 1024, 1 );
+
+        std::vector< uint32_t* > allocations( number_of_threads * allocations_per_thread, nullptr );
+        # pragma omp parallel for num_threads(number_of_threads)
+        for( int i = 0; i < number_of_threads * allocations_per_thread; ++ i )
+          {
+            allocations[ i ] = static_cast< uint32_t* >( cache.allocate( 2 * sizeof(uint32_t), 4, sizeof(uint32_t) ) ) + 1;
+            *allocations[ i ] = uint32_t( i );
+          }
+
+        std::set< uint32_t* > distinct( allocations.begin(), allocations.end() );
+        BOOST_REQUIRE_EQUAL( distinct.size(), allocations.size() );
+        for( int i = 0; i < number_of_threads * allocations_per_thread; ++ i )
+          BOOST_REQUIRE_EQUAL( *allocations[ i ], uint32_t( i ) );
+      }
+
+      static void thread_index_reused_after_termination()
+      {
+        uint32_t first = 0, second = 0, third = 0;
+        std::thread( [&first]{ first = detail::get_thread_index(); } ).join();
+        std::thread( [&second]{ second = detail::get_thread_index(); } ).join();
+        BOOST_REQUIRE_EQUAL( first, second );
+
+        // a running thread keeps its index
+        std::atomic< bool > acquired{ false }, done{ false };
+        std::thread running( [&]{
+          second = detail::get_thread_index();
+          acquired = true;
+          while( !done )
+            std::this_thread::yield();
+        } );
+        while( !acquired )
+          std::this_thread::yield();
+        std::thread( [&third]{ third = detail::get_thread_index(); } ).join();
+        done = true;
+        running.join();
+        BOOST_REQUIRE_EQUAL( second, first );
+        BOOST_REQUIRE_NE( third, second );
+      }
+
+      test_suite* thread_policy_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("thread policy");
+        ADD_TEST_CASE( mutex_mutual_exclusion );
+        ADD_TEST_CASE( spinlock_mutual_exclusion );
+        ADD_TEST_CASE( spinlock_arena_concurrent_allocations );
+        ADD_TEST_CASE( thread_cache_concurrent_allocations );
+        ADD_TEST_CASE( thread_cache_refills_only_when_exhausted );
+        ADD_TEST_CASE( thread_cache_large_allocation );
+        ADD_TEST_CASE( thread_cache_reset_reuses_chunks );
+        ADD_TEST_CASE( thread_cache_more_threads_than_slots );
+        ADD_TEST_CASE( thread_index_reused_after_termination );
+        return suite;
+      }
+
+    }
+  }
+}
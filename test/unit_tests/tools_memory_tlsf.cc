@@ -0,0 +1,183 @@
+# include "common.h"
+# include "../../graphics-origin/tools/memory.h"
+# include <random>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      typedef memory_arena<
+          allocation_policy::tlsf,
+          thread_policy::single_thread,
+          bounds_checking_policy::per_allocation,
+          memory_tracking_policy::no,
+          memory_tagging_policy::yes > checked_tlsf_arena;
+
+      static void tlsf_one_free_block_at_start()
+      {
+        memory_area::on_heap area( 1 << 16 );
+        allocation_policy::tlsf allocator( area );
+        BOOST_REQUIRE_EQUAL( allocator.get_number_of_free_blocks(), 1u );
+        BOOST_REQUIRE_EQUAL( allocator.get_free_memory(), allocator.get_managed_memory() );
+        BOOST_REQUIRE_EQUAL( allocator.get_largest_free_block(), allocator.get_free_memory() );
+        BOOST_REQUIRE_SMALL( allocator.get_fragmentation(), 1e-12 );
+      }
+
+      static void tlsf_aligned_allocations()
+      {
+        memory_area::on_heap area( 1 << 16 );
+        allocation_policy::tlsf allocator( area );
+        for( size_t alignment = 1; alignment <= 256; alignment <<= 1 )
+          {
+            char* ptr = static_cast< char* >( allocator.allocate( 100, alignment, 12 ) );
+            BOOST_REQUIRE( ptr != nullptr );
+            BOOST_REQUIRE_EQUAL( reinterpret_cast< uintptr_t >( ptr + 12 ) % alignment, 0u );
+            BOOST_REQUIRE_EQUAL( allocator.get_allocation_size( ptr ), 100u );
+          }
+      }
+
+      static void tlsf_unaligned_offset()
+      {
+        memory_area::on_heap area( 1 << 16 );
+        allocation_policy::tlsf allocator( area );
+        const size_t managed = allocator.get_managed_memory();
+
+        // the user memory starts 12 bytes after the allocation, which cannot
+        // be at the beginning of a block
+        std::vector< char* > allocations;
+        for( int i = 0; i < 100; ++ i )
+          {
+            char* ptr = static_cast< char* >( allocator.allocate( 40, 8, 12 ) );
+            BOOST_REQUIRE_EQUAL( reinterpret_cast< uintptr_t >( ptr + 12 ) & 7, 0u );
+            for( size_t j = 8; j < 40; ++ j )
+              ptr[ j ] = char( i );
+            allocations.push_back( ptr );
+          }
+        for( int i = 0; i < 100; ++ i )
+          for( size_t j = 8; j < 40; ++ j )
+            BOOST_REQUIRE_EQUAL( allocations[ i ][ j ], char( i ) );
+        for( auto ptr : allocations )
+          allocator.deallocate( ptr );
+        BOOST_REQUIRE_EQUAL( allocator.get_free_memory(), managed );
+      }
+
+      static void tlsf_exhausted()
+      {
+        memory_area::on_heap area( 1 << 12 );
+        allocation_policy::tlsf allocator( area );
+        BOOST_REQUIRE( allocator.allocate( 1 << 12, 8, allocation_policy::tlsf::size_front ) == nullptr );
+        size_t count = 0;
+        while( allocator.allocate( 64, 8, allocation_policy::tlsf::size_front ) )
+          ++ count;
+        BOOST_REQUIRE_GT( count, 0u );
+        BOOST_REQUIRE_LE( count, ( 1u << 12 ) / 64 );
+      }
+
+      static void tlsf_merge_freed_blocks()
+      {
+        memory_area::on_heap area( 1 << 16 );
+        allocation_policy::tlsf allocator( area );
+        const size_t managed = allocator.get_managed_memory();
+
+        std::vector< void* > allocations;
+        for( size_t i = 0; i < 100; ++ i )
+          allocations.push_back( allocator.allocate( 16 + 8 * i, 8, allocation_policy::tlsf::size_front ) );
+
+        // free every other block: no merge is possible
+        for( size_t i = 0; i < allocations.size(); i += 2 )
+          allocator.deallocate( allocations[ i ] );
+        BOOST_REQUIRE_EQUAL( allocator.get_number_of_free_blocks(), allocations.size() / 2 + 1 );
+        BOOST_REQUIRE_GT( allocator.get_fragmentation(), 0.0 );
+
+        for( size_t i = 1; i < allocations.size(); i += 2 )
+          allocator.deallocate( allocations[ i ] );
+        BOOST_REQUIRE_EQUAL( allocator.get_number_of_free_blocks(), 1u );
+        BOOST_REQUIRE_EQUAL( allocator.get_free_memory(), managed );
+      }
+
+      static void tlsf_random_allocations_keep_content()
+      {
+        memory_area::on_heap area( 1 << 22 );
+        allocation_policy::tlsf allocator( area );
+        checked_tlsf_arena arena( &allocator );
+        const size_t managed = allocator.get_managed_memory();
+
+        std::mt19937 generator( 42 );
+        std::uniform_int_distribution< uint32_t > sizes( 1, 4096 );
+        struct allocation {
+          uint8_t* data;
+          uint32_t size;
+        };
+        std::vector< allocation > allocations;
+        for( int step = 0; step < 20000; ++ step )
+          {
+            if( allocations.size() < 200 && ( allocations.empty() || generator() % 3 ) )
+              {
+                const uint32_t size = sizes( generator );
+                uint8_t* data = static_cast< uint8_t* >( arena.allocate( size, 16, __FILE__, "", "" ) );
+                BOOST_REQUIRE( data != nullptr );
+                BOOST_REQUIRE_EQUAL( reinterpret_cast< uintptr_t >( data ) & 15, 0u );
+                for( uint32_t i = 0; i < size; ++ i )
+                  data[ i ] = uint8_t( size + i );
+                allocations.push_back( allocation{ data, size } );
+              }
+            else
+              {
+                const size_t index = generator() % allocations.size();
+                const allocation a = allocations[ index ];
+                for( uint32_t i = 0; i < a.size; ++ i )
+                  BOOST_REQUIRE_EQUAL( a.data[ i ], uint8_t( a.size + i ) );
+                arena.deallocate( a.data );
+                allocations[ index ] = allocations.back();
+                allocations.pop_back();
+              }
+          }
+        for( auto& a : allocations )
+          arena.deallocate( a.data );
+        BOOST_REQUIRE_EQUAL( allocator.get_number_of_free_blocks(), 1u );
+        BOOST_REQUIRE_EQUAL( allocator.get_free_memory(), managed );
+      }
+
+      static void growing_tlsf_commit_on_demand()
+      {
+        const size_t page_size = virtual_memory::get_page_size();
+        allocation_policy::growing_tlsf allocator( page_size * 256, page_size );
+        BOOST_REQUIRE_EQUAL( allocator.get_committed_memory(), 0u );
+
+        std::vector< uint64_t* > allocations;
+        for( size_t i = 0; i < 100; ++ i )
+          {
+            uint64_t* ptr = static_cast< uint64_t* >( allocator.allocate( 1000, 8, allocation_policy::tlsf::size_front ) );
+            BOOST_REQUIRE( ptr != nullptr );
+            ptr[1] = i;
+            allocations.push_back( ptr );
+          }
+        const size_t committed = allocator.get_committed_memory();
+        BOOST_REQUIRE_GE( committed, 100 * 1000u );
+        BOOST_REQUIRE_LE( committed, 100 * 1000u + 100 * page_size );
+        for( size_t i = 0; i < allocations.size(); ++ i )
+          BOOST_REQUIRE_EQUAL( allocations[ i ][1], i );
+
+        // a large allocation after the freed memory merges with the last block
+        for( auto ptr : allocations )
+          allocator.deallocate( ptr );
+        BOOST_REQUIRE_EQUAL( allocator.get_number_of_free_blocks(), 1u );
+        BOOST_REQUIRE( allocator.allocate( committed + page_size, 8, allocation_policy::tlsf::size_front ) != nullptr );
+        BOOST_REQUIRE( allocator.allocate( page_size * 256, 8, allocation_policy::tlsf::size_front ) == nullptr );
+      }
+
+      test_suite* tlsf_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("tlsf");
+        ADD_TEST_CASE( tlsf_one_free_block_at_start );
+        ADD_TEST_CASE( tlsf_aligned_allocations );
+        ADD_TEST_CASE( tlsf_unaligned_offset );
+        ADD_TEST_CASE( tlsf_exhausted );
+        ADD_TEST_CASE( tlsf_merge_freed_blocks );
+        ADD_TEST_CASE( tlsf_random_allocations_keep_content );
+        ADD_TEST_CASE( growing_tlsf_commit_on_demand );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -0,0 +1,105 @@
+# include "common.h"
+# include "../../graphics-origin/tools/memory.h"
+# include <random>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      typedef memory_arena<
+          allocation_policy::tlsf,
+          thread_policy::single_thread,
+          bounds_checking_policy::no,
+          memory_tracking_policy::per_callsite,
+          memory_tagging_policy::no > tracked_arena;
+
+      static void per_callsite_aggregate_allocations()
+      {
+        memory_area::on_heap area( 1 << 16 );
+        allocation_policy::tlsf allocator( area );
+        tracked_arena arena( &allocator );
+        const auto& tracker = arena.get_memory_tracker();
+
+        std::vector< uint64_t* > first, second;
+        for( int i = 0; i < 10; ++ i )
+          first.push_back( go_new( uint64_t, arena ) );
+        for( int i = 0; i < 5; ++ i )
+          second.push_back( go_new( uint64_t, arena ) );
+
+        const size_t allocation_size = sizeof(uint64_t) + allocation_policy::tlsf::size_front;
+        BOOST_REQUIRE_EQUAL( tracker.get_callsites().size(), 2u );
+        BOOST_REQUIRE_EQUAL( tracker.get_number_of_allocations(), 15u );
+        BOOST_REQUIRE_EQUAL( tracker.get_live_bytes(), 15 * allocation_size );
+        BOOST_REQUIRE_EQUAL( tracker.get_callsites()[0].live_count, 10u );
+        BOOST_REQUIRE_EQUAL( tracker.get_callsites()[1].live_count, 5u );
+        BOOST_REQUIRE_EQUAL( tracker.get_callsites()[1].live_bytes, 5 * allocation_size );
+
+        for( int i = 0; i < 4; ++ i )
+          go_delete( first[ i ], arena );
+        go_delete( second.back(), arena );
+        second.pop_back();
+        second.push_back( go_new( uint64_t, arena ) );
+
+        const auto& c = tracker.get_callsites()[0];
+        BOOST_REQUIRE_EQUAL( c.live_count, 6u );
+        BOOST_REQUIRE_EQUAL( c.total_count, 10u );
+        BOOST_REQUIRE_EQUAL( c.peak_count, 10u );
+        BOOST_REQUIRE_EQUAL( c.peak_bytes, 10 * allocation_size );
+        BOOST_REQUIRE_EQUAL( tracker.get_callsites().size(), 3u );
+        BOOST_REQUIRE_EQUAL( tracker.get_peak_bytes(), 15 * allocation_size );
+
+        for( int i = 4; i < 10; ++ i )
+          go_delete( first[ i ], arena );
+        for( auto ptr : second )
+          go_delete( ptr, arena );
+        BOOST_REQUIRE_EQUAL( tracker.get_number_of_allocations(), 0u );
+        BOOST_REQUIRE_EQUAL( tracker.get_live_bytes(), 0u );
+        BOOST_REQUIRE_EQUAL( tracker.report_leaks(), 0u );
+      }
+
+      static void per_callsite_random_allocations()
+      {
+        memory_area::on_heap area( 1 << 22 );
+        allocation_policy::tlsf allocator( area );
+        tracked_arena arena( &allocator );
+        const auto& tracker = arena.get_memory_tracker();
+
+        std::mt19937 generator( 3 );
+        std::vector< void* > live;
+        size_t bytes = 0;
+        for( int step = 0; step < 20000; ++ step )
+          {
+            if( live.empty() || generator() % 2 )
+              {
+                const size_t size = 1 + generator() % 256;
+                live.push_back( arena.allocate( size, 8, "file", "line", "function" ) );
+                bytes += size + allocation_policy::tlsf::size_front;
+              }
+            else
+              {
+                const size_t index = generator() % live.size();
+                bytes -= allocator.get_allocation_size( static_cast< char* >( live[ index ] ) - allocation_policy::tlsf::size_front );
+                arena.deallocate( live[ index ] );
+                live[ index ] = live.back();
+                live.pop_back();
+              }
+            BOOST_REQUIRE_EQUAL( tracker.get_number_of_allocations(), live.size() );
+            BOOST_REQUIRE_EQUAL( tracker.get_live_bytes(), bytes );
+          }
+        BOOST_REQUIRE_EQUAL( tracker.get_callsites().size(), 1u );
+        BOOST_REQUIRE_EQUAL( tracker.report_leaks(), live.size() );
+        for( auto ptr : live )
+          arena.deallocate( ptr );
+        BOOST_REQUIRE_EQUAL( tracker.get_number_of_allocations(), 0u );
+      }
+
+      test_suite* memory_tracking_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("memory tracking");
+        ADD_TEST_CASE( per_callsite_aggregate_allocations );
+        ADD_TEST_CASE( per_callsite_random_allocations );
+        return suite;
+      }
+
+    }
+  }
+}
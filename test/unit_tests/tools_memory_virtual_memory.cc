@@ -0,0 +1,99 @@
+# include "common.h"
+# include "../../graphics-origin/tools/memory.h"
+# include <cstring>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      static void virtual_memory_commit_and_decommit()
+      {
+        const size_t page_size = virtual_memory::get_page_size();
+        const size_t size = page_size * 64;
+        char* start = static_cast< char* >( virtual_memory::allocate_address_space( size ) );
+        BOOST_REQUIRE( start != nullptr );
+
+        BOOST_REQUIRE( virtual_memory::commit_memory( start, size ) );
+        std::memset( start, 0xAB, size );
+        BOOST_REQUIRE_EQUAL( start[ size - 1 ], char( 0xAB ) );
+
+        // decommitted memory is zero once committed again
+        virtual_memory::decommit_memory( start + page_size * 32, page_size * 32 );
+        BOOST_REQUIRE( virtual_memory::commit_memory( start + page_size * 32, page_size * 32 ) );
+        BOOST_REQUIRE_EQUAL( start[ page_size * 32 - 1 ], char( 0xAB ) );
+        BOOST_REQUIRE_EQUAL( start[ page_size * 32 ], 0 );
+        BOOST_REQUIRE_EQUAL( start[ size - 1 ], 0 );
+
+        virtual_memory::free_address_space( start, size );
+      }
+
+      static void virtual_memory_huge_pages()
+      {
+        const size_t huge_page_size = virtual_memory::get_huge_page_size();
+        if( !huge_page_size )
+          return;
+        const size_t size = huge_page_size * 4;
+        const virtual_memory::page_kind kinds[] = {
+          virtual_memory::page_kind::transparent_huge,
+          virtual_memory::page_kind::explicit_huge };
+        for( auto kind : kinds )
+          {
+            char* start = static_cast< char* >( virtual_memory::allocate_address_space( size, kind ) );
+            BOOST_REQUIRE( start != nullptr );
+            BOOST_REQUIRE_EQUAL( reinterpret_cast< uintptr_t >( start ) % huge_page_size, 0u );
+            BOOST_REQUIRE( virtual_memory::commit_memory( start, huge_page_size * 2 ) );
+            std::memset( start, 1, huge_page_size * 2 );
+            virtual_memory::decommit_memory( start + huge_page_size, huge_page_size );
+            BOOST_REQUIRE_EQUAL( start[ huge_page_size - 1 ], 1 );
+            virtual_memory::free_address_space( start, size, kind );
+          }
+
+        // a size that is not a multiple of the page size is rounded
+        const size_t odd_size = size + 100;
+        char* start = static_cast< char* >( virtual_memory::allocate_address_space( odd_size, virtual_memory::page_kind::transparent_huge ) );
+        BOOST_REQUIRE( start != nullptr );
+        BOOST_REQUIRE_EQUAL( reinterpret_cast< uintptr_t >( start ) % huge_page_size, 0u );
+        BOOST_REQUIRE( virtual_memory::commit_memory( start, odd_size ) );
+        start[ odd_size - 1 ] = 1;
+        virtual_memory::free_address_space( start, odd_size, virtual_memory::page_kind::transparent_huge );
+      }
+
+      static void virtual_memory_numa_binding()
+      {
+        const int node = virtual_memory::get_current_numa_node();
+        if( node < 0 )
+          return;
+        const size_t page_size = virtual_memory::get_page_size();
+        allocation_policy::growing_stack allocator( page_size * 64, page_size );
+        // binding can be forbidden in some sandboxes, but must not prevent the allocations
+        allocator.bind_to_numa_node( node );
+        BOOST_REQUIRE( !allocator.bind_to_numa_node( -1 ) );
+        uint32_t* ptr = static_cast< uint32_t* >( allocator.allocate( 1000, 8, allocation_policy::growing_stack::size_front ) );
+        BOOST_REQUIRE( ptr != nullptr );
+        ptr[ 100 ] = 42;
+        BOOST_REQUIRE_EQUAL( ptr[ 100 ], 42u );
+      }
+
+      static void growing_stack_stays_usable_when_exhausted()
+      {
+        const size_t page_size = virtual_memory::get_page_size();
+        allocation_policy::growing_stack allocator( page_size * 4, page_size );
+        BOOST_REQUIRE( allocator.allocate( page_size * 8, 8, 8 ) == nullptr );
+        char* ptr = static_cast< char* >( allocator.allocate( page_size, 8, 8 ) );
+        BOOST_REQUIRE( ptr != nullptr );
+        ptr[ page_size - 1 ] = 1;
+        BOOST_REQUIRE_EQUAL( allocator.get_committed_memory(), page_size );
+      }
+
+      test_suite* virtual_memory_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("virtual memory");
+        ADD_TEST_CASE( virtual_memory_commit_and_decommit );
+        ADD_TEST_CASE( virtual_memory_huge_pages );
+        ADD_TEST_CASE( virtual_memory_numa_binding );
+        ADD_TEST_CASE( growing_stack_stays_usable_when_exhausted );
+        return suite;
+      }
+
+    }
+  }
+}
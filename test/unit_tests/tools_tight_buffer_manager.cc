@@ -0,0 +1,214 @@
+# include "common.h"
+# include "../../graphics-origin/tools/tight_buffer_manager.h"
+# include <vector>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      struct tb_element {
+        tb_element()
+          : value{ 0 }, payload{}
+        {}
+        uint32_t value;
+        float payload[7];
+      };
+
+      typedef tight_buffer_manager< tb_element, uint32_t, 20 > tb_manager;
+
+      static void tight_buffer_handles_survive_removals()
+      {
+        const tight_buffer_growth growths[] = { tight_buffer_growth::reallocate, tight_buffer_growth::commit_in_place };
+        for( auto growth : growths )
+          {
+            tb_manager buffer( 0, growth );
+            std::vector< tb_manager::handle > handles;
+            for( uint32_t i = 0; i < 10000; ++ i )
+              {
+                auto pair = buffer.create();
+                pair.second.value = i;
+                handles.push_back( pair.first );
+              }
+            for( uint32_t i = 0; i < 10000; i += 3 )
+              buffer.remove( handles[ i ] );
+            for( uint32_t i = 0; i < 10000; ++ i )
+              if( i % 3 )
+                BOOST_REQUIRE_EQUAL( buffer.get( handles[ i ] ).value, i );
+              else
+                BOOST_REQUIRE_THROW( buffer.get( handles[ i ] ), tight_buffer_manager_invalid_handle );
+            BOOST_REQUIRE_EQUAL( buffer.get_size(), 10000u - 3334u );
+          }
+      }
+
+      static void tight_buffer_handles_survive_creations_after_removals()
+      {
+        tb_manager buffer;
+        std::vector< tb_manager::handle > handles;
+        for( uint32_t i = 0; i < 1000; ++ i )
+          {
+            auto pair = buffer.create();
+            pair.second.value = i;
+            handles.push_back( pair.first );
+          }
+        // the last elements take the place of the removed ones, and new
+        // elements are created after them
+        for( uint32_t i = 0; i < 1000; i += 2 )
+          buffer.remove( handles[ i ] );
+        buffer.remove( &buffer.get_by_index( 0 ) );
+        for( uint32_t i = 1000; i < 1500; ++ i )
+          {
+            auto pair = buffer.create();
+            pair.second.value = i;
+            handles.push_back( pair.first );
+          }
+        BOOST_REQUIRE_EQUAL( buffer.get_size(), 999u );
+        for( size_t i = 0; i < buffer.get_size(); ++ i )
+          BOOST_REQUIRE_EQUAL( &buffer.get( buffer.get_handle( i ) ), &buffer.get_by_index( i ) );
+        for( uint32_t i = 1; i < 1500; i += 2 )
+          if( i != 999 )
+            BOOST_REQUIRE_EQUAL( buffer.get( handles[ i ] ).value, i );
+        for( uint32_t i = 1000; i < 1500; ++ i )
+          BOOST_REQUIRE_EQUAL( buffer.get( handles[ i ] ).value, i );
+      }
+
+      static void tight_buffer_commit_in_place_never_moves()
+      {
+        tb_manager buffer( 0, tight_buffer_growth::commit_in_place );
+        BOOST_REQUIRE( buffer.get_growth() == tight_buffer_growth::commit_in_place );
+        auto first = buffer.create();
+        first.second.value = 42;
+        tb_element* data = buffer.data();
+        for( uint32_t i = 0; i < 100000; ++ i )
+          buffer.create();
+        BOOST_REQUIRE_EQUAL( buffer.data(), data );
+        BOOST_REQUIRE_EQUAL( &buffer.get( first.first ), data );
+        BOOST_REQUIRE_EQUAL( data->value, 42u );
+        BOOST_REQUIRE_GE( buffer.get_capacity(), 100001u );
+        // capacity grows by small increments, not by doubling
+        BOOST_REQUIRE_LT( buffer.get_capacity(), 100001u + ( size_t(64) << 10 ) / sizeof(tb_element) + 1 );
+      }
+
+      static void tight_buffer_commit_in_place_up_to_max_capacity()
+      {
+        typedef tight_buffer_manager< uint64_t, uint32_t, 10 > small_manager;
+        small_manager buffer( 0, tight_buffer_growth::commit_in_place );
+        for( size_t i = 0; i < small_manager::get_max_capacity(); ++ i )
+          buffer.create().second = i;
+        BOOST_REQUIRE_THROW( buffer.create(), tight_buffer_manager_buffer_overflow );
+        for( size_t i = 0; i < buffer.get_size(); ++ i )
+          BOOST_REQUIRE_EQUAL( buffer.get_by_index( i ), i );
+      }
+
+      static void tight_buffer_create_n()
+      {
+        const tight_buffer_growth growths[] = { tight_buffer_growth::reallocate, tight_buffer_growth::commit_in_place };
+        for( auto growth : growths )
+          {
+            tb_manager buffer( 0, growth );
+            buffer.create().second.value = 42;
+            std::vector< tb_manager::handle > handles( 5000 );
+            tb_element* first = buffer.create_n( handles.size(), handles.data() );
+            BOOST_REQUIRE_EQUAL( first, buffer.data() + 1 );
+            BOOST_REQUIRE_EQUAL( buffer.get_size(), 5001u );
+            for( uint32_t i = 0; i < handles.size(); ++ i )
+              first[ i ].value = i;
+            for( uint32_t i = 0; i < handles.size(); ++ i )
+              BOOST_REQUIRE_EQUAL( buffer.get( handles[ i ] ).value, i );
+            BOOST_REQUIRE_EQUAL( buffer.data()->value, 42u );
+          }
+
+        typedef tight_buffer_manager< uint64_t, uint32_t, 10 > small_manager;
+        small_manager small;
+        small.create_n( 1000 );
+        BOOST_REQUIRE_THROW( small.create_n( small_manager::get_max_capacity() ), tight_buffer_manager_buffer_overflow );
+        BOOST_REQUIRE_EQUAL( small.get_size(), 1000u );
+      }
+
+      static void tight_buffer_collect( bool keep_order )
+      {
+        const tight_buffer_growth growths[] = { tight_buffer_growth::reallocate, tight_buffer_growth::commit_in_place };
+        for( auto growth : growths )
+          {
+            tb_manager buffer( 0, growth );
+            std::vector< tb_manager::handle > handles( 10000 );
+            tb_element* elements = buffer.create_n( handles.size(), handles.data() );
+            for( uint32_t i = 0; i < handles.size(); ++ i )
+              elements[ i ].value = i;
+
+            // mark elements while iterating: no element is skipped
+            tb_element* e = buffer.data();
+            for( size_t i = 0; i < buffer.get_size(); ++ i, ++ e )
+              if( e->value % 3 == 0 || e->value > 9000 )
+                buffer.mark_for_removal( e );
+            buffer.mark_for_removal( handles[ 1 ] );
+            buffer.mark_for_removal( handles[ 1 ] );
+            BOOST_REQUIRE_EQUAL( buffer.get_garbage_size(), 3334u + 666u + 1u );
+            BOOST_REQUIRE_EQUAL( buffer.get_size(), 10000u );
+            BOOST_REQUIRE_THROW( buffer.get( handles[ 1 ] ), tight_buffer_manager_invalid_handle );
+
+            if( keep_order )
+              buffer.collect_stable();
+            else
+              buffer.collect();
+            BOOST_REQUIRE_EQUAL( buffer.get_garbage_size(), 0u );
+            BOOST_REQUIRE_EQUAL( buffer.get_size(), 10000u - 4001u );
+            for( uint32_t i = 0; i < handles.size(); ++ i )
+              if( i % 3 == 0 || i > 9000 || i == 1 )
+                BOOST_REQUIRE_THROW( buffer.get( handles[ i ] ), tight_buffer_manager_invalid_handle );
+              else
+                BOOST_REQUIRE_EQUAL( buffer.get( handles[ i ] ).value, i );
+            for( size_t i = 0; i < buffer.get_size(); ++ i )
+              BOOST_REQUIRE_EQUAL( &buffer.get( buffer.get_handle( i ) ), &buffer.get_by_index( i ) );
+            if( keep_order )
+              for( size_t i = 1; i < buffer.get_size(); ++ i )
+                BOOST_REQUIRE_LT( buffer.get_by_index( i - 1 ).value, buffer.get_by_index( i ).value );
+
+            // freed handles are recycled
+            const size_t capacity = buffer.get_capacity();
+            std::vector< tb_manager::handle > new_handles( 4001 );
+            elements = buffer.create_n( new_handles.size(), new_handles.data() );
+            for( uint32_t i = 0; i < new_handles.size(); ++ i )
+              elements[ i ].value = 10000 + i;
+            BOOST_REQUIRE_EQUAL( buffer.get_size(), 10000u );
+            BOOST_REQUIRE_EQUAL( buffer.get_capacity(), capacity );
+
+            // collect again, with the buffers of the previous collection
+            for( uint32_t i = 0; i < new_handles.size(); i += 2 )
+              buffer.mark_for_removal( new_handles[ i ] );
+            if( keep_order )
+              buffer.collect_stable();
+            else
+              buffer.collect();
+            BOOST_REQUIRE_EQUAL( buffer.get_size(), 10000u - 2001u );
+            for( uint32_t i = 1; i < new_handles.size(); i += 2 )
+              BOOST_REQUIRE_EQUAL( buffer.get( new_handles[ i ] ).value, 10000 + i );
+            for( size_t i = 0; i < buffer.get_size(); ++ i )
+              BOOST_REQUIRE_EQUAL( &buffer.get( buffer.get_handle( i ) ), &buffer.get_by_index( i ) );
+          }
+      }
+
+      static void tight_buffer_collect_unstable()
+      {
+        tight_buffer_collect( false );
+      }
+
+      static void tight_buffer_collect_stable()
+      {
+        tight_buffer_collect( true );
+      }
+
+      test_suite* tight_buffer_manager_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("tight buffer manager");
+        ADD_TEST_CASE( tight_buffer_handles_survive_removals );
+        ADD_TEST_CASE( tight_buffer_handles_survive_creations_after_removals );
+        ADD_TEST_CASE( tight_buffer_commit_in_place_never_moves );
+        ADD_TEST_CASE( tight_buffer_commit_in_place_up_to_max_capacity );
+        ADD_TEST_CASE( tight_buffer_create_n );
+        ADD_TEST_CASE( tight_buffer_collect_unstable );
+        ADD_TEST_CASE( tight_buffer_collect_stable );
+        return suite;
+      }
+
+    }
+  }
+}
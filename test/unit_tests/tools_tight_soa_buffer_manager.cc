@@ -0,0 +1,92 @@
+# include "common.h"
+# include "../../graphics-origin/tools/tight_soa_buffer_manager.h"
+# include <string>
+# include <vector>
+namespace graphics_origin {
+  namespace tools {
+    namespace test {
+
+      typedef tight_soa_buffer_manager< uint32_t, 20, uint32_t, float, std::string > soa_manager;
+
+      static void tight_soa_buffer_create_and_remove()
+      {
+        const tight_buffer_growth growths[] = { tight_buffer_growth::reallocate, tight_buffer_growth::commit_in_place };
+        for( auto growth : growths )
+          {
+            soa_manager buffer( 0, growth );
+            std::vector< soa_manager::handle > handles;
+            for( uint32_t i = 0; i < 10000; ++ i )
+              handles.push_back( buffer.create( i, float( i ) * 0.5f, std::to_string( i ) ) );
+            for( uint32_t i = 0; i < 10000; i += 3 )
+              buffer.remove( handles[ i ] );
+            BOOST_REQUIRE_EQUAL( buffer.get_size(), 10000u - 3334u );
+
+            for( uint32_t i = 0; i < 10000; ++ i )
+              if( i % 3 )
+                {
+                  auto fields = buffer.get( handles[ i ] );
+                  BOOST_REQUIRE_EQUAL( std::get<0>( fields ), i );
+                  BOOST_REQUIRE_EQUAL( std::get<1>( fields ), float( i ) * 0.5f );
+                  BOOST_REQUIRE_EQUAL( buffer.get<2>( handles[ i ] ), std::to_string( i ) );
+                }
+              else
+                BOOST_REQUIRE_THROW( buffer.get( handles[ i ] ), tight_buffer_manager_invalid_handle );
+
+            // columns are tight
+            auto ids = buffer.column<0>();
+            BOOST_REQUIRE_EQUAL( ids.size(), buffer.get_size() );
+            for( size_t i = 0; i < ids.size(); ++ i )
+              {
+                BOOST_REQUIRE_NE( ids[ i ] % 3, 0u );
+                BOOST_REQUIRE_EQUAL( buffer.get_index( buffer.get_handle( i ) ), i );
+              }
+          }
+      }
+
+      static void tight_soa_buffer_sort_by_column()
+      {
+        soa_manager buffer;
+        std::vector< soa_manager::handle > handles;
+        for( uint32_t i = 0; i < 1000; ++ i )
+          handles.push_back( buffer.create( i, float( ( i * 7919 ) % 1000 ), std::to_string( i ) ) );
+        buffer.remove_by_index( 0 );
+
+        buffer.sort<1>( []( float a, float b ){ return a > b; } );
+        auto depths = buffer.column<1>();
+        for( size_t i = 1; i < depths.size(); ++ i )
+          BOOST_REQUIRE_GE( depths[ i - 1 ], depths[ i ] );
+        for( uint32_t i = 1; i < 1000; ++ i )
+          {
+            auto fields = buffer.get( handles[ i ] );
+            BOOST_REQUIRE_EQUAL( std::get<0>( fields ), i );
+            BOOST_REQUIRE_EQUAL( std::get<1>( fields ), float( ( i * 7919 ) % 1000 ) );
+            BOOST_REQUIRE_EQUAL( std::get<2>( fields ), std::to_string( i ) );
+          }
+
+        // the sort buffers are reused, and the handles stay valid
+        buffer.remove( handles[ 500 ] );
+        buffer.sort<0>( []( uint32_t a, uint32_t b ){ return a < b; } );
+        auto ids = buffer.column<0>();
+        auto names = buffer.column<2>();
+        BOOST_REQUIRE_EQUAL( ids.size(), 998u );
+        for( size_t i = 1; i < ids.size(); ++ i )
+          BOOST_REQUIRE_LT( ids[ i - 1 ], ids[ i ] );
+        for( size_t i = 0; i < ids.size(); ++ i )
+          {
+            BOOST_REQUIRE_EQUAL( names[ i ], std::to_string( ids[ i ] ) );
+            BOOST_REQUIRE_EQUAL( buffer.get_index( buffer.get_handle( i ) ), i );
+            BOOST_REQUIRE_EQUAL( buffer.get_index( handles[ ids[ i ] ] ), i );
+          }
+      }
+
+      test_suite* tight_soa_buffer_manager_test_suite()
+      {
+        test_suite* suite = BOOST_TEST_SUITE("tight soa buffer manager");
+        ADD_TEST_CASE( tight_soa_buffer_create_and_remove );
+        ADD_TEST_CASE( tight_soa_buffer_sort_by_column );
+        return suite;
+      }
+
+    }
+  }
+}
@@ -6,54 +6,10 @@
 # include "../../../graphics-origin/application/renderer.h"
 # include "../../../graphics-origin/application/gl_helper.h"
 # include <GL/glew.h>
+# include <functional>
 
 namespace graphics_origin {
   namespace application {
-    transparent_windows_renderable::storage::storage( const storage& other )
-       : center{ other.center }, v1{ other.v1 }, v2{ other.v2 },
-         color{ other.color }, depth{ other.depth }
-     {}
-
-   transparent_windows_renderable::storage&
-   transparent_windows_renderable::storage::operator=( const storage& other )
-    {
-      center = other.center;
-      v1 = other.v1;
-      v2 = other.v2;
-      color = other.color;
-      depth = other.depth;
-      return *this;
-    }
-
-   transparent_windows_renderable::storage&
-   transparent_windows_renderable::storage::operator=( storage&& other )
-  {
-    center = other.center;
-    v1 = other.v1;
-    v2 = other.v2;
-    color = other.color;
-    depth = other.depth;
-    return *this;
-  }
-
-   transparent_windows_renderable::storage::storage()
-    : depth{0}
-  {}
-
-  transparent_windows_renderable::storage_depth_computation::storage_depth_computation( const gl_mat4& view )
-    : eye{ -gl_vec3( view[3] ) * gl_mat3( view ) }, forward{ -view[0][2], -view[1][2], -view[2][2] }
-  {}
-
-  void transparent_windows_renderable::storage_depth_computation::operator()( storage& s ) const
-  {
-    s.depth = dot( forward, s.center - eye );
-  }
-
-  bool
-  transparent_windows_renderable::storage_depth_ordering::operator()( const storage& a, const storage& b ) const
-  {
-    return a.depth > b.depth;
-  }
   transparent_windows_renderable::transparent_windows_renderable(
       shader_program_ptr program,
       size_t expected_number_of_windows )
@@ -76,15 +32,10 @@ namespace graphics_origin {
       const gl_vec4& color )
   {
     m_dirty = true;
-    auto pair = m_windows.create();
-    pair.second.center = center;
-    pair.second.v1 = v1;
-    pair.second.v2 = v2;
-    pair.second.color = color;
-    return pair.first;
+    return m_windows.create( center, v1, v2, color, gl_real(0) );
   }
 
-  transparent_windows_renderable::storage&
+  transparent_windows_renderable::window
   transparent_windows_renderable::get( handle h )
   {
     return m_windows.get( h );
@@ -92,13 +43,45 @@ namespace graphics_origin {
 
   void transparent_windows_renderable::sort()
   {
-    // first compute the depth for all windows (done in parallel by the tight buffer manager)
-    m_windows.process( storage_depth_computation{renderer_ptr->get_view_matrix()} );
+    // first compute the depth for all windows, only from the center column
+    const gl_mat4& view = renderer_ptr->get_view_matrix();
+    const gl_vec3 eye = -gl_vec3( view[3] ) * gl_mat3( view );
+    const gl_vec3 forward{ -view[0][2], -view[1][2], -view[2][2] };
+    const auto centers = m_windows.column< center_column >();
+    const auto depths = m_windows.column< depth_column >();
+# ifdef _MSC_VER
+    GO_MSVC_OMP_NO_UNSIGNED_FOR_INDEX
+    # pragma omp parallel for
+    for( long i = 0; i < centers.size(); ++ i )
+# else
+    # pragma omp parallel for
+    for( size_t i = 0; i < centers.size(); ++ i )
+# endif
+      depths[ i ] = dot( forward, centers[ i ] - eye );
     // then sort windows according to this depth (done in parallel by the tight buffer manager)
-    m_windows.sort( storage_depth_ordering{} );
+    m_windows.sort< depth_column >( std::greater< gl_real >{} );
     // now update the data on the GPU.
     glcheck(glBindBuffer( GL_ARRAY_BUFFER, m_vbos[ windows_vbo_id] ));
-    glcheck(glBufferData( GL_ARRAY_BUFFER, sizeof(storage) * m_windows.get_size(), m_windows.data(), GL_DYNAMIC_DRAW));
+    upload();
+  }
+
+  // Upload the center, v1, v2 and color columns one after the other in the
+  // bound buffer. The depths are not needed on the GPU.
+  void transparent_windows_renderable::upload()
+  {
+    const auto centers = m_windows.column< center_column >();
+    const auto v1s = m_windows.column< v1_column >();
+    const auto v2s = m_windows.column< v2_column >();
+    const auto colors = m_windows.column< color_column >();
+    size_t offset = 0;
+    glcheck(glBufferData( GL_ARRAY_BUFFER, centers.size_in_bytes() + v1s.size_in_bytes() + v2s.size_in_bytes() + colors.size_in_bytes(), nullptr, GL_DYNAMIC_DRAW));
+    glcheck(glBufferSubData( GL_ARRAY_BUFFER, offset, centers.size_in_bytes(), centers.data() ));
+    offset += centers.size_in_bytes();
+    glcheck(glBufferSubData( GL_ARRAY_BUFFER, offset, v1s.size_in_bytes(), v1s.data() ));
+    offset += v1s.size_in_bytes();
+    glcheck(glBufferSubData( GL_ARRAY_BUFFER, offset, v2s.size_in_bytes(), v2s.data() ));
+    offset += v2s.size_in_bytes();
+    glcheck(glBufferSubData( GL_ARRAY_BUFFER, offset, colors.size_in_bytes(), colors.data() ));
   }
 
     void transparent_windows_renderable::update_gpu_data()
@@ -116,31 +99,33 @@ namespace graphics_origin {
 
       glcheck(glBindVertexArray( m_vao ));
         glcheck(glBindBuffer( GL_ARRAY_BUFFER, m_vbos[ windows_vbo_id] ));
-        glcheck(glBufferData( GL_ARRAY_BUFFER, sizeof(storage) * m_windows.get_size(), m_windows.data(), GL_DYNAMIC_DRAW));
+        upload();
 
+        // each stream is tightly packed, and follows the previous one
+        const size_t stream_size = m_windows.get_size() * sizeof(gl_vec3);
         glcheck(glEnableVertexAttribArray( center_location ));
         glcheck(glVertexAttribPointer( center_location,        // format of center:
           3, GL_FLOAT, GL_FALSE,                               // 3 unnormalized floats
-          sizeof(storage),                                     // each attribute has the size of storage
-          reinterpret_cast<void*>(offsetof(storage,center)))); // offset of the center inside an attribute
+          0,                                                   // centers are tightly packed
+          reinterpret_cast<void*>(0)));                        // first stream
 
         glcheck(glEnableVertexAttribArray( v1_location ));
         glcheck(glVertexAttribPointer( v1_location,            // format of v1:
           3, GL_FLOAT, GL_FALSE,                               // 3 unnormalized floats
-          sizeof(storage),                                     // each attribute has the size of storage
-          reinterpret_cast<void*>(offsetof(storage,v1))));     // offset of the v1 inside an attribute
+          0,                                                   // v1s are tightly packed
+          reinterpret_cast<void*>(stream_size)));              // after the centers
 
         glcheck(glEnableVertexAttribArray( v2_location ));
-        glcheck(glVertexAttribPointer( v2_location,            // format of v1:
+        glcheck(glVertexAttribPointer( v2_location,            // format of v2:
           3, GL_FLOAT, GL_FALSE,                               // 3 unnormalized floats
-          sizeof(storage),                                     // each attribute has the size of storage
-          reinterpret_cast<void*>(offsetof(storage,v2))));     // offset of the v1 inside an attribute
+          0,                                                   // v2s are tightly packed
+          reinterpret_cast<void*>(2 * stream_size)));          // after the v1s
 
         glcheck(glEnableVertexAttribArray( color_location ));
         glcheck(glVertexAttribPointer( color_location,        // format of color:
           4, GL_FLOAT, GL_FALSE,                              // 4 unnormalized floats
-          sizeof(storage),                                    // each attribute has the size of storage
-          reinterpret_cast<void*>(offsetof(storage,color)))); // offset of the color inside an attribute
+          0,                                                  // colors are tightly packed
+          reinterpret_cast<void*>(3 * stream_size)));         // after the v2s
 
       glcheck(glBindVertexArray( 0 ));
     }
@@ -1,7 +1,7 @@
 # ifndef PROJECT_TRANSPARENT_WINDOWS_RENDERABLE_H_
 # define PROJECT_TRANSPARENT_WINDOWS_RENDERABLE_H_
 # include "../../../graphics-origin/application/renderable.h"
-# include "../../../graphics-origin/tools/tight_buffer_manager.h"
+# include "../../../graphics-origin/tools/tight_soa_buffer_manager.h"
 
 namespace graphics_origin {
   namespace application {
@@ -35,37 +35,22 @@ namespace graphics_origin {
     class transparent_windows_renderable
       : public graphics_origin::application::renderable {
 
-      struct storage {
-        gl_vec3 center;
-        gl_vec3 v1;
-        gl_vec3 v2;
-        gl_vec4 color;
-        gl_real depth;
-
-        storage( const storage& other );
-        storage& operator=( const storage& other );
-        storage& operator=( storage&& other );
-        storage();
-      };
-
-      typedef tools::tight_buffer_manager<
-          storage,
+      // Each field of the windows is stored in its own column. The depth
+      // computation and the sort only touch the center and depth columns,
+      // and the other columns are uploaded as separate vertex streams.
+      enum { center_column, v1_column, v2_column, color_column, depth_column };
+      typedef tools::tight_soa_buffer_manager<
           uint32_t,
-          22 > windows_buffer;
-
-      struct storage_depth_computation {
-        storage_depth_computation( const gl_mat4& view );
-        void operator()( storage& s ) const;
-        const gl_vec3 eye;
-        const gl_vec3 forward;
-      };
-
-      struct storage_depth_ordering {
-        bool operator()( const storage& a, const storage& b ) const;
-      };
+          22,
+          gl_vec3,
+          gl_vec3,
+          gl_vec3,
+          gl_vec4,
+          gl_real > windows_buffer;
 
     public:
       typedef windows_buffer::handle handle;
+      typedef windows_buffer::reference window;
 
       /**@brief Create a new collection of transparent windows.
        *
@@ -106,15 +91,17 @@ namespace graphics_origin {
        * Access to a window that was previously created by add(). If you modify
        * the data of a window, be sure to notify
        * @param h Handle of the existing window.
-       * @return The window pointed by the handle h.
+       * @return References to the center, v1, v2, color and depth of the window
+       * pointed by the handle h.
        */
-      storage& get( handle h );
+      window get( handle h );
 
     private:
       void update_gpu_data() override;
       void do_render() override;
       void remove_gpu_data() override;
       void sort();
+      void upload();
 
       windows_buffer m_windows;
       enum{ windows_vbo_id, number_of_vbos };